@@ -76,4 +76,14 @@ namespace pika::execution::experimental {
       : detail::property_base<get_annotation_t>
     {
     } get_annotation{};
+
+    inline constexpr struct with_inline_execution_t final
+      : detail::property_base<with_inline_execution_t>
+    {
+    } with_inline_execution{};
+
+    inline constexpr struct get_inline_execution_t final
+      : detail::property_base<get_inline_execution_t>
+    {
+    } get_inline_execution{};
 }    // namespace pika::execution::experimental
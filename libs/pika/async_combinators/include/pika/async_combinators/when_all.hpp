@@ -133,9 +133,9 @@ namespace pika {
 #else    // DOXYGEN
 
 #include <pika/config.hpp>
-#include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/datastructures/tuple.hpp>
 #include <pika/futures/detail/future_data.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/detail/future_transforms.hpp>
 #include <pika/futures/future.hpp>
 #include <pika/futures/traits/acquire_future.hpp>
@@ -233,7 +233,7 @@ namespace pika {
             using no_addref = typename frame_type::base_type::init_no_addref;
 
             auto frame = pika::util::traverse_pack_async_allocator(
-                pika::detail::internal_allocator<>{},
+                pika::lcos::detail::default_future_data_allocator<>{},
                 pika::util::async_traverse_in_place_tag<frame_type>{},
                 no_addref{},
                 pika::traits::acquire_future_disp()(PIKA_FORWARD(T, args))...);
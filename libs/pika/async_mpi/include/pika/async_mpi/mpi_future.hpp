@@ -46,13 +46,12 @@ namespace pika { namespace mpi { namespace experimental {
 
     namespace detail {
 
+        // mutex protecting the requests of one shard of the request
+        // registry, note that the mpi poll function takes place inside the
+        // main scheduling loop of pika and not on an pika worker thread, so
+        // we can't use a pika mutex
         using mutex_type = pika::lcos::local::spinlock;
 
-        // mutex needed to protect mpi request vector, note that the
-        // mpi poll function takes place inside the main scheduling loop
-        // of pika and not on an pika worker thread, so we must use std:mutex
-        PIKA_EXPORT mutex_type& get_vector_mtx();
-
         // -----------------------------------------------------------------
         // An implementation of future_data for MPI
         struct future_data : pika::lcos::detail::future_data<int>
@@ -116,11 +115,11 @@ namespace pika { namespace mpi { namespace experimental {
             bool error_handler_initialized_ = false;
             int rank_ = -1;
             int size_ = -1;
-            // requests vector holds the requests that are checked; this
-            // represents the number of active requests in the vector, not the
-            // size of the vector
+            // the number of requests that are being tested, summed over all
+            // shards of the request registry
             std::atomic<std::uint32_t> active_requests_vector_size_{0};
-            // requests queue holds the requests recently added
+            // the number of requests recently added that have not been
+            // picked up by a polling thread yet
             std::atomic<std::uint32_t> requests_queue_size_{0};
         };
 
@@ -139,14 +138,6 @@ namespace pika { namespace mpi { namespace experimental {
         // function that converts an MPI error into an exception
         PIKA_EXPORT void pika_MPI_Handler(MPI_Comm*, int* errorcode, ...);
 
-        // -----------------------------------------------------------------
-        // we track requests and callbacks in two vectors even though
-        // we have the request stored in the request_callback vector already
-        // the reason for this is because we can use MPI_Testany
-        // with a vector of requests to save overheads compared
-        // to testing one by one every item (using a list)
-        PIKA_EXPORT std::vector<MPI_Request>& get_requests_vector();
-
         // -----------------------------------------------------------------
         // define a lockfree queue type to place requests in prior to handling
         // this is done only to avoid taking a lock every time a request is
@@ -155,9 +146,9 @@ namespace pika { namespace mpi { namespace experimental {
         using queue_type = concurrency::ConcurrentQueue<future_data_ptr>;
 
         // -----------------------------------------------------------------
-        // used internally to query how many requests are 'in flight'
-        // these are requests that are being polled for actively
-        // and not the same as the requests enqueued
+        // used internally to query how many requests are 'in flight', this
+        // includes the requests being tested and the requests that have
+        // been added but not yet picked up by a polling thread
         PIKA_EXPORT std::size_t get_number_of_active_requests();
 
     }    // namespace detail
@@ -201,35 +192,31 @@ namespace pika { namespace mpi { namespace experimental {
     // when found
     PIKA_EXPORT pika::threads::policies::detail::polling_status poll();
 
+    // -----------------------------------------------------------------
+    // The maximum number of requests tested by a single call to poll. This
+    // bounds the time a worker thread spends polling when many requests are
+    // in flight, requests which aren't tested in one call are tested in the
+    // following ones. A value of 0 means that all requests are tested. The
+    // initial value is taken from the configuration entry
+    // pika.mpi.max_requests_per_poll when polling is enabled.
+    PIKA_EXPORT void set_max_requests_per_poll(std::size_t max_requests);
+    PIKA_EXPORT std::size_t get_max_requests_per_poll();
+
     // -----------------------------------------------------------------
     // This is not completely safe as it will return when the request vector is
     // empty, but cannot guarantee that other communications are not about
     // to be launched in outstanding continuations etc.
     inline void wait()
     {
-        pika::util::yield_while([]() {
-            std::unique_lock<detail::mutex_type> lk(
-                detail::get_vector_mtx(), std::try_to_lock);
-            if (!lk.owns_lock())
-            {
-                return true;
-            }
-            return (detail::get_mpi_info().active_requests_vector_size_ > 0);
-        });
+        pika::util::yield_while(
+            []() { return detail::get_number_of_active_requests() > 0; });
     }
 
     template <typename F>
     inline void wait(F&& f)
     {
         pika::util::yield_while([&]() {
-            std::unique_lock<detail::mutex_type> lk(
-                detail::get_vector_mtx(), std::try_to_lock);
-            if (!lk.owns_lock())
-            {
-                return true;
-            }
-            return (detail::get_mpi_info().active_requests_vector_size_ > 0) ||
-                f();
+            return detail::get_number_of_active_requests() > 0 || f();
         });
     }
 
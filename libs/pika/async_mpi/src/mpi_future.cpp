@@ -8,15 +8,21 @@
 #include <pika/assert.hpp>
 #include <pika/async_mpi/mpi_exception.hpp>
 #include <pika/async_mpi/mpi_future.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/modules/threading_base.hpp>
 #include <pika/mpi_base/mpi_environment.hpp>
+#include <pika/runtime/config_entry.hpp>
 #include <pika/synchronization/mutex.hpp>
+#include <pika/util/from_string.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -39,34 +45,69 @@ namespace pika { namespace mpi { namespace experimental {
         using request_callback_queue_type =
             concurrency::ConcurrentQueue<request_callback>;
 
-        request_callback_queue_type& get_request_callback_queue()
+        // In-flight requests are distributed over a number of shards (one
+        // per worker thread of the polling pool). New requests are handed
+        // off to a shard through a lock-free queue, only the thread polling
+        // a shard moves them to the vectors that are passed to
+        // MPI_Testsome. We track requests and callbacks in two vectors even
+        // though the request is part of the request_callback already, this
+        // allows passing the requests to MPI without copying them.
+        struct request_shard
         {
-            static request_callback_queue_type request_callback_queue;
-            return request_callback_queue;
-        }
+            // taken with try_lock by the polling threads, a shard is never
+            // polled by more than one thread at a time
+            mutex_type mtx_;
+            request_callback_queue_type queue_;
+            std::atomic<std::size_t> queue_size_{0};
+
+            std::vector<MPI_Request> requests_;
+            std::vector<request_callback_function_type> callbacks_;
+
+            // the first request tested by the next poll, used to rotate
+            // through the requests if not all of them can be tested at once
+            std::size_t next_request_ = 0;
+        };
 
-        using request_callback_vector_type = std::vector<request_callback>;
+        using request_shard_vector_type =
+            std::vector<util::cache_line_data<request_shard>>;
+
+        request_shard_vector_type& get_request_shards()
+        {
+            static request_shard_vector_type request_shards;
+            return request_shards;
+        }
 
-        request_callback_vector_type& get_request_callback_vector()
+        // Shards are selected based on the local worker thread number. If
+        // the requests are created on the polling pool, the thread creating
+        // a request is usually also the first to test it.
+        std::size_t get_shard_index(std::size_t num_shards)
         {
-            static request_callback_vector_type request_callback_vector;
-            return request_callback_vector;
+            std::size_t num_thread = pika::get_local_worker_thread_num();
+            if (num_thread == std::size_t(-1))
+            {
+                static std::atomic<std::size_t> next_shard{0};
+                num_thread = next_shard++;
+            }
+            return num_thread % num_shards;
         }
 
-        std::size_t get_num_active_requests_in_vector()
+        std::atomic<std::size_t>& get_max_requests_per_poll_value()
         {
-            return std::count_if(detail::get_requests_vector().begin(),
-                detail::get_requests_vector().end(),
-                [](MPI_Request r) { return r != MPI_REQUEST_NULL; });
+            static std::atomic<std::size_t> max_requests_per_poll{
+                PIKA_MPI_MAX_REQUESTS_PER_POLL};
+            return max_requests_per_poll;
         }
 
-        // used internally to add an MPI_Request to the lockfree queue
-        // that will be used by the polling routines to check when requests
-        // have completed
+        // used internally to add an MPI_Request to the lockfree queue of a
+        // shard that will be used by the polling routines to check when
+        // requests have completed
         void add_to_request_callback_queue(request_callback&& req_callback)
         {
-            get_request_callback_queue().enqueue(std::move(req_callback));
-            ++(get_mpi_info().requests_queue_size_);
+            auto& shards = get_request_shards();
+            PIKA_ASSERT(!shards.empty());
+
+            request_shard& shard =
+                shards[get_shard_index(shards.size())].data_;
 
             if constexpr (mpi_debug.is_enabled())
             {
@@ -74,26 +115,10 @@ namespace pika { namespace mpi { namespace experimental {
                     get_mpi_info(), "request",
                     debug::hex<8>(req_callback.request));
             }
-        }
-
-        // used internally to add a request to the main polling vector
-        // that is passed to MPI_Testany
-        void add_to_request_callback_vector(request_callback&& req_callback)
-        {
-            get_requests_vector().push_back(req_callback.request);
-            get_request_callback_vector().push_back(std::move(req_callback));
-            ++(get_mpi_info().active_requests_vector_size_);
 
-            if constexpr (mpi_debug.is_enabled())
-            {
-                mpi_debug.debug(
-                    debug::str<>("request callback moved from queue to vector"),
-                    get_mpi_info(), "request",
-                    debug::hex<8>(req_callback.request), "callbacks in vector",
-                    debug::dec<3>(get_request_callback_vector().size()),
-                    "non null",
-                    debug::dec<3>(get_num_active_requests_in_vector()));
-            }
+            ++(get_mpi_info().requests_queue_size_);
+            ++shard.queue_size_;
+            shard.queue_.enqueue(std::move(req_callback));
         }
 
 #if defined(PIKA_DEBUG)
@@ -116,15 +141,6 @@ namespace pika { namespace mpi { namespace experimental {
                 request_callback{request, std::move(callback)});
         }
 
-        // mutex needed to protect mpi request vector, note that the
-        // mpi poll function takes place inside the main scheduling loop
-        // of pika and not on an pika worker thread, so we must use std:mutex
-        mutex_type& get_vector_mtx()
-        {
-            static mutex_type vector_mtx;
-            return vector_mtx;
-        }
-
         // an MPI error handling type that we can use to intercept
         // MPI errors if we enable the error handler
         MPI_Errhandler pika_mpi_errhandler = 0;
@@ -156,13 +172,164 @@ namespace pika { namespace mpi { namespace experimental {
                 detail::error_message(*errorcode));
         }
 
-        std::vector<MPI_Request>& get_requests_vector()
+        std::size_t get_number_of_active_requests()
         {
-            static std::vector<MPI_Request> requests_vector;
-            return requests_vector;
+            return get_mpi_info().active_requests_vector_size_ +
+                get_mpi_info().requests_queue_size_;
+        }
+
+        // Callbacks of completed requests are collected while the shard is
+        // locked and invoked only after the lock has been released. The
+        // buffers are reused between calls to poll.
+        struct poll_buffers
+        {
+            std::vector<int> indices_;
+            std::vector<MPI_Status> statuses_;
+            std::vector<std::size_t> order_;
+            std::vector<std::pair<request_callback_function_type, int>>
+                completed_;
+        };
+
+        poll_buffers& get_poll_buffers()
+        {
+            static thread_local poll_buffers buffers;
+            return buffers;
+        }
+
+        // Tests at most max_requests of the requests in the given shard,
+        // completed requests are removed from the shard and their callbacks
+        // are appended to buffers.completed_. Returns the number of tested
+        // requests.
+        std::size_t poll_shard(request_shard& shard, std::size_t max_requests,
+            poll_buffers& buffers)
+        {
+            // have any requests been made that need to be handled?
+            if (shard.queue_size_.load(std::memory_order_relaxed) != 0)
+            {
+                request_callback req_callback;
+                while (shard.queue_.try_dequeue(req_callback))
+                {
+                    --shard.queue_size_;
+                    shard.requests_.push_back(req_callback.request);
+                    shard.callbacks_.push_back(
+                        PIKA_MOVE(req_callback.callback_function));
+
+                    ++(get_mpi_info().active_requests_vector_size_);
+                    --(get_mpi_info().requests_queue_size_);
+                }
+            }
+
+            std::size_t const num_requests = shard.requests_.size();
+            if (num_requests == 0)
+            {
+                return 0;
+            }
+
+            // test a window of at most max_requests requests, continuing
+            // where the previous poll has stopped
+            std::size_t const first =
+                shard.next_request_ < num_requests ? shard.next_request_ : 0;
+            std::size_t const count =
+                (std::min)(max_requests, num_requests - first);
+
+            buffers.indices_.resize(count);
+            buffers.statuses_.resize(count);
+
+            int outcount = 0;
+            int const result = MPI_Testsome(static_cast<int>(count),
+                shard.requests_.data() + first, &outcount,
+                buffers.indices_.data(), buffers.statuses_.data());
+
+            if (result != MPI_SUCCESS && result != MPI_ERR_IN_STATUS)
+            {
+                // The requests can't be tested reliably anymore, report the
+                // error to all of them.
+                if constexpr (mpi_debug.is_enabled())
+                {
+                    mpi_debug.error(debug::str<>("Poll <ERR>"),
+                        get_mpi_info(), "MPI_ERROR",
+                        detail::error_message(result));
+                }
+
+                outcount = static_cast<int>(count);
+                for (std::size_t i = 0; i != count; ++i)
+                {
+                    buffers.indices_[i] = static_cast<int>(i);
+                    buffers.statuses_[i].MPI_ERROR = result;
+                }
+            }
+            else if (outcount == MPI_UNDEFINED)
+            {
+                outcount = 0;
+            }
+
+            // Remove the completed requests from the shard by moving the
+            // last request into their place. Higher indices have to be
+            // removed first so that no completed request is moved.
+            std::vector<int> const& indices = buffers.indices_;
+            std::vector<std::size_t>& order = buffers.order_;
+            order.resize(std::size_t(outcount));
+            for (std::size_t i = 0; i != order.size(); ++i)
+            {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(),
+                [&](std::size_t lhs, std::size_t rhs) {
+                    return indices[lhs] > indices[rhs];
+                });
+
+            for (std::size_t i : order)
+            {
+                std::size_t const index = first + std::size_t(indices[i]);
+                int const status = result == MPI_SUCCESS ?
+                    MPI_SUCCESS :
+                    buffers.statuses_[i].MPI_ERROR;
+
+                buffers.completed_.emplace_back(
+                    PIKA_MOVE(shard.callbacks_[index]), status);
+
+                if (index != shard.requests_.size() - 1)
+                {
+                    shard.requests_[index] = shard.requests_.back();
+                    shard.callbacks_[index] =
+                        PIKA_MOVE(shard.callbacks_.back());
+                }
+                shard.requests_.pop_back();
+                shard.callbacks_.pop_back();
+            }
+
+            get_mpi_info().active_requests_vector_size_ -=
+                static_cast<std::uint32_t>(outcount);
+
+            std::size_t const next = first + count - std::size_t(outcount);
+            shard.next_request_ = next < shard.requests_.size() ? next : 0;
+
+            if constexpr (mpi_debug.is_enabled())
+            {
+                if (outcount != 0)
+                {
+                    mpi_debug.debug(debug::str<>("MPI_Testsome"),
+                        get_mpi_info(), "tested", debug::dec<3>(count),
+                        "completed", debug::dec<3>(outcount));
+                }
+            }
+
+            return count;
         }
     }    // namespace detail
 
+    void set_max_requests_per_poll(std::size_t max_requests)
+    {
+        detail::get_max_requests_per_poll_value().store(
+            max_requests, std::memory_order_relaxed);
+    }
+
+    std::size_t get_max_requests_per_poll()
+    {
+        return detail::get_max_requests_per_poll_value().load(
+            std::memory_order_relaxed);
+    }
+
     // return a future object from a user supplied MPI_Request
     pika::future<void> get_future(MPI_Request request)
     {
@@ -202,174 +369,66 @@ namespace pika { namespace mpi { namespace experimental {
     {
         using pika::threads::policies::detail::polling_status;
 
-        auto& request_callback_vector = detail::get_request_callback_vector();
-        auto& requests_vector = detail::get_requests_vector();
-
-        std::unique_lock<detail::mutex_type> lk(
-            detail::get_vector_mtx(), std::try_to_lock);
-        if (!lk.owns_lock())
+        if (detail::get_number_of_active_requests() == 0)
         {
-            if constexpr (mpi_debug.is_enabled())
-            {
-                // for debugging, create a timer
-                static auto poll_deb =
-                    mpi_debug.make_timer(1, debug::str<>("Poll - lock failed"));
-                // output mpi debug info every N seconds
-                mpi_debug.timed(poll_deb, detail::get_mpi_info());
-            }
             return polling_status::idle;
         }
 
+        auto& shards = detail::get_request_shards();
+        std::size_t const num_shards = shards.size();
+
+        std::size_t max_requests = get_max_requests_per_poll();
+        if (max_requests == 0)
+        {
+            max_requests = (std::numeric_limits<std::size_t>::max)();
+        }
+
         if constexpr (mpi_debug.is_enabled())
         {
             // for debugging, create a timer
             static auto poll_deb =
-                mpi_debug.make_timer(1, debug::str<>("Poll - lock success"));
+                mpi_debug.make_timer(1, debug::str<>("Poll"));
             // output mpi debug info every N seconds
             mpi_debug.timed(poll_deb, detail::get_mpi_info());
         }
 
+        // Start with the shard belonging to this thread, continue with the
+        // other shards unless they are being polled by another thread.
+        detail::poll_buffers& buffers = detail::get_poll_buffers();
+        std::size_t const first = detail::get_shard_index(num_shards);
+        for (std::size_t i = 0; i != num_shards && max_requests != 0; ++i)
         {
-            // have any requests been made that need to be handled?
-            detail::request_callback req_callback;
-            while (
-                detail::get_request_callback_queue().try_dequeue(req_callback))
-            {
-                --(detail::get_mpi_info().requests_queue_size_);
-                add_to_request_callback_vector(PIKA_MOVE(req_callback));
-            }
-        }
-
-        bool keep_trying = !requests_vector.empty();
-        while (keep_trying)
-        {
-            int index = 0;
-            int flag = false;
-            MPI_Status status;
-
-            int result = MPI_Testany(static_cast<int>(requests_vector.size()),
-                requests_vector.data(), &index, &flag, &status);
-
-            if constexpr (mpi_debug.is_enabled())
-            {
-                if (result == MPI_SUCCESS)
-                {
-                    static auto poll_deb =
-                        mpi_debug.make_timer(1, debug::str<>("Poll - success"));
-
-                    mpi_debug.timed(poll_deb, detail::get_mpi_info(),
-                        debug::str<>("Success"), "index",
-                        debug::dec<>(index == MPI_UNDEFINED ? -1 : index),
-                        "flag", debug::dec<>(flag), "status",
-                        debug::hex(status.MPI_ERROR));
-                }
-                else
-                {
-                    auto poll_deb =
-                        mpi_debug.make_timer(1, debug::str<>("Poll - <ERR>"));
-
-                    mpi_debug.error(poll_deb, detail::get_mpi_info(),
-                        debug::str<>("Poll <ERR>"), "MPI_ERROR",
-                        detail::error_message(status.MPI_ERROR), "status",
-                        debug::dec<>(status.MPI_ERROR), "index",
-                        debug::dec<>(index), "flag", debug::dec<>(flag));
-                }
-            }
-
-            // No operation completed
-            if (index == MPI_UNDEFINED)
-                break;
+            detail::request_shard& shard =
+                shards[(first + i) % num_shards].data_;
 
-            keep_trying = flag;
-            if constexpr (mpi_debug.is_enabled())
+            std::unique_lock<detail::mutex_type> lk(
+                shard.mtx_, std::try_to_lock);
+            if (!lk.owns_lock())
             {
-                // One operation completed
-                if (keep_trying)
-                {
-                    mpi_debug.debug(debug::str<>("MPI_Testany(set)"),
-                        detail::get_mpi_info(), "request",
-                        debug::hex<8>(requests_vector[std::size_t(index)]),
-                        "vector size", debug::dec<3>(requests_vector.size()),
-                        "non null",
-                        debug::dec<3>(
-                            detail::get_num_active_requests_in_vector()));
-                }
+                continue;
             }
-            if (result != MPI_SUCCESS)    // Error and operation not completed
-                keep_trying = false;
-            if (keep_trying || result != MPI_SUCCESS)
-            {
-                // Invoke the callback with the status of the completed
-                // operation (status of the request is forwarded to MPI_Testany)
-                request_callback_vector[std::size_t(index)].callback_function(
-                    result);
 
-                // Remove the request from our vector to prevent retesting
-                requests_vector[std::size_t(index)] = MPI_REQUEST_NULL;
-
-                // Could store only the callbacks, right now the request
-                // is only used for an assert
-                request_callback_vector[std::size_t(index)].request =
-                    MPI_REQUEST_NULL;
-
-                --(detail::get_mpi_info().active_requests_vector_size_);
-            }
-        }
+            max_requests -= detail::poll_shard(shard, max_requests, buffers);
+            lk.unlock();
 
-        // if there are more than 25% NULL request handles in our vector,
-        // compact them
-        if (!requests_vector.empty())
-        {
-            std::size_t nulls = std::count(requests_vector.begin(),
-                requests_vector.end(), MPI_REQUEST_NULL);
-
-            if (nulls > requests_vector.size() / 4)
+            // Invoke the callbacks with the status of the completed
+            // operations
+            for (auto& completed : buffers.completed_)
             {
-                // compact away any requests that have been replaced by
-                // MPI_REQUEST_NULL
-                auto end1 = std::remove(requests_vector.begin(),
-                    requests_vector.end(), MPI_REQUEST_NULL);
-                requests_vector.resize(
-                    std::distance(requests_vector.begin(), end1));
-
-                auto end2 = std::remove_if(request_callback_vector.begin(),
-                    request_callback_vector.end(),
-                    [](detail::request_callback& req_callback) {
-                        return req_callback.request == MPI_REQUEST_NULL;
-                    });
-                request_callback_vector.resize(
-                    std::distance(request_callback_vector.begin(), end2));
-
-                if (requests_vector.size() != request_callback_vector.size())
-                {
-                    PIKA_THROW_EXCEPTION(invalid_status,
-                        "pika::mpi::experimental::poll",
-                        "Fatal Error: Mismatch in vectors");
-                }
-
-                detail::get_mpi_info().active_requests_vector_size_ =
-                    static_cast<std::uint32_t>(requests_vector.size());
-
-                if constexpr (mpi_debug.is_enabled())
-                {
-                    mpi_debug.debug(debug::str<>("MPI_REQUEST_NULL"),
-                        detail::get_mpi_info(), "nulls ", debug::dec<>(nulls));
-                }
+                completed.first(completed.second);
             }
+            buffers.completed_.clear();
         }
 
-        return requests_vector.empty() ? polling_status::idle :
-                                         polling_status::busy;
+        return detail::get_number_of_active_requests() == 0 ?
+            polling_status::idle :
+            polling_status::busy;
     }
 
     namespace detail {
         std::size_t get_work_count()
         {
-            std::size_t work_count =
-                get_mpi_info().active_requests_vector_size_;
-            work_count += get_mpi_info().requests_queue_size_;
-
-            return work_count;
+            return get_number_of_active_requests();
         }
 
         // -------------------------------------------------------------
@@ -379,6 +438,18 @@ namespace pika { namespace mpi { namespace experimental {
             ++get_register_polling_count();
 #endif
             mpi_debug.debug(debug::str<>("enable polling"));
+
+            // The shards are created once, when polling is enabled for the
+            // first time. One shard per worker thread of the polling pool
+            // keeps the polling threads from competing for the same
+            // requests.
+            auto& shards = get_request_shards();
+            if (shards.empty())
+            {
+                shards = request_shard_vector_type(
+                    (std::max)(pool.get_os_thread_count(), std::size_t(1)));
+            }
+
             auto* sched = pool.get_scheduler();
             sched->set_mpi_polling_functions(
                 &pika::mpi::experimental::poll, &get_work_count);
@@ -389,13 +460,10 @@ namespace pika { namespace mpi { namespace experimental {
         {
 #if defined(PIKA_DEBUG)
             {
-                std::unique_lock<pika::mpi::experimental::detail::mutex_type>
-                    lk(detail::get_vector_mtx());
                 bool requests_queue_empty =
-                    get_request_callback_queue().size_approx() == 0;
+                    get_mpi_info().requests_queue_size_ == 0;
                 bool requests_vector_empty =
-                    get_num_active_requests_in_vector() == 0;
-                lk.unlock();
+                    get_mpi_info().active_requests_vector_size_ == 0;
                 PIKA_ASSERT_MSG(requests_queue_empty,
                     "MPI request polling was disabled while there are "
                     "unprocessed MPI requests. Make sure MPI request polling "
@@ -457,6 +525,11 @@ namespace pika { namespace mpi { namespace experimental {
         mpi_debug.debug(debug::str<>("pika::mpi::experimental::init"),
             detail::get_mpi_info());
 
+        set_max_requests_per_poll(
+            pika::util::from_string<std::size_t>(pika::get_config_entry(
+                "pika.mpi.max_requests_per_poll",
+                PIKA_MPI_MAX_REQUESTS_PER_POLL)));
+
         if (init_errorhandler)
         {
             set_error_handler();
@@ -0,0 +1,119 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This test creates many MPI requests from all worker threads at the same
+// time and checks that every one of them completes even when only a few
+// requests may be tested by each call to the polling function.
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/mpi.hpp>
+#include <pika/program_options.hpp>
+#include <pika/testing.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+namespace mpi = pika::mpi::experimental;
+
+void test_requests(std::size_t num_messages, std::size_t max_requests_per_poll)
+{
+    int rank, size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    int const rank_from = (size + rank - 1) % size;
+    int const rank_to = (rank + 1) % size;
+
+    mpi::set_max_requests_per_poll(max_requests_per_poll);
+    PIKA_TEST_EQ(mpi::get_max_requests_per_poll(), max_requests_per_poll);
+
+    std::vector<int> send_buffer(num_messages);
+    std::vector<int> recv_buffer(num_messages, -1);
+    mpi::executor exec(MPI_COMM_WORLD);
+
+    // create the requests from all worker threads so that they end up in
+    // different shards of the request registry
+    std::vector<pika::future<void>> futures;
+    futures.reserve(num_messages);
+    for (std::size_t i = 0; i != num_messages; ++i)
+    {
+        futures.push_back(pika::async([&, i]() {
+            int const tag = static_cast<int>(i);
+            send_buffer[i] = rank * int(num_messages) + tag;
+
+            pika::future<int> f_recv = pika::async(
+                exec, MPI_Irecv, &recv_buffer[i], 1, MPI_INT, rank_from, tag);
+            pika::future<int> f_send = pika::async(
+                exec, MPI_Isend, &send_buffer[i], 1, MPI_INT, rank_to, tag);
+
+            PIKA_TEST_EQ(f_send.get(), MPI_SUCCESS);
+            PIKA_TEST_EQ(f_recv.get(), MPI_SUCCESS);
+        }));
+    }
+    pika::wait_all(futures);
+
+    for (std::size_t i = 0; i != num_messages; ++i)
+    {
+        PIKA_TEST_EQ(recv_buffer[i], rank_from * int(num_messages) + int(i));
+    }
+
+    mpi::wait();
+    PIKA_TEST_EQ(mpi::detail::get_number_of_active_requests(), std::size_t(0));
+}
+
+int pika_main(variables_map& vm)
+{
+    std::size_t const num_messages = vm["messages"].as<std::size_t>();
+
+    {
+        mpi::enable_user_polling enable_polling;
+
+        // the limit is initialized from the configuration
+        PIKA_TEST_EQ(mpi::get_max_requests_per_poll(),
+            std::size_t(PIKA_MPI_MAX_REQUESTS_PER_POLL));
+
+        // test all requests on every poll
+        test_requests(num_messages, 0);
+
+        // only a few requests per poll
+        test_requests(num_messages, 1);
+        test_requests(num_messages, 7);
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    // all ranks run their main function
+    std::vector<std::string> cfg = {"pika.run_pika_main!=1"};
+
+    int provided = MPI_THREAD_MULTIPLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    PIKA_TEST_EQ(provided, MPI_THREAD_MULTIPLE);
+
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+    cmdline.add_options()("messages", value<std::size_t>()->default_value(1000),
+        "number of messages sent to the next rank");
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+    init_args.cfg = cfg;
+
+    auto result = pika::init(pika_main, argc, argv, init_args);
+
+    MPI_Finalize();
+
+    return result || pika::util::report_errors();
+}
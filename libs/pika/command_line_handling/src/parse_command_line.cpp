@@ -356,8 +356,9 @@ namespace pika::detail {
                 ("pika:queuing", value<std::string>(),
                   "the queue scheduling policy to use, options are "
                   "'local', 'local-priority-fifo','local-priority-lifo', "
-                  "'abp-priority-fifo', 'abp-priority-lifo', 'static', and "
-                  "'static-priority' (default: 'local-priority'; "
+                  "'local-priority-chase-lev', 'abp-priority-fifo', "
+                  "'abp-priority-lifo', 'static', and 'static-priority' "
+                  "(default: 'local-priority'; "
                   "all option values can be abbreviated)")
                 ("pika:high-priority-threads", value<std::size_t>(),
                   "the number of operating system threads maintaining a high "
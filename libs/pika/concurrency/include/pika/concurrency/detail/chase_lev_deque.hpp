@@ -0,0 +1,225 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace pika { namespace concurrency { namespace detail {
+    /// \brief A dynamically growing work-stealing deque.
+    ///
+    /// The deque has a single owner which pushes and pops items at the bottom
+    /// end without any read-modify-write operations, except when popping the
+    /// last remaining item. Any number of other threads can concurrently
+    /// steal items from the top end. This is the deque described by Chase and
+    /// Lev (https://doi.org/10.1145/1073970.1073974) with the memory orderings
+    /// of Lê et al. (https://doi.org/10.1145/2442516.2442524).
+    ///
+    /// The buffer is grown by the owner when it is full. Buffers which have
+    /// been replaced may still be read by concurrent thieves and are only
+    /// freed when the deque is destroyed. Since the buffer grows
+    /// geometrically this at most doubles the memory held by the deque.
+    template <typename T>
+    class chase_lev_deque
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "chase_lev_deque requires trivially copyable items as stealing "
+            "threads may read items which are concurrently overwritten");
+
+        class buffer
+        {
+        public:
+            explicit buffer(std::int64_t capacity)
+              : mask_(capacity - 1)
+              , items_(new std::atomic<T>[static_cast<std::size_t>(capacity)])
+            {
+                PIKA_ASSERT(capacity > 0 && (capacity & mask_) == 0);
+            }
+
+            std::int64_t capacity() const noexcept
+            {
+                return mask_ + 1;
+            }
+
+            T load(std::int64_t i) const noexcept
+            {
+                return items_[i & mask_].load(std::memory_order_relaxed);
+            }
+
+            void store(std::int64_t i, T val) noexcept
+            {
+                items_[i & mask_].store(val, std::memory_order_relaxed);
+            }
+
+        private:
+            std::int64_t mask_;
+            std::unique_ptr<std::atomic<T>[]> items_;
+        };
+
+        static std::int64_t round_up_capacity(std::size_t capacity) noexcept
+        {
+            std::int64_t result = 2;
+            while (result < static_cast<std::int64_t>(capacity))
+            {
+                result *= 2;
+            }
+            return result;
+        }
+
+    public:
+        using value_type = T;
+
+        explicit chase_lev_deque(std::size_t initial_capacity = 64)
+          : buffer_(new buffer(round_up_capacity(initial_capacity)))
+        {
+            top_.data_.store(0, std::memory_order_relaxed);
+            bottom_.data_.store(0, std::memory_order_relaxed);
+        }
+
+        ~chase_lev_deque()
+        {
+            delete buffer_.load(std::memory_order_relaxed);
+        }
+
+        chase_lev_deque(chase_lev_deque const&) = delete;
+        chase_lev_deque& operator=(chase_lev_deque const&) = delete;
+
+        /// Push an item to the bottom of the deque. Must only be called by
+        /// the owner of the deque.
+        void push_bottom(T val)
+        {
+            std::int64_t const b =
+                bottom_.data_.load(std::memory_order_relaxed);
+            std::int64_t const t = top_.data_.load(std::memory_order_acquire);
+            buffer* buf = buffer_.load(std::memory_order_relaxed);
+
+            if (b - t > buf->capacity() - 1)
+            {
+                buf = grow(buf, t, b);
+            }
+
+            buf->store(b, val);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.data_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        /// Pop an item from the bottom of the deque. Must only be called by
+        /// the owner of the deque. Returns false if the deque was empty.
+        bool pop_bottom(T& val) noexcept
+        {
+            std::int64_t const b =
+                bottom_.data_.load(std::memory_order_relaxed) - 1;
+            buffer* buf = buffer_.load(std::memory_order_relaxed);
+            bottom_.data_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = top_.data_.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                // the deque was empty
+                bottom_.data_.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            val = buf->load(b);
+            if (t != b)
+            {
+                // there are more items left, no thief can race with us
+                return true;
+            }
+
+            // this is the last item, race with the thieves for it
+            bool const success = top_.data_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.data_.store(b + 1, std::memory_order_relaxed);
+            return success;
+        }
+
+        /// Steal an item from the top of the deque. Can be called by any
+        /// thread. Returns false if the deque was empty or if the item was
+        /// taken by another thread concurrently.
+        bool steal_top(T& val) noexcept
+        {
+            std::int64_t t = top_.data_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t const b =
+                bottom_.data_.load(std::memory_order_acquire);
+
+            if (t >= b)
+            {
+                return false;
+            }
+
+            // The item has to be read before the top index is claimed, once
+            // the CAS succeeded the owner may overwrite the slot.
+            buffer* buf = buffer_.load(std::memory_order_acquire);
+            T const item = buf->load(t);
+            if (!top_.data_.compare_exchange_strong(t, t + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            val = item;
+            return true;
+        }
+
+        /// Returns an estimate of the number of items in the deque.
+        std::size_t size() const noexcept
+        {
+            std::int64_t const b =
+                bottom_.data_.load(std::memory_order_relaxed);
+            std::int64_t const t = top_.data_.load(std::memory_order_relaxed);
+            return b > t ? static_cast<std::size_t>(b - t) : 0;
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        /// Returns the current capacity of the buffer.
+        std::size_t capacity() const noexcept
+        {
+            return static_cast<std::size_t>(
+                buffer_.load(std::memory_order_relaxed)->capacity());
+        }
+
+    private:
+        buffer* grow(buffer* old_buf, std::int64_t t, std::int64_t b)
+        {
+            std::unique_ptr<buffer> new_buf(
+                new buffer(2 * old_buf->capacity()));
+            for (std::int64_t i = t; i != b; ++i)
+            {
+                new_buf->store(i, old_buf->load(i));
+            }
+
+            // thieves may still be reading from the old buffer
+            retired_buffers_.emplace_back(old_buf);
+
+            buffer* result = new_buf.release();
+            buffer_.store(result, std::memory_order_release);
+            return result;
+        }
+
+        pika::util::cache_line_data<std::atomic<std::int64_t>> top_;
+        pika::util::cache_line_data<std::atomic<std::int64_t>> bottom_;
+        std::atomic<buffer*> buffer_;
+
+        // only accessed by the owner
+        std::vector<std::unique_ptr<buffer>> retired_buffers_;
+    };
+}}}    // namespace pika::concurrency::detail
@@ -0,0 +1,126 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/concurrency/detail/chase_lev_deque.hpp>
+#include <pika/testing.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using pika::concurrency::detail::chase_lev_deque;
+
+void test_basic()
+{
+    chase_lev_deque<std::size_t> q(4);
+    std::size_t val = 0;
+
+    PIKA_TEST(q.empty());
+    PIKA_TEST(!q.pop_bottom(val));
+    PIKA_TEST(!q.steal_top(val));
+
+    // push more items than the initial capacity to force the deque to grow
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        q.push_bottom(i);
+    }
+    PIKA_TEST_EQ(q.size(), std::size_t(100));
+    PIKA_TEST_LTE(std::size_t(100), q.capacity());
+
+    // the owner pops the most recently pushed items
+    PIKA_TEST(q.pop_bottom(val));
+    PIKA_TEST_EQ(val, std::size_t(99));
+
+    // thieves take the oldest items
+    PIKA_TEST(q.steal_top(val));
+    PIKA_TEST_EQ(val, std::size_t(0));
+
+    for (std::size_t i = 98; i != 0; --i)
+    {
+        PIKA_TEST(q.pop_bottom(val));
+        PIKA_TEST_EQ(val, i);
+    }
+
+    PIKA_TEST(q.empty());
+    PIKA_TEST(!q.pop_bottom(val));
+    PIKA_TEST(!q.steal_top(val));
+}
+
+void test_concurrent(std::size_t num_thieves)
+{
+    constexpr std::size_t num_items = 100000;
+
+    chase_lev_deque<std::size_t> q(16);
+    std::vector<std::atomic<int>> taken(num_items);
+    for (auto& t : taken)
+    {
+        t.store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> done(false);
+    std::atomic<std::size_t> num_taken(0);
+
+    std::vector<std::thread> thieves;
+    for (std::size_t i = 0; i != num_thieves; ++i)
+    {
+        thieves.emplace_back([&]() {
+            std::size_t val = 0;
+            while (!done.load(std::memory_order_acquire) || !q.empty())
+            {
+                if (q.steal_top(val))
+                {
+                    ++taken[val];
+                    ++num_taken;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // the owner interleaves pushes and pops
+    std::size_t val = 0;
+    for (std::size_t i = 0; i != num_items; ++i)
+    {
+        q.push_bottom(i);
+        if (i % 3 == 0 && q.pop_bottom(val))
+        {
+            ++taken[val];
+            ++num_taken;
+        }
+    }
+    while (q.pop_bottom(val))
+    {
+        ++taken[val];
+        ++num_taken;
+    }
+    done.store(true, std::memory_order_release);
+
+    for (auto& t : thieves)
+    {
+        t.join();
+    }
+
+    // every item was taken exactly once
+    PIKA_TEST_EQ(num_taken.load(), num_items);
+    for (auto& t : taken)
+    {
+        PIKA_TEST_EQ(t.load(), 1);
+    }
+}
+
+int main()
+{
+    test_basic();
+    test_concurrent(1);
+    test_concurrent(3);
+
+    return pika::util::report_errors();
+}
@@ -182,6 +182,43 @@
 #  define PIKA_THREAD_QUEUE_INIT_THREADS_COUNT 10
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// Maximum number of terminated threads (per stack size) a thread queue keeps
+// for reuse. The stacks of threads beyond this limit are handed back to the
+// global stack pool.
+#if !defined(PIKA_THREAD_QUEUE_MAX_CACHED_THREADS)
+#  define PIKA_THREAD_QUEUE_MAX_CACHED_THREADS 1000
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Size of the buffer in which the function executed by a pika thread is stored
+// without allocating memory. This is sized such that the closures of typical
+// tasks fit.
+#if !defined(PIKA_THREAD_FUNCTION_STORAGE_SIZE)
+#  define PIKA_THREAD_FUNCTION_STORAGE_SIZE (8 * sizeof(void*))
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Maximum number of idle coroutine stacks kept by the stack pool per NUMA
+// domain.
+#if !defined(PIKA_STACK_POOL_MAX_CACHED_STACKS)
+#  define PIKA_STACK_POOL_MAX_CACHED_STACKS 1024
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of resident bytes held by the idle stacks of one NUMA domain above
+// which the stack pool starts releasing their pages (64MB).
+#if !defined(PIKA_STACK_POOL_HIGH_WATER_MARK)
+#  define PIKA_STACK_POOL_HIGH_WATER_MARK 0x4000000
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Maximum number of MPI requests tested by one invocation of the MPI polling
+// function.
+#if !defined(PIKA_MPI_MAX_REQUESTS_PER_POLL)
+#  define PIKA_MPI_MAX_REQUESTS_PER_POLL 256
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // Maximum sleep time for idle backoff in milliseconds (used only if
 // PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF is defined).
@@ -189,6 +226,21 @@
 #  define PIKA_IDLE_BACKOFF_TIME_MAX 1000
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// Maximum number of iterations a thread spins on a contended
+// lcos::local::mutex before suspending. The actual number of iterations adapts
+// to how long the mutex was held in the past.
+#if !defined(PIKA_MUTEX_MAX_SPIN_COUNT)
+#  define PIKA_MUTEX_MAX_SPIN_COUNT 100
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Maximum number of idle blocks of one size class kept by each thread in the
+// future data pool.
+#if !defined(PIKA_FUTURE_DATA_POOL_MAX_CACHED_BLOCKS)
+#  define PIKA_FUTURE_DATA_POOL_MAX_CACHED_BLOCKS 1024
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // This limits how deep the internal recursion of future continuations will go
 // before a new operation is re-spawned.
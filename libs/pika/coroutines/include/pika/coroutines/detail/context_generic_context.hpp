@@ -12,6 +12,7 @@
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
 #include <pika/coroutines/detail/get_stack_pointer.hpp>
+#include <pika/coroutines/detail/stack_pool.hpp>
 #include <pika/coroutines/detail/swap_context.hpp>
 #include <pika/util/get_and_reset_value.hpp>
 
@@ -91,7 +92,7 @@ namespace pika { namespace threads { namespace coroutines {
             void* allocate(std::size_t size) const
             {
 #if defined(_POSIX_VERSION)
-                void* limit = posix::alloc_stack(size);
+                void* limit = stack_pool::get().allocate(size);
                 posix::watermark_stack(limit, size);
 #else
                 void* limit = std::calloc(size, sizeof(char));
@@ -106,7 +107,7 @@ namespace pika { namespace threads { namespace coroutines {
                 PIKA_ASSERT(vp);
                 void* limit = static_cast<char*>(vp) - size;
 #if defined(_POSIX_VERSION)
-                posix::free_stack(limit, size);
+                stack_pool::get().deallocate(limit, size);
 #else
                 std::free(limit);
 #endif
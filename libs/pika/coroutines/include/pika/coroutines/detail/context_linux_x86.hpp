@@ -18,6 +18,7 @@
 #include <pika/assert.hpp>
 #include <pika/coroutines/detail/get_stack_pointer.hpp>
 #include <pika/coroutines/detail/posix_utility.hpp>
+#include <pika/coroutines/detail/stack_pool.hpp>
 #include <pika/coroutines/detail/swap_context.hpp>
 #include <pika/modules/format.hpp>
 #include <pika/util/get_and_reset_value.hpp>
@@ -206,6 +207,7 @@ namespace pika { namespace threads { namespace coroutines {
                         static_cast<std::ptrdiff_t>(default_stack_size) :
                         stack_size)
               , m_stack(nullptr)
+              , m_stack_accounted_pages(0)
             {
             }
 
@@ -228,8 +230,9 @@ namespace pika { namespace threads { namespace coroutines {
                         "stack size of {1} is invalid", m_stack_size));
                 }
 
-                m_stack =
-                    posix::alloc_stack(static_cast<std::size_t>(m_stack_size));
+                m_stack = stack_pool::get().allocate(
+                    static_cast<std::size_t>(m_stack_size),
+                    m_stack_accounted_pages);
                 if (m_stack == nullptr)
                 {
                     throw std::runtime_error(
@@ -273,8 +276,9 @@ namespace pika { namespace threads { namespace coroutines {
                     VALGRIND_STACK_DEREGISTER(
                         reinterpret_cast<std::size_t>(m_sp[valgrind_id_idx]));
 #endif
-                    posix::free_stack(
-                        m_stack, static_cast<std::size_t>(m_stack_size));
+                    stack_pool::get().deallocate(m_stack,
+                        static_cast<std::size_t>(m_stack_size),
+                        m_stack_accounted_pages);
                 }
             }
 
@@ -356,6 +360,8 @@ namespace pika { namespace threads { namespace coroutines {
                             if (posix::reset_stack(m_stack,
                                     static_cast<std::size_t>(m_stack_size)))
                             {
+                                // only the topmost page is left resident
+                                m_stack_accounted_pages = 1;
 #if defined(PIKA_HAVE_COROUTINE_COUNTERS)
                                 increment_stack_unbind_count();
 #endif
@@ -515,6 +521,10 @@ namespace pika { namespace threads { namespace coroutines {
                         std::ptrdiff_t m_stack_size;
                         void* m_stack;
 
+                        // resident pages of the stack which have been counted
+                        // by the stack pool already
+                        std::size_t m_stack_accounted_pages;
+
 #if defined(PIKA_HAVE_STACKOVERFLOW_DETECTION) &&                              \
     !defined(PIKA_HAVE_ADDRESS_SANITIZER)
                         struct sigaction action;
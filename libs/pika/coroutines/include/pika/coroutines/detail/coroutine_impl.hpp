@@ -64,7 +64,8 @@ namespace pika { namespace threads { namespace coroutines { namespace detail {
         using result_type = std::pair<thread_schedule_state, thread_id_type>;
         using arg_type = thread_restart_state;
 
-        using functor_type = util::unique_function<result_type(arg_type)>;
+        using functor_type = util::unique_function<result_type(arg_type),
+            PIKA_THREAD_FUNCTION_STORAGE_SIZE>;
 
         coroutine_impl(
             functor_type&& f, thread_id_type id, std::ptrdiff_t stack_size)
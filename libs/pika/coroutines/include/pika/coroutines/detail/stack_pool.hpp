@@ -0,0 +1,176 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pika { namespace threads { namespace coroutines { namespace detail {
+
+    /// Counters of the stack pool, collected separately for each thread pool.
+    struct stack_pool_statistics
+    {
+        /// Number of stacks which had to be newly mapped.
+        std::int64_t allocated_stacks = 0;
+
+        /// Number of stacks which were taken from the cache instead.
+        std::int64_t reused_stacks = 0;
+
+        /// Number of stacks which were given back to the cache.
+        std::int64_t cached_stacks = 0;
+
+        /// Number of pages which were faulted in while the stacks were in
+        /// use, i.e. the growth of their residency against the residency
+        /// recorded when they were cached before. The residency is only
+        /// sampled when trimming, pages are counted once the stacks they
+        /// belong to have been looked at by the trimmer.
+        std::int64_t faulted_pages = 0;
+
+        /// Number of pages released from idle stacks by the trimmer.
+        std::int64_t trimmed_pages = 0;
+    };
+
+    /// The stack pool caches coroutine stacks which are no longer used by any
+    /// thread object so that they can be handed out again without going
+    /// through mmap and faulting in the pages again. Idle stacks are kept in
+    /// one free list per NUMA domain. Stacks are taken from the free list of
+    /// the calling worker thread's domain first and stolen from other domains
+    /// only if the local one is empty.
+    ///
+    /// Idle stacks are not released eagerly. Only once the estimated number of
+    /// resident bytes held by the idle stacks of a domain exceeds the high
+    /// water mark the least recently used stacks are trimmed, releasing only
+    /// the part of each stack which has actually been touched.
+    class PIKA_EXPORT stack_pool
+    {
+    public:
+        static constexpr std::size_t max_numa_domains = 16;
+
+        static constexpr std::size_t default_max_cached_stacks =
+            PIKA_STACK_POOL_MAX_CACHED_STACKS;
+        static constexpr std::size_t default_high_water_mark =
+            PIKA_STACK_POOL_HIGH_WATER_MARK;
+
+        /// Stacks of at least this size are backed by transparent huge pages
+        /// if enabled.
+        static constexpr std::size_t huge_page_size =
+            std::size_t(2) * 1024 * 1024;
+
+        stack_pool();
+        ~stack_pool();
+
+        stack_pool(stack_pool const&) = delete;
+        stack_pool& operator=(stack_pool const&) = delete;
+
+        /// Returns the process wide stack pool.
+        static stack_pool& get();
+
+        /// Associates the calling thread with the given thread pool and NUMA
+        /// domain. Stacks released by the calling thread are cached in the
+        /// free list of that domain and are accounted to that pool.
+        static void register_thread(
+            std::size_t pool_index, std::size_t numa_domain);
+
+        /// Returns a stack of (exactly) \a size bytes. \a accounted_pages is
+        /// set to the number of resident pages of the stack which have been
+        /// counted as faulted in already.
+        void* allocate(std::size_t size, std::size_t& accounted_pages);
+
+        void* allocate(std::size_t size)
+        {
+            std::size_t accounted_pages = 0;
+            return allocate(size, accounted_pages);
+        }
+
+        /// Returns a stack which has been obtained from \a allocate to the
+        /// pool. \a accounted_pages should be the value returned by
+        /// \a allocate, otherwise the pages of a reused stack are counted as
+        /// faulted in again.
+        void deallocate(void* stack, std::size_t size,
+            std::size_t accounted_pages = 0) noexcept;
+
+        /// Releases the touched pages of all idle stacks, returns the number
+        /// of released pages.
+        std::size_t trim();
+
+        /// Unmaps all idle stacks.
+        void clear();
+
+        void set_max_cached_stacks(std::size_t max_cached_stacks) noexcept
+        {
+            max_cached_stacks_.store(
+                max_cached_stacks, std::memory_order_relaxed);
+        }
+        std::size_t get_max_cached_stacks() const noexcept
+        {
+            return max_cached_stacks_.load(std::memory_order_relaxed);
+        }
+
+        void set_high_water_mark(std::size_t high_water_mark) noexcept
+        {
+            high_water_mark_.store(high_water_mark, std::memory_order_relaxed);
+        }
+        std::size_t get_high_water_mark() const noexcept
+        {
+            return high_water_mark_.load(std::memory_order_relaxed);
+        }
+
+        void set_use_huge_pages(bool use_huge_pages) noexcept
+        {
+            use_huge_pages_.store(use_huge_pages, std::memory_order_relaxed);
+        }
+        bool get_use_huge_pages() const noexcept
+        {
+            return use_huge_pages_.load(std::memory_order_relaxed);
+        }
+
+        /// Returns the number of stacks currently held by the pool.
+        std::size_t get_num_cached_stacks() const noexcept;
+
+        /// Returns the statistics of the given thread pool. Stacks allocated
+        /// or released by threads which are not registered with any pool are
+        /// accounted to the pool index -1.
+        stack_pool_statistics get_statistics(
+            std::size_t pool_index, bool reset);
+
+    private:
+        struct statistics_data
+        {
+            std::atomic<std::int64_t> allocated_stacks{0};
+            std::atomic<std::int64_t> reused_stacks{0};
+            std::atomic<std::int64_t> cached_stacks{0};
+            std::atomic<std::int64_t> faulted_pages{0};
+            std::atomic<std::int64_t> trimmed_pages{0};
+        };
+
+        struct domain_data;
+
+        statistics_data& get_statistics_data(std::size_t pool_index);
+        static statistics_data& get_local_statistics_data();
+
+        std::size_t trim_locked(domain_data& d, std::size_t target,
+            statistics_data& stats) noexcept;
+
+        std::vector<std::unique_ptr<domain_data>> domains_;
+        std::atomic<std::size_t> max_cached_stacks_;
+        std::atomic<std::size_t> high_water_mark_;
+        std::atomic<bool> use_huge_pages_;
+
+        // the elements have stable addresses, threads keep a pointer to the
+        // statistics of their pool
+        std::mutex statistics_mtx_;
+        std::deque<statistics_data> statistics_;
+        statistics_data unregistered_statistics_;
+    };
+}}}}    // namespace pika::threads::coroutines::detail
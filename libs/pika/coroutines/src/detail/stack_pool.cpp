@@ -0,0 +1,475 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/coroutines/detail/stack_pool.hpp>
+#include <pika/util/get_and_reset_value.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux) || defined(linux) || defined(__linux__) ||                \
+    defined(__FreeBSD__) || defined(__APPLE__)
+#include <pika/coroutines/detail/posix_utility.hpp>
+
+#if defined(PIKA_HAVE_THREAD_STACK_MMAP) && defined(_POSIX_MAPPED_FILES) &&    \
+    _POSIX_MAPPED_FILES > 0 && !defined(PIKA_HAVE_ADDRESS_SANITIZER)
+#define PIKA_COROUTINES_HAVE_STACK_POOL
+#endif
+#endif
+
+namespace pika { namespace threads { namespace coroutines { namespace detail {
+
+    namespace {
+        thread_local std::size_t local_numa_domain = 0;
+        thread_local void* local_statistics = nullptr;
+
+#if defined(PIKA_COROUTINES_HAVE_STACK_POOL)
+        constexpr std::size_t page_size() noexcept
+        {
+            return static_cast<std::size_t>(EXEC_PAGESIZE);
+        }
+
+        // Determine which pages of the given stack are resident. The stack
+        // grows downwards, the lowest resident page tells how deep the stack
+        // has been used.
+        void get_residency(void* stack, std::size_t size,
+            std::size_t& resident_pages, std::size_t& touched_offset) noexcept
+        {
+            std::size_t const num_pages = size / page_size();
+
+            resident_pages = num_pages;
+            touched_offset = 0;
+
+            thread_local std::vector<char> residency;
+            try
+            {
+                residency.resize(num_pages);
+            }
+            catch (...)
+            {
+                // assume the whole stack has been touched
+                return;
+            }
+
+#if defined(__linux) || defined(linux) || defined(__linux__)
+            if (::mincore(stack, size,
+                    reinterpret_cast<unsigned char*>(residency.data())) != 0)
+#else
+            if (::mincore(stack, size, residency.data()) != 0)
+#endif
+            {
+                return;
+            }
+
+            resident_pages = 0;
+            touched_offset = size;
+            for (std::size_t i = 0; i != num_pages; ++i)
+            {
+                if (residency[i] & 0x1)
+                {
+                    if (resident_pages++ == 0)
+                    {
+                        touched_offset = i * page_size();
+                    }
+                }
+            }
+        }
+#endif
+    }    // namespace
+
+    ///////////////////////////////////////////////////////////////////////////
+    struct stack_pool::domain_data
+    {
+#if defined(PIKA_COROUTINES_HAVE_STACK_POOL)
+        struct cached_stack
+        {
+            void* stack;
+
+            // number of resident pages, all pages of the stack as long as
+            // the residency has not been sampled since the stack was cached
+            std::size_t resident_pages;
+
+            // offset of the lowest resident page, everything below has never
+            // been touched (or has been released already)
+            std::size_t touched_offset;
+
+            // number of resident pages which have been counted as faulted in
+            std::size_t accounted_pages;
+
+            bool sampled;
+        };
+
+        // all stacks of the same size, the most recently cached stacks are
+        // at the back
+        struct size_class
+        {
+            std::size_t size;
+            std::vector<cached_stack> stacks;
+        };
+
+        std::mutex mtx_;
+        std::vector<size_class> size_classes_;
+        std::atomic<std::size_t> num_stacks_{0};
+        std::size_t resident_bytes_ = 0;
+
+        size_class& get_size_class(std::size_t size)
+        {
+            for (auto& c : size_classes_)
+            {
+                if (c.size == size)
+                {
+                    return c;
+                }
+            }
+            size_classes_.push_back(size_class{size, {}});
+            return size_classes_.back();
+        }
+
+        void* pop(std::size_t size, std::size_t& accounted_pages) noexcept
+        {
+            for (auto& c : size_classes_)
+            {
+                if (c.size == size && !c.stacks.empty())
+                {
+                    cached_stack s = c.stacks.back();
+                    c.stacks.pop_back();
+                    --num_stacks_;
+                    resident_bytes_ -= s.resident_pages * page_size();
+                    accounted_pages = s.accounted_pages;
+                    return s.stack;
+                }
+            }
+            return nullptr;
+        }
+#endif
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    stack_pool::stack_pool()
+      : max_cached_stacks_(default_max_cached_stacks)
+      , high_water_mark_(default_high_water_mark)
+      , use_huge_pages_(false)
+    {
+        domains_.reserve(max_numa_domains);
+        for (std::size_t i = 0; i != max_numa_domains; ++i)
+        {
+            domains_.push_back(std::make_unique<domain_data>());
+        }
+    }
+
+    stack_pool::~stack_pool()
+    {
+        clear();
+    }
+
+    stack_pool& stack_pool::get()
+    {
+        // Coroutines may be destroyed during static destruction, the pool is
+        // never destroyed to be able to accept their stacks.
+        static stack_pool* pool = new stack_pool();
+        return *pool;
+    }
+
+    void stack_pool::register_thread(
+        std::size_t pool_index, std::size_t numa_domain)
+    {
+        local_numa_domain = numa_domain % max_numa_domains;
+        local_statistics = &get().get_statistics_data(pool_index);
+    }
+
+    stack_pool::statistics_data& stack_pool::get_statistics_data(
+        std::size_t pool_index)
+    {
+        if (pool_index == std::size_t(-1))
+        {
+            return unregistered_statistics_;
+        }
+
+        std::lock_guard<std::mutex> l(statistics_mtx_);
+        while (statistics_.size() <= pool_index)
+        {
+            statistics_.emplace_back();
+        }
+        return statistics_[pool_index];
+    }
+
+    stack_pool::statistics_data& stack_pool::get_local_statistics_data()
+    {
+        if (local_statistics != nullptr)
+        {
+            return *static_cast<statistics_data*>(local_statistics);
+        }
+        return get().unregistered_statistics_;
+    }
+
+    stack_pool_statistics stack_pool::get_statistics(
+        std::size_t pool_index, bool reset)
+    {
+        statistics_data& data = get_statistics_data(pool_index);
+
+        stack_pool_statistics result;
+        result.allocated_stacks =
+            util::get_and_reset_value(data.allocated_stacks, reset);
+        result.reused_stacks =
+            util::get_and_reset_value(data.reused_stacks, reset);
+        result.cached_stacks =
+            util::get_and_reset_value(data.cached_stacks, reset);
+        result.faulted_pages =
+            util::get_and_reset_value(data.faulted_pages, reset);
+        result.trimmed_pages =
+            util::get_and_reset_value(data.trimmed_pages, reset);
+        return result;
+    }
+
+#if defined(PIKA_COROUTINES_HAVE_STACK_POOL)
+    ///////////////////////////////////////////////////////////////////////////
+    void* stack_pool::allocate(std::size_t size, std::size_t& accounted_pages)
+    {
+        statistics_data& stats = get_local_statistics_data();
+
+        // prefer the stacks cached in the local NUMA domain, steal from the
+        // other domains otherwise
+        std::size_t const local_domain = local_numa_domain;
+        for (std::size_t i = 0; i != max_numa_domains; ++i)
+        {
+            domain_data& d =
+                *domains_[(local_domain + i) % max_numa_domains];
+            if (d.num_stacks_.load(std::memory_order_relaxed) == 0)
+            {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> l(d.mtx_);
+            if (void* stack = d.pop(size, accounted_pages))
+            {
+                ++stats.reused_stacks;
+                return stack;
+            }
+        }
+
+        void* stack = posix::alloc_stack(size);
+#if defined(MADV_HUGEPAGE)
+        if (size >= huge_page_size &&
+            use_huge_pages_.load(std::memory_order_relaxed))
+        {
+            // this is only a hint, failing to use huge pages is not an error
+            ::madvise(stack, size, MADV_HUGEPAGE);
+        }
+#endif
+        ++stats.allocated_stacks;
+        accounted_pages = 0;
+        return stack;
+    }
+
+    void stack_pool::deallocate(
+        void* stack, std::size_t size, std::size_t accounted_pages) noexcept
+    {
+        statistics_data& stats = get_local_statistics_data();
+
+        // The residency of the stack is sampled only once the idle stacks
+        // may exceed the high water mark, until then all of its pages are
+        // assumed to be resident.
+        std::size_t const num_pages = size / page_size();
+
+        domain_data& d = *domains_[local_numa_domain];
+        {
+            std::lock_guard<std::mutex> l(d.mtx_);
+            if (d.num_stacks_.load(std::memory_order_relaxed) <
+                max_cached_stacks_.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    d.get_size_class(size).stacks.push_back(
+                        domain_data::cached_stack{
+                            stack, num_pages, 0, accounted_pages, false});
+                    ++d.num_stacks_;
+                    d.resident_bytes_ += size;
+                    ++stats.cached_stacks;
+
+                    std::size_t const high_water_mark =
+                        high_water_mark_.load(std::memory_order_relaxed);
+                    if (d.resident_bytes_ > high_water_mark)
+                    {
+                        // leave some headroom to not trim again on the next
+                        // deallocation
+                        trim_locked(d, high_water_mark / 2, stats);
+                    }
+                    return;
+                }
+                catch (...)
+                {
+                    // fall through and release the stack
+                }
+            }
+        }
+
+        posix::free_stack(stack, size);
+    }
+
+    std::size_t stack_pool::trim_locked(domain_data& d, std::size_t target,
+        statistics_data& stats) noexcept
+    {
+        if (d.resident_bytes_ <= target)
+        {
+            return 0;
+        }
+
+        // Sample the residency of the stacks cached since the last time,
+        // the estimate of the resident bytes may well drop below the
+        // target already. The pages faulted in are counted against the
+        // residency of the stack when it was cached before.
+        std::size_t faulted_pages = 0;
+        for (auto& c : d.size_classes_)
+        {
+            for (auto& s : c.stacks)
+            {
+                if (s.sampled)
+                {
+                    continue;
+                }
+
+                std::size_t const estimated_pages = s.resident_pages;
+                get_residency(
+                    s.stack, c.size, s.resident_pages, s.touched_offset);
+                d.resident_bytes_ -=
+                    (estimated_pages - s.resident_pages) * page_size();
+
+                if (s.resident_pages > s.accounted_pages)
+                {
+                    faulted_pages += s.resident_pages - s.accounted_pages;
+                }
+                s.accounted_pages = s.resident_pages;
+                s.sampled = true;
+            }
+        }
+        stats.faulted_pages += static_cast<std::int64_t>(faulted_pages);
+
+        // Release the least recently cached stacks first. Only the touched
+        // part of a stack is released, the topmost page is kept as it will
+        // be written to as soon as the stack is reused.
+        std::size_t trimmed_pages = 0;
+        for (auto& c : d.size_classes_)
+        {
+            for (auto& s : c.stacks)
+            {
+                if (d.resident_bytes_ <= target)
+                {
+                    break;
+                }
+
+                std::size_t const top = c.size - page_size();
+                if (s.resident_pages <= 1 || s.touched_offset >= top)
+                {
+                    continue;
+                }
+
+                ::madvise(static_cast<char*>(s.stack) + s.touched_offset,
+                    top - s.touched_offset, MADV_DONTNEED);
+
+                trimmed_pages += s.resident_pages - 1;
+                d.resident_bytes_ -= (s.resident_pages - 1) * page_size();
+                s.resident_pages = 1;
+                s.touched_offset = top;
+                s.accounted_pages = 1;
+            }
+        }
+
+        stats.trimmed_pages += static_cast<std::int64_t>(trimmed_pages);
+        return trimmed_pages;
+    }
+
+    std::size_t stack_pool::trim()
+    {
+        statistics_data& stats = get_local_statistics_data();
+
+        std::size_t trimmed_pages = 0;
+        for (auto& d : domains_)
+        {
+            std::lock_guard<std::mutex> l(d->mtx_);
+            trimmed_pages += trim_locked(*d, 0, stats);
+        }
+        return trimmed_pages;
+    }
+
+    void stack_pool::clear()
+    {
+        for (auto& d : domains_)
+        {
+            std::lock_guard<std::mutex> l(d->mtx_);
+            for (auto& c : d->size_classes_)
+            {
+                for (auto& s : c.stacks)
+                {
+                    posix::free_stack(s.stack, c.size);
+                }
+                c.stacks.clear();
+            }
+            d->num_stacks_ = 0;
+            d->resident_bytes_ = 0;
+        }
+    }
+
+    std::size_t stack_pool::get_num_cached_stacks() const noexcept
+    {
+        std::size_t num_stacks = 0;
+        for (auto const& d : domains_)
+        {
+            num_stacks += d->num_stacks_.load(std::memory_order_relaxed);
+        }
+        return num_stacks;
+    }
+
+#else
+    ///////////////////////////////////////////////////////////////////////////
+    // Without mmap'ed stacks (or with AddressSanitizer, which gets confused
+    // by reused stacks) stacks are not cached.
+    void* stack_pool::allocate(std::size_t size, std::size_t& accounted_pages)
+    {
+        ++get_local_statistics_data().allocated_stacks;
+        accounted_pages = 0;
+#if defined(_POSIX_VERSION)
+        return posix::alloc_stack(size);
+#else
+        return ::operator new(size);
+#endif
+    }
+
+    void stack_pool::deallocate(
+        void* stack, std::size_t size, std::size_t) noexcept
+    {
+#if defined(_POSIX_VERSION)
+        posix::free_stack(stack, size);
+#else
+        PIKA_UNUSED(size);
+        ::operator delete(stack);
+#endif
+    }
+
+    std::size_t stack_pool::trim_locked(
+        domain_data&, std::size_t, statistics_data&) noexcept
+    {
+        return 0;
+    }
+
+    std::size_t stack_pool::trim()
+    {
+        return 0;
+    }
+
+    void stack_pool::clear() {}
+
+    std::size_t stack_pool::get_num_cached_stacks() const noexcept
+    {
+        return 0;
+    }
+#endif
+}}}}    // namespace pika::threads::coroutines::detail
@@ -0,0 +1,182 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/coroutines/detail/stack_pool.hpp>
+#include <pika/testing.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+using pika::threads::coroutines::detail::stack_pool;
+
+constexpr std::size_t pool_index = 3;
+constexpr std::size_t stack_size = 0x20000;
+constexpr std::size_t page_size = 0x1000;
+
+void test_reuse(stack_pool& pool)
+{
+    stack_pool::register_thread(pool_index, 0);
+    pool.get_statistics(pool_index, true);
+
+    void* stack = pool.allocate(stack_size);
+    PIKA_TEST(stack != nullptr);
+    pool.deallocate(stack, stack_size);
+    PIKA_TEST_EQ(pool.get_num_cached_stacks(), std::size_t(1));
+
+    // stacks of a different size are not handed out
+    void* other = pool.allocate(2 * stack_size);
+    PIKA_TEST(other != stack);
+    pool.deallocate(other, 2 * stack_size);
+
+    void* reused = pool.allocate(stack_size);
+    PIKA_TEST_EQ(reused, stack);
+    pool.deallocate(reused, stack_size);
+
+    auto stats = pool.get_statistics(pool_index, true);
+    PIKA_TEST_EQ(stats.allocated_stacks, 2);
+    PIKA_TEST_EQ(stats.reused_stacks, 1);
+    PIKA_TEST_EQ(stats.cached_stacks, 3);
+
+    stats = pool.get_statistics(pool_index, false);
+    PIKA_TEST_EQ(stats.allocated_stacks, 0);
+
+    pool.clear();
+    PIKA_TEST_EQ(pool.get_num_cached_stacks(), std::size_t(0));
+}
+
+void test_steal(stack_pool& pool)
+{
+    // a stack cached in another domain is used if the local domain has none
+    stack_pool::register_thread(pool_index, 1);
+    void* stack = pool.allocate(stack_size);
+    pool.deallocate(stack, stack_size);
+
+    stack_pool::register_thread(pool_index, 0);
+    void* stolen = pool.allocate(stack_size);
+    PIKA_TEST_EQ(stolen, stack);
+    pool.deallocate(stolen, stack_size);
+
+    pool.clear();
+}
+
+void test_trim(stack_pool& pool)
+{
+    stack_pool::register_thread(pool_index, 0);
+    pool.get_statistics(pool_index, true);
+
+    // touch the upper half of the stack
+    void* stack = pool.allocate(stack_size);
+    std::memset(static_cast<char*>(stack) + stack_size / 2, 1, stack_size / 2);
+    pool.deallocate(stack, stack_size);
+
+    // the residency is sampled only when trimming
+    auto stats = pool.get_statistics(pool_index, false);
+    PIKA_TEST_EQ(stats.faulted_pages, 0);
+
+    // all but the topmost page are released
+    PIKA_TEST_EQ(pool.trim(), stack_size / 2 / page_size - 1);
+    PIKA_TEST_EQ(pool.trim(), std::size_t(0));
+
+    stats = pool.get_statistics(pool_index, false);
+    PIKA_TEST_EQ(stats.faulted_pages,
+        static_cast<std::int64_t>(stack_size / 2 / page_size));
+
+    // the high water mark triggers trimming when stacks are cached
+    pool.set_high_water_mark(page_size);
+    std::size_t accounted_pages = 0;
+    stack = pool.allocate(stack_size, accounted_pages);
+    PIKA_TEST_EQ(accounted_pages, std::size_t(1));
+    std::memset(static_cast<char*>(stack) + stack_size / 2, 1, stack_size / 2);
+    pool.deallocate(stack, stack_size, accounted_pages);
+
+    // the released pages have been faulted in again
+    stats = pool.get_statistics(pool_index, true);
+    PIKA_TEST_EQ(stats.faulted_pages,
+        static_cast<std::int64_t>(2 * (stack_size / 2 / page_size) - 1));
+    PIKA_TEST_EQ(stats.trimmed_pages,
+        static_cast<std::int64_t>(2 * (stack_size / 2 / page_size - 1)));
+
+    pool.set_high_water_mark(stack_pool::default_high_water_mark);
+    pool.clear();
+}
+
+void test_faulted_pages(stack_pool& pool)
+{
+    stack_pool::register_thread(pool_index, 0);
+    pool.get_statistics(pool_index, true);
+
+    // caching a stack exceeds the high water mark as long as it has not been
+    // sampled, the sampled residency stays below half of it
+    pool.set_high_water_mark(stack_size - page_size);
+
+    std::size_t accounted_pages = 0;
+    void* stack = pool.allocate(stack_size, accounted_pages);
+    PIKA_TEST_EQ(accounted_pages, std::size_t(0));
+    std::memset(static_cast<char*>(stack) + stack_size / 4 * 3, 1,
+        stack_size / 4);
+    pool.deallocate(stack, stack_size, accounted_pages);
+
+    auto stats = pool.get_statistics(pool_index, true);
+    PIKA_TEST_EQ(stats.faulted_pages,
+        static_cast<std::int64_t>(stack_size / 4 / page_size));
+    PIKA_TEST_EQ(stats.trimmed_pages, 0);
+
+    // touching the same pages of the reused stack does not count them again
+    stack = pool.allocate(stack_size, accounted_pages);
+    PIKA_TEST_EQ(accounted_pages, stack_size / 4 / page_size);
+    std::memset(static_cast<char*>(stack) + stack_size / 4 * 3, 1,
+        stack_size / 4);
+    pool.deallocate(stack, stack_size, accounted_pages);
+
+    stats = pool.get_statistics(pool_index, true);
+    PIKA_TEST_EQ(stats.faulted_pages, 0);
+
+    // only the additionally touched pages are counted
+    stack = pool.allocate(stack_size, accounted_pages);
+    std::memset(static_cast<char*>(stack) + stack_size / 8 * 5, 1,
+        stack_size / 8 * 3);
+    pool.deallocate(stack, stack_size, accounted_pages);
+
+    stats = pool.get_statistics(pool_index, true);
+    PIKA_TEST_EQ(stats.faulted_pages,
+        static_cast<std::int64_t>(stack_size / 8 / page_size));
+    PIKA_TEST_EQ(stats.trimmed_pages, 0);
+
+    pool.set_high_water_mark(stack_pool::default_high_water_mark);
+    pool.clear();
+}
+
+void test_max_cached_stacks(stack_pool& pool)
+{
+    pool.set_max_cached_stacks(1);
+
+    void* stack1 = pool.allocate(stack_size);
+    void* stack2 = pool.allocate(stack_size);
+    pool.deallocate(stack1, stack_size);
+    pool.deallocate(stack2, stack_size);
+    PIKA_TEST_EQ(pool.get_num_cached_stacks(), std::size_t(1));
+
+    pool.set_max_cached_stacks(stack_pool::default_max_cached_stacks);
+    pool.clear();
+}
+
+int main()
+{
+#if defined(PIKA_HAVE_THREAD_STACK_MMAP) &&                                    \
+    !defined(PIKA_HAVE_ADDRESS_SANITIZER)
+    // the process wide pool is not used by anything else in this test
+    stack_pool& pool = stack_pool::get();
+
+    test_reuse(pool);
+    test_steal(pool);
+    test_trim(pool);
+    test_faulted_pages(pool);
+    test_max_cached_stacks(pool);
+#endif
+
+    return pika::util::report_errors();
+}
@@ -7,7 +7,6 @@
 #pragma once
 
 #include <pika/allocator_support/allocator_deleter.hpp>
-#include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/allocator_support/traits/is_allocator.hpp>
 #include <pika/datastructures/optional.hpp>
 #include <pika/errors/try_catch_exception_ptr.hpp>
@@ -17,6 +16,7 @@
 #include <pika/execution_base/sender.hpp>
 #include <pika/functional/invoke_result.hpp>
 #include <pika/futures/detail/future_data.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/promise.hpp>
 #include <pika/modules/memory.hpp>
 #include <pika/type_support/detail/with_result_of.hpp>
@@ -217,7 +217,8 @@ namespace pika { namespace execution { namespace experimental {
     private:
         // clang-format off
         template <typename Sender,
-            typename Allocator = pika::detail::internal_allocator<>,
+            typename Allocator =
+                pika::lcos::detail::default_future_data_allocator<>,
             PIKA_CONCEPT_REQUIRES_(
                 is_sender_v<Sender> &&
                 pika::detail::is_allocator_v<Allocator>
@@ -231,7 +232,8 @@ namespace pika { namespace execution { namespace experimental {
         }
 
         // clang-format off
-        template <typename Allocator = pika::detail::internal_allocator<>,
+        template <typename Allocator =
+                      pika::lcos::detail::default_future_data_allocator<>,
             PIKA_CONCEPT_REQUIRES_(
                 pika::detail::is_allocator_v<Allocator>
             )>
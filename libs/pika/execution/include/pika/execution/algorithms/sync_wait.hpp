@@ -7,6 +7,7 @@
 #pragma once
 
 #include <pika/config.hpp>
+#include <pika/assert.hpp>
 #include <pika/concepts/concepts.hpp>
 #include <pika/datastructures/variant.hpp>
 #include <pika/execution/algorithms/detail/partial_algorithm.hpp>
@@ -14,13 +15,19 @@
 #include <pika/execution_base/operation_state.hpp>
 #include <pika/execution_base/sender.hpp>
 #include <pika/functional/detail/tag_fallback_invoke.hpp>
-#include <pika/synchronization/condition_variable.hpp>
+#include <pika/lock_registration/detail/register_locks.hpp>
+#include <pika/synchronization/detail/condition_variable.hpp>
 #include <pika/synchronization/spinlock.hpp>
+#include <pika/threading_base/detail/futex.hpp>
+#include <pika/threading_base/thread_helpers.hpp>
 #include <pika/type_support/pack.hpp>
 #include <pika/type_support/unused.hpp>
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <mutex>
 #include <type_traits>
 #include <utility>
 
@@ -83,26 +90,146 @@ namespace pika::this_thread::experimental {
                     predecessor_error_types<pika::variant>,
                     std::exception_ptr>>;
 
-            // We use a spinlock here to allow taking the lock on non-pika threads.
+            // The lock is only taken by pika threads which suspend while
+            // waiting, and by the thread completing the sender if such a
+            // thread is waiting.
             using mutex_type = pika::lcos::local::spinlock;
 
+            // The state lives on the stack of the thread calling sync_wait.
+            // The waiting thread first spins with exponential backoff, as
+            // the sender often completes within a few microseconds. After
+            // that pika threads suspend on a condition variable and OS
+            // threads sleep on the status word using a futex.
             struct shared_state
             {
-                pika::lcos::local::condition_variable cond_var;
+                // No thread waits yet, or the waiting thread is still
+                // spinning
+                static constexpr std::uint32_t pending = 0;
+                // A pika thread is suspended on cond_var
+                static constexpr std::uint32_t waiting_suspended = 1;
+                // An OS thread is sleeping on the status word
+                static constexpr std::uint32_t waiting_parked = 2;
+                // The receiver has been signaled
+                static constexpr std::uint32_t ready = 3;
+
+                // The number of times the waiting thread doubles its
+                // backoff before it blocks, the spinning phase takes about
+                // 2^rounds pause instructions. Suspending a pika thread is
+                // cheap and frees the worker thread, which often has to run
+                // the work we are waiting for, so pika threads barely spin.
+                static constexpr std::size_t spin_rounds_os_thread = 8;
+                static constexpr std::size_t spin_rounds_pika_thread = 2;
+
+                pika::lcos::local::detail::condition_variable cond_var;
                 mutex_type mtx;
-                std::atomic<bool> set_called = false;
+                std::atomic<std::uint32_t> status{pending};
                 pika::variant<pika::monostate, error_type, value_type> value;
 
+                bool is_ready() const noexcept
+                {
+                    return status.load(std::memory_order_acquire) == ready;
+                }
+
+                bool spin(std::size_t rounds) const noexcept
+                {
+                    for (std::size_t k = 0; k != rounds; ++k)
+                    {
+                        if (is_ready())
+                        {
+                            return true;
+                        }
+                        for (std::size_t i = 0; i != (std::size_t(1) << k);
+                             ++i)
+                        {
+                            PIKA_SMT_PAUSE;
+                        }
+                    }
+                    return is_ready();
+                }
+
                 void wait()
                 {
-                    if (!set_called)
+                    if (pika::threads::get_self_ptr() != nullptr)
                     {
-                        std::unique_lock<mutex_type> l(mtx);
-                        if (!set_called)
+                        if (!spin(spin_rounds_pika_thread))
                         {
-                            cond_var.wait(l);
+                            wait_suspended();
                         }
                     }
+                    else if (!spin(spin_rounds_os_thread))
+                    {
+                        wait_parked();
+                    }
+                }
+
+                void wait_suspended()
+                {
+                    std::unique_lock<mutex_type> l(mtx);
+
+                    // the completing thread takes the lock to mark the state
+                    // ready and notify us, hence it can't miss us once we
+                    // have registered
+                    std::uint32_t expected = pending;
+                    if (!status.compare_exchange_strong(expected,
+                            waiting_suspended, std::memory_order_acq_rel))
+                    {
+                        return;
+                    }
+
+                    while (!is_ready())
+                    {
+                        cond_var.wait(l, "sync_wait");
+                    }
+                }
+
+                void wait_parked()
+                {
+                    std::uint32_t expected = pending;
+                    if (!status.compare_exchange_strong(expected,
+                            waiting_parked, std::memory_order_acq_rel))
+                    {
+                        return;
+                    }
+
+                    while (!is_ready())
+                    {
+                        pika::threads::detail::futex_wait(
+                            status, waiting_parked);
+                    }
+                }
+
+                void signal() noexcept
+                {
+                    std::uint32_t previous = pending;
+                    if (status.compare_exchange_strong(
+                            previous, ready, std::memory_order_acq_rel))
+                    {
+                        return;
+                    }
+
+                    // Only we change the status of a registered waiter
+                    if (previous == waiting_suspended)
+                    {
+                        // The waiter checks the status only while holding
+                        // the lock. Publishing it under the lock keeps the
+                        // waiter from returning, and destroying this state,
+                        // before we are done with mtx and cond_var.
+                        std::unique_lock<mutex_type> l(mtx);
+                        pika::util::ignore_while_checking<decltype(l)> il(&l);
+                        PIKA_UNUSED(il);
+
+                        status.store(ready, std::memory_order_release);
+                        cond_var.notify_one(PIKA_MOVE(l));
+                    }
+                    else
+                    {
+                        PIKA_ASSERT(previous == waiting_parked);
+                        status.store(ready, std::memory_order_release);
+
+                        // the waiting thread may already have returned,
+                        // the futex wake only uses the address of the word
+                        pika::threads::detail::futex_wake_one(status);
+                    }
                 }
 
                 auto get_value()
@@ -134,12 +261,7 @@ namespace pika::this_thread::experimental {
 
             void signal_set_called() noexcept
             {
-                std::unique_lock<mutex_type> l(state.mtx);
-                state.set_called = true;
-                pika::util::ignore_while_checking<decltype(l)> il(&l);
-                PIKA_UNUSED(il);
-
-                state.cond_var.notify_one();
+                state.signal();
             }
 
             template <typename Error>
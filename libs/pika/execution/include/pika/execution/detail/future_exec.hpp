@@ -8,7 +8,6 @@
 #pragma once
 
 #include <pika/config.hpp>
-#include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/assert.hpp>
 #include <pika/async_base/launch_policy.hpp>
 #include <pika/async_base/traits/is_launch_policy.hpp>
@@ -19,6 +18,7 @@
 #include <pika/functional/invoke.hpp>
 #include <pika/functional/invoke_result.hpp>
 #include <pika/futures/detail/future_data.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/future.hpp>
 #include <pika/futures/packaged_continuation.hpp>
 #include <pika/futures/traits/future_access.hpp>
@@ -62,8 +62,9 @@ namespace pika { namespace lcos { namespace detail {
 
             pika::traits::detail::shared_state_ptr_t<result_type> p =
                 detail::make_continuation_alloc<continuation_result_type>(
-                    pika::detail::internal_allocator<>{}, PIKA_MOVE(fut),
-                    PIKA_FORWARD(Policy_, policy), PIKA_FORWARD(F, f));
+                    pika::lcos::detail::default_future_data_allocator<>{},
+                    PIKA_MOVE(fut), PIKA_FORWARD(Policy_, policy),
+                    PIKA_FORWARD(F, f));
 
             return pika::traits::future_access<
                 pika::future<result_type>>::create(PIKA_MOVE(p));
@@ -4,6 +4,7 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include <pika/execution.hpp>
 #include <pika/init.hpp>
 #include <pika/modules/execution.hpp>
 #include <pika/testing.hpp>
@@ -11,9 +12,11 @@
 #include "algorithm_test_utils.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <exception>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -27,8 +30,88 @@ void tag_invoke(tt::sync_wait_t, custom_sender2 s)
     s.tag_invoke_overload_called = true;
 }
 
+// Sends its value from a separate OS thread after the given delay.
+struct delayed_sender
+{
+    int x;
+    std::chrono::milliseconds delay;
+
+    template <template <typename...> class Tuple,
+        template <typename...> class Variant>
+    using value_types = Variant<Tuple<int>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<std::exception_ptr>;
+
+    static constexpr bool sends_done = false;
+
+    template <typename R>
+    struct operation_state
+    {
+        int x;
+        std::chrono::milliseconds delay;
+        std::decay_t<R> r;
+        std::thread t;
+
+        ~operation_state()
+        {
+            t.join();
+        }
+
+        friend void tag_invoke(ex::start_t, operation_state& os) noexcept
+        {
+            os.t = std::thread([&os]() {
+                std::this_thread::sleep_for(os.delay);
+                ex::set_value(std::move(os.r), os.x);
+            });
+        }
+    };
+
+    template <typename R>
+    friend operation_state<R> tag_invoke(
+        ex::connect_t, delayed_sender s, R&& r)
+    {
+        return {s.x, s.delay, std::forward<R>(r), {}};
+    }
+};
+
+void test_delayed_completion()
+{
+    // completes while spinning
+    PIKA_TEST_EQ(
+        tt::sync_wait(delayed_sender{42, std::chrono::milliseconds(0)}), 42);
+
+    // completes after the waiting thread has blocked
+    PIKA_TEST_EQ(
+        tt::sync_wait(delayed_sender{43, std::chrono::milliseconds(50)}), 43);
+}
+
+// The state of sync_wait is destroyed as soon as the waiting thread returns,
+// completions racing with the waiting thread suspending must not touch it
+// afterwards.
+void test_racing_completion()
+{
+    ex::thread_pool_scheduler sched{};
+    for (int i = 0; i != 10000; ++i)
+    {
+        PIKA_TEST_EQ(
+            tt::sync_wait(ex::schedule(sched) | ex::then([i]() { return i; })),
+            i);
+    }
+}
+
 int pika_main()
 {
+    // Waiting on pika and OS threads
+    {
+        test_delayed_completion();
+
+        std::thread t(&test_delayed_completion);
+        t.join();
+
+        test_racing_completion();
+    }
+
     // Success path
     {
         std::atomic<bool> start_called{false};
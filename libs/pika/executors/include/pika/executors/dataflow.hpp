@@ -21,6 +21,7 @@
 #include <pika/functional/invoke_fused.hpp>
 #include <pika/functional/traits/get_function_annotation.hpp>
 #include <pika/functional/traits/is_action.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/detail/future_transforms.hpp>
 #include <pika/futures/future.hpp>
 #include <pika/futures/traits/acquire_future.hpp>
@@ -426,7 +427,8 @@ namespace pika::detail {
         // Construct the dataflow_frame and traverse
         // the arguments asynchronously
         pika::intrusive_ptr<Frame> p = util::traverse_pack_async_allocator(
-            alloc, util::async_traverse_in_place_tag<Frame>{}, PIKA_MOVE(data),
+            pika::lcos::detail::select_future_data_allocator(alloc),
+            util::async_traverse_in_place_tag<Frame>{}, PIKA_MOVE(data),
             PIKA_FORWARD(Ts, ts)...);
 
         using traits::future_access;
@@ -0,0 +1,38 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace pika { namespace execution { namespace experimental {
+    namespace detail {
+        /// The average time in nanoseconds one iteration of a bulk operation
+        /// with the given shape and function took the last times it ran. The
+        /// estimate is shared by all bulk operations with the same function
+        /// type, which for lambdas means the same call site. It is zero until
+        /// a bulk operation with this function has completed.
+        template <typename Shape, typename F>
+        struct bulk_iteration_time
+        {
+            static inline std::atomic<std::uint64_t> estimate{0};
+
+            // Smooth the measurements so that a single outlier doesn't
+            // change the chunk size of the next invocation too much.
+            static void update(std::uint64_t measured) noexcept
+            {
+                std::uint64_t const previous =
+                    estimate.load(std::memory_order_relaxed);
+                estimate.store(previous == 0 ? measured :
+                                               (3 * previous + measured) / 4,
+                    std::memory_order_relaxed);
+            }
+        };
+    }    // namespace detail
+}}}    // namespace pika::execution::experimental
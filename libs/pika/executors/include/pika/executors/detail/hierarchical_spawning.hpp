@@ -17,14 +17,18 @@
 #include <pika/execution/detail/post_policy_dispatch.hpp>
 #include <pika/execution/executors/execution.hpp>
 #include <pika/execution/executors/fused_bulk_execute.hpp>
+#include <pika/functional/deferred_call.hpp>
 #include <pika/futures/future.hpp>
+#include <pika/futures/futures_factory.hpp>
 #include <pika/futures/traits/future_traits.hpp>
 #include <pika/iterator_support/range.hpp>
 #include <pika/pack_traversal/unwrap.hpp>
 #include <pika/synchronization/latch.hpp>
+#include <pika/threading_base/register_thread.hpp>
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/thread_data.hpp>
 #include <pika/threading_base/thread_helpers.hpp>
+#include <pika/threading_base/thread_init_data.hpp>
 #include <pika/threading_base/thread_pool_base.hpp>
 
 #include <algorithm>
@@ -36,6 +40,43 @@
 
 namespace pika { namespace parallel { namespace execution { namespace detail {
 
+    // Launch the work for the elements [part_begin, part_end) of the shape,
+    // starting at the element pointed to by it. If new threads are created
+    // for the elements they are all submitted to the thread pool at once.
+    template <typename Result, typename F, typename Iter, typename... Ts>
+    void hierarchical_bulk_async_execute_part(
+        pika::util::thread_description const& desc,
+        threads::thread_pool_base* pool, launch policy,
+        std::vector<pika::future<Result>>& results, std::size_t part_begin,
+        std::size_t part_end, F& f, Iter it, Ts&... ts)
+    {
+        if (!pika::detail::has_async_policy(policy) || policy == launch::fork)
+        {
+            for (std::size_t part_i = part_begin; part_i < part_end; ++part_i)
+            {
+                results[part_i] =
+                    pika::detail::async_launch_policy_dispatch<launch>::call(
+                        policy, desc, pool, f, *it, ts...);
+                ++it;
+            }
+            return;
+        }
+
+        std::vector<threads::thread_init_data> data;
+        data.reserve(part_end - part_begin);
+        for (std::size_t part_i = part_begin; part_i < part_end; ++part_i)
+        {
+            lcos::local::futures_factory<Result()> p(
+                pika::util::deferred_call(f, *it, ts...));
+            data.push_back(
+                p.get_thread_init_data(desc.get_description(), policy));
+            results[part_i] = p.get_future();
+            ++it;
+        }
+
+        threads::register_work_bulk(data.data(), data.size(), pool);
+    }
+
     template <typename Launch, typename F, typename S, typename... Ts>
     std::vector<
         pika::future<typename detail::bulk_function_result<F, S, Ts...>::type>>
@@ -74,16 +115,11 @@ namespace pika { namespace parallel { namespace execution { namespace detail {
             {
                 detail::post_policy_dispatch<Launch>::call(post_policy, desc,
                     pool,
-                    [&, part_begin, part_end, part_size, f, it]() mutable {
-                        for (std::size_t part_i = part_begin; part_i < part_end;
-                             ++part_i)
-                        {
-                            results[part_i] =
-                                pika::detail::async_launch_policy_dispatch<
-                                    Launch>::call(async_policy, desc, pool, f,
-                                    *it, ts...);
-                            ++it;
-                        }
+                    [&, part_begin, part_end, part_size, f, it,
+                        async_policy]() mutable {
+                        hierarchical_bulk_async_execute_part(desc, pool,
+                            async_policy, results, part_begin, part_end, f, it,
+                            ts...);
                         l.count_down(part_size);
                     });
 
@@ -91,15 +127,9 @@ namespace pika { namespace parallel { namespace execution { namespace detail {
             }
             else
             {
-                for (std::size_t part_i = part_begin; part_i < part_end;
-                     ++part_i)
-                {
-                    results[part_i] =
-                        pika::detail::async_launch_policy_dispatch<
-                            Launch>::call(async_policy, desc, pool, f, *it,
-                            ts...);
-                    ++it;
-                }
+                hierarchical_bulk_async_execute_part(desc, pool, async_policy,
+                    results, part_begin, part_end, f, it, ts...);
+                std::advance(it, part_size);
                 l.count_down(part_size);
             }
 
@@ -17,13 +17,16 @@
 #include <pika/execution/executors/static_chunk_size.hpp>
 #include <pika/execution_base/this_thread.hpp>
 #include <pika/execution_base/traits/is_executor.hpp>
+#include <pika/executors/detail/bulk_iteration_time.hpp>
 #include <pika/functional/invoke.hpp>
 #include <pika/functional/invoke_fused.hpp>
 #include <pika/modules/hardware.hpp>
 #include <pika/modules/itt_notify.hpp>
 #include <pika/synchronization/spinlock.hpp>
 #include <pika/threading/thread.hpp>
+#include <pika/timing/high_resolution_clock.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
@@ -31,6 +34,7 @@
 #include <exception>
 #include <iosfwd>
 #include <memory>
+#include <optional>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -43,7 +47,10 @@ namespace pika { namespace execution { namespace experimental {
     /// executor has reference semantics, i.e. copies of a fork_join_executor
     /// hold a reference to the worker threads of the original instance.
     /// Scheduling work through the executor concurrently from different
-    /// threads is undefined behaviour.
+    /// threads is undefined behaviour. Scheduling work from within a parallel
+    /// region of the same executor is allowed: such a nested region is run
+    /// sequentially by the worker thread which starts it, since all worker
+    /// threads of the executor are already busy with the enclosing region.
     ///
     /// The executor keeps a set of worker threads alive for the lifetime of the
     /// executor, meaning other work will not be executed while the executor is
@@ -58,11 +65,19 @@ namespace pika { namespace execution { namespace experimental {
         /// Type of loop schedule for use with the fork_join_executor.
         /// loop_schedule::static_ implies no work-stealing;
         /// loop_schedule::dynamic allows stealing when a worker has finished
-        /// its local work.
+        /// its local work;
+        /// loop_schedule::guided hands out chunks of decreasing size from a
+        /// shared counter, each chunk being the number of remaining elements
+        /// divided by the number of threads (as OpenMP's guided schedule);
+        /// loop_schedule::adaptive works like loop_schedule::dynamic on
+        /// chunks of elements, the chunk size is chosen from the time an
+        /// element took the previous times the same bulk call site ran.
         enum class loop_schedule
         {
             static_,
             dynamic,
+            guided,
+            adaptive,
         };
 
         /// \cond nointernal
@@ -92,8 +107,9 @@ namespace pika { namespace execution { namespace experimental {
                 std::vector<pika::util::cache_aligned_data<queue_type>>;
 
             struct region_data_type;
+            struct loop_data;
             using thread_function_helper_type = void(region_data_type&,
-                std::size_t, std::size_t, queues_type&,
+                std::size_t, std::size_t, queues_type&, loop_data&,
                 pika::lcos::local::spinlock&, std::exception_ptr&) noexcept;
 
             // Members that change for each parallel region.
@@ -110,6 +126,29 @@ namespace pika { namespace execution { namespace experimental {
                 void* element_function_;
                 void const* shape_;
                 void* argument_pack_;
+
+                // The time this thread spent processing elements (adaptive
+                // scheduling).
+                std::uint64_t busy_time_;
+            };
+
+            // Members that change for each parallel region and are shared
+            // by all threads.
+            struct loop_data
+            {
+                // The number of consecutive elements processed as one item
+                // of the work queues (dynamic and adaptive scheduling).
+                std::size_t chunk_size_ = 1;
+
+                // The first element which has not been taken by any thread
+                // yet (guided scheduling).
+                pika::util::cache_aligned_data<std::atomic<std::size_t>>
+                    next_index_;
+
+                // Updates the time per element of the current bulk call
+                // site (adaptive scheduling), nullptr otherwise.
+                void (*update_iteration_time_)(std::uint64_t) noexcept =
+                    nullptr;
             };
 
             // Can't apply 'using' here as the type needs to be forward
@@ -140,9 +179,19 @@ namespace pika { namespace execution { namespace experimental {
             // Data for each parallel region.
             region_data_type region_data_;
 
+            // Set while a parallel region is running. Scheduling work while
+            // a region is running can only happen from within the region,
+            // as concurrent use of the executor is not allowed. It is set
+            // before the states of the worker threads are published, hence
+            // the worker threads see it when they start the region.
+            std::atomic<bool> in_region_{false};
+
             // The current queues for each worker pika thread.
             queues_type queues_;
 
+            // Data for each parallel region shared by all threads.
+            loop_data loop_data_;
+
             template <typename Op>
             static thread_state wait_state_this_thread_while(
                 std::atomic<thread_state> const& tstate, thread_state state,
@@ -193,6 +242,7 @@ namespace pika { namespace execution { namespace experimental {
                 // Changing data for each parallel region.
                 region_data_type& region_data_;
                 queues_type& queues_;
+                loop_data& loop_data_;
 
                 void set_state_this_thread(thread_state state) noexcept
                 {
@@ -222,7 +272,7 @@ namespace pika { namespace execution { namespace experimental {
                     while (state != thread_state::stopping)
                     {
                         data.thread_function_helper_(region_data_,
-                            thread_index_, num_threads_, queues_,
+                            thread_index_, num_threads_, queues_, loop_data_,
                             exception_mutex_, exception_);
 
                         // wait as long the state is 'idle'
@@ -292,7 +342,7 @@ namespace pika { namespace execution { namespace experimental {
                         launch::async_policy>::call(policy, desc, pool_,
                         thread_function{num_threads_, t, schedule_,
                             exception_mutex_, exception_, yield_delay_,
-                            region_data_, queues_});
+                            region_data_, queues_, loop_data_});
                 }
 
                 wait_state_all(thread_state::idle);
@@ -382,7 +432,8 @@ namespace pika { namespace execution { namespace experimental {
                 /// scheduling).
                 static void call_static(region_data_type& rdata,
                     std::size_t thread_index, std::size_t num_threads,
-                    queues_type&, pika::lcos::local::spinlock& exception_mutex,
+                    queues_type&, loop_data&,
+                    pika::lcos::local::spinlock& exception_mutex,
                     std::exception_ptr& exception) noexcept
                 {
                     region_data& data = rdata[thread_index].data_;
@@ -427,15 +478,20 @@ namespace pika { namespace execution { namespace experimental {
                     set_state(data.state_, thread_state::idle);
                 }
 
-                /// Main entry point for a single parallel region (dynamic
-                /// scheduling).
+                /// Main entry point for a single parallel region (dynamic and
+                /// adaptive scheduling). The work queues hold the indices of
+                /// chunks of loop.chunk_size_ elements.
                 static void call_dynamic(region_data_type& rdata,
                     std::size_t thread_index, std::size_t num_threads,
-                    queues_type& queues,
+                    queues_type& queues, loop_data& loop,
                     pika::lcos::local::spinlock& exception_mutex,
                     std::exception_ptr& exception) noexcept
                 {
                     region_data& data = rdata[thread_index].data_;
+                    bool const measure = loop.update_iteration_time_ != nullptr;
+                    std::uint64_t const start = measure ?
+                        pika::chrono::high_resolution_clock::now() :
+                        0;
                     try
                     {
                         // Cast void pointers back to the actual types given to
@@ -448,20 +504,32 @@ namespace pika { namespace execution { namespace experimental {
 
                         // Set up the local queues and state.
                         queue_type& local_queue = queues[thread_index].data_;
-                        std::size_t size = pika::util::size(shape);
-                        init_local_work_queue(
-                            local_queue, thread_index, num_threads, size);
+                        std::size_t const size = pika::util::size(shape);
+                        std::size_t const chunk_size = loop.chunk_size_;
+                        init_local_work_queue(local_queue, thread_index,
+                            num_threads,
+                            (size + chunk_size - 1) / chunk_size);
 
                         set_state(data.state_, thread_state::active);
 
+                        auto process_chunk = [&](std::uint32_t chunk) {
+                            std::size_t const begin = chunk * chunk_size;
+                            std::size_t const end =
+                                (std::min)(begin + chunk_size, size);
+                            auto it =
+                                std::next(pika::util::begin(shape), begin);
+                            for (std::size_t i = begin; i != end; ++i, ++it)
+                            {
+                                invoke_helper(index_pack_type{},
+                                    element_function, *it, argument_pack);
+                            }
+                        };
+
                         // Process local items first.
                         pika::util::optional<std::uint32_t> index;
                         while ((index = local_queue.pop_left()))
                         {
-                            auto it = std::next(
-                                pika::util::begin(shape), index.value());
-                            invoke_helper(index_pack_type{}, element_function,
-                                *it, argument_pack);
+                            process_chunk(index.value());
                         }
 
                         // As loop schedule is dynamic, steal from neighboring
@@ -484,11 +552,76 @@ namespace pika { namespace execution { namespace experimental {
 
                             while ((index = neighbor_queue.pop_right()))
                             {
-                                auto it = std::next(
-                                    pika::util::begin(shape), index.value());
+                                process_chunk(index.value());
+                            }
+                        }
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard l(exception_mutex);
+                        if (!exception)
+                        {
+                            exception = std::current_exception();
+                        }
+                    }
+
+                    if (measure)
+                    {
+                        data.busy_time_ =
+                            pika::chrono::high_resolution_clock::now() - start;
+                    }
+
+                    set_state(data.state_, thread_state::idle);
+                }
+
+                /// Main entry point for a single parallel region (guided
+                /// scheduling).
+                static void call_guided(region_data_type& rdata,
+                    std::size_t thread_index, std::size_t num_threads,
+                    queues_type&, loop_data& loop,
+                    pika::lcos::local::spinlock& exception_mutex,
+                    std::exception_ptr& exception) noexcept
+                {
+                    region_data& data = rdata[thread_index].data_;
+                    try
+                    {
+                        // Cast void pointers back to the actual types given to
+                        // bulk_sync_execute.
+                        auto& element_function =
+                            *static_cast<F*>(data.element_function_);
+                        auto& shape = *static_cast<S const*>(data.shape_);
+                        auto& argument_pack =
+                            *static_cast<Tuple*>(data.argument_pack_);
+
+                        std::size_t const size = pika::util::size(shape);
+                        std::atomic<std::size_t>& next_index =
+                            loop.next_index_.data_;
+
+                        set_state(data.state_, thread_state::active);
+
+                        // Take chunks of a share of the remaining elements
+                        // until no elements are left.
+                        std::size_t begin =
+                            next_index.load(std::memory_order_relaxed);
+                        while (begin < size)
+                        {
+                            std::size_t const end = begin +
+                                (size - begin + num_threads - 1) / num_threads;
+                            if (!next_index.compare_exchange_weak(begin, end,
+                                    std::memory_order_relaxed))
+                            {
+                                continue;
+                            }
+
+                            auto it =
+                                std::next(pika::util::begin(shape), begin);
+                            for (; begin != end; ++begin, ++it)
+                            {
                                 invoke_helper(index_pack_type{},
                                     element_function, *it, argument_pack);
                             }
+
+                            begin = next_index.load(std::memory_order_relaxed);
                         }
                     }
                     catch (...)
@@ -504,26 +637,80 @@ namespace pika { namespace execution { namespace experimental {
                 }
             };
 
-            template <typename F, typename S, typename Args>
+            // Returns the chunk size for the adaptive loop schedule. Chunks
+            // should take about target_chunk_time nanoseconds to amortize the
+            // cost of taking them from the queues, but there have to be
+            // enough chunks per thread to balance irregular workloads.
+            static std::size_t get_adaptive_chunk_size(std::size_t num_threads,
+                std::size_t size, std::uint64_t iteration_time) noexcept
+            {
+                constexpr std::uint64_t target_chunk_time = 20000;
+                constexpr std::size_t min_chunks_per_thread = 4;
+
+                std::size_t const max_chunk_size = (std::max)(std::size_t(1),
+                    size / (min_chunks_per_thread * num_threads));
+                if (iteration_time == 0)
+                {
+                    return max_chunk_size;
+                }
+
+                return (std::clamp)(static_cast<std::size_t>(
+                                        target_chunk_time / iteration_time),
+                    std::size_t(1), max_chunk_size);
+            }
+
+            // Sets the region data of all threads. get_function(t) returns
+            // the element function used by thread t.
+            template <typename GetFunction, typename S, typename Args>
             thread_function_helper_type* set_all_states_and_region_data(
-                thread_state state, F& f, S const& shape,
+                thread_state state, GetFunction&& get_function, S const& shape,
                 Args& argument_pack) noexcept
             {
+                using F = std::remove_pointer_t<decltype(get_function(0))>;
+
+                using helper_type = thread_function_helper<F, S, Args>;
+
+                loop_data_.chunk_size_ = 1;
+                loop_data_.update_iteration_time_ = nullptr;
+
+                // Published to the worker threads by the release stores of
+                // their states below
+                in_region_.store(true, std::memory_order_relaxed);
+
                 thread_function_helper_type* func = nullptr;
                 if (schedule_ == loop_schedule::static_ || num_threads_ == 1)
                 {
-                    func = &thread_function_helper<F, S, Args>::call_static;
+                    func = &helper_type::call_static;
+                }
+                else if (schedule_ == loop_schedule::guided)
+                {
+                    loop_data_.next_index_.data_.store(
+                        0, std::memory_order_relaxed);
+                    func = &helper_type::call_guided;
                 }
                 else
                 {
-                    func = &thread_function_helper<F, S, Args>::call_dynamic;
+                    if (schedule_ == loop_schedule::adaptive)
+                    {
+                        using iteration_time_type =
+                            detail::bulk_iteration_time<S, F>;
+
+                        loop_data_.chunk_size_ =
+                            get_adaptive_chunk_size(num_threads_,
+                                pika::util::size(shape),
+                                iteration_time_type::estimate.load(
+                                    std::memory_order_relaxed));
+                        loop_data_.update_iteration_time_ =
+                            &iteration_time_type::update;
+                    }
+                    func = &helper_type::call_dynamic;
                 }
 
                 for (std::size_t t = 0; t < num_threads_; ++t)
                 {
                     region_data& data = region_data_[t].data_;
 
-                    data.element_function_ = &f;
+                    data.element_function_ = get_function(t);
                     data.shape_ = &shape;
                     data.argument_pack_ = &argument_pack;
                     data.thread_function_helper_ = func;
@@ -533,10 +720,81 @@ namespace pika { namespace execution { namespace experimental {
                 return func;
             }
 
+            // Runs the parallel region set up by
+            // set_all_states_and_region_data and rethrows the first exception
+            // thrown by any of the threads.
+            void run_region(thread_function_helper_type* func, std::size_t size)
+            {
+                // Start work on the main thread.
+                func(region_data_, main_thread_, num_threads_, queues_,
+                    loop_data_, exception_mutex_, exception_);
+
+                // Wait for all threads to finish their work assigned to
+                // them in this parallel region.
+                wait_state_all(thread_state::idle);
+
+                in_region_.store(false, std::memory_order_relaxed);
+
+                std::lock_guard l(exception_mutex_);
+                if (exception_)
+                {
+                    std::rethrow_exception(PIKA_MOVE(exception_));
+                }
+
+                // Feed the time per element back to the next region started
+                // from the same call site.
+                if (loop_data_.update_iteration_time_ != nullptr && size != 0)
+                {
+                    std::uint64_t busy_time = 0;
+                    for (std::size_t t = 0; t < num_threads_; ++t)
+                    {
+                        busy_time += region_data_[t].data_.busy_time_;
+                    }
+                    loop_data_.update_iteration_time_(busy_time / size);
+                }
+            }
+
+            // The element function used by each thread in
+            // bulk_reduce_sync_execute. It combines the results of all
+            // elements handled by the thread into a partial result.
+            template <typename F, typename Op, typename T>
+            struct reduce_function
+            {
+                F& f;
+                Op& op;
+                std::optional<T> partial;
+
+                template <typename... Ts>
+                void operator()(Ts&&... ts)
+                {
+                    if (partial)
+                    {
+                        *partial = PIKA_INVOKE(op, PIKA_MOVE(*partial),
+                            PIKA_INVOKE(f, PIKA_FORWARD(Ts, ts)...));
+                    }
+                    else
+                    {
+                        partial.emplace(
+                            PIKA_INVOKE(f, PIKA_FORWARD(Ts, ts)...));
+                    }
+                }
+            };
+
         public:
             template <typename F, typename S, typename... Ts>
             void bulk_sync_execute(F&& f, S const& shape, Ts&&... ts)
             {
+                // A nested region is run sequentially by the calling thread
+                if (in_region_.load(std::memory_order_relaxed))
+                {
+                    for (auto it = pika::util::begin(shape);
+                         it != pika::util::end(shape); ++it)
+                    {
+                        PIKA_INVOKE(f, *it, ts...);
+                    }
+                    return;
+                }
+
 #if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
                 static pika::util::itt::event notify_event(
                     "fork_join_executor::bulk_sync_execute");
@@ -552,22 +810,100 @@ namespace pika { namespace execution { namespace experimental {
                 // themselves, and then starting the actual work.
                 thread_function_helper_type* func =
                     set_all_states_and_region_data(
-                        thread_state::partitioning_work, f, shape,
+                        thread_state::partitioning_work,
+                        [&f](std::size_t) { return &f; }, shape,
                         argument_pack);
 
-                // Start work on the main thread.
-                func(region_data_, main_thread_, num_threads_, queues_,
-                    exception_mutex_, exception_);
+                run_region(func, pika::util::size(shape));
+            }
 
-                // Wait for all threads to finish their work assigned to
-                // them in this parallel region.
-                wait_state_all(thread_state::idle);
+            template <typename F, typename S, typename T, typename Op,
+                typename... Ts>
+            T bulk_reduce_sync_execute(
+                F&& f, S const& shape, T init, Op&& op, Ts&&... ts)
+            {
+                // A nested region is run sequentially by the calling thread
+                if (in_region_.load(std::memory_order_relaxed))
+                {
+                    for (auto it = pika::util::begin(shape);
+                         it != pika::util::end(shape); ++it)
+                    {
+                        init = PIKA_INVOKE(
+                            op, PIKA_MOVE(init), PIKA_INVOKE(f, *it, ts...));
+                    }
+                    return init;
+                }
 
-                std::lock_guard l(exception_mutex_);
-                if (exception_)
+#if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
+                static pika::util::itt::event notify_event(
+                    "fork_join_executor::bulk_reduce_sync_execute");
+
+                pika::util::itt::mark_event e(notify_event);
+#endif
+
+                // Each thread accumulates the results of its elements in its
+                // own partial result, no synchronization is needed between
+                // the threads.
+                using reduce_function_type =
+                    reduce_function<std::remove_reference_t<F>,
+                        std::remove_reference_t<Op>, T>;
+                std::vector<
+                    pika::util::cache_aligned_data<reduce_function_type>>
+                    partials;
+                partials.reserve(num_threads_);
+                for (std::size_t t = 0; t < num_threads_; ++t)
                 {
-                    std::rethrow_exception(PIKA_MOVE(exception_));
+                    partials.emplace_back(reduce_function_type{f, op, {}});
+                }
+
+                auto argument_pack =
+                    pika::forward_as_tuple(PIKA_FORWARD(Ts, ts)...);
+
+                thread_function_helper_type* func =
+                    set_all_states_and_region_data(
+                        thread_state::partitioning_work,
+                        [&partials](
+                            std::size_t t) { return &partials[t].data_; },
+                        shape, argument_pack);
+
+                run_region(func, pika::util::size(shape));
+
+                // Combine the partial results pairwise in a tree. Each
+                // partial result combines the elements of a contiguous range
+                // of the shape in order only if the loop schedule is static.
+                // With any other schedule a thread gets non-contiguous
+                // elements, op then also has to be commutative.
+                for (std::size_t stride = 1; stride < num_threads_;
+                     stride *= 2)
+                {
+                    for (std::size_t t = 0; t + stride < num_threads_;
+                         t += 2 * stride)
+                    {
+                        auto& left = partials[t].data_.partial;
+                        auto& right = partials[t + stride].data_.partial;
+                        if (!right)
+                        {
+                            continue;
+                        }
+
+                        if (left)
+                        {
+                            *left = PIKA_INVOKE(
+                                op, PIKA_MOVE(*left), PIKA_MOVE(*right));
+                        }
+                        else
+                        {
+                            left.emplace(PIKA_MOVE(*right));
+                        }
+                    }
                 }
+
+                auto& result = partials[0].data_.partial;
+                if (result)
+                {
+                    init = PIKA_INVOKE(op, PIKA_MOVE(init), PIKA_MOVE(*result));
+                }
+                return init;
             }
 
             template <typename F, typename S, typename... Ts>
@@ -613,6 +949,27 @@ namespace pika { namespace execution { namespace experimental {
             return shared_data_->bulk_async_execute(
                 PIKA_FORWARD(F, f), shape, PIKA_FORWARD(Ts, ts)...);
         }
+        /// \endcond
+
+        /// \brief Invoke f for all elements of shape and reduce the results.
+        ///
+        /// Returns the combination of init and f(element, ts...) for all
+        /// elements of shape using op. Each worker thread reduces the
+        /// results of its own elements into a partial result. The partial
+        /// results are then combined pairwise in a tree. op has to be
+        /// associative. With any schedule other than static_, op also has
+        /// to be commutative, as elements may be reduced out of order.
+        template <typename F, typename S, typename T, typename Op,
+            typename... Ts>
+        T bulk_reduce_sync_execute(
+            F&& f, S const& shape, T init, Op&& op, Ts&&... ts)
+        {
+            return shared_data_->bulk_reduce_sync_execute(PIKA_FORWARD(F, f),
+                shape, PIKA_MOVE(init), PIKA_FORWARD(Op, op),
+                PIKA_FORWARD(Ts, ts)...);
+        }
+
+        /// \cond NOINTERNAL
 
         bool operator==(fork_join_executor const& rhs) const noexcept
         {
@@ -10,14 +10,23 @@
 #include <pika/concepts/has_member_xxx.hpp>
 #include <pika/execution/traits/executor_traits.hpp>
 #include <pika/execution_base/execution.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
 #include <pika/execution_base/this_thread.hpp>
 #include <pika/execution_base/traits/is_executor.hpp>
 #include <pika/functional/detail/invoke.hpp>
+#include <pika/synchronization/spinlock.hpp>
 #include <pika/threading_base/print.hpp>
+#include <pika/timing/high_resolution_clock.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <mutex>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -33,9 +42,210 @@ namespace pika { namespace execution { namespace experimental {
     using print_on = pika::debug::enable_print<false>;
     static constexpr print_on lim_debug("LIMEXEC");
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Parameters of the rate based throttling of limiting_executor
+    struct rate_limit
+    {
+        // the average number of tasks started per second, zero disables
+        // the rate based throttling
+        double tasks_per_second = 0.0;
+
+        // the number of tasks which may be started at once after a period
+        // in which fewer tasks than allowed by the rate were started
+        std::size_t burst = 1;
+    };
+
     ///////////////////////////////////////////////////////////////////////////
     namespace detail {
         PIKA_HAS_MEMBER_XXX_TRAIT_DEF(in_flight_estimate)
+
+        // --------------------------------------------------------------------
+        // Token bucket holding up to burst tokens, which is refilled with
+        // tasks_per_second tokens per second. Every task takes one token.
+        // --------------------------------------------------------------------
+        class token_bucket
+        {
+        public:
+            token_bucket() = default;
+
+            token_bucket(rate_limit const& rate, std::uint64_t now) noexcept
+              : tokens_per_ns_(rate.tasks_per_second * 1e-9)
+              , capacity_(double((std::max)(rate.burst, std::size_t(1))))
+              , tokens_(capacity_)
+              , last_refill_(now)
+            {
+            }
+
+            bool enabled() const noexcept
+            {
+                return tokens_per_ns_ > 0.0;
+            }
+
+            // Takes a token and returns zero if one is available, otherwise
+            // returns the time in nanoseconds until the next token is added.
+            std::uint64_t try_take(std::uint64_t now) noexcept
+            {
+                tokens_ = (std::min)(capacity_,
+                    tokens_ + double(now - last_refill_) * tokens_per_ns_);
+                last_refill_ = now;
+
+                if (tokens_ >= 1.0)
+                {
+                    tokens_ -= 1.0;
+                    return 0;
+                }
+                return std::uint64_t((1.0 - tokens_) / tokens_per_ns_) + 1;
+            }
+
+        private:
+            double tokens_per_ns_ = 0.0;
+            double capacity_ = 0.0;
+            double tokens_ = 0.0;
+            std::uint64_t last_refill_ = 0;
+        };
+
+        // --------------------------------------------------------------------
+        // An operation started through throttle which waits in the queue of
+        // a limiting_executor until it is allowed to run
+        // --------------------------------------------------------------------
+        struct throttle_waiter
+        {
+            throttle_waiter* next = nullptr;
+            void (*start)(throttle_waiter&) noexcept = nullptr;
+        };
+
+        // --------------------------------------------------------------------
+        // Sender returned by throttle. Starting the operation doesn't block,
+        // the wrapped sender is started by the limiting_executor as soon as
+        // the thresholds and the rate limit allow it.
+        // --------------------------------------------------------------------
+        template <typename Sender, typename Limiter>
+        struct throttle_sender
+        {
+            PIKA_NO_UNIQUE_ADDRESS std::decay_t<Sender> sender;
+            Limiter* limiter;
+
+            template <template <typename...> class Tuple,
+                template <typename...> class Variant>
+            using value_types =
+                typename pika::execution::experimental::sender_traits<
+                    Sender>::template value_types<Tuple, Variant>;
+
+            template <template <typename...> class Variant>
+            using error_types =
+                typename pika::execution::experimental::sender_traits<
+                    Sender>::template error_types<Variant>;
+
+            static constexpr bool sends_done =
+                pika::execution::experimental::sender_traits<
+                    Sender>::sends_done;
+
+            template <typename Receiver>
+            struct operation_state : throttle_waiter
+            {
+                // Releases the limiter before forwarding the completion, the
+                // operation state may be destroyed by the receiver.
+                struct throttle_receiver
+                {
+                    operation_state& op_state;
+
+                    template <typename Error>
+                    friend void tag_invoke(
+                        pika::execution::experimental::set_error_t,
+                        throttle_receiver&& r, Error&& error) noexcept
+                    {
+                        r.op_state.release();
+                        pika::execution::experimental::set_error(
+                            PIKA_MOVE(r.op_state.receiver),
+                            PIKA_FORWARD(Error, error));
+                    }
+
+                    friend void tag_invoke(
+                        pika::execution::experimental::set_done_t,
+                        throttle_receiver&& r) noexcept
+                    {
+                        r.op_state.release();
+                        pika::execution::experimental::set_done(
+                            PIKA_MOVE(r.op_state.receiver));
+                    }
+
+                    template <typename... Ts>
+                    friend void tag_invoke(
+                        pika::execution::experimental::set_value_t,
+                        throttle_receiver&& r, Ts&&... ts) noexcept
+                    {
+                        r.op_state.release();
+                        pika::execution::experimental::set_value(
+                            PIKA_MOVE(r.op_state.receiver),
+                            PIKA_FORWARD(Ts, ts)...);
+                    }
+                };
+
+                Limiter* limiter;
+                PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
+                pika::execution::experimental::connect_result_t<Sender,
+                    throttle_receiver>
+                    op_state;
+
+                template <typename Sender_, typename Receiver_>
+                operation_state(
+                    Sender_&& sender, Limiter* limiter, Receiver_&& receiver)
+                  : limiter(limiter)
+                  , receiver(PIKA_FORWARD(Receiver_, receiver))
+                  , op_state(pika::execution::experimental::connect(
+                        PIKA_FORWARD(Sender_, sender),
+                        throttle_receiver{*this}))
+                {
+                    this->start = &operation_state::start_waiter;
+                }
+
+                operation_state(operation_state&&) = delete;
+                operation_state& operator=(operation_state&&) = delete;
+                operation_state(operation_state const&) = delete;
+                operation_state& operator=(operation_state const&) = delete;
+
+                static void start_waiter(throttle_waiter& w) noexcept
+                {
+                    pika::execution::experimental::start(
+                        static_cast<operation_state&>(w).op_state);
+                }
+
+                // the limiter only grants access to its queue to the members
+                // of throttle_sender
+                void enqueue() noexcept
+                {
+                    limiter->enqueue(*this);
+                }
+
+                void release() noexcept
+                {
+                    limiter->release();
+                }
+
+                friend void tag_invoke(pika::execution::experimental::start_t,
+                    operation_state& os) noexcept
+                {
+                    os.enqueue();
+                }
+            };
+
+            template <typename Receiver>
+            friend operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t, throttle_sender&& s,
+                Receiver&& receiver)
+            {
+                return {PIKA_MOVE(s.sender), s.limiter,
+                    PIKA_FORWARD(Receiver, receiver)};
+            }
+
+            template <typename Receiver>
+            friend operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t,
+                throttle_sender const& s, Receiver&& receiver)
+            {
+                return {s.sender, s.limiter, PIKA_FORWARD(Receiver, receiver)};
+            }
+        };
     }    // namespace detail
 
     template <typename BaseExecutor>
@@ -83,6 +293,7 @@ namespace pika { namespace execution { namespace experimental {
                     pika::util::yield_while([&]() { return exceeds_lower(); });
                     lim_debug.debug(pika::debug::str<>("Below_lower"));
                 }
+                limiting_.acquire_token();
             }
 
             // when task completes, on_exit destructor calls count_down
@@ -137,6 +348,7 @@ namespace pika { namespace execution { namespace experimental {
                         "in_flight",
                         pika::debug::dec<4>(base.in_flight_estimate()));
                 }
+                limiting_.acquire_token();
             }
 
             template <typename... Ts>
@@ -187,12 +399,39 @@ namespace pika { namespace execution { namespace experimental {
         {
         }
 
+        // --------------------------------------------------------------------
+        // rate based throttling only, the number of tasks in flight is not
+        // limited
+        limiting_executor(BaseExecutor& ex, rate_limit const& rate,
+            bool block_on_destruction = true)
+          : limiting_executor(ex, (std::numeric_limits<std::size_t>::max)(),
+                (std::numeric_limits<std::size_t>::max)(),
+                block_on_destruction)
+        {
+            set_rate_limit(rate);
+        }
+
+        limiting_executor(
+            rate_limit const& rate, bool block_on_destruction = true)
+          : limiting_executor((std::numeric_limits<std::size_t>::max)(),
+                (std::numeric_limits<std::size_t>::max)(),
+                block_on_destruction)
+        {
+            set_rate_limit(rate);
+        }
+
         // --------------------------------------------------------------------
         ~limiting_executor()
         {
             if (block_)
             {
+                // deferred operations have to be started before the
+                // thresholds are lowered
+                wait_deferred();
                 set_and_wait(0, 0);
+
+                // the thread which counted down last may still hold the lock
+                std::lock_guard<mutex_type> l(mtx_);
             }
         }
 
@@ -277,6 +516,7 @@ namespace pika { namespace execution { namespace experimental {
         // wait (suspend) until all tasks launched on this executor have completed
         void wait_all()
         {
+            wait_deferred();
             pika::util::yield_while([&]() { return (count_ > 0); });
         }
 
@@ -286,15 +526,174 @@ namespace pika { namespace execution { namespace experimental {
             upper_threshold_ = upper;
         }
 
+        // --------------------------------------------------------------------
+        // limit the rate at which tasks are started in addition to the
+        // number of tasks in flight, a rate of zero removes the limit
+        void set_rate_limit(rate_limit const& rate)
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+            bucket_ = detail::token_bucket(
+                rate, pika::chrono::high_resolution_clock::now());
+            rate_limited_.store(bucket_.enabled(), std::memory_order_release);
+            dispatch(l);
+        }
+
     private:
+        using mutex_type = pika::lcos::local::spinlock;
+
+        template <typename Sender, typename Limiter>
+        friend struct detail::throttle_sender;
+
         void count_up()
         {
             ++count_;
         }
 
+        // The decrement and the load of num_waiters_ are sequentially
+        // consistent and pair with the increment of num_waiters_ and the
+        // load of count_ in enqueue: either enqueue sees the decremented
+        // count or this sees the waiter. Without waiters no lock is taken.
         void count_down() const
         {
             --count_;
+            if (num_waiters_.load(std::memory_order_seq_cst) != 0)
+            {
+                std::unique_lock<mutex_type> l(mtx_);
+                dispatch(l);
+            }
+        }
+
+        // --------------------------------------------------------------------
+        // used by throttle: queues the operation and starts it if the
+        // thresholds and the rate limit allow it, the calling thread never
+        // blocks
+        void enqueue(detail::throttle_waiter& w) const
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+            w.next = nullptr;
+            if (waiters_tail_ != nullptr)
+            {
+                waiters_tail_->next = &w;
+            }
+            else
+            {
+                waiters_head_ = &w;
+            }
+            waiters_tail_ = &w;
+            num_waiters_.fetch_add(1, std::memory_order_seq_cst);
+            dispatch(l);
+        }
+
+        // used by throttle when an operation has completed
+        void release() const
+        {
+            count_down();
+        }
+
+        // --------------------------------------------------------------------
+        // blocks (suspends) until a token is available if a rate limit is set
+        void acquire_token() const
+        {
+            if (!rate_limited_.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            std::unique_lock<mutex_type> l(mtx_);
+            while (bucket_.enabled())
+            {
+                std::uint64_t const wait = bucket_.try_take(
+                    pika::chrono::high_resolution_clock::now());
+                if (wait == 0)
+                {
+                    return;
+                }
+
+                lim_debug.debug(pika::debug::str<>("Rate_limit"));
+                l.unlock();
+                pika::execution_base::this_thread::sleep_for(
+                    std::chrono::nanoseconds(wait));
+                l.lock();
+            }
+        }
+
+        // --------------------------------------------------------------------
+        // Starts queued operations in order as long as fewer than the upper
+        // threshold of tasks are in flight and tokens are available. Tasks in
+        // flight are counted by count_ even if the base executor provides
+        // in_flight_estimate, as operations started through throttle don't
+        // necessarily run on the base executor. Only one
+        // thread starts operations at a time, the others return immediately
+        // and leave their work to that thread, which re-checks the conditions
+        // after each operation. If the rate limit stops the queue, a task on
+        // the base executor resumes dispatching once the next token is
+        // available.
+        void dispatch(std::unique_lock<mutex_type>& l) const
+        {
+            if (dispatching_)
+            {
+                return;
+            }
+            dispatching_ = true;
+
+            while (waiters_head_ != nullptr && count_ < upper_threshold_)
+            {
+                if (bucket_.enabled())
+                {
+                    std::uint64_t const wait = bucket_.try_take(
+                        pika::chrono::high_resolution_clock::now());
+                    if (wait != 0)
+                    {
+                        if (!refill_pending_)
+                        {
+                            refill_pending_ = true;
+                            l.unlock();
+                            schedule_refill(wait);
+                            l.lock();
+                        }
+                        break;
+                    }
+                }
+
+                detail::throttle_waiter* w = waiters_head_;
+                waiters_head_ = w->next;
+                if (waiters_head_ == nullptr)
+                {
+                    waiters_tail_ = nullptr;
+                }
+                num_waiters_.fetch_sub(1, std::memory_order_relaxed);
+                ++count_;
+
+                l.unlock();
+                w->start(*w);
+                l.lock();
+            }
+
+            dispatching_ = false;
+        }
+
+        void schedule_refill(std::uint64_t wait) const
+        {
+            lim_debug.debug(pika::debug::str<>("Rate_limit"), "deferred");
+            pika::parallel::execution::post(executor_, [this, wait]() {
+                pika::execution_base::this_thread::sleep_for(
+                    std::chrono::nanoseconds(wait));
+
+                std::unique_lock<mutex_type> l(mtx_);
+                refill_pending_ = false;
+                dispatch(l);
+            });
+        }
+
+        // wait (suspend) until all operations deferred by throttle have been
+        // started
+        void wait_deferred() const
+        {
+            pika::util::yield_while([&]() {
+                std::lock_guard<mutex_type> l(mtx_);
+                return waiters_head_ != nullptr || dispatching_ ||
+                    refill_pending_;
+            });
         }
 
         void set_and_wait(std::size_t lower, std::size_t upper)
@@ -310,7 +709,41 @@ namespace pika { namespace execution { namespace experimental {
         mutable std::size_t lower_threshold_;
         mutable std::size_t upper_threshold_;
         bool block_;
+
+        // state for rate based throttling and for throttle, protected by mtx_
+        mutable mutex_type mtx_;
+        mutable detail::token_bucket bucket_;
+        mutable detail::throttle_waiter* waiters_head_ = nullptr;
+        mutable detail::throttle_waiter* waiters_tail_ = nullptr;
+        mutable bool dispatching_ = false;
+        mutable bool refill_pending_ = false;
+
+        // the number of queued operations and whether a rate limit is set,
+        // let tasks run through the executor interface skip the lock
+        mutable std::atomic<std::size_t> num_waiters_{0};
+        std::atomic<bool> rate_limited_{false};
     };
+
+    // ------------------------------------------------------------------------
+    // Returns a sender which starts sender once limiter allows another task
+    // to run, i.e. fewer than the upper threshold of tasks are in flight and
+    // the rate limit (if any) has a token available. The operation counts as
+    // in flight until sender completes. In contrast to the executor interface
+    // of limiting_executor the thread starting the operation is never
+    // blocked, the operation is deferred instead. Deferred operations are
+    // started in the order they were started themselves. The limiter has to
+    // stay alive until all operations have completed.
+    //
+    // The operations are counted by the limiter itself. If BaseExecutor
+    // provides in_flight_estimate, the executor interface throttles on that
+    // estimate instead, so tasks submitted through the executor interface
+    // are then not included in the limit of throttle and vice versa.
+    template <typename Sender, typename BaseExecutor>
+    detail::throttle_sender<Sender, limiting_executor<BaseExecutor>> throttle(
+        Sender&& sender, limiting_executor<BaseExecutor>& limiter)
+    {
+        return {PIKA_FORWARD(Sender, sender), &limiter};
+    }
 }}}    // namespace pika::execution::experimental
 
 namespace pika { namespace parallel { namespace execution {
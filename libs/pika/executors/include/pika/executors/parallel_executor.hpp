@@ -9,7 +9,6 @@
 #pragma once
 
 #include <pika/config.hpp>
-#include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/assert.hpp>
 #include <pika/async_base/launch_policy.hpp>
 #include <pika/execution/algorithms/detail/predicates.hpp>
@@ -25,6 +24,7 @@
 #include <pika/functional/deferred_call.hpp>
 #include <pika/functional/invoke.hpp>
 #include <pika/functional/one_shot.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/future.hpp>
 #include <pika/futures/traits/future_traits.hpp>
 #include <pika/iterator_support/range.hpp>
@@ -280,7 +280,7 @@ namespace pika { namespace execution {
 
             typename pika::traits::detail::shared_state_ptr<result_type>::type
                 p = lcos::detail::make_continuation_alloc_nounwrap<result_type>(
-                    pika::detail::internal_allocator<>{},
+                    pika::lcos::detail::default_future_data_allocator<>{},
                     PIKA_FORWARD(Future, predecessor), policy_,
                     PIKA_MOVE(func));
 
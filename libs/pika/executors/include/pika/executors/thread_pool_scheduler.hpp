@@ -18,6 +18,8 @@
 #include <pika/threading_base/annotated_function.hpp>
 #include <pika/threading_base/register_thread.hpp>
 #include <pika/threading_base/thread_description.hpp>
+#include <pika/threading_base/thread_helpers.hpp>
+#include <pika/threading_base/thread_pool_base.hpp>
 
 #include <cstddef>
 #include <exception>
@@ -26,6 +28,39 @@
 #include <utility>
 
 namespace pika { namespace execution { namespace experimental {
+    namespace detail {
+        /// Returns true if work scheduled on the given pool with the given
+        /// stacksize and hint can be run directly on the calling thread
+        /// instead of on a new thread.
+        PIKA_EXPORT bool can_execute_inline(
+            pika::threads::thread_pool_base* pool,
+            pika::threads::thread_stacksize stacksize,
+            pika::threads::thread_schedule_hint hint);
+
+        // Keeps track of the nesting depth of work run inline on the current
+        // thread.
+        struct inline_execution_depth_guard
+        {
+            inline_execution_depth_guard() noexcept
+              : count_(pika::threads::get_continuation_recursion_count())
+            {
+                ++count_;
+            }
+
+            ~inline_execution_depth_guard()
+            {
+                --count_;
+            }
+
+            inline_execution_depth_guard(
+                inline_execution_depth_guard const&) = delete;
+            inline_execution_depth_guard& operator=(
+                inline_execution_depth_guard const&) = delete;
+
+            std::size_t& count_;
+        };
+    }    // namespace detail
+
     struct thread_pool_scheduler
     {
         constexpr thread_pool_scheduler() = default;
@@ -39,7 +74,8 @@ namespace pika { namespace execution { namespace experimental {
         {
             return pool_ == rhs.pool_ && priority_ == rhs.priority_ &&
                 stacksize_ == rhs.stacksize_ &&
-                schedulehint_ == rhs.schedulehint_;
+                schedulehint_ == rhs.schedulehint_ &&
+                inline_execution_ == rhs.inline_execution_;
         }
 
         bool operator!=(thread_pool_scheduler const& rhs) const noexcept
@@ -135,9 +171,40 @@ namespace pika { namespace execution { namespace experimental {
             return scheduler.annotation_;
         }
 
+        // support with_inline_execution property
+        //
+        // When enabled, work is run directly on the calling thread instead of
+        // on a new thread if the calling thread is a worker thread of the
+        // same pool, no particular placement has been requested, and the
+        // nesting depth of work run inline is small enough. Otherwise a new
+        // thread is spawned as usual.
+        friend thread_pool_scheduler tag_invoke(
+            pika::execution::experimental::with_inline_execution_t,
+            thread_pool_scheduler const& scheduler, bool inline_execution)
+        {
+            auto sched_with_inline_execution = scheduler;
+            sched_with_inline_execution.inline_execution_ = inline_execution;
+            return sched_with_inline_execution;
+        }
+
+        friend bool tag_invoke(
+            pika::execution::experimental::get_inline_execution_t,
+            thread_pool_scheduler const& scheduler) noexcept
+        {
+            return scheduler.inline_execution_;
+        }
+
         template <typename F>
         void execute(F&& f, char const* fallback_annotation) const
         {
+            if (inline_execution_ &&
+                detail::can_execute_inline(pool_, stacksize_, schedulehint_))
+            {
+                detail::inline_execution_depth_guard guard;
+                PIKA_FORWARD(F, f)();
+                return;
+            }
+
             pika::util::thread_description desc(f, fallback_annotation);
             threads::thread_init_data data(
                 threads::make_thread_function_nullary(PIKA_FORWARD(F, f)), desc,
@@ -327,6 +394,7 @@ namespace pika { namespace execution { namespace experimental {
             pika::threads::thread_stacksize::small_;
         pika::threads::thread_schedule_hint schedulehint_{};
         char const* annotation_ = nullptr;
+        bool inline_execution_ = false;
         /// \endcond
     };
 }}}    // namespace pika::execution::experimental
@@ -17,6 +17,7 @@
 #include <pika/execution_base/completion_scheduler.hpp>
 #include <pika/execution_base/receiver.hpp>
 #include <pika/execution_base/sender.hpp>
+#include <pika/executors/detail/bulk_iteration_time.hpp>
 #include <pika/executors/thread_pool_scheduler.hpp>
 #include <pika/functional/bind_front.hpp>
 #include <pika/functional/tag_invoke.hpp>
@@ -25,11 +26,15 @@
 #include <pika/iterator_support/traits/is_range.hpp>
 #include <pika/threading_base/annotated_function.hpp>
 #include <pika/threading_base/register_thread.hpp>
+#include <pika/threading_base/thread_init_data.hpp>
+#include <pika/timing/high_resolution_clock.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <limits>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -42,16 +47,20 @@ namespace pika { namespace execution { namespace experimental {
         /// thread_pool_scheduler.
         ///
         /// The work is chunked into a number of chunks larger than the number
-        /// of worker threads available on the underlying thread pool. The
-        /// chunks are then assigned to worker thread-specific thread-safe index
-        /// queues. One pika thread is spawned for each underlying worker (OS)
-        /// thread. The pika thread is responsible for work in one queue. If the
-        /// queue is empty, no pika thread will be spawned. Once the pika thread
-        /// has finished working on its own queue, it will attempt to steal work
-        /// from other queues. Since predecessor sender must complete on an pika
-        /// thread (the completion scheduler is a thread_pool_scheduler;
-        /// otherwise the customization defined in this file is not chosen) it
-        /// will be reused as one of the worker threads.
+        /// of worker threads available on the underlying thread pool. Once
+        /// the time one iteration takes has been measured for a call site,
+        /// the chunk size is chosen such that one chunk runs for about
+        /// target_chunk_time, otherwise there are 4 to 8 chunks per worker
+        /// thread. The chunks are then assigned to worker thread-specific
+        /// thread-safe index queues. One pika thread is spawned for each
+        /// underlying worker (OS) thread. The pika thread is responsible for
+        /// work in one queue. If the queue is empty, no pika thread will be
+        /// spawned. Once the pika thread has finished working on its own
+        /// queue, it will attempt to steal work from other queues. Since
+        /// predecessor sender must complete on an pika thread (the completion
+        /// scheduler is a thread_pool_scheduler; otherwise the customization
+        /// defined in this file is not chosen) it will be reused as one of
+        /// the worker threads.
         template <typename Sender, typename Shape, typename F>
         class thread_pool_bulk_sender
         {
@@ -125,6 +134,14 @@ namespace pika { namespace execution { namespace experimental {
             }
 
         private:
+            using iteration_time_type =
+                bulk_iteration_time<std::decay_t<Shape>, std::decay_t<F>>;
+
+            // The time in nanoseconds one chunk should run for once the time
+            // per iteration is known. This is long enough to make the
+            // overhead of taking chunks from the index queues negligible.
+            static constexpr std::uint64_t target_chunk_time = 20000;
+
             template <typename Receiver>
             struct operation_state
             {
@@ -175,7 +192,7 @@ namespace pika { namespace execution { namespace experimental {
                                     task_f->n);
                             auto it = pika::util::begin(op_state->shape);
                             std::advance(it, i_begin);
-                            for (std::uint32_t i = i_begin; i < i_end; ++i)
+                            for (size_type i = i_begin; i < i_end; ++i)
                             {
                                 pika::util::invoke_fused(
                                     pika::util::bind_front(op_state->f, *it),
@@ -296,6 +313,11 @@ namespace pika { namespace execution { namespace experimental {
                                 }
                                 else
                                 {
+                                    iteration_time_type::update(
+                                        op_state->busy_time.load(
+                                            std::memory_order_relaxed) /
+                                        n);
+
                                     pika::visit(
                                         set_value_end_loop_visitor{op_state},
                                         PIKA_MOVE(op_state->ts));
@@ -306,9 +328,12 @@ namespace pika { namespace execution { namespace experimental {
                         // Entry point for the worker thread. It will attempt to
                         // do its local work, catch any exceptions, and then
                         // call set_value or set_error on the connected
-                        // receiver.
+                        // receiver. The time spent working is added to the
+                        // total used for the iteration time estimate.
                         void operator()()
                         {
+                            std::uint64_t const start =
+                                pika::chrono::high_resolution_clock::now();
                             try
                             {
                                 do_work();
@@ -317,24 +342,53 @@ namespace pika { namespace execution { namespace experimental {
                             {
                                 store_exception();
                             }
+                            op_state->busy_time.fetch_add(
+                                pika::chrono::high_resolution_clock::now() -
+                                    start,
+                                std::memory_order_relaxed);
 
                             finish();
                         };
                     };
 
                     // Compute a chunk size given a number of worker threads and
-                    // a total number of items n. Returns a power-of-2 chunk
-                    // size that produces at most 8 and at least 4 chunks per
-                    // worker thread.
+                    // a total number of items n. Without an estimate of the
+                    // time per iteration this returns a power-of-2 chunk size
+                    // that produces at most 8 and at least 4 chunks per worker
+                    // thread. Otherwise the chunk size is chosen such that a
+                    // chunk runs for about target_chunk_time, but there are
+                    // still at least 4 chunks per worker thread to steal from
+                    // when the iterations have irregular costs.
                     static constexpr std::uint32_t get_chunk_size(
-                        std::uint32_t const num_threads, size_type const n)
+                        std::uint32_t const num_threads, size_type const n,
+                        std::uint64_t const iteration_time)
                     {
-                        std::uint32_t chunk_size = 1;
-                        while (chunk_size * num_threads * 8 < n)
+                        std::uint64_t chunk_size = 1;
+                        if (iteration_time == 0)
+                        {
+                            while (chunk_size * num_threads * 8 < n)
+                            {
+                                chunk_size *= 2;
+                            }
+                        }
+                        else
                         {
-                            chunk_size *= 2;
+                            chunk_size = (std::max)(std::uint64_t(1),
+                                target_chunk_time / iteration_time);
+                            chunk_size = (std::min)(chunk_size,
+                                (std::max)(std::uint64_t(1),
+                                    static_cast<std::uint64_t>(n) /
+                                        (std::uint64_t(num_threads) * 4)));
                         }
-                        return chunk_size;
+
+                        // The chunk indices have to fit into the 32 bit
+                        // index queues.
+                        constexpr std::uint64_t max_index =
+                            (std::numeric_limits<std::uint32_t>::max)();
+                        chunk_size = (std::max)(chunk_size,
+                            static_cast<std::uint64_t>(n) / max_index + 1);
+                        return static_cast<std::uint32_t>(
+                            (std::min)(chunk_size, max_index));
                     }
 
                     // Initialize a queue for a worker thread.
@@ -351,10 +405,12 @@ namespace pika { namespace execution { namespace experimental {
                         queue.reset(part_begin, part_end);
                     }
 
-                    // Spawn a task which will process a number of chunks. If
-                    // the queue contains no chunks no task will be spawned.
-                    void do_work_task(size_type const n,
-                        std::uint32_t const chunk_size,
+                    // Add the description of a task which will process a
+                    // number of chunks to the given tasks. If the queue
+                    // contains no chunks no task will be spawned.
+                    void add_work_task(
+                        std::vector<threads::thread_init_data>& tasks,
+                        size_type const n, std::uint32_t const chunk_size,
                         std::uint32_t const worker_thread) const
                     {
                         task_function task_f{
@@ -379,7 +435,6 @@ namespace pika { namespace execution { namespace experimental {
                                 worker_thread);
                         }
 
-                        // Spawn the task.
                         char const* scheduler_annotation =
                             get_annotation(op_state->scheduler);
                         char const* annotation =
@@ -388,13 +443,11 @@ namespace pika { namespace execution { namespace experimental {
                                 std::decay_t<F>>::call(op_state->f) :
                             scheduler_annotation;
 
-                        threads::thread_init_data data(
+                        tasks.emplace_back(
                             threads::make_thread_function_nullary(
                                 PIKA_MOVE(task_f)),
                             annotation, get_priority(op_state->scheduler), hint,
                             get_stacksize(op_state->scheduler));
-                        threads::register_work(
-                            data, op_state->scheduler.get_thread_pool());
                     }
 
                     // Do the work on the worker thread that called set_value
@@ -435,7 +488,9 @@ namespace pika { namespace execution { namespace experimental {
 
                         // Calculate chunk size and number of chunks
                         auto const chunk_size =
-                            get_chunk_size(r.op_state->num_worker_threads, n);
+                            get_chunk_size(r.op_state->num_worker_threads, n,
+                                iteration_time_type::estimate.load(
+                                    std::memory_order_relaxed));
                         auto const num_chunks =
                             (n + chunk_size - 1) / chunk_size;
 
@@ -453,9 +508,13 @@ namespace pika { namespace execution { namespace experimental {
                             r.init_queue(worker_thread, num_chunks);
                         }
 
-                        // Spawn the worker threads for all except the local queue.
+                        // Spawn the worker threads for all except the local
+                        // queue. All tasks are submitted to the thread pool at
+                        // once.
                         auto const local_worker_thread =
                             pika::get_local_worker_thread_num();
+                        std::vector<threads::thread_init_data> tasks;
+                        tasks.reserve(r.op_state->num_worker_threads);
                         for (std::size_t worker_thread = 0;
                              worker_thread < r.op_state->num_worker_threads;
                              ++worker_thread)
@@ -467,7 +526,15 @@ namespace pika { namespace execution { namespace experimental {
                                 continue;
                             }
 
-                            r.do_work_task(n, chunk_size, worker_thread);
+                            r.add_work_task(
+                                tasks, n, chunk_size, worker_thread);
+                        }
+
+                        if (!tasks.empty())
+                        {
+                            threads::register_work_bulk(tasks.data(),
+                                tasks.size(),
+                                r.op_state->scheduler.get_thread_pool());
                         }
 
                         // Handle the queue for the local thread.
@@ -496,6 +563,7 @@ namespace pika { namespace execution { namespace experimental {
                     ts;
                 std::atomic<bool> exception_thrown{false};
                 std::optional<std::exception_ptr> exception;
+                std::atomic<std::uint64_t> busy_time{0};
 
                 template <typename Sender_, typename Shape_, typename F_,
                     typename Receiver_>
@@ -20,6 +20,12 @@ namespace pika::execution::experimental {
         case fork_join_executor::loop_schedule::dynamic:
             os << "dynamic";
             break;
+        case fork_join_executor::loop_schedule::guided:
+            os << "guided";
+            break;
+        case fork_join_executor::loop_schedule::adaptive:
+            os << "adaptive";
+            break;
         default:
             os << "<unknown>";
             break;
@@ -0,0 +1,58 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/coroutines/thread_enums.hpp>
+#include <pika/executors/thread_pool_scheduler.hpp>
+#include <pika/threading_base/detail/get_default_pool.hpp>
+#include <pika/threading_base/thread_data.hpp>
+#include <pika/threading_base/thread_helpers.hpp>
+
+#include <cstddef>
+
+namespace pika::execution::experimental::detail {
+    bool can_execute_inline(pika::threads::thread_pool_base* pool,
+        pika::threads::thread_stacksize stacksize,
+        pika::threads::thread_schedule_hint hint)
+    {
+        using pika::threads::thread_stacksize;
+
+        // Only worker threads of the same pool can run the work directly.
+        // Work which has been explicitly placed elsewhere is always spawned.
+        if (pika::threads::get_self_ptr() == nullptr ||
+            pool != pika::threads::detail::get_self_or_default_pool() ||
+            hint.mode != pika::threads::thread_schedule_hint_mode::none)
+        {
+            return false;
+        }
+
+        // The current thread must be allowed to suspend and its stack must be
+        // at least as large as the requested one.
+        thread_stacksize const self_stacksize =
+            pika::threads::get_self_stacksize_enum();
+        if (self_stacksize == thread_stacksize::nostack ||
+            (stacksize != thread_stacksize::current &&
+                stacksize != thread_stacksize::nostack &&
+                stacksize > self_stacksize))
+        {
+            return false;
+        }
+
+        // Bound the depth of nested inline executions, shared with the
+        // continuations of futures
+        if (pika::threads::get_continuation_recursion_count() >=
+            PIKA_CONTINUATION_MAX_RECURSION_DEPTH)
+        {
+            return false;
+        }
+
+#if defined(PIKA_HAVE_THREADS_GET_STACK_POINTER)
+        return pika::this_thread::has_sufficient_stack_space();
+#else
+        return true;
+#endif
+    }
+}    // namespace pika::execution::experimental::detail
@@ -16,6 +16,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
@@ -81,6 +82,162 @@ void test_bulk_async(ExecutorArgs&&... args)
     PIKA_TEST_EQ(count.load(), 2 * n);
 }
 
+template <typename... ExecutorArgs>
+void test_bulk_sync_repeated(ExecutorArgs&&... args)
+{
+    std::cerr << "test_bulk_sync_repeated\n";
+
+    // Every element is processed exactly once, also when the adaptive
+    // schedule changes the chunk size between invocations from the same call
+    // site
+    fork_join_executor exec{std::forward<ExecutorArgs>(args)...};
+    for (std::size_t n : {0, 1, 7, 107, 1000, 10000, 3, 1000})
+    {
+        std::vector<std::atomic<int>> counts(n);
+        std::vector<std::size_t> v(n);
+        std::iota(std::begin(v), std::end(v), 0);
+
+        pika::parallel::execution::bulk_sync_execute(
+            exec, [&](std::size_t i) { ++counts[i]; }, v);
+
+        for (auto const& c : counts)
+        {
+            PIKA_TEST_EQ(c.load(), 1);
+        }
+    }
+}
+
+void test_bulk_reduce(pika::threads::thread_priority priority,
+    pika::threads::thread_stacksize stacksize,
+    fork_join_executor::loop_schedule schedule)
+{
+    std::cerr << "test_bulk_reduce\n";
+
+    std::size_t const n = 107;
+    std::vector<int> v(n);
+    std::iota(std::begin(v), std::end(v), 1);
+
+    fork_join_executor exec{priority, stacksize, schedule};
+    int const sum = exec.bulk_reduce_sync_execute(
+        [](int i, int offset) { return i + offset; }, v, 0, std::plus<>{}, 1);
+    PIKA_TEST_EQ(sum, int(n * (n + 1) / 2 + n));
+
+    // The result only contains init if the shape is empty
+    std::vector<int> empty;
+    PIKA_TEST_EQ(exec.bulk_reduce_sync_execute(
+                     [](int i) { return i; }, empty, 42, std::plus<>{}),
+        42);
+
+    // The elements are reduced in order with the static loop schedule
+    std::vector<std::string> strings(n);
+    std::transform(std::begin(v), std::end(v), std::begin(strings),
+        [](int i) { return std::to_string(i) + " "; });
+    std::string const concatenated = exec.bulk_reduce_sync_execute(
+        [](std::string const& s) { return s; }, strings, std::string(),
+        std::plus<>{});
+    std::string const expected =
+        std::accumulate(std::begin(strings), std::end(strings), std::string());
+    if (schedule == fork_join_executor::loop_schedule::static_)
+    {
+        PIKA_TEST_EQ(concatenated, expected);
+    }
+    else
+    {
+        PIKA_TEST_EQ(concatenated.size(), expected.size());
+    }
+}
+
+template <typename... ExecutorArgs>
+void test_bulk_sync_nested(ExecutorArgs&&... args)
+{
+    std::cerr << "test_bulk_sync_nested\n";
+
+    count = 0;
+    std::size_t const n = 17;
+    std::size_t const m = 13;
+    std::vector<int> outer(n);
+    std::vector<int> inner(m);
+    std::iota(std::begin(outer), std::end(outer), 0);
+    std::iota(std::begin(inner), std::end(inner), 1);
+
+    // Regions started from within a region of the same executor are run
+    // sequentially by the calling worker thread
+    fork_join_executor exec{std::forward<ExecutorArgs>(args)...};
+    std::vector<int> inner_sums(n);
+    pika::parallel::execution::bulk_sync_execute(
+        exec,
+        [&](int i) {
+            pika::parallel::execution::bulk_sync_execute(
+                exec, [](int, std::atomic<std::size_t>& c) { ++c; }, inner,
+                std::ref(count));
+            inner_sums[i] = exec.bulk_reduce_sync_execute(
+                [](int j) { return j; }, inner, i, std::plus<>{});
+        },
+        outer);
+    PIKA_TEST_EQ(count.load(), n * m);
+    for (std::size_t i = 0; i != n; ++i)
+    {
+        PIKA_TEST_EQ(inner_sums[i], int(i + m * (m + 1) / 2));
+    }
+
+    // The executor can be used for regular regions again after a nested one
+    pika::parallel::execution::bulk_sync_execute(exec, &bulk_test, outer, 42);
+    PIKA_TEST_EQ(count.load(), n * m + n);
+}
+
+void test_bulk_sync_nested_workers(pika::threads::thread_priority priority,
+    pika::threads::thread_stacksize stacksize,
+    fork_join_executor::loop_schedule schedule)
+{
+    std::cerr << "test_bulk_sync_nested_workers\n";
+
+    std::size_t const num_threads = pika::get_num_worker_threads();
+    std::size_t const n = 8 * num_threads;
+    std::size_t const m = 29;
+    std::vector<int> outer(n);
+    std::vector<int> inner(m);
+    std::iota(std::begin(outer), std::end(outer), 0);
+    std::iota(std::begin(inner), std::end(inner), 1);
+
+    // Every worker thread of the executor starts nested regions while the
+    // outer region is running on all of them
+    fork_join_executor exec{priority, stacksize, schedule};
+    std::vector<int> inner_sums(n);
+    std::vector<std::size_t> inner_counts(n);
+    std::vector<std::size_t> worker_threads(n);
+    for (std::size_t repeat = 0; repeat != 10; ++repeat)
+    {
+        pika::parallel::execution::bulk_sync_execute(
+            exec,
+            [&](int i) {
+                worker_threads[i] = pika::get_worker_thread_num();
+                inner_counts[i] = 0;
+                pika::parallel::execution::bulk_sync_execute(
+                    exec, [&](int) { ++inner_counts[i]; }, inner);
+                inner_sums[i] = exec.bulk_reduce_sync_execute(
+                    [](int j) { return j; }, inner, i, std::plus<>{});
+            },
+            outer);
+
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            PIKA_TEST_EQ(inner_counts[i], m);
+            PIKA_TEST_EQ(inner_sums[i], int(i + m * (m + 1) / 2));
+        }
+    }
+
+    // With the static schedule each worker thread handles its own part of
+    // the outer region
+    std::sort(std::begin(worker_threads), std::end(worker_threads));
+    std::size_t const num_used_threads = std::distance(
+        std::begin(worker_threads),
+        std::unique(std::begin(worker_threads), std::end(worker_threads)));
+    if (schedule == fork_join_executor::loop_schedule::static_)
+    {
+        PIKA_TEST_EQ(num_used_threads, num_threads);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void bulk_test_exception(int, int passed_through)    //-V813
 {
@@ -182,6 +339,10 @@ void test_executor(pika::threads::thread_priority priority,
               << "\n";
     test_bulk_sync(priority, stacksize, schedule);
     test_bulk_async(priority, stacksize, schedule);
+    test_bulk_sync_repeated(priority, stacksize, schedule);
+    test_bulk_reduce(priority, stacksize, schedule);
+    test_bulk_sync_nested(priority, stacksize, schedule);
+    test_bulk_sync_nested_workers(priority, stacksize, schedule);
     test_bulk_sync_exception(priority, stacksize, schedule);
     test_bulk_async_exception(priority, stacksize, schedule);
 }
@@ -208,6 +369,8 @@ int pika_main()
             for (auto const schedule : {
                      fork_join_executor::loop_schedule::static_,
                      fork_join_executor::loop_schedule::dynamic,
+                     fork_join_executor::loop_schedule::guided,
+                     fork_join_executor::loop_schedule::adaptive,
                  })
             {
                 {
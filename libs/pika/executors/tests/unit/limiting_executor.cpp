@@ -104,10 +104,131 @@ void test_limit()
     // PIKA_TEST_LTE(task_1_max, max1 + pika::get_num_worker_threads());
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// with a rate limit the first burst tasks start immediately, the remaining
+// ones at the given rate
+void test_rate_limit()
+{
+    auto exec = pika::execution::parallel_executor();
+
+    double const rate = 500.0;
+    std::size_t const burst = 10;
+    std::size_t const n = 60;
+
+    std::atomic<std::size_t> count(0);
+    auto start = std::chrono::steady_clock::now();
+    {
+        pika::execution::experimental::limiting_executor<decltype(exec)> lexec(
+            exec, pika::execution::experimental::rate_limit{rate, burst});
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            pika::apply(lexec, [&]() { ++count; });
+        }
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::cout << "Rate limited " << n << " tasks in " << elapsed.count()
+              << "s (expected at least " << (n - burst) / rate << "s)"
+              << std::endl;
+    PIKA_TEST_EQ(count.load(), n);
+    PIKA_TEST_LTE((n - burst) / rate * 0.9, elapsed.count());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// throttle defers operations instead of blocking the thread starting them:
+// all operations are started while the first ones can't complete yet, and
+// no more than the upper threshold of operations run at the same time
+void test_throttle()
+{
+    namespace ex = pika::execution::experimental;
+
+    std::size_t const upper = 4;
+    std::size_t const n = 100;
+
+    atype in_flight(0);
+    atype max_in_flight(0);
+    std::atomic<std::size_t> done(0);
+    std::atomic<bool> go(false);
+
+    auto exec = pika::execution::parallel_executor();
+    {
+        ex::limiting_executor<decltype(exec)> lexec(exec, upper / 2, upper);
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            ex::start_detached(
+                ex::throttle(ex::schedule(ex::thread_pool_scheduler{}) |
+                        ex::then([&]() {
+                            if (++in_flight > max_in_flight)
+                                max_in_flight.store(in_flight.load());
+                            pika::util::yield_while([&]() { return !go; });
+                            --in_flight;
+                            ++done;
+                        }),
+                    lexec));
+        }
+        PIKA_TEST_LTE(done.load(), std::size_t(0));
+
+        go = true;
+    }
+
+    PIKA_TEST_EQ(done.load(), n);
+    PIKA_TEST_LTE(max_in_flight.load(), std::int64_t(upper));
+
+    // the values of the sender are forwarded
+    {
+        ex::limiting_executor<decltype(exec)> lexec(exec, 0, 1);
+        PIKA_TEST_EQ(
+            pika::this_thread::experimental::sync_wait(
+                ex::throttle(ex::transfer_just(ex::thread_pool_scheduler{}, 42),
+                    lexec)),
+            42);
+    }
+}
+
+// throttle defers operations until the rate limit allows them to start
+void test_throttle_rate_limit()
+{
+    namespace ex = pika::execution::experimental;
+
+    double const rate = 500.0;
+    std::size_t const burst = 10;
+    std::size_t const n = 60;
+
+    std::atomic<std::size_t> count(0);
+    auto exec = pika::execution::parallel_executor();
+    auto start = std::chrono::steady_clock::now();
+    {
+        ex::limiting_executor<decltype(exec)> lexec(
+            exec, ex::rate_limit{rate, burst});
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            ex::start_detached(ex::throttle(
+                ex::schedule(ex::thread_pool_scheduler{}) |
+                    ex::then([&]() { ++count; }),
+                lexec));
+        }
+        std::chrono::duration<double> submitted =
+            std::chrono::steady_clock::now() - start;
+        PIKA_TEST_LTE(submitted.count(), (n - burst) / rate);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    PIKA_TEST_EQ(count.load(), n);
+    PIKA_TEST_LTE((n - burst) / rate * 0.9, elapsed.count());
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 int pika_main()
 {
     test_limit();
+    test_rate_limit();
+    test_throttle();
+    test_throttle_rate_limit();
 
     return pika::finalize();
 }
@@ -8,6 +8,7 @@
 #include <pika/execution.hpp>
 #include <pika/functional.hpp>
 #include <pika/init.hpp>
+#include <pika/latch.hpp>
 #include <pika/mutex.hpp>
 #include <pika/testing.hpp>
 #include <pika/thread.hpp>
@@ -356,6 +357,63 @@ void test_properties()
     }
 }
 
+void test_inline_execution()
+{
+    ex::thread_pool_scheduler sched{};
+    PIKA_TEST(!ex::get_inline_execution(sched));
+
+    auto sched_inline = ex::with_inline_execution(sched, true);
+    PIKA_TEST(ex::get_inline_execution(sched_inline));
+    PIKA_TEST(sched != sched_inline);
+
+    // Work is run directly on the calling worker thread
+    {
+        pika::thread::id parent_id = pika::this_thread::get_id();
+        bool executed = false;
+        ex::start_detached(ex::schedule(sched_inline) | ex::then([&]() {
+            PIKA_TEST_EQ(parent_id, pika::this_thread::get_id());
+            executed = true;
+        }));
+        PIKA_TEST(executed);
+    }
+
+    // Work with an explicit placement is always run on a new thread
+    {
+        pika::thread::id parent_id = pika::this_thread::get_id();
+        auto sched_hint = ex::with_hint(
+            sched_inline, pika::threads::thread_schedule_hint{0});
+        tt::sync_wait(ex::schedule(sched_hint) | ex::then([&]() {
+            PIKA_TEST_NEQ(parent_id, pika::this_thread::get_id());
+        }));
+    }
+
+    // Work scheduled from outside the pool is run on a new thread
+    {
+        pika::latch l(2);
+        std::thread t([&]() {
+            tt::sync_wait(ex::schedule(sched_inline) | ex::then([]() {
+                PIKA_TEST(pika::threads::get_self_ptr() != nullptr);
+            }));
+            l.count_down(1);
+        });
+        l.arrive_and_wait();
+        t.join();
+    }
+
+    // Long chains of continuations are run partially inline and partially on
+    // new threads when the nesting depth gets too large
+    {
+        constexpr std::size_t chain_length = 100;
+        ex::unique_any_sender<std::size_t> s = ex::just(std::size_t(0));
+        for (std::size_t i = 0; i != chain_length; ++i)
+        {
+            s = ex::transfer(std::move(s), sched_inline) |
+                ex::then([](std::size_t x) { return x + 1; });
+        }
+        PIKA_TEST_EQ(tt::sync_wait(std::move(s)), chain_length);
+    }
+}
+
 void test_transfer_basic()
 {
     ex::thread_pool_scheduler sched{};
@@ -1899,6 +1957,7 @@ int pika_main()
     test_sender_receiver_then_sync_wait();
     test_sender_receiver_then_arguments();
     test_properties();
+    test_inline_execution();
     test_transfer_basic();
     test_transfer_arguments();
     test_just_void();
@@ -19,21 +19,25 @@
 #include <pika/functional/traits/is_invocable.hpp>
 
 #include <cstddef>
-#include <cstring>
 #include <new>
 #include <string>
 #include <type_traits>
 #include <utility>
 
 namespace pika { namespace util { namespace detail {
+    /// The default size of the buffer used by function and unique_function to
+    /// store callables without allocating memory.
     static const std::size_t function_storage_size = 3 * sizeof(void*);
 
     ///////////////////////////////////////////////////////////////////////////
-    class PIKA_EXPORT function_base
+    template <std::size_t StorageSize>
+    class function_base
     {
         using vtable = function_base_vtable;
 
     public:
+        static constexpr std::size_t storage_size = StorageSize;
+
         constexpr explicit function_base(
             function_base_vtable const* empty_vptr) noexcept
           : vptr(empty_vptr)
@@ -74,10 +78,170 @@ namespace pika { namespace util { namespace detail {
         union
         {
             char storage_init;
-            mutable unsigned char storage[function_storage_size];
+            mutable unsigned char storage[StorageSize];
         };
     };
 
+    ///////////////////////////////////////////////////////////////////////////
+    template <std::size_t StorageSize>
+    function_base<StorageSize>::function_base(
+        function_base const& other, vtable const* /* empty_vtable */)
+      : vptr(other.vptr)
+      , object(other.object)
+    {
+        if (other.object != nullptr)
+        {
+            object = vptr->copy(
+                storage, StorageSize, other.object, /*destroy*/ false);
+        }
+    }
+
+    template <std::size_t StorageSize>
+    function_base<StorageSize>::function_base(
+        function_base&& other, vtable const* empty_vptr) noexcept
+      : vptr(other.vptr)
+      , object(other.object)
+    {
+        if (object == &other.storage)
+        {
+            vptr->relocate(storage, other.storage);
+            object = &storage;
+        }
+        other.vptr = empty_vptr;
+        other.object = nullptr;
+    }
+
+    template <std::size_t StorageSize>
+    function_base<StorageSize>::~function_base()
+    {
+        destroy();
+    }
+
+    template <std::size_t StorageSize>
+    void function_base<StorageSize>::op_assign(
+        function_base const& other, vtable const* /* empty_vtable */)
+    {
+        if (vptr == other.vptr)
+        {
+            if (this != &other && object)
+            {
+                PIKA_ASSERT(other.object != nullptr);
+                // reuse object storage
+                object = vptr->copy(
+                    object, std::size_t(-1), other.object, /*destroy*/ true);
+            }
+        }
+        else
+        {
+            destroy();
+            vptr = other.vptr;
+            if (other.object != nullptr)
+            {
+                object = vptr->copy(
+                    storage, StorageSize, other.object, /*destroy*/ false);
+            }
+            else
+            {
+                object = nullptr;
+            }
+        }
+    }
+
+    template <std::size_t StorageSize>
+    void function_base<StorageSize>::op_assign(
+        function_base&& other, vtable const* empty_vtable) noexcept
+    {
+        if (this != &other)
+        {
+            swap(other);
+            other.reset(empty_vtable);
+        }
+    }
+
+    template <std::size_t StorageSize>
+    void function_base<StorageSize>::destroy() noexcept
+    {
+        if (object != nullptr)
+        {
+            vptr->deallocate(object, StorageSize, /*destroy*/ true);
+        }
+    }
+
+    template <std::size_t StorageSize>
+    void function_base<StorageSize>::reset(vtable const* empty_vptr) noexcept
+    {
+        destroy();
+        vptr = empty_vptr;
+        object = nullptr;
+    }
+
+    template <std::size_t StorageSize>
+    void function_base<StorageSize>::swap(function_base& f) noexcept
+    {
+        // objects stored in the inline buffers have to be relocated through
+        // their vtables, at most one of them at a time is moved to a
+        // temporary buffer
+        alignas(void*) unsigned char tmp[StorageSize];
+
+        void* this_object = object;
+        if (object == &storage)
+        {
+            vptr->relocate(tmp, storage);
+            this_object = &tmp;
+        }
+
+        object = f.object;
+        if (f.object == &f.storage)
+        {
+            f.vptr->relocate(storage, f.storage);
+            object = &storage;
+        }
+
+        f.object = this_object;
+        if (this_object == &tmp)
+        {
+            vptr->relocate(f.storage, tmp);
+            f.object = &f.storage;
+        }
+
+        std::swap(vptr, f.vptr);
+    }
+
+    template <std::size_t StorageSize>
+    std::size_t function_base<StorageSize>::get_function_address() const
+    {
+#if defined(PIKA_HAVE_THREAD_DESCRIPTION)
+        return vptr->get_function_address(object);
+#else
+        return 0;
+#endif
+    }
+
+    template <std::size_t StorageSize>
+    char const* function_base<StorageSize>::get_function_annotation() const
+    {
+#if defined(PIKA_HAVE_THREAD_DESCRIPTION)
+        return vptr->get_function_annotation(object);
+#else
+        return nullptr;
+#endif
+    }
+
+    template <std::size_t StorageSize>
+    util::itt::string_handle
+    function_base<StorageSize>::get_function_annotation_itt() const
+    {
+#if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
+        return vptr->get_function_annotation_itt(object);
+#else
+        return util::itt::string_handle{};
+#endif
+    }
+
+    // the function_base used by the default function and unique_function is
+    // instantiated only once in the library
+    extern template class PIKA_EXPORT function_base<function_storage_size>;
+
     ///////////////////////////////////////////////////////////////////////////
     template <typename F>
     constexpr bool is_empty_function(F* fp) noexcept
@@ -91,7 +255,8 @@ namespace pika { namespace util { namespace detail {
         return mp == nullptr;
     }
 
-    inline bool is_empty_function_impl(function_base const* f) noexcept
+    template <std::size_t StorageSize>
+    bool is_empty_function_impl(function_base<StorageSize> const* f) noexcept
     {
         return f->empty();
     }
@@ -108,13 +273,16 @@ namespace pika { namespace util { namespace detail {
     }
 
     ///////////////////////////////////////////////////////////////////////////
-    template <typename Sig, bool Copyable>
+    template <typename Sig, bool Copyable,
+        std::size_t StorageSize = function_storage_size>
     class basic_function;
 
-    template <bool Copyable, typename R, typename... Ts>
-    class basic_function<R(Ts...), Copyable> : public function_base
+    template <bool Copyable, std::size_t StorageSize, typename R,
+        typename... Ts>
+    class basic_function<R(Ts...), Copyable, StorageSize>
+      : public function_base<StorageSize>
     {
-        using base_type = function_base;
+        using base_type = function_base<StorageSize>;
         using vtable = function_vtable<R(Ts...), Copyable>;
 
     public:
@@ -171,10 +339,9 @@ namespace pika { namespace util { namespace detail {
                 }
                 else
                 {
-                    destroy();
+                    base_type::destroy();
                     vptr = f_vptr;
-                    buffer = vtable::template allocate<T>(
-                        storage, function_storage_size);
+                    buffer = vtable::template allocate<T>(storage, StorageSize);
                 }
                 object = ::new (buffer) T(PIKA_FORWARD(F, f));
             }
@@ -201,7 +368,7 @@ namespace pika { namespace util { namespace detail {
                 "T shall be Callable with the function signature");
 
             vtable const* f_vptr = get_vtable<TD>();
-            if (vptr != f_vptr || empty())
+            if (vptr != f_vptr || base_type::empty())
                 return nullptr;
 
             return &vtable::template get<TD>(object);
@@ -215,7 +382,7 @@ namespace pika { namespace util { namespace detail {
                 "T shall be Callable with the function signature");
 
             vtable const* f_vptr = get_vtable<TD>();
-            if (vptr != f_vptr || empty())
+            if (vptr != f_vptr || base_type::empty())
                 return nullptr;
 
             return &vtable::template get<TD>(object);
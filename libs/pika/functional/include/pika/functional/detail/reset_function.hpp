@@ -9,15 +9,17 @@
 #include <pika/functional/function.hpp>
 #include <pika/functional/unique_function.hpp>
 
+#include <cstddef>
+
 namespace pika { namespace util { namespace detail {
-    template <typename Sig>
-    inline void reset_function(pika::util::function<Sig>& f)
+    template <typename Sig, std::size_t StorageSize>
+    inline void reset_function(pika::util::function<Sig, StorageSize>& f)
     {
         f.reset();
     }
 
-    template <typename Sig>
-    inline void reset_function(pika::util::unique_function<Sig>& f)
+    template <typename Sig, std::size_t StorageSize>
+    inline void reset_function(pika::util::unique_function<Sig, StorageSize>& f)
     {
         f.reset();
     }
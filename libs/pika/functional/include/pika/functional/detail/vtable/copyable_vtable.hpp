@@ -21,8 +21,12 @@ namespace pika { namespace util { namespace detail {
         static void* _copy(void* storage, std::size_t storage_size,
             void const* src, bool destroy)
         {
+            // the storage of the destroyed object is reused
             if (destroy)
+            {
                 vtable::get<T>(storage).~T();
+                return ::new (storage) T(vtable::get<T>(src));
+            }
 
             void* buffer = vtable::allocate<T>(storage, storage_size);
             return ::new (buffer) T(vtable::get<T>(src));
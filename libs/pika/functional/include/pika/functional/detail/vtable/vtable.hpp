@@ -11,7 +11,9 @@
 #include <pika/config.hpp>
 
 #include <cstddef>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 namespace pika { namespace util { namespace detail {
     ///////////////////////////////////////////////////////////////////////////
@@ -53,13 +55,22 @@ namespace pika { namespace util { namespace detail {
             return *reinterpret_cast<T const*>(obj);
         }
 
+        // Objects are only stored in the inline buffer if moving them can't
+        // throw, as they are relocated when the function is moved or swapped.
+        template <typename T>
+        static constexpr bool is_stored_inline(std::size_t storage_size)
+        {
+            return sizeof(T) <= storage_size &&
+                std::is_nothrow_move_constructible_v<T>;
+        }
+
         template <typename T>
         static void* allocate(void* storage, std::size_t storage_size)
         {
             using storage_t =
                 typename std::aligned_storage<sizeof(T), alignof(T)>::type;
 
-            if (sizeof(T) > storage_size)
+            if (!is_stored_inline<T>(storage_size))
             {
                 return new storage_t;
             }
@@ -78,16 +89,45 @@ namespace pika { namespace util { namespace detail {
                 get<T>(obj).~T();
             }
 
-            if (sizeof(T) > storage_size)
+            if (!is_stored_inline<T>(storage_size))
             {
                 delete static_cast<storage_t*>(obj);
             }
         }
         void (*deallocate)(void*, std::size_t storage_size, bool);
 
+        // Moves an object stored in the inline buffer of a function to the
+        // inline buffer of another one. Objects are not relocated bitwise as
+        // they may refer to their own storage (e.g. nested functions).
+        template <typename T>
+        static void _relocate(void* dest, void* src) noexcept
+        {
+            ::new (dest) T(PIKA_MOVE(get<T>(src)));
+            get<T>(src).~T();
+        }
+        using relocate_function = void (*)(void*, void*) noexcept;
+        relocate_function relocate;
+
+        // Objects which can't be moved without throwing (or at all) are
+        // never stored inline and thus never relocated, _relocate is not
+        // instantiated for them.
+        template <typename T>
+        static constexpr relocate_function get_relocate() noexcept
+        {
+            if constexpr (std::is_nothrow_move_constructible_v<T>)
+            {
+                return &vtable::template _relocate<T>;
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
         template <typename T>
         constexpr vtable(construct_vtable<T>) noexcept
           : deallocate(&vtable::template _deallocate<T>)
+          , relocate(get_relocate<T>())
         {
         }
     };
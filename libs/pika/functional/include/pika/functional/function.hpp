@@ -20,13 +20,18 @@
 
 namespace pika { namespace util {
     ///////////////////////////////////////////////////////////////////////////
-    template <typename Sig>
+    /// A copyable wrapper for callables with the signature \a Sig. Callables
+    /// of up to \a StorageSize bytes are stored in place, larger ones are
+    /// allocated on the heap.
+    template <typename Sig,
+        std::size_t StorageSize = detail::function_storage_size>
     class function;
 
-    template <typename R, typename... Ts>
-    class function<R(Ts...)> : public detail::basic_function<R(Ts...), true>
+    template <std::size_t StorageSize, typename R, typename... Ts>
+    class function<R(Ts...), StorageSize>
+      : public detail::basic_function<R(Ts...), true, StorageSize>
     {
-        using base_type = detail::basic_function<R(Ts...), true>;
+        using base_type = detail::basic_function<R(Ts...), true, StorageSize>;
 
     public:
         using result_type = R;
@@ -72,30 +77,32 @@ namespace pika { namespace util {
 #if defined(PIKA_HAVE_THREAD_DESCRIPTION)
 ///////////////////////////////////////////////////////////////////////////////
 namespace pika { namespace traits {
-    template <typename Sig>
-    struct get_function_address<util::function<Sig>>
+    template <typename Sig, std::size_t StorageSize>
+    struct get_function_address<util::function<Sig, StorageSize>>
     {
-        static constexpr std::size_t call(util::function<Sig> const& f) noexcept
+        static constexpr std::size_t call(
+            util::function<Sig, StorageSize> const& f) noexcept
         {
             return f.get_function_address();
         }
     };
 
-    template <typename Sig>
-    struct get_function_annotation<util::function<Sig>>
+    template <typename Sig, std::size_t StorageSize>
+    struct get_function_annotation<util::function<Sig, StorageSize>>
     {
-        static constexpr char const* call(util::function<Sig> const& f) noexcept
+        static constexpr char const* call(
+            util::function<Sig, StorageSize> const& f) noexcept
         {
             return f.get_function_annotation();
         }
     };
 
 #if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
-    template <typename Sig>
-    struct get_function_annotation_itt<util::function<Sig>>
+    template <typename Sig, std::size_t StorageSize>
+    struct get_function_annotation_itt<util::function<Sig, StorageSize>>
     {
         static util::itt::string_handle call(
-            util::function<Sig> const& f) noexcept
+            util::function<Sig, StorageSize> const& f) noexcept
         {
             return f.get_function_annotation_itt();
         }
@@ -20,14 +20,19 @@
 
 namespace pika { namespace util {
     ///////////////////////////////////////////////////////////////////////////
-    template <typename Sig>
+    /// A move-only wrapper for callables with the signature \a Sig. Callables
+    /// of up to \a StorageSize bytes are stored in place, larger ones are
+    /// allocated on the heap.
+    template <typename Sig,
+        std::size_t StorageSize = detail::function_storage_size>
     class unique_function;
 
-    template <typename R, typename... Ts>
-    class unique_function<R(Ts...)>
-      : public detail::basic_function<R(Ts...), false>
+    template <std::size_t StorageSize, typename R, typename... Ts>
+    class unique_function<R(Ts...), StorageSize>
+      : public detail::basic_function<R(Ts...), false, StorageSize>
     {
-        using base_type = detail::basic_function<R(Ts...), false>;
+        using base_type =
+            detail::basic_function<R(Ts...), false, StorageSize>;
 
     public:
         using result_type = R;
@@ -71,32 +76,32 @@ namespace pika { namespace util {
 #if defined(PIKA_HAVE_THREAD_DESCRIPTION)
 ///////////////////////////////////////////////////////////////////////////////
 namespace pika { namespace traits {
-    template <typename Sig>
-    struct get_function_address<util::unique_function<Sig>>
+    template <typename Sig, std::size_t StorageSize>
+    struct get_function_address<util::unique_function<Sig, StorageSize>>
     {
         static constexpr std::size_t call(
-            util::unique_function<Sig> const& f) noexcept
+            util::unique_function<Sig, StorageSize> const& f) noexcept
         {
             return f.get_function_address();
         }
     };
 
-    template <typename Sig>
-    struct get_function_annotation<util::unique_function<Sig>>
+    template <typename Sig, std::size_t StorageSize>
+    struct get_function_annotation<util::unique_function<Sig, StorageSize>>
     {
         static constexpr char const* call(
-            util::unique_function<Sig> const& f) noexcept
+            util::unique_function<Sig, StorageSize> const& f) noexcept
         {
             return f.get_function_annotation();
         }
     };
 
 #if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
-    template <typename Sig>
-    struct get_function_annotation_itt<util::unique_function<Sig>>
+    template <typename Sig, std::size_t StorageSize>
+    struct get_function_annotation_itt<util::unique_function<Sig, StorageSize>>
     {
         static util::itt::string_handle call(
-            util::unique_function<Sig> const& f) noexcept
+            util::unique_function<Sig, StorageSize> const& f) noexcept
         {
             return f.get_function_annotation_itt();
         }
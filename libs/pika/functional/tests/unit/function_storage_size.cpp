@@ -0,0 +1,246 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/functional/function.hpp>
+#include <pika/functional/unique_function.hpp>
+#include <pika/testing.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// a callable of (at least) N bytes which keeps track of its live instances
+template <std::size_t N>
+struct closure
+{
+    static int instances;
+
+    unsigned char data[N];
+
+    explicit closure(unsigned char value)
+    {
+        data[0] = value;
+        data[N - 1] = value;
+        ++instances;
+    }
+
+    closure(closure const& other) noexcept
+    {
+        data[0] = other.data[0];
+        data[N - 1] = other.data[N - 1];
+        ++instances;
+    }
+
+    ~closure()
+    {
+        --instances;
+    }
+
+    int operator()() const
+    {
+        return data[0] + data[N - 1];
+    }
+};
+
+template <std::size_t N>
+int closure<N>::instances = 0;
+
+template <typename Function, std::size_t N>
+void test_function()
+{
+    {
+        Function f1 = closure<N>(1);
+        PIKA_TEST_EQ(f1(), 2);
+        PIKA_TEST_EQ(closure<N>::instances, 1);
+
+        // moving an object stored in place must relocate it
+        Function f2 = std::move(f1);
+        PIKA_TEST(f1.empty());
+        PIKA_TEST_EQ(f2(), 2);
+
+        Function f3 = closure<N>(2);
+        f3.swap(f2);
+        PIKA_TEST_EQ(f2(), 4);
+        PIKA_TEST_EQ(f3(), 2);
+        PIKA_TEST_EQ(closure<N>::instances, 2);
+
+        f3 = std::move(f2);
+        PIKA_TEST_EQ(f3(), 4);
+        PIKA_TEST_EQ(closure<N>::instances, 1);
+
+        PIKA_TEST(f3.template target<closure<N>>() != nullptr);
+    }
+    PIKA_TEST_EQ(closure<N>::instances, 0);
+}
+
+template <std::size_t N>
+void test_copy()
+{
+    {
+        pika::util::function<int(), 64> f1 = closure<N>(3);
+        pika::util::function<int(), 64> f2 = f1;
+        PIKA_TEST_EQ(f1(), 6);
+        PIKA_TEST_EQ(f2(), 6);
+        PIKA_TEST_EQ(closure<N>::instances, 2);
+
+        pika::util::function<int(), 64> f3;
+        f3 = f2;
+        PIKA_TEST_EQ(f3(), 6);
+        PIKA_TEST_EQ(closure<N>::instances, 3);
+    }
+    PIKA_TEST_EQ(closure<N>::instances, 0);
+}
+
+// a function stored in place may itself store its callable in place, the
+// inner object refers to its own storage and must not be copied bitwise
+void test_nested()
+{
+    using inner_type = pika::util::unique_function<int()>;
+    using outer_type = pika::util::unique_function<int(), 64>;
+
+    struct wrapper
+    {
+        inner_type f;
+
+        int operator()()
+        {
+            return f();
+        }
+    };
+    static_assert(sizeof(wrapper) <= 64, "wrapper should be stored in place");
+
+    outer_type f1 = wrapper{inner_type(closure<8>(1))};
+    outer_type f2 = std::move(f1);
+    PIKA_TEST_EQ(f2(), 2);
+
+    outer_type f3 = wrapper{inner_type(closure<8>(2))};
+    f2.swap(f3);
+    PIKA_TEST_EQ(f2(), 4);
+    PIKA_TEST_EQ(f3(), 2);
+
+    f2 = std::move(f3);
+    PIKA_TEST_EQ(f2(), 2);
+}
+
+// a callable whose move constructor may throw is stored on the heap even if it
+// fits into the inline buffer, moving or swapping functions must not move it
+struct throwing_move
+{
+    int value;
+
+    explicit throwing_move(int value)
+      : value(value)
+    {
+    }
+
+    throwing_move(throwing_move const& other)
+      : value(other.value)
+    {
+    }
+
+    throwing_move(throwing_move&&)
+    {
+        throw std::runtime_error("throwing_move");
+    }
+
+    int operator()() const
+    {
+        return value;
+    }
+};
+
+template <typename Function>
+void test_throwing_move()
+{
+    throwing_move const t1(1);
+    throwing_move const t2(2);
+
+    Function f1 = t1;
+    Function f2 = std::move(f1);
+    PIKA_TEST(f1.empty());
+    PIKA_TEST_EQ(f2(), 1);
+
+    Function f3 = t2;
+    f3.swap(f2);
+    PIKA_TEST_EQ(f2(), 2);
+    PIKA_TEST_EQ(f3(), 1);
+
+    f3 = std::move(f2);
+    PIKA_TEST_EQ(f3(), 2);
+}
+
+// a callable which can only be copied is stored on the heap as well
+struct deleted_move
+{
+    int value;
+
+    explicit deleted_move(int value)
+      : value(value)
+    {
+    }
+
+    deleted_move(deleted_move const& other)
+      : value(other.value)
+    {
+    }
+
+    deleted_move(deleted_move&&) = delete;
+
+    int operator()() const
+    {
+        return value;
+    }
+};
+
+void test_deleted_move()
+{
+    using function_type = pika::util::function<int(), 64>;
+
+    deleted_move const d1(1);
+    deleted_move const d2(2);
+
+    function_type f1 = d1;
+    function_type f2 = std::move(f1);
+    PIKA_TEST(f1.empty());
+    PIKA_TEST_EQ(f2(), 1);
+
+    function_type f3 = d2;
+    f3.swap(f2);
+    PIKA_TEST_EQ(f2(), 2);
+    PIKA_TEST_EQ(f3(), 1);
+
+    function_type f4 = f3;
+    PIKA_TEST_EQ(f4(), 1);
+}
+
+int main()
+{
+    static_assert(sizeof(pika::util::unique_function<void(), 128>) >= 128,
+        "the inline buffer should be part of the function object");
+    static_assert(sizeof(pika::util::unique_function<void()>) <
+            sizeof(pika::util::unique_function<void(), 128>),
+        "the default inline buffer should be smaller");
+
+    // stored in place and on the heap, respectively
+    test_function<pika::util::unique_function<int(), 64>, 48>();
+    test_function<pika::util::unique_function<int(), 64>, 96>();
+    test_function<pika::util::unique_function<int()>, 16>();
+    test_function<pika::util::unique_function<int()>, 96>();
+    test_function<pika::util::function<int(), 128>, 128>();
+
+    test_copy<32>();
+    test_copy<80>();
+
+    test_nested();
+
+    test_throwing_move<pika::util::unique_function<int(), 64>>();
+    test_throwing_move<pika::util::function<int(), 64>>();
+
+    test_deleted_move();
+
+    return pika::util::report_errors();
+}
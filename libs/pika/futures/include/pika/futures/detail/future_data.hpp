@@ -13,6 +13,7 @@
 #include <pika/datastructures/detail/small_vector.hpp>
 #include <pika/errors/try_catch_exception_ptr.hpp>
 #include <pika/functional/function.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/future_fwd.hpp>
 #include <pika/futures/traits/future_access.hpp>
 #include <pika/futures/traits/get_remote_result.hpp>
@@ -24,14 +25,17 @@
 #include <pika/thread_support/atomic_count.hpp>
 #include <pika/threading_base/annotated_function.hpp>
 #include <pika/threading_base/thread_helpers.hpp>
+#include <pika/threading_base/thread_init_data.hpp>
 #include <pika/type_support/unused.hpp>
 
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -98,6 +102,38 @@ namespace pika { namespace lcos { namespace detail {
             delete this;
         }
 
+#if defined(PIKA_HAVE_FUTURE_DATA_POOL)
+        // Shared states created without an allocator are taken from the
+        // future data pool. Over-aligned shared states bypass the pool.
+        PIKA_NODISCARD static void* operator new(std::size_t size)
+        {
+            return future_data_pool_allocate(size);
+        }
+        static void operator delete(void* p) noexcept
+        {
+            future_data_pool_deallocate(p);
+        }
+
+        PIKA_NODISCARD static void* operator new(
+            std::size_t size, std::align_val_t alignment)
+        {
+            return ::operator new(size, alignment);
+        }
+        static void operator delete(
+            void* p, std::align_val_t alignment) noexcept
+        {
+            ::operator delete(p, alignment);
+        }
+
+        // the class specific allocation functions hide the global placement
+        // forms
+        PIKA_NODISCARD static void* operator new(std::size_t, void* p) noexcept
+        {
+            return p;
+        }
+        static void operator delete(void*, void*) noexcept {}
+#endif
+
         // This is a tag type used to convey the information that the caller is
         // _not_ going to addref the future_data instance
         struct init_no_addref
@@ -215,12 +251,18 @@ namespace pika { namespace lcos { namespace detail {
 
         future_data_base() noexcept
           : state_(empty)
+          , has_waiters_(false)
+          , on_completed_(nullptr)
+          , inline_on_completed_used_(false)
         {
         }
 
         explicit future_data_base(init_no_addref no_addref) noexcept
           : future_data_refcnt_base(no_addref)
           , state_(empty)
+          , has_waiters_(false)
+          , on_completed_(nullptr)
+          , inline_on_completed_used_(false)
         {
         }
 
@@ -323,9 +365,39 @@ namespace pika { namespace lcos { namespace detail {
         }
 
     protected:
+        // Callbacks are kept in a singly linked list which is detached by the
+        // thread making the future ready. The first callback is stored in the
+        // shared state itself.
+        struct completed_callback_node
+        {
+            completed_callback_type callback_;
+            completed_callback_node* next_ = nullptr;
+        };
+
+        // marks the list of callbacks as detached
+        static completed_callback_node* on_completed_closed() noexcept
+        {
+            return reinterpret_cast<completed_callback_node*>(
+                static_cast<std::uintptr_t>(1));
+        }
+
+        // Change the state from empty to the given one and invoke all
+        // registered callbacks. Returns false if the state was not empty.
+        bool set_ready(state s);
+
+        // release all callbacks without invoking them
+        void clear_on_completed() noexcept;
+
+        // move the callback out of the given node and release the node
+        completed_callback_type take_on_completed(
+            completed_callback_node* node) noexcept;
+
         mutable mutex_type mtx_;
         std::atomic<state> state_;    // current state
-        completed_callback_vector_type on_completed_;
+        std::atomic<bool> has_waiters_;
+        std::atomic<completed_callback_node*> on_completed_;
+        std::atomic<bool> inline_on_completed_used_;
+        completed_callback_node inline_on_completed_;
         local::detail::condition_variable cond_;    // threads waiting in read
     };
 
@@ -445,49 +517,15 @@ namespace pika { namespace lcos { namespace detail {
             result_type* value_ptr = reinterpret_cast<result_type*>(&storage_);
             construct(value_ptr, PIKA_FORWARD(Ts, ts)...);
 
-            // At this point the lock needs to be acquired to safely access the
-            // registered continuations
-            std::unique_lock<mutex_type> l(mtx_);
-
-            // handle all threads waiting for the future to become ready
-            auto on_completed = PIKA_MOVE(on_completed_);
-            on_completed_.clear();
-
             // The value has been set, changing the state to 'value' at this
             // point signals to all other threads that this future is ready.
-            state expected = empty;
-            if (!state_.compare_exchange_strong(
-                    expected, value, std::memory_order_release))
+            if (!set_ready(value))
             {
                 // this future should be 'empty' still (it can't be made ready
                 // more than once).
-                l.unlock();
                 PIKA_THROW_EXCEPTION(promise_already_satisfied,
                     "future_data_base::set_value",
                     "data has already been set for this future");
-                return;
-            }
-
-            // Note: we use notify_one repeatedly instead of notify_all as we
-            //       know: a) that most of the time we have at most one thread
-            //       waiting on the future (most futures are not shared), and
-            //       b) our implementation of condition_variable::notify_one
-            //       relinquishes the lock before resuming the waiting thread
-            //       which avoids suspension of this thread when it tries to
-            //       re-lock the mutex while exiting from condition_variable::wait
-            while (
-                cond_.notify_one(PIKA_MOVE(l), threads::thread_priority::boost))
-            {
-                l = std::unique_lock<mutex_type>(mtx_);
-            }
-
-            // Note: cv.notify_one() above 'consumes' the lock 'l' and leaves
-            //       it unlocked when returning.
-
-            // invoke the callback (continuation) function
-            if (!on_completed.empty())
-            {
-                handle_on_completed(PIKA_MOVE(on_completed));
             }
         }
 
@@ -504,49 +542,15 @@ namespace pika { namespace lcos { namespace detail {
                 reinterpret_cast<std::exception_ptr*>(&storage_);
             ::new ((void*) exception_ptr) std::exception_ptr(PIKA_MOVE(data));
 
-            // At this point the lock needs to be acquired to safely access the
-            // registered continuations
-            std::unique_lock<mutex_type> l(mtx_);
-
-            // handle all threads waiting for the future to become ready
-            auto on_completed = PIKA_MOVE(on_completed_);
-            on_completed_.clear();
-
             // The value has been set, changing the state to 'exception' at this
             // point signals to all other threads that this future is ready.
-            state expected = empty;
-            if (!state_.compare_exchange_strong(
-                    expected, exception, std::memory_order_release))
+            if (!set_ready(exception))
             {
                 // this future should be 'empty' still (it can't be made ready
                 // more than once).
-                l.unlock();
                 PIKA_THROW_EXCEPTION(promise_already_satisfied,
                     "future_data_base::set_exception",
                     "data has already been set for this future");
-                return;
-            }
-
-            // Note: we use notify_one repeatedly instead of notify_all as we
-            //       know: a) that most of the time we have at most one thread
-            //       waiting on the future (most futures are not shared), and
-            //       b) our implementation of condition_variable::notify_one
-            //       relinquishes the lock before resuming the waiting thread
-            //       which avoids suspension of this thread when it tries to
-            //       re-lock the mutex while exiting from condition_variable::wait
-            while (
-                cond_.notify_one(PIKA_MOVE(l), threads::thread_priority::boost))
-            {
-                l = std::unique_lock<mutex_type>(mtx_);
-            }
-
-            // Note: cv.notify_one() above 'consumes' the lock 'l' and leaves
-            //       it unlocked when returning.
-
-            // invoke the callback (continuation) function
-            if (!on_completed.empty())
-            {
-                handle_on_completed(PIKA_MOVE(on_completed));
             }
         }
 
@@ -615,7 +619,7 @@ namespace pika { namespace lcos { namespace detail {
                 break;
             }
 
-            on_completed_.clear();
+            clear_on_completed();
         }
 
         std::exception_ptr get_exception_ptr() const override
@@ -626,7 +630,6 @@ namespace pika { namespace lcos { namespace detail {
 
     protected:
         using base_type::mtx_;
-        using base_type::on_completed_;
         using base_type::state_;
 
     private:
@@ -899,6 +902,15 @@ namespace pika { namespace lcos { namespace detail {
             return threads::invalid_thread_id;
         }
 
+        // Return the description of a new thread which will run this task,
+        // without creating the thread
+        virtual threads::thread_init_data get_thread_init_data(
+            const char* /*annotation*/, launch /*policy*/)
+        {
+            PIKA_ASSERT(false);    // shouldn't ever be called
+            return threads::thread_init_data();
+        }
+
     protected:
         static void run_impl(future_base_type this_)
         {
@@ -0,0 +1,150 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/allocator_support/internal_allocator.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace pika { namespace lcos { namespace detail {
+
+    /// Counters of the future data pool, summed over all threads which have
+    /// used the pool. The counters are never reset.
+    struct future_data_pool_statistics
+    {
+        /// Number of blocks handed out by the pool.
+        std::int64_t allocations = 0;
+
+        /// Number of allocations which were served from a free list of the
+        /// calling thread.
+        std::int64_t reused_blocks = 0;
+
+        /// Number of allocations which had to go to the system allocator
+        /// because no block of the required size class was cached.
+        std::int64_t allocated_blocks = 0;
+
+        /// Number of allocations which were too large for any size class and
+        /// were forwarded to the system allocator.
+        std::int64_t large_allocations = 0;
+
+        /// Number of blocks which were released by a thread other than the
+        /// one which allocated them.
+        std::int64_t remote_deallocations = 0;
+    };
+
+    /// The future data pool is a size-class allocator for future shared
+    /// states. Each thread keeps one free list per size class. Blocks
+    /// released by the thread which allocated them go back to its free list
+    /// directly, blocks released by other threads are pushed onto a lock-free
+    /// list of the owning thread which is drained once its free lists run
+    /// empty.
+    ///
+    /// Returns memory for \a size bytes, suitably aligned for any object of
+    /// fundamental alignment.
+    PIKA_EXPORT void* future_data_pool_allocate(std::size_t size);
+
+    /// Releases memory obtained from \a future_data_pool_allocate. This can
+    /// be called from any thread.
+    PIKA_EXPORT void future_data_pool_deallocate(void* p) noexcept;
+
+    /// Returns the counters of the future data pool.
+    PIKA_EXPORT future_data_pool_statistics
+    get_future_data_pool_statistics();
+
+    /// Standard allocator taking its memory from the future data pool.
+    /// Over-aligned types bypass the pool.
+    template <typename T = char>
+    struct future_data_pool_allocator
+    {
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using is_always_equal = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+
+        constexpr future_data_pool_allocator() noexcept = default;
+
+        template <typename U>
+        constexpr future_data_pool_allocator(
+            future_data_pool_allocator<U> const&) noexcept
+        {
+        }
+
+        PIKA_NODISCARD T* allocate(std::size_t n)
+        {
+            if constexpr (alignof(T) > alignof(std::max_align_t))
+            {
+                return static_cast<T*>(::operator new(
+                    n * sizeof(T), std::align_val_t(alignof(T))));
+            }
+            else
+            {
+                return static_cast<T*>(
+                    future_data_pool_allocate(n * sizeof(T)));
+            }
+        }
+
+        void deallocate(T* p, std::size_t) noexcept
+        {
+            if constexpr (alignof(T) > alignof(std::max_align_t))
+            {
+                ::operator delete(p, std::align_val_t(alignof(T)));
+            }
+            else
+            {
+                future_data_pool_deallocate(p);
+            }
+        }
+    };
+
+    template <typename T, typename U>
+    constexpr bool operator==(future_data_pool_allocator<T> const&,
+        future_data_pool_allocator<U> const&) noexcept
+    {
+        return true;
+    }
+
+    template <typename T, typename U>
+    constexpr bool operator!=(future_data_pool_allocator<T> const&,
+        future_data_pool_allocator<U> const&) noexcept
+    {
+        return false;
+    }
+
+#if defined(PIKA_HAVE_FUTURE_DATA_POOL)
+    /// The allocator used for shared states created without a user supplied
+    /// allocator.
+    template <typename T = char>
+    using default_future_data_allocator = future_data_pool_allocator<T>;
+#else
+    template <typename T = char>
+    using default_future_data_allocator = pika::detail::internal_allocator<T>;
+#endif
+
+    /// Shared states created through entry points of modules which can't
+    /// depend on the futures module (e.g. pika::dataflow) are passed the
+    /// internal allocator. This replaces it with the default allocator for
+    /// shared states and leaves all other allocators alone.
+    template <typename Allocator>
+    constexpr Allocator const& select_future_data_allocator(
+        Allocator const& alloc) noexcept
+    {
+        return alloc;
+    }
+
+    template <typename T>
+    constexpr default_future_data_allocator<T> select_future_data_allocator(
+        pika::detail::internal_allocator<T> const&) noexcept
+    {
+        return default_future_data_allocator<T>{};
+    }
+}}}    // namespace pika::lcos::detail
@@ -9,7 +9,6 @@
 
 #include <pika/config.hpp>
 #include <pika/allocator_support/allocator_deleter.hpp>
-#include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/assert.hpp>
 #include <pika/async_base/launch_policy.hpp>
 #include <pika/concepts/concepts.hpp>
@@ -20,6 +19,7 @@
 #include <pika/functional/detail/invoke.hpp>
 #include <pika/functional/traits/is_invocable.hpp>
 #include <pika/futures/detail/future_data.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/future_fwd.hpp>
 #include <pika/futures/traits/acquire_shared_state.hpp>
 #include <pika/futures/traits/detail/future_await_traits.hpp>
@@ -1269,7 +1269,8 @@ namespace pika {
     make_ready_future(Ts&&... ts)
     {
         return make_ready_future_alloc<T>(
-            pika::detail::internal_allocator<>{}, PIKA_FORWARD(Ts, ts)...);
+            pika::lcos::detail::default_future_data_allocator<>{},
+            PIKA_FORWARD(Ts, ts)...);
     }
     ///////////////////////////////////////////////////////////////////////////
     // extension: create a pre-initialized future object, with allocator
@@ -1287,7 +1288,8 @@ namespace pika {
         T&& init)
     {
         return pika::make_ready_future_alloc<pika::util::decay_unwrap_t<T>>(
-            pika::detail::internal_allocator<>{}, PIKA_FORWARD(T, init));
+            pika::lcos::detail::default_future_data_allocator<>{},
+            PIKA_FORWARD(T, init));
     }
 
     ///////////////////////////////////////////////////////////////////////////
@@ -1357,7 +1359,8 @@ namespace pika {
     PIKA_FORCEINLINE future<void> make_ready_future()
     {
         return make_ready_future_alloc<void>(
-            pika::detail::internal_allocator<>{}, util::unused);
+            pika::lcos::detail::default_future_data_allocator<>{},
+            util::unused);
     }
 
     // Extension (see wg21.link/P0319)
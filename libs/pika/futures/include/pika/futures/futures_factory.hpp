@@ -8,13 +8,13 @@
 
 #include <pika/config.hpp>
 #include <pika/allocator_support/allocator_deleter.hpp>
-#include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/async_base/launch_policy.hpp>
 #include <pika/coroutines/thread_enums.hpp>
 #include <pika/errors/try_catch_exception_ptr.hpp>
 #include <pika/execution_base/execution.hpp>
 #include <pika/functional/deferred_call.hpp>
 #include <pika/futures/detail/future_data.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/future.hpp>
 #include <pika/futures/traits/future_access.hpp>
 #include <pika/modules/errors.hpp>
@@ -95,11 +95,11 @@ namespace pika { namespace lcos { namespace local {
             threads::thread_id_ref_type apply(threads::thread_pool_base* pool,
                 const char* annotation, launch policy, error_code& ec) override
             {
-                this->check_started();
-
-                pika::intrusive_ptr<base_type> this_(this);
                 if (policy == launch::fork)
                 {
+                    this->check_started();
+
+                    pika::intrusive_ptr<base_type> this_(this);
                     threads::thread_init_data data(
                         threads::make_thread_function_nullary(
                             util::deferred_call(
@@ -115,14 +115,23 @@ namespace pika { namespace lcos { namespace local {
                     return threads::register_thread(data, pool, ec);
                 }
 
-                threads::thread_init_data data(
+                threads::thread_init_data data =
+                    get_thread_init_data(annotation, policy);
+                return threads::register_work(data, pool, ec);
+            }
+
+            threads::thread_init_data get_thread_init_data(
+                const char* annotation, launch policy) override
+            {
+                this->check_started();
+
+                pika::intrusive_ptr<base_type> this_(this);
+                return threads::thread_init_data(
                     threads::make_thread_function_nullary(util::deferred_call(
                         &base_type::run_impl, PIKA_MOVE(this_))),
                     util::thread_description(f_, annotation), policy.priority(),
                     policy.hint(), policy.stacksize(),
                     threads::thread_schedule_state::pending);
-
-                return threads::register_work(data, pool, ec);
             }
         };
 
@@ -249,6 +258,22 @@ namespace pika { namespace lcos { namespace local {
 
                 return this->base_type::apply(pool, annotation, policy, ec);
             }
+
+            threads::thread_init_data get_thread_init_data(
+                const char* annotation, launch policy) override
+            {
+                if (exec_)
+                {
+                    PIKA_THROW_EXCEPTION(invalid_status,
+                        "task_object::get_thread_init_data",
+                        "tasks bound to an executor can't be run on a new "
+                        "thread");
+                    return threads::thread_init_data();
+                }
+
+                return this->base_type::get_thread_init_data(
+                    annotation, policy);
+            }
         };
 
         ///////////////////////////////////////////////////////////////////////
@@ -673,13 +698,14 @@ namespace pika { namespace lcos { namespace local {
                 !std::is_same_v<std::decay_t<F>, futures_factory>>>
         explicit futures_factory(F&& f)
           : task_(detail::create_task_object<Result, Cancelable>::call(
-                pika::detail::internal_allocator<>{}, PIKA_FORWARD(F, f)))
+                pika::lcos::detail::default_future_data_allocator<>{},
+                PIKA_FORWARD(F, f)))
         {
         }
 
         explicit futures_factory(Result (*f)())
           : task_(detail::create_task_object<Result, Cancelable>::call(
-                pika::detail::internal_allocator<>{}, f))
+                pika::lcos::detail::default_future_data_allocator<>{}, f))
         {
         }
 
@@ -745,6 +771,23 @@ namespace pika { namespace lcos { namespace local {
             return task_->apply(pool, annotation, policy, ec);
         }
 
+        // Return the description of a new thread which will run the task,
+        // without creating the thread. This allows to create the threads for
+        // a number of tasks at once using threads::register_work_bulk.
+        threads::thread_init_data get_thread_init_data(
+            const char* annotation = "futures_factory::apply",
+            launch policy = launch::async) const
+        {
+            if (!task_)
+            {
+                PIKA_THROW_EXCEPTION(task_moved,
+                    "futures_factory<Result()>::get_thread_init_data()",
+                    "futures_factory invalid (has it been moved?)");
+                return threads::thread_init_data();
+            }
+            return task_->get_thread_init_data(annotation, policy);
+        }
+
         // This is the same as get_future, except that it moves the
         // shared state into the returned future.
         pika::future<Result> get_future(error_code& ec = throws)
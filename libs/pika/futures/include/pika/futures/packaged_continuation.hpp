@@ -9,10 +9,10 @@
 
 #include <pika/config.hpp>
 #include <pika/allocator_support/allocator_deleter.hpp>
-#include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/async_base/launch_policy.hpp>
 #include <pika/errors/try_catch_exception_ptr.hpp>
 #include <pika/futures/detail/future_data.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/futures/traits/acquire_shared_state.hpp>
 #include <pika/futures/traits/future_access.hpp>
 #include <pika/futures/traits/future_traits.hpp>
@@ -762,7 +762,7 @@ namespace pika { namespace lcos { namespace detail {
     inline traits::detail::shared_state_ptr_t<future_unwrap_result_t<Future>>
     unwrap_impl(Future&& future, error_code& ec)
     {
-        return unwrap_impl_alloc(pika::detail::internal_allocator<>{},
+        return unwrap_impl_alloc(default_future_data_allocator<>{},
             PIKA_FORWARD(Future, future), ec);
     }
 
@@ -19,6 +19,8 @@
 #include <pika/modules/memory.hpp>
 #include <pika/threading_base/annotated_function.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <exception>
 #include <functional>
@@ -87,8 +89,10 @@ namespace pika { namespace lcos { namespace detail {
     }
 
     ///////////////////////////////////////////////////////////////////////////
-    future_data_base<traits::detail::future_data_void>::~future_data_base() =
-        default;
+    future_data_base<traits::detail::future_data_void>::~future_data_base()
+    {
+        clear_on_completed();
+    }
 
     static util::unused_type unused_;
 
@@ -245,6 +249,111 @@ namespace pika { namespace lcos { namespace detail {
     future_data_base<traits::detail::future_data_void>::handle_on_completed<
         completed_callback_vector_type>(completed_callback_vector_type&&);
 
+    future_data_base<traits::detail::future_data_void>::completed_callback_type
+    future_data_base<traits::detail::future_data_void>::take_on_completed(
+        completed_callback_node* node) noexcept
+    {
+        completed_callback_type on_completed = PIKA_MOVE(node->callback_);
+        if (node != &inline_on_completed_)
+        {
+            delete node;
+        }
+        else
+        {
+            node->callback_.reset();
+            node->next_ = nullptr;
+        }
+        return on_completed;
+    }
+
+    void
+    future_data_base<traits::detail::future_data_void>::clear_on_completed()
+        noexcept
+    {
+        completed_callback_node* head =
+            on_completed_.exchange(nullptr, std::memory_order_acquire);
+        if (head != on_completed_closed())
+        {
+            while (head != nullptr)
+            {
+                completed_callback_node* next = head->next_;
+                take_on_completed(head);
+                head = next;
+            }
+        }
+
+        inline_on_completed_used_.store(false, std::memory_order_relaxed);
+        has_waiters_.store(false, std::memory_order_relaxed);
+    }
+
+    bool future_data_base<traits::detail::future_data_void>::set_ready(state s)
+    {
+        state expected = empty;
+        if (!state_.compare_exchange_strong(
+                expected, s, std::memory_order_seq_cst))
+        {
+            return false;
+        }
+
+        // Threads waiting for the future to become ready set the flag before
+        // checking the state again, the lock is needed only if there are any.
+        if (has_waiters_.load(std::memory_order_seq_cst))
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+
+            // Note: we use notify_one repeatedly instead of notify_all as we
+            //       know: a) that most of the time we have at most one thread
+            //       waiting on the future (most futures are not shared), and
+            //       b) our implementation of condition_variable::notify_one
+            //       relinquishes the lock before resuming the waiting thread
+            //       which avoids suspension of this thread when it tries to
+            //       re-lock the mutex while exiting from
+            //       condition_variable::wait
+            while (
+                cond_.notify_one(PIKA_MOVE(l), threads::thread_priority::boost))
+            {
+                l = std::unique_lock<mutex_type>(mtx_);
+            }
+        }
+
+        // Detach the registered callbacks. Callbacks which are registered from
+        // now on see the list closed and are invoked right away.
+        completed_callback_node* head = on_completed_.exchange(
+            on_completed_closed(), std::memory_order_acq_rel);
+        if (head == nullptr)
+        {
+            return true;
+        }
+
+        // invoke the callback (continuation) functions
+        if (head->next_ == nullptr)
+        {
+            handle_on_completed(take_on_completed(head));
+            return true;
+        }
+
+        // the list holds the callbacks in reverse order of their registration
+        std::size_t count = 0;
+        for (completed_callback_node* node = head; node != nullptr;
+             node = node->next_)
+        {
+            ++count;
+        }
+
+        completed_callback_vector_type on_completed;
+        on_completed.reserve(count);
+        for (completed_callback_node* node = head; node != nullptr;)
+        {
+            completed_callback_node* next = node->next_;
+            on_completed.push_back(take_on_completed(node));
+            node = next;
+        }
+        std::reverse(on_completed.begin(), on_completed.end());
+
+        handle_on_completed(PIKA_MOVE(on_completed));
+        return true;
+    }
+
     /// Set the callback which needs to be invoked when the future becomes
     /// ready. If the future is ready the function will be invoked
     /// immediately.
@@ -258,22 +367,38 @@ namespace pika { namespace lcos { namespace detail {
         {
             // invoke the callback (continuation) function right away
             handle_on_completed(PIKA_MOVE(data_sink));
+            return;
+        }
+
+        // The first callback is stored in the shared state, only additional
+        // callbacks (of shared futures) need to be allocated.
+        completed_callback_node* node = nullptr;
+        if (!inline_on_completed_used_.load(std::memory_order_relaxed) &&
+            !inline_on_completed_used_.exchange(
+                true, std::memory_order_relaxed))
+        {
+            node = &inline_on_completed_;
         }
         else
         {
-            std::unique_lock l(mtx_);
-            if (is_ready())
-            {
-                l.unlock();
+            node = new completed_callback_node;
+        }
+        node->callback_ = PIKA_MOVE(data_sink);
 
-                // invoke the callback (continuation) function
-                handle_on_completed(PIKA_MOVE(data_sink));
-            }
-            else
+        completed_callback_node* head =
+            on_completed_.load(std::memory_order_acquire);
+        do
+        {
+            if (head == on_completed_closed())
             {
-                on_completed_.push_back(PIKA_MOVE(data_sink));
+                // the future has become ready in the meantime, invoke the
+                // callback (continuation) function
+                handle_on_completed(take_on_completed(node));
+                return;
             }
-        }
+            node->next_ = head;
+        } while (!on_completed_.compare_exchange_weak(head, node,
+            std::memory_order_release, std::memory_order_acquire));
     }
 
     future_data_base<traits::detail::future_data_void>::state
@@ -284,7 +409,10 @@ namespace pika { namespace lcos { namespace detail {
         if (s == empty)
         {
             std::unique_lock l(mtx_);
-            s = state_.load(std::memory_order_relaxed);
+
+            // make sure the thread setting the value notifies this thread
+            has_waiters_.store(true, std::memory_order_seq_cst);
+            s = state_.load(std::memory_order_seq_cst);
             if (s == empty)
             {
                 cond_.wait(l, "future_data_base::wait", ec);
@@ -313,7 +441,10 @@ namespace pika { namespace lcos { namespace detail {
         if (state_.load(std::memory_order_acquire) == empty)
         {
             std::unique_lock l(mtx_);
-            if (state_.load(std::memory_order_relaxed) == empty)
+
+            // make sure the thread setting the value notifies this thread
+            has_waiters_.store(true, std::memory_order_seq_cst);
+            if (state_.load(std::memory_order_seq_cst) == empty)
             {
                 threads::thread_restart_state const reason = cond_.wait_until(
                     l, abs_time, "future_data_base::wait_until", ec);
@@ -0,0 +1,325 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace pika { namespace lcos { namespace detail {
+
+    namespace {
+        constexpr std::size_t size_class_granularity = 64;
+        constexpr std::size_t num_size_classes = 16;
+        constexpr std::size_t max_cached_blocks =
+            PIKA_FUTURE_DATA_POOL_MAX_CACHED_BLOCKS;
+
+        struct thread_cache;
+
+        // Every block starts with a header recording the cache it was
+        // allocated from and its size class. Large blocks have no owner.
+        struct alignas(std::max_align_t) block_header
+        {
+            thread_cache* owner;
+            std::size_t size_class;
+        };
+
+        // Idle blocks are linked through the first word after their header.
+        struct free_block
+        {
+            block_header header;
+            free_block* next;
+        };
+
+        void increment(std::atomic<std::int64_t>& counter) noexcept
+        {
+            // the counters are only ever written by the owning thread
+            counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+        }
+
+        struct thread_cache
+        {
+            void push_local(free_block* b) noexcept
+            {
+                std::size_t const size_class = b->header.size_class;
+                if (num_free_[size_class] >= max_cached_blocks)
+                {
+                    ::operator delete(b);
+                    return;
+                }
+
+                b->next = free_lists_[size_class];
+                free_lists_[size_class] = b;
+                ++num_free_[size_class];
+            }
+
+            free_block* pop_local(std::size_t size_class) noexcept
+            {
+                free_block* b = free_lists_[size_class];
+                if (b != nullptr)
+                {
+                    free_lists_[size_class] = b->next;
+                    --num_free_[size_class];
+                }
+                return b;
+            }
+
+            void push_remote(free_block* b) noexcept
+            {
+                free_block* head = remote_free_.load(std::memory_order_relaxed);
+                do
+                {
+                    b->next = head;
+                } while (!remote_free_.compare_exchange_weak(head, b,
+                    std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            // Moves the blocks released by other threads to the free lists.
+            // Only the owning thread takes blocks off the remote list, and it
+            // takes all of them at once, so the list does not suffer from
+            // ABA.
+            void drain_remote() noexcept
+            {
+                free_block* b =
+                    remote_free_.exchange(nullptr, std::memory_order_acquire);
+                while (b != nullptr)
+                {
+                    free_block* next = b->next;
+                    push_local(b);
+                    b = next;
+                }
+            }
+
+            void release_local() noexcept
+            {
+                for (std::size_t i = 0; i != num_size_classes; ++i)
+                {
+                    while (free_block* b = pop_local(i))
+                    {
+                        ::operator delete(b);
+                    }
+                }
+            }
+
+            free_block* free_lists_[num_size_classes] = {};
+            std::size_t num_free_[num_size_classes] = {};
+
+            std::atomic<std::int64_t> allocations_{0};
+            std::atomic<std::int64_t> reused_blocks_{0};
+            std::atomic<std::int64_t> allocated_blocks_{0};
+            std::atomic<std::int64_t> large_allocations_{0};
+            std::atomic<std::int64_t> remote_deallocations_{0};
+
+            // written by other threads, keep it away from the fields above
+            alignas(threads::get_cache_line_size())
+                std::atomic<free_block*> remote_free_{nullptr};
+        };
+
+        // Caches are never deleted as blocks allocated from a cache may be
+        // released at any time. Caches of threads which have exited are
+        // handed to the next thread which needs a cache.
+        struct cache_registry
+        {
+            std::mutex mtx_;
+            std::vector<thread_cache*> caches_;
+            std::vector<thread_cache*> orphaned_caches_;
+        };
+
+        cache_registry& get_cache_registry()
+        {
+            // intentionally leaked, threads may release blocks during
+            // static destruction
+            static cache_registry* registry = new cache_registry;
+            return *registry;
+        }
+
+        thread_cache* acquire_cache()
+        {
+            cache_registry& registry = get_cache_registry();
+
+            std::lock_guard<std::mutex> l(registry.mtx_);
+            if (!registry.orphaned_caches_.empty())
+            {
+                thread_cache* cache = registry.orphaned_caches_.back();
+                registry.orphaned_caches_.pop_back();
+                return cache;
+            }
+
+            registry.caches_.push_back(new thread_cache);
+            return registry.caches_.back();
+        }
+
+        void orphan_cache(thread_cache* cache) noexcept
+        {
+            cache->release_local();
+
+            cache_registry& registry = get_cache_registry();
+
+            std::lock_guard<std::mutex> l(registry.mtx_);
+            registry.orphaned_caches_.push_back(cache);
+        }
+
+        thread_local thread_cache* local_cache = nullptr;
+        thread_local bool local_cache_released = false;
+
+        struct thread_cache_holder
+        {
+            ~thread_cache_holder()
+            {
+                if (cache_ != nullptr)
+                {
+                    local_cache = nullptr;
+                    local_cache_released = true;
+                    orphan_cache(cache_);
+                }
+            }
+
+            thread_cache* cache_ = nullptr;
+        };
+
+        thread_local thread_cache_holder local_cache_holder;
+
+        PIKA_NOINLINE thread_cache* init_local_cache()
+        {
+            // blocks allocated or released after the cache of this thread
+            // has been given up bypass the pool
+            if (local_cache_released)
+            {
+                return nullptr;
+            }
+
+            thread_cache* cache = acquire_cache();
+            local_cache_holder.cache_ = cache;
+            local_cache = cache;
+            return cache;
+        }
+
+        PIKA_FORCEINLINE thread_cache* get_local_cache()
+        {
+            thread_cache* cache = local_cache;
+            if (PIKA_LIKELY(cache != nullptr))
+            {
+                return cache;
+            }
+            return init_local_cache();
+        }
+
+        PIKA_FORCEINLINE void* get_payload(block_header* header) noexcept
+        {
+            return header + 1;
+        }
+
+        PIKA_FORCEINLINE block_header* get_header(void* p) noexcept
+        {
+            return static_cast<block_header*>(p) - 1;
+        }
+    }    // namespace
+
+    void* future_data_pool_allocate(std::size_t size)
+    {
+        std::size_t const total_size = size + sizeof(block_header);
+        std::size_t const size_class =
+            (total_size - 1) / size_class_granularity;
+
+        thread_cache* cache = get_local_cache();
+        if (PIKA_UNLIKELY(
+                size_class >= num_size_classes || cache == nullptr))
+        {
+            auto* header =
+                static_cast<block_header*>(::operator new(total_size));
+            header->owner = nullptr;
+            header->size_class = num_size_classes;
+            if (cache != nullptr)
+            {
+                increment(cache->large_allocations_);
+            }
+            return get_payload(header);
+        }
+
+        increment(cache->allocations_);
+
+        free_block* b = cache->pop_local(size_class);
+        if (b == nullptr)
+        {
+            cache->drain_remote();
+            b = cache->pop_local(size_class);
+        }
+
+        if (b != nullptr)
+        {
+            increment(cache->reused_blocks_);
+            return get_payload(&b->header);
+        }
+
+        increment(cache->allocated_blocks_);
+
+        auto* header = static_cast<block_header*>(
+            ::operator new((size_class + 1) * size_class_granularity));
+        header->owner = cache;
+        header->size_class = size_class;
+        return get_payload(header);
+    }
+
+    void future_data_pool_deallocate(void* p) noexcept
+    {
+        if (p == nullptr)
+        {
+            return;
+        }
+
+        block_header* header = get_header(p);
+        thread_cache* owner = header->owner;
+        if (owner == nullptr)
+        {
+            ::operator delete(header);
+            return;
+        }
+
+        auto* b = reinterpret_cast<free_block*>(header);
+        thread_cache* cache = get_local_cache();
+        if (owner == cache)
+        {
+            cache->push_local(b);
+            return;
+        }
+
+        owner->push_remote(b);
+        if (cache != nullptr)
+        {
+            increment(cache->remote_deallocations_);
+        }
+    }
+
+    future_data_pool_statistics get_future_data_pool_statistics()
+    {
+        cache_registry& registry = get_cache_registry();
+
+        future_data_pool_statistics stats;
+
+        std::lock_guard<std::mutex> l(registry.mtx_);
+        for (thread_cache const* cache : registry.caches_)
+        {
+            stats.allocations +=
+                cache->allocations_.load(std::memory_order_relaxed);
+            stats.reused_blocks +=
+                cache->reused_blocks_.load(std::memory_order_relaxed);
+            stats.allocated_blocks +=
+                cache->allocated_blocks_.load(std::memory_order_relaxed);
+            stats.large_allocations +=
+                cache->large_allocations_.load(std::memory_order_relaxed);
+            stats.remote_deallocations +=
+                cache->remote_deallocations_.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+}}}    // namespace pika::lcos::detail
@@ -0,0 +1,161 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/future.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
+#include <pika/init.hpp>
+#include <pika/testing.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using pika::lcos::detail::future_data_pool_allocate;
+using pika::lcos::detail::future_data_pool_deallocate;
+using pika::lcos::detail::get_future_data_pool_statistics;
+
+void test_allocate()
+{
+    // blocks of all size classes and large blocks are usable and aligned
+    std::vector<std::pair<char*, std::size_t>> blocks;
+    for (std::size_t size = 1; size <= 4096; size = size * 3 / 2 + 1)
+    {
+        auto* p = static_cast<char*>(future_data_pool_allocate(size));
+        PIKA_TEST_EQ(reinterpret_cast<std::uintptr_t>(p) %
+                alignof(std::max_align_t),
+            std::uintptr_t(0));
+        for (std::size_t i = 0; i != size; ++i)
+        {
+            p[i] = static_cast<char>(size);
+        }
+        blocks.emplace_back(p, size);
+    }
+
+    for (auto const& b : blocks)
+    {
+        for (std::size_t i = 0; i != b.second; ++i)
+        {
+            PIKA_TEST_EQ(b.first[i], static_cast<char>(b.second));
+        }
+        future_data_pool_deallocate(b.first);
+    }
+
+    future_data_pool_deallocate(nullptr);
+}
+
+void test_reuse()
+{
+#if defined(PIKA_HAVE_FUTURE_DATA_POOL)
+    auto const before = get_future_data_pool_statistics();
+
+    // the block released by this thread is handed out again
+    void* p = future_data_pool_allocate(100);
+    future_data_pool_deallocate(p);
+    void* q = future_data_pool_allocate(100);
+    PIKA_TEST_EQ(p, q);
+    future_data_pool_deallocate(q);
+
+    auto const after = get_future_data_pool_statistics();
+    PIKA_TEST_LTE(std::int64_t(2), after.allocations - before.allocations);
+    PIKA_TEST_LTE(std::int64_t(1), after.reused_blocks - before.reused_blocks);
+#endif
+}
+
+void test_remote_deallocate()
+{
+    constexpr std::size_t num_blocks = 1000;
+
+    auto const before = get_future_data_pool_statistics();
+
+    // blocks allocated by this thread are released by another one
+    std::vector<void*> blocks;
+    for (std::size_t i = 0; i != num_blocks; ++i)
+    {
+        blocks.push_back(future_data_pool_allocate(64 + i % 512));
+    }
+
+    std::thread t([&]() {
+        for (void* p : blocks)
+        {
+            future_data_pool_deallocate(p);
+        }
+    });
+    t.join();
+
+    // the released blocks are reused by the owning thread
+    for (std::size_t i = 0; i != num_blocks; ++i)
+    {
+        blocks[i] = future_data_pool_allocate(64 + i % 512);
+    }
+    for (void* p : blocks)
+    {
+        future_data_pool_deallocate(p);
+    }
+
+#if defined(PIKA_HAVE_FUTURE_DATA_POOL)
+    auto const after = get_future_data_pool_statistics();
+    PIKA_TEST_LTE(std::int64_t(num_blocks),
+        after.remote_deallocations - before.remote_deallocations);
+    PIKA_TEST_LTE(std::int64_t(num_blocks),
+        after.reused_blocks - before.reused_blocks);
+#else
+    PIKA_UNUSED(before);
+#endif
+}
+
+struct alignas(128) overaligned
+{
+    char data[128];
+};
+
+void test_futures()
+{
+    constexpr std::size_t num_futures = 10000;
+
+    // shared states are released on other worker threads
+    std::vector<pika::future<std::size_t>> futures;
+    for (std::size_t i = 0; i != num_futures; ++i)
+    {
+        futures.push_back(pika::async([i]() { return i; }).then(
+            [](pika::future<std::size_t>&& f) { return f.get() + 1; }));
+    }
+    for (std::size_t i = 0; i != num_futures; ++i)
+    {
+        PIKA_TEST_EQ(futures[i].get(), i + 1);
+    }
+
+    // over-aligned shared states bypass the pool and are still aligned
+    pika::shared_future<overaligned> f =
+        pika::async([]() { return overaligned{}; });
+    PIKA_TEST_EQ(reinterpret_cast<std::uintptr_t>(&f.get()) %
+            alignof(overaligned),
+        std::uintptr_t(0));
+
+    pika::lcos::local::promise<overaligned> p;
+    pika::shared_future<overaligned> pf = p.get_future();
+    p.set_value(overaligned{});
+    PIKA_TEST_EQ(reinterpret_cast<std::uintptr_t>(&pf.get()) %
+            alignof(overaligned),
+        std::uintptr_t(0));
+}
+
+int pika_main()
+{
+    test_allocate();
+    test_reuse();
+    test_remote_deallocate();
+    test_futures();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv), 0);
+    return pika::util::report_errors();
+}
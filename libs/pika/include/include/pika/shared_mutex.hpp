@@ -7,9 +7,11 @@
 #pragma once
 
 #include <pika/synchronization/lock_types.hpp>
+#include <pika/synchronization/reader_biased_shared_mutex.hpp>
 #include <pika/synchronization/shared_mutex.hpp>
 
 namespace pika {
+    using pika::lcos::local::reader_biased_shared_mutex;
     using pika::lcos::local::shared_mutex;
     using pika::lcos::local::upgrade_lock;
     using pika::lcos::local::upgrade_to_unique_lock;
@@ -10,6 +10,7 @@
 #include <pika/assert.hpp>
 #include <pika/command_line_handling/command_line_handling.hpp>
 #include <pika/coroutines/detail/context_impl.hpp>
+#include <pika/coroutines/detail/stack_pool.hpp>
 #include <pika/detail/filesystem.hpp>
 #include <pika/execution/detail/execution_parameter_callbacks.hpp>
 #include <pika/execution_base/detail/spinlock_deadlock_detection.hpp>
@@ -233,6 +234,19 @@ namespace pika {
             threads::coroutines::detail::posix::use_guard_pages =
                 cmdline.rtcfg_.use_stack_guard_pages();
 #endif
+            {
+                auto& stacks = threads::coroutines::detail::stack_pool::get();
+                stacks.set_max_cached_stacks(
+                    pika::util::get_entry_as<std::size_t>(cmdline.rtcfg_,
+                        "pika.stacks.max_cached",
+                        PIKA_STACK_POOL_MAX_CACHED_STACKS));
+                stacks.set_high_water_mark(
+                    pika::util::get_entry_as<std::size_t>(cmdline.rtcfg_,
+                        "pika.stacks.high_water_mark",
+                        PIKA_STACK_POOL_HIGH_WATER_MARK));
+                stacks.set_use_huge_pages(pika::util::get_entry_as<bool>(
+                    cmdline.rtcfg_, "pika.stacks.use_huge_pages", false));
+            }
 #ifdef PIKA_HAVE_VERIFY_LOCKS
             if (cmdline.rtcfg_.enable_lock_detection())
             {
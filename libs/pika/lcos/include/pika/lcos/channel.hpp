@@ -781,6 +781,10 @@ namespace pika { namespace lcos { namespace local {
 
     ///////////////////////////////////////////////////////////////////////////
     // channel with unlimited buffer
+    //
+    // Each value passes through a shared state of a future. See
+    // pika::lcos::local::unbounded_channel for a channel with an unlimited
+    // buffer which is accessed through senders instead.
     template <typename T>
     class channel : protected detail::channel_base<T>
     {
@@ -29,13 +29,19 @@
 //        delete t
 //
 //  def run_task(t):
-//    t.run() // call the task
-//    zero = nullptr
-//    if t.next.compare_exchange_strong(zero,t):
-//      pass
-//    else:
-//      run_task(zero)
-//      delete t
+//    while t != nullptr:
+//      t.run() // call the task
+//      zero = nullptr
+//      if t.next.compare_exchange_strong(zero,t):
+//        t = nullptr
+//      else:
+//        delete t
+//        t = zero
+//
+// The queued tasks are run in a loop rather than recursively, such that long
+// chains of tasks queued on a guard can't exhaust the stack. The guard_task
+// objects are recycled through a cache per thread, so that running a task on
+// an uncontended guard does not allocate.
 //
 // Consider cases. Thread A, B, and C on guard g.
 // Case 1:
@@ -82,13 +88,19 @@
 
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
+#include <pika/errors/try_catch_exception_ptr.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
 #include <pika/functional/deferred_call.hpp>
 #include <pika/functional/unique_function.hpp>
 #include <pika/futures/packaged_task.hpp>
 
 #include <atomic>
 #include <cstddef>
+#include <exception>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -182,7 +194,10 @@ namespace pika { namespace lcos { namespace local {
     };
 
     /// Conceptually, a guard acts like a mutex on an asynchronous task. The
-    /// mutex is locked before the task runs, and unlocked afterwards.
+    /// mutex is locked before the task runs, and unlocked afterwards. If the
+    /// task is run before run_guarded returns, an exception thrown by it is
+    /// propagated to the caller. Exceptions thrown by tasks run later on behalf
+    /// of other callers are ignored.
     PIKA_EXPORT void run_guarded(guard& guard, detail::guard_function task);
 
     template <typename F, typename... Args>
@@ -205,4 +220,116 @@ namespace pika { namespace lcos { namespace local {
             detail::guard_function(util::deferred_call(
                 PIKA_FORWARD(F, f), PIKA_FORWARD(Args, args)...)));
     }
+
+    namespace detail {
+        // Sender returned by async_run_guarded. The function is run with the
+        // guards held, and the receiver is completed before the guards are
+        // released.
+        template <typename Guard, typename F>
+        struct run_guarded_sender
+        {
+            Guard* guard;
+            std::decay_t<F> f;
+
+            using result_type = std::invoke_result_t<std::decay_t<F>>;
+
+            template <template <typename...> class Tuple,
+                template <typename...> class Variant>
+            using value_types = Variant<std::conditional_t<
+                std::is_void_v<result_type>, Tuple<>, Tuple<result_type>>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<std::exception_ptr>;
+
+            static constexpr bool sends_done = false;
+
+            template <typename Receiver>
+            struct operation_state
+            {
+                Guard* guard;
+                std::decay_t<F> f;
+                std::decay_t<Receiver> receiver;
+
+                void run() noexcept
+                {
+                    pika::detail::try_catch_exception_ptr(
+                        [&]() {
+                            if constexpr (std::is_void_v<result_type>)
+                            {
+                                PIKA_MOVE(f)();
+                                pika::execution::experimental::set_value(
+                                    PIKA_MOVE(receiver));
+                            }
+                            else
+                            {
+                                auto&& result = PIKA_MOVE(f)();
+                                pika::execution::experimental::set_value(
+                                    PIKA_MOVE(receiver), PIKA_MOVE(result));
+                            }
+                        },
+                        [&](std::exception_ptr ep) {
+                            pika::execution::experimental::set_error(
+                                PIKA_MOVE(receiver), PIKA_MOVE(ep));
+                        });
+                }
+
+                // The function is run inline if the guards are free, otherwise
+                // it is run by the task which releases the last of the guards.
+                // run_guarded only rethrows exceptions of the function passed
+                // to it, which reports its own errors, so anything caught here
+                // was thrown before the function was queued (e.g. when
+                // allocating the task) and the receiver is still waiting.
+                friend void tag_invoke(pika::execution::experimental::start_t,
+                    operation_state& os) noexcept
+                {
+                    pika::detail::try_catch_exception_ptr(
+                        [&]() {
+                            lcos::local::run_guarded(*os.guard,
+                                guard_function([&os]() { os.run(); }));
+                        },
+                        [&](std::exception_ptr ep) {
+                            pika::execution::experimental::set_error(
+                                PIKA_MOVE(os.receiver), PIKA_MOVE(ep));
+                        });
+                }
+            };
+
+            template <typename Receiver>
+            friend operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t,
+                run_guarded_sender&& s, Receiver&& receiver)
+            {
+                return {s.guard, PIKA_MOVE(s.f),
+                    PIKA_FORWARD(Receiver, receiver)};
+            }
+        };
+    }    // namespace detail
+
+    /// Returns a sender which runs f(args...) with the guard held once it has
+    /// been started and sends the result of the call. The guard is released
+    /// after the receiver has been completed, and it has to stay alive until
+    /// then.
+    template <typename F, typename... Args>
+    auto async_run_guarded(guard& guard, F&& f, Args&&... args)
+    {
+        using deferred_type = decltype(util::deferred_call(
+            PIKA_FORWARD(F, f), PIKA_FORWARD(Args, args)...));
+        return detail::run_guarded_sender<lcos::local::guard, deferred_type>{
+            &guard,
+            util::deferred_call(
+                PIKA_FORWARD(F, f), PIKA_FORWARD(Args, args)...)};
+    }
+
+    /// Returns a sender which runs f(args...) with all guards of the guard_set
+    /// held once it has been started and sends the result of the call. The
+    /// guards are released after the receiver has been completed.
+    template <typename F, typename... Args>
+    auto async_run_guarded(guard_set& guards, F&& f, Args&&... args)
+    {
+        using deferred_type = decltype(util::deferred_call(
+            PIKA_FORWARD(F, f), PIKA_FORWARD(Args, args)...));
+        return detail::run_guarded_sender<guard_set, deferred_type>{&guards,
+            util::deferred_call(
+                PIKA_FORWARD(F, f), PIKA_FORWARD(Args, args)...)};
+    }
 }}}    // namespace pika::lcos::local
@@ -9,12 +9,17 @@
 
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
+#include <pika/futures/detail/future_data.hpp>
+#include <pika/futures/traits/future_access.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/modules/futures.hpp>
+#include <pika/modules/memory.hpp>
 #include <pika/synchronization/no_mutex.hpp>
 #include <pika/synchronization/spinlock.hpp>
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <map>
 #include <memory>
@@ -22,6 +27,463 @@
 #include <utility>
 
 namespace pika { namespace lcos { namespace local {
+    namespace detail {
+        ///////////////////////////////////////////////////////////////////////
+        // Storage of a receive_buffer for the generations which fall into a
+        // fixed window. Generation n uses slot n % window. Receiving and
+        // storing a generation which finds its slot available does not take
+        // any lock: the side which arrives first publishes a shared state in
+        // the slot, the side which arrives second takes it out again and
+        // frees the slot for the next generation.
+        //
+        // A generation whose slot is still in use by an earlier generation
+        // is redirected to the fallback of the receive_buffer. This is
+        // recorded in the slot so that the other side of the same
+        // generation is redirected as well. The other side of a cancelled
+        // generation is redirected to the fallback, too.
+        template <typename T>
+        class receive_buffer_ring
+        {
+            using shared_state_type = lcos::detail::future_data<T>;
+            using init_no_addref = typename shared_state_type::init_no_addref;
+            using future_access = pika::traits::future_access<pika::future<T>>;
+
+            // The word of a slot holds the generation which owns the slot,
+            // whether one or both sides of that generation have entered the
+            // slot and the number of following generations of the same slot
+            // which have been redirected to the fallback. A number of
+            // skip_mask redirects all following generations, the slot is not
+            // used anymore.
+            static constexpr std::uint64_t skip_bits = 16;
+            static constexpr std::uint64_t skip_mask =
+                (std::uint64_t(1) << skip_bits) - 1;
+            static constexpr std::uint64_t busy = std::uint64_t(1)
+                << skip_bits;
+            static constexpr std::uint64_t paired = busy << 1;
+            static constexpr std::uint64_t generation_shift = skip_bits + 2;
+
+            // Shared states published by the storing side are tagged in the
+            // lowest bit. A cancelled shared state is replaced by a marker
+            // for the other side of the generation if it has entered the
+            // slot already.
+            static constexpr std::uintptr_t stored_tag = 1;
+            static constexpr std::uintptr_t cancelled = 2;
+
+            struct slot
+            {
+                std::atomic<std::uint64_t> word_;
+                std::atomic<std::uintptr_t> state_;
+            };
+
+        public:
+            enum class lookup_result
+            {
+                found,
+                not_found,
+                fallback
+            };
+
+            receive_buffer_ring() = default;
+
+            explicit receive_buffer_ring(std::size_t window)
+              : window_(window)
+              , slots_(window != 0 ? new slot[window] : nullptr)
+            {
+                for (std::size_t i = 0; i != window_; ++i)
+                {
+                    slots_[i].word_.store(
+                        std::uint64_t(i) << generation_shift,
+                        std::memory_order_relaxed);
+                    slots_[i].state_.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            receive_buffer_ring(receive_buffer_ring&& other) noexcept
+              : window_(std::exchange(other.window_, 0))
+              , slots_(PIKA_MOVE(other.slots_))
+            {
+            }
+
+            receive_buffer_ring& operator=(receive_buffer_ring&& other) noexcept
+            {
+                window_ = std::exchange(other.window_, 0);
+                slots_ = PIKA_MOVE(other.slots_);
+                return *this;
+            }
+
+            std::size_t window() const noexcept
+            {
+                return window_;
+            }
+
+            // Returns false if the generation has to be handled by the
+            // fallback.
+            bool receive(std::size_t step, pika::future<T>& f)
+            {
+                if (window_ == 0)
+                {
+                    return false;
+                }
+
+                slot& s = slots_[step % window_];
+                if (!enter(s, step))
+                {
+                    return false;
+                }
+
+                pika::intrusive_ptr<shared_state_type> p;
+                std::uintptr_t state = s.state_.load(std::memory_order_acquire);
+                for (;;)
+                {
+                    if (state == cancelled)
+                    {
+                        return leave_cancelled(s);
+                    }
+
+                    if (state != 0)
+                    {
+                        // the value has been stored already, take the shared
+                        // state out of the slot
+                        PIKA_ASSERT((state & stored_tag) != 0);
+                        if (s.state_.compare_exchange_weak(state, 0,
+                                std::memory_order_acquire,
+                                std::memory_order_acquire))
+                        {
+                            leave(s);
+                            f = future_access::create(
+                                get_shared_state(state), false);
+                            return true;
+                        }
+                        continue;
+                    }
+
+                    if (!p)
+                    {
+                        p.reset(new shared_state_type(init_no_addref{}), false);
+                    }
+
+                    // publish a shared state for the storing side, the slot
+                    // holds a reference of its own
+                    intrusive_ptr_add_ref(p.get());
+                    if (s.state_.compare_exchange_strong(state,
+                            reinterpret_cast<std::uintptr_t>(p.get()),
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        f = future_access::create(PIKA_MOVE(p));
+                        return true;
+                    }
+                    intrusive_ptr_release(p.get());
+                }
+            }
+
+            lookup_result try_receive(std::size_t step, pika::future<T>* f)
+            {
+                if (window_ == 0)
+                {
+                    return lookup_result::fallback;
+                }
+
+                slot& s = slots_[step % window_];
+                std::uint64_t const word =
+                    s.word_.load(std::memory_order_acquire);
+                std::uint64_t const generation = word >> generation_shift;
+                if (step != generation || (word & busy) == 0)
+                {
+                    // the generation can only be found in the fallback if it
+                    // has been redirected
+                    return redirected(word, step) ? lookup_result::fallback :
+                                                    lookup_result::not_found;
+                }
+
+                std::uintptr_t state = s.state_.load(std::memory_order_acquire);
+                if (state == 0 || state == cancelled)
+                {
+                    return lookup_result::not_found;
+                }
+
+                if ((state & stored_tag) == 0)
+                {
+                    if (f != nullptr)
+                    {
+                        PIKA_THROW_EXCEPTION(future_already_retrieved,
+                            "receive_buffer::try_receive",
+                            "the future has already been retrieved for this "
+                            "generation");
+                    }
+                    return lookup_result::found;
+                }
+
+                if (f != nullptr)
+                {
+                    if (!s.state_.compare_exchange_strong(state, 0,
+                            std::memory_order_acquire,
+                            std::memory_order_relaxed))
+                    {
+                        return lookup_result::not_found;
+                    }
+                    leave(s);
+                    *f = future_access::create(get_shared_state(state), false);
+                }
+                return lookup_result::found;
+            }
+
+            // Returns false if the generation has to be handled by the
+            // fallback.
+            template <typename Lock, typename... Ts>
+            bool store(std::size_t step, Lock* lock, Ts&&... ts)
+            {
+                if (window_ == 0)
+                {
+                    return false;
+                }
+
+                slot& s = slots_[step % window_];
+                if (!enter(s, step))
+                {
+                    return false;
+                }
+
+                pika::intrusive_ptr<shared_state_type> p;
+                std::uintptr_t state = s.state_.load(std::memory_order_acquire);
+                for (;;)
+                {
+                    if (state == cancelled)
+                    {
+                        return leave_cancelled(s);
+                    }
+
+                    if (state != 0)
+                    {
+                        // the receiving side is waiting already, take its
+                        // shared state out of the slot
+                        PIKA_ASSERT((state & stored_tag) == 0);
+                        if (s.state_.compare_exchange_weak(state, 0,
+                                std::memory_order_acquire,
+                                std::memory_order_acquire))
+                        {
+                            leave(s);
+                            p.reset(get_shared_state(state), false);
+                            break;
+                        }
+                        continue;
+                    }
+
+                    if (!p)
+                    {
+                        p.reset(new shared_state_type(init_no_addref{}), false);
+                    }
+
+                    // publish a shared state for the receiving side, the
+                    // slot holds a reference of its own
+                    intrusive_ptr_add_ref(p.get());
+                    if (s.state_.compare_exchange_strong(state,
+                            reinterpret_cast<std::uintptr_t>(p.get()) |
+                                stored_tag,
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        break;
+                    }
+                    intrusive_ptr_release(p.get());
+                }
+
+                if (lock)
+                    lock->unlock();
+
+                // set the value only after the lock went out of scope
+                p->set_value(PIKA_FORWARD(Ts, ts)...);
+                return true;
+            }
+
+            bool empty() const noexcept
+            {
+                for (std::size_t i = 0; i != window_; ++i)
+                {
+                    if (slots_[i].state_.load(std::memory_order_acquire) != 0)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // return the number of deleted slot entries
+            std::size_t cancel_waiting(
+                std::exception_ptr const& e, bool force_delete_entries)
+            {
+                std::size_t count = 0;
+                for (std::size_t i = 0; i != window_; ++i)
+                {
+                    slot& sl = slots_[i];
+                    std::atomic<std::uintptr_t>& s = sl.state_;
+                    std::uintptr_t state = s.load(std::memory_order_acquire);
+                    if (state == 0 || state == cancelled ||
+                        ((state & stored_tag) != 0 && !force_delete_entries))
+                    {
+                        continue;
+                    }
+
+                    // The slot stays with the generation as long as it holds
+                    // a shared state or the marker
+                    if (s.compare_exchange_strong(state, cancelled,
+                            std::memory_order_acquire,
+                            std::memory_order_relaxed))
+                    {
+                        // If the other side of the cancelled generation has
+                        // not entered the slot yet, take its place and hand
+                        // the slot to the next generation, the other side is
+                        // redirected to the fallback. Otherwise the other
+                        // side finds the marker and hands the slot on.
+                        std::uint64_t word =
+                            sl.word_.load(std::memory_order_relaxed);
+                        while ((word & paired) == 0)
+                        {
+                            PIKA_ASSERT((word & busy) != 0);
+                            if (sl.word_.compare_exchange_weak(word,
+                                    word | paired, std::memory_order_relaxed,
+                                    std::memory_order_relaxed))
+                            {
+                                s.store(0, std::memory_order_relaxed);
+                                leave(sl);
+                                break;
+                            }
+                        }
+
+                        pika::intrusive_ptr<shared_state_type> p(
+                            get_shared_state(state), false);
+                        if ((state & stored_tag) == 0)
+                        {
+                            p->set_exception(e);
+                        }
+                        ++count;
+                    }
+                }
+                return count;
+            }
+
+        private:
+            static shared_state_type* get_shared_state(
+                std::uintptr_t state) noexcept
+            {
+                return reinterpret_cast<shared_state_type*>(
+                    state & ~stored_tag);
+            }
+
+            // Returns whether the generation has been redirected to the
+            // fallback (or is older than the generation owning the slot).
+            bool redirected(std::uint64_t word, std::uint64_t step) const
+                noexcept
+            {
+                std::uint64_t const generation = word >> generation_shift;
+                std::uint64_t const skip = word & skip_mask;
+                return step < generation ||
+                    (step > generation &&
+                        (skip == skip_mask ||
+                            (step - generation) / window_ <= skip));
+            }
+
+            // Returns true if the generation can use its slot. A slot which
+            // is not in use is handed to any later generation right away,
+            // the generations in between are redirected to the fallback
+            // should they ever arrive.
+            bool enter(slot& s, std::uint64_t step)
+            {
+                std::uint64_t word = s.word_.load(std::memory_order_acquire);
+                for (;;)
+                {
+                    std::uint64_t const generation = word >> generation_shift;
+                    if (step == generation)
+                    {
+                        // Both sides have entered already if the generation
+                        // has been cancelled before this side arrived
+                        if ((word & paired) != 0)
+                        {
+                            return false;
+                        }
+
+                        std::uint64_t const new_word =
+                            word | ((word & busy) != 0 ? paired : busy);
+                        if (s.word_.compare_exchange_weak(word, new_word,
+                                std::memory_order_acq_rel,
+                                std::memory_order_acquire))
+                        {
+                            return true;
+                        }
+                        continue;
+                    }
+
+                    if (redirected(word, step))
+                    {
+                        return false;
+                    }
+
+                    std::uint64_t new_word = 0;
+                    if ((word & busy) == 0)
+                    {
+                        new_word = (step << generation_shift) | busy;
+                    }
+                    else
+                    {
+                        // the slot is still used by an earlier generation,
+                        // generations too far ahead to be counted retire the
+                        // slot
+                        std::uint64_t const distance =
+                            (step - generation) / window_;
+                        new_word = (word & ~skip_mask) |
+                            (distance < skip_mask ? distance : skip_mask);
+                    }
+
+                    if (s.word_.compare_exchange_weak(word, new_word,
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        return (new_word & skip_mask) == 0;
+                    }
+                }
+            }
+
+            // Called by the side which arrives second, hands the slot to the
+            // next generation which has not been redirected. A retired slot
+            // keeps redirecting all generations.
+            void leave(slot& s) noexcept
+            {
+                std::uint64_t word = s.word_.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    std::uint64_t new_word = word & ~(busy | paired);
+                    if ((word & skip_mask) != skip_mask)
+                    {
+                        std::uint64_t const generation =
+                            word >> generation_shift;
+                        new_word = (generation +
+                                       ((word & skip_mask) + 1) * window_)
+                            << generation_shift;
+                    }
+                    if (s.word_.compare_exchange_weak(word, new_word,
+                            std::memory_order_release,
+                            std::memory_order_relaxed))
+                    {
+                        return;
+                    }
+                }
+            }
+
+            // Called by the side which arrives second and finds its
+            // generation cancelled. It removes the marker, hands the slot to
+            // the next generation and is redirected to the fallback, as if it
+            // had arrived after the cancellation.
+            bool leave_cancelled(slot& s) noexcept
+            {
+                s.state_.store(0, std::memory_order_relaxed);
+                leave(s);
+                return false;
+            }
+
+            std::size_t window_ = 0;
+            std::unique_ptr<slot[]> slots_;
+        };
+    }    // namespace detail
     ///////////////////////////////////////////////////////////////////////////
     template <typename T, typename Mutex = lcos::local::spinlock>
     struct receive_buffer
@@ -29,6 +491,7 @@ namespace pika { namespace lcos { namespace local {
     protected:
         using mutex_type = Mutex;
         using buffer_promise_type = pika::lcos::local::promise<T>;
+        using ring_type = detail::receive_buffer_ring<T>;
 
         struct entry_data
         {
@@ -94,15 +557,25 @@ namespace pika { namespace lcos { namespace local {
     public:
         receive_buffer() = default;
 
+        // Generations are kept in a ring buffer of the given number of slots
+        // as long as the generations in use fall into a window of that size.
+        // Storing and receiving such generations does not take the lock.
+        // Generations further ahead fall back to the map.
+        explicit receive_buffer(std::size_t window)
+          : ring_(window)
+        {
+        }
+
         receive_buffer(receive_buffer&& other) noexcept
           : mtx_()
           , buffer_map_(PIKA_MOVE(other.buffer_map_))
+          , ring_(PIKA_MOVE(other.ring_))
         {
         }
 
         ~receive_buffer()
         {
-            PIKA_ASSERT(buffer_map_.empty());
+            PIKA_ASSERT(empty());
         }
 
         receive_buffer& operator=(receive_buffer&& other) noexcept
@@ -111,12 +584,19 @@ namespace pika { namespace lcos { namespace local {
             {
                 mtx_ = mutex_type();
                 buffer_map_ = PIKA_MOVE(other.buffer_map_);
+                ring_ = PIKA_MOVE(other.ring_);
             }
             return *this;
         }
 
         pika::future<T> receive(std::size_t step)
         {
+            pika::future<T> f;
+            if (ring_.receive(step, f))
+            {
+                return f;
+            }
+
             std::lock_guard<mutex_type> l(mtx_);
 
             iterator it = get_buffer_entry(step);
@@ -137,6 +617,13 @@ namespace pika { namespace lcos { namespace local {
 
         bool try_receive(std::size_t step, pika::future<T>* f = nullptr)
         {
+            using lookup_result = typename ring_type::lookup_result;
+            lookup_result const r = ring_.try_receive(step, f);
+            if (r != lookup_result::fallback)
+            {
+                return r == lookup_result::found;
+            }
+
             std::lock_guard<mutex_type> l(mtx_);
 
             iterator it = buffer_map_.find(step);
@@ -167,6 +654,11 @@ namespace pika { namespace lcos { namespace local {
         template <typename Lock = pika::lcos::local::no_mutex>
         void store_received(std::size_t step, T&& val, Lock* lock = nullptr)
         {
+            if (ring_.store(step, lock, PIKA_MOVE(val)))
+            {
+                return;
+            }
+
             std::shared_ptr<entry_data> entry;
 
             {
@@ -200,16 +692,17 @@ namespace pika { namespace lcos { namespace local {
 
         bool empty() const
         {
-            return buffer_map_.empty();
+            return buffer_map_.empty() && ring_.empty();
         }
 
         // return the number of deleted buffer entries
         std::size_t cancel_waiting(
             std::exception_ptr const& e, bool force_delete_entries = false)
         {
+            std::size_t count = ring_.cancel_waiting(e, force_delete_entries);
+
             std::lock_guard<mutex_type> l(mtx_);
 
-            std::size_t count = 0;
             iterator end = buffer_map_.end();
             for (iterator it = buffer_map_.begin(); it != end; /**/)
             {
@@ -245,6 +738,7 @@ namespace pika { namespace lcos { namespace local {
     private:
         mutable mutex_type mtx_;
         buffer_map_type buffer_map_;
+        ring_type ring_;
     };
 
     ///////////////////////////////////////////////////////////////////////////
@@ -254,6 +748,7 @@ namespace pika { namespace lcos { namespace local {
     protected:
         using mutex_type = Mutex;
         using buffer_promise_type = pika::lcos::local::promise<void>;
+        using ring_type = detail::receive_buffer_ring<void>;
 
         struct entry_data
         {
@@ -318,14 +813,20 @@ namespace pika { namespace lcos { namespace local {
     public:
         receive_buffer() {}
 
+        explicit receive_buffer(std::size_t window)
+          : ring_(window)
+        {
+        }
+
         receive_buffer(receive_buffer&& other)
           : buffer_map_(PIKA_MOVE(other.buffer_map_))
+          , ring_(PIKA_MOVE(other.ring_))
         {
         }
 
         ~receive_buffer()
         {
-            PIKA_ASSERT(buffer_map_.empty());
+            PIKA_ASSERT(empty());
         }
 
         receive_buffer& operator=(receive_buffer&& other)
@@ -333,12 +834,19 @@ namespace pika { namespace lcos { namespace local {
             if (this != &other)
             {
                 buffer_map_ = PIKA_MOVE(other.buffer_map_);
+                ring_ = PIKA_MOVE(other.ring_);
             }
             return *this;
         }
 
         pika::future<void> receive(std::size_t step)
         {
+            pika::future<void> f;
+            if (ring_.receive(step, f))
+            {
+                return f;
+            }
+
             std::lock_guard<mutex_type> l(mtx_);
 
             iterator it = get_buffer_entry(step);
@@ -359,6 +867,13 @@ namespace pika { namespace lcos { namespace local {
 
         bool try_receive(std::size_t step, pika::future<void>* f = nullptr)
         {
+            using lookup_result = typename ring_type::lookup_result;
+            lookup_result const r = ring_.try_receive(step, f);
+            if (r != lookup_result::fallback)
+            {
+                return r == lookup_result::found;
+            }
+
             std::lock_guard<mutex_type> l(mtx_);
 
             iterator it = buffer_map_.find(step);
@@ -389,6 +904,11 @@ namespace pika { namespace lcos { namespace local {
         template <typename Lock = pika::lcos::local::no_mutex>
         void store_received(std::size_t step, Lock* lock = nullptr)
         {
+            if (ring_.store(step, lock))
+            {
+                return;
+            }
+
             std::shared_ptr<entry_data> entry;
 
             {
@@ -422,16 +942,17 @@ namespace pika { namespace lcos { namespace local {
 
         bool empty() const
         {
-            return buffer_map_.empty();
+            return buffer_map_.empty() && ring_.empty();
         }
 
         // return the number of deleted buffer entries
         std::size_t cancel_waiting(
             std::exception_ptr const& e, bool force_delete_entries = false)
         {
+            std::size_t count = ring_.cancel_waiting(e, force_delete_entries);
+
             std::lock_guard<mutex_type> l(mtx_);
 
-            std::size_t count = 0;
             iterator end = buffer_map_.end();
             for (iterator it = buffer_map_.begin(); it != end; /**/)
             {
@@ -467,5 +988,6 @@ namespace pika { namespace lcos { namespace local {
     private:
         mutable mutex_type mtx_;
         buffer_map_type buffer_map_;
+        ring_type ring_;
     };
 }}}    // namespace pika::lcos::local
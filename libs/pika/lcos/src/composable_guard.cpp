@@ -6,163 +6,295 @@
 
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
-#include <pika/functional/bind_front.hpp>
-#include <pika/functional/function.hpp>
+#include <pika/datastructures/detail/small_vector.hpp>
 
 #include <pika/lcos/composable_guard.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <exception>
 #include <memory>
 #include <utility>
 #include <vector>
 
 namespace pika { namespace lcos { namespace local {
-    static void run_composable(detail::guard_task* task);
-
-    static void nothing() {}
-
     namespace detail {
-        // A link in the list of tasks attached
-        // to a guard
+        struct stage_data;
+
+        // A link in the list of tasks attached to a guard. A task which is
+        // part of a guard set (single_guard is false) acquires one guard of
+        // the set, the function of the set is stored in the stage data shared
+        // by all guards of the set.
+        //
+        // The next field is empty while the task is queued or running. It is
+        // set to the task queued behind this one, or to the task itself once
+        // the task has finished.
         struct guard_task : detail::debug_object
         {
-            guard_atomic next;
+            guard_atomic next{nullptr};
             detail::guard_function run;
-            bool const single_guard;
+            stage_data* stage = nullptr;
+            std::size_t stage_index = 0;
+            bool single_guard = true;
+        };
+
+        // Marks the last task of a destructed guard
+        static guard_task empty;
+
+        struct stage_data : detail::debug_object
+        {
+            stage_data(detail::guard_function task_,
+                std::vector<std::shared_ptr<guard>> const& guards_);
+
+            pika::detail::small_vector<std::shared_ptr<guard>, 4> guards;
+            detail::guard_function task;
+            pika::detail::small_vector<guard_task*, 4> stages;
+        };
+
+        ///////////////////////////////////////////////////////////////////////
+        // Guard tasks are recycled through a cache per thread. A task is put
+        // into the cache of the thread which releases it, which is not
+        // necessarily the thread which took it from its cache.
+        constexpr std::size_t max_cached_guard_tasks = 1024;
+
+        struct guard_task_cache
+        {
+            guard_task_cache() = default;
+            guard_task_cache(guard_task_cache const&) = delete;
+            guard_task_cache& operator=(guard_task_cache const&) = delete;
+
+            ~guard_task_cache();
+
+            guard_task* head = nullptr;
+            std::size_t size = 0;
+        };
+
+        // Tasks released during thread exit after the cache has been
+        // destructed are deleted right away.
+        static thread_local bool guard_task_cache_released = false;
+        static thread_local guard_task_cache guard_task_cache_;
 
-            guard_task()
-              : next(nullptr)
-              , run(nothing)
-              , single_guard(true)
+        guard_task_cache::~guard_task_cache()
+        {
+            guard_task_cache_released = true;
+            while (head != nullptr)
             {
+                guard_task* next = head->next.load(std::memory_order_relaxed);
+                delete head;
+                head = next;
             }
-            guard_task(bool sg)
-              : next(nullptr)
-              , run(nothing)
-              , single_guard(sg)
+        }
+
+        static guard_task* allocate_guard_task()
+        {
+            if (!guard_task_cache_released)
             {
+                guard_task_cache& cache = guard_task_cache_;
+                guard_task* task = cache.head;
+                if (task != nullptr)
+                {
+                    cache.head = task->next.load(std::memory_order_relaxed);
+                    --cache.size;
+                    task->next.store(nullptr, std::memory_order_relaxed);
+                    task->single_guard = true;
+                    return task;
+                }
             }
-        };
+            return new guard_task;
+        }
 
         void free(guard_task* task)
         {
             if (task == nullptr)
                 return;
             task->check_();
-            delete task;
-        }
-    }    // namespace detail
 
-    void guard_set::sort()
-    {
-        if (!sorted)
-        {
-            std::sort(guards.begin(), guards.end());
-            (*guards.begin())->check_();
-            sorted = true;
+            task->run.reset();
+            task->stage = nullptr;
+
+            if (!guard_task_cache_released)
+            {
+                guard_task_cache& cache = guard_task_cache_;
+                if (cache.size != max_cached_guard_tasks)
+                {
+                    task->next.store(cache.head, std::memory_order_relaxed);
+                    cache.head = task;
+                    ++cache.size;
+                    return;
+                }
+            }
+            delete task;
         }
-    }
 
-    struct stage_data : public detail::debug_object
-    {
-        guard_set gs;
-        detail::guard_function task;
-        std::size_t n;
-        detail::guard_task** stages;
-
-        stage_data(detail::guard_function task_,
-            std::vector<std::shared_ptr<guard>>& guards)
-          : gs()
+        stage_data::stage_data(detail::guard_function task_,
+            std::vector<std::shared_ptr<guard>> const& guards_)
+          : guards(guards_.begin(), guards_.end())
           , task(PIKA_MOVE(task_))
-          , n(guards.size())
-          , stages(new detail::guard_task*[n])
         {
+            std::size_t const n = guards.size();
+            stages.reserve(n);
             for (std::size_t i = 0; i < n; i++)
             {
-                stages[i] = new detail::guard_task(false);
+                guard_task* stage = allocate_guard_task();
+                stage->single_guard = false;
+                stage->stage = this;
+                stage->stage_index = i;
+                stages.push_back(stage);
             }
         }
 
-        ~stage_data()
+        ///////////////////////////////////////////////////////////////////////
+        // Appends the task to the tasks of the guard. Returns true if the task
+        // holds the guard right away, in which case the caller has to run it.
+        static bool enqueue(guard& g, guard_task* task) noexcept
         {
-            if (stages == nullptr)
-                abort();
-            PIKA_ASSERT(n == gs.size());
-            delete[] stages;
-            stages = nullptr;
-        }
-    };
+            PIKA_ASSERT(task != nullptr);
+            task->check_();
+
+            guard_task* prev = g.task.exchange(task, std::memory_order_acq_rel);
+            if (prev == nullptr)
+            {
+                return true;
+            }
 
-    static void run_guarded(guard& g, detail::guard_task* task)
-    {
-        PIKA_ASSERT(task != nullptr);
-        task->check_();
-        detail::guard_task* prev = g.task.exchange(task);
-        if (prev != nullptr)
-        {
             prev->check_();
-            detail::guard_task* zero = nullptr;
-            if (!prev->next.compare_exchange_strong(zero, task))
+
+            // A finished task is not touched by its runner anymore, there's
+            // no need to link the task to it.
+            guard_task* next = prev->next.load(std::memory_order_acquire);
+            if (next == nullptr &&
+                prev->next.compare_exchange_strong(next, task,
+                    std::memory_order_acq_rel, std::memory_order_acquire))
             {
-                run_composable(task);
-                free(prev);
+                // the runner of prev will run the task
+                return false;
             }
+
+            PIKA_ASSERT(next == prev);
+            free(prev);
+            return true;
         }
-        else
-        {
-            run_composable(task);
-        }
-    }
 
-    struct stage_task_cleanup
-    {
-        stage_data* sd;
-        std::size_t n;
-        stage_task_cleanup(stage_data* sd_, std::size_t n_)
-          : sd(sd_)
-          , n(n_)
+        // Marks the task as finished. Returns the task queued behind it,
+        // which now holds the guard, or nullptr if there is none.
+        static guard_task* complete(guard_task* task) noexcept
         {
+            task->check_();
+
+            guard_task* next = nullptr;
+            if (task->next.compare_exchange_strong(next, task,
+                    std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                // The task stays attached to the guard until the next task
+                // is queued or the guard is destructed.
+                return nullptr;
+            }
+
+            PIKA_ASSERT(next != nullptr && next != task);
+            free(task);
+            return next == &empty ? nullptr : next;
         }
-        ~stage_task_cleanup()
+
+        // Runs the given task, which holds its guard, and all tasks which
+        // acquire their guard while doing so. The tasks are kept on a
+        // worklist instead of being run recursively, so that long chains of
+        // queued tasks do not exhaust the stack. If functions throw, the
+        // remaining tasks are still run. Only the exception of the function
+        // passed to run_guarded by the caller is rethrown at the end. The
+        // other functions are run on behalf of callers which have already
+        // returned, their exceptions are ignored.
+        static void run_composable(guard_task* task)
         {
-            detail::guard_task* zero = nullptr;
-            // The tasks on the other guards had single_task marked,
-            // so they haven't had their next field set yet. Setting
-            // the next field is necessary if they are going to
-            // continue processing.
-            for (std::size_t k = 0; k < n; k++)
+            pika::detail::small_vector<guard_task*, 8> worklist;
+            worklist.push_back(task);
+
+            // A stage data is alive until its function has been run, and the
+            // task of a single guard is the first one to be run, so neither
+            // can be mistaken for a later allocation at the same address.
+            guard_task* own_task = task->single_guard ? task : nullptr;
+            stage_data* own_stage = task->single_guard ? nullptr : task->stage;
+
+            std::exception_ptr exception;
+            auto run = [&exception](detail::guard_function& f, bool own) {
+                try
+                {
+                    f();
+                }
+                catch (...)
+                {
+                    if (own)
+                    {
+                        exception = std::current_exception();
+                    }
+                }
+            };
+
+            while (!worklist.empty())
             {
-                detail::guard_task* lt = sd->stages[k];
-                lt->check_();
-                PIKA_ASSERT(!lt->single_guard);
-                zero = nullptr;
-                if (!lt->next.compare_exchange_strong(zero, lt))
+                task = worklist.back();
+                worklist.pop_back();
+                task->check_();
+
+                if (task->single_guard)
+                {
+                    bool const own = task == own_task;
+                    own_task = nullptr;
+                    run(task->run, own);
+                    if (guard_task* next = complete(task))
+                    {
+                        worklist.push_back(next);
+                    }
+                    continue;
+                }
+
+                // The task holds one guard of a guard set, acquire the next
+                // one. The guards are acquired in the order of the sorted set.
+                stage_data* sd = task->stage;
+                sd->check_();
+
+                std::size_t const k = task->stage_index + 1;
+                if (k != sd->stages.size())
+                {
+                    if (enqueue(*sd->guards[k], sd->stages[k]))
+                    {
+                        worklist.push_back(sd->stages[k]);
+                    }
+                    continue;
+                }
+
+                // All guards of the set are held, run the function and release
+                // the guards.
+                bool const own = sd == own_stage;
+                if (own)
                 {
-                    PIKA_ASSERT(zero != lt);
-                    run_composable(zero);
-                    free(lt);
+                    own_stage = nullptr;
                 }
+                run(sd->task, own);
+                for (guard_task* stage : sd->stages)
+                {
+                    if (guard_task* next = complete(stage))
+                    {
+                        worklist.push_back(next);
+                    }
+                }
+                delete sd;
+            }
+
+            if (exception)
+            {
+                std::rethrow_exception(PIKA_MOVE(exception));
             }
-            delete sd;
         }
-    };
+    }    // namespace detail
 
-    static void stage_task(stage_data* sd, std::size_t i, std::size_t n)
+    void guard_set::sort()
     {
-        // if this is the last task in the set...
-        if (i + 1 == n)
-        {
-            stage_task_cleanup stc(sd, n);
-            sd->task();
-        }
-        else
+        if (!sorted)
         {
-            std::size_t k = i + 1;
-            detail::guard_task* stage = sd->stages[k];
-            stage->run = util::bind_front(stage_task, sd, k, n);
-            PIKA_ASSERT(!stage->single_guard);
-            run_guarded(*sd->gs.get(k), stage);
+            std::sort(guards.begin(), guards.end());
+            (*guards.begin())->check_();
+            sorted = true;
         }
     }
 
@@ -181,103 +313,39 @@ namespace pika { namespace lcos { namespace local {
             return;
         }
         guards.sort();
-        stage_data* sd = new stage_data(PIKA_MOVE(task), guards.guards);
-        int k = 0;
-        sd->stages[k]->run = util::bind_front(stage_task, sd, k, n);
-        sd->gs = guards;
-        detail::guard_task* stage = sd->stages[k];    //-V108
-        run_guarded(*sd->gs.get(k), stage);           //-V106
-    }
 
-    void run_guarded(guard& guard, detail::guard_function task)
-    {
-        detail::guard_task* tptr = new detail::guard_task();
-        tptr->run = PIKA_MOVE(task);
-        run_guarded(guard, tptr);
-    }
-
-    // This class exists so that a destructor is
-    // used to perform cleanup. By using a destructor
-    // we ensure the code works even if exceptions are
-    // thrown.
-    struct run_composable_cleanup
-    {
-        detail::guard_task* task;
-        run_composable_cleanup(detail::guard_task* task_)
-          : task(task_)
+        // the stage data is deleted once the task has been run
+        auto* sd = new detail::stage_data(PIKA_MOVE(task), guards.guards);
+        detail::guard_task* stage = sd->stages[0];
+        if (detail::enqueue(*sd->guards[0], stage))
         {
+            detail::run_composable(stage);
         }
-        ~run_composable_cleanup()
-        {
-            detail::guard_task* zero = nullptr;
-            // If single_guard is false, then this is one of the
-            // setup tasks for a multi-guarded task. By not setting
-            // the next field, we halt processing on items queued
-            // to this guard.
-            PIKA_ASSERT(task != nullptr);
-            task->check_();
-            if (!task->next.compare_exchange_strong(zero, task))
-            {
-                PIKA_ASSERT(zero != nullptr);
-                run_composable(zero);
-                free(task);
-            }
-        }
-    };
-
-    namespace detail {
-        struct empty_helper
-        {
-            static guard_task*& get_empty_guard_task()
-            {
-                static guard_task* empty = new guard_task;
-                return empty;
-            }
-
-            empty_helper() = default;
-            ~empty_helper()
-            {
-                auto& empty = get_empty_guard_task();
-                delete empty;
-                empty = nullptr;
-            }
-        };
-
-        empty_helper empty_helper_{};
-    }    // namespace detail
-
-    using pika::lcos::local::detail::guard_task;
-    static guard_task empty;
+    }
 
-    static void run_composable(detail::guard_task* task)
+    void run_guarded(guard& guard, detail::guard_function task)
     {
-        if (task == &empty)
-            return;
-        PIKA_ASSERT(task != nullptr);
-        task->check_();
-        if (task->single_guard)
-        {
-            run_composable_cleanup rcc(task);
-            task->run();
-        }
-        else
+        detail::guard_task* tptr = detail::allocate_guard_task();
+        tptr->run = PIKA_MOVE(task);
+        if (detail::enqueue(guard, tptr))
         {
-            task->run();
-            // Note that by this point in the execution
-            // the task data structure has probably
-            // been deleted.
+            detail::run_composable(tptr);
         }
     }
 
     guard::~guard()
     {
-        guard_task* zero = nullptr;
-        guard_task* current = task.load();
+        detail::guard_task* current = task.load(std::memory_order_acquire);
         if (current == nullptr)
             return;
-        if (!current->next.compare_exchange_strong(zero, &empty))
+
+        // A task which is still running finds the empty marker when it
+        // finishes and releases itself.
+        detail::guard_task* next = nullptr;
+        if (!current->next.compare_exchange_strong(next, &detail::empty,
+                std::memory_order_acq_rel, std::memory_order_acquire))
         {
-            free(zero);
+            detail::free(current);
         }
     }
 }}}    // namespace pika::lcos::local
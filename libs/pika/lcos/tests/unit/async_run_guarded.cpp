@@ -0,0 +1,225 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/execution.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/lcos/composable_guard.hpp>
+#include <pika/testing.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::lcos::local::async_run_guarded;
+using pika::lcos::local::guard;
+using pika::lcos::local::guard_set;
+
+///////////////////////////////////////////////////////////////////////////////
+void test_values()
+{
+    guard g;
+
+    tt::sync_wait(async_run_guarded(g, []() {}));
+    PIKA_TEST_EQ(tt::sync_wait(async_run_guarded(g, []() { return 42; })), 42);
+    PIKA_TEST_EQ(
+        tt::sync_wait(async_run_guarded(
+            g, [](int x, int y) { return x + y; }, 1, 2)),
+        3);
+
+    // move-only results and arguments
+    auto p = tt::sync_wait(async_run_guarded(
+        g, [](std::unique_ptr<int> p) { return p; },
+        std::make_unique<int>(3)));
+    PIKA_TEST(p);
+    PIKA_TEST_EQ(*p, 3);
+
+    // composition with other senders
+    PIKA_TEST_EQ(tt::sync_wait(async_run_guarded(g, []() { return 1; }) |
+                     ex::then([](int x) { return x + 1; })),
+        2);
+}
+
+void test_exception()
+{
+    guard g;
+
+    bool exception_thrown = false;
+    try
+    {
+        tt::sync_wait(async_run_guarded(
+            g, []() { throw std::runtime_error("error"); }));
+        PIKA_TEST(false);
+    }
+    catch (std::runtime_error const& e)
+    {
+        PIKA_TEST_EQ(std::string(e.what()), std::string("error"));
+        exception_thrown = true;
+    }
+    PIKA_TEST(exception_thrown);
+
+    // the guard is released after an exception
+    PIKA_TEST_EQ(tt::sync_wait(async_run_guarded(g, []() { return 1; })), 1);
+}
+
+void test_exception_other_task()
+{
+    guard g;
+
+    // The throwing task is queued while the function of the sender holds the
+    // guard, and it is run by start before it returns. Its exception is not
+    // reported to the receiver of the sender.
+    bool other_run = false;
+    PIKA_TEST_EQ(tt::sync_wait(async_run_guarded(g,
+                     [&]() {
+                         pika::lcos::local::run_guarded(g, [&]() {
+                             other_run = true;
+                             throw std::runtime_error("other");
+                         });
+                         return 1;
+                     })),
+        1);
+    PIKA_TEST(other_run);
+
+    // The same for run_guarded, and the failing function of a sender queued
+    // behind it still reports its own exception.
+    other_run = false;
+    pika::future<void> f;
+    pika::lcos::local::run_guarded(g, [&]() {
+        pika::lcos::local::run_guarded(g, [&]() {
+            other_run = true;
+            throw std::runtime_error("other");
+        });
+        f = ex::make_future(
+            async_run_guarded(g, []() { throw std::runtime_error("error"); }));
+    });
+    PIKA_TEST(other_run);
+
+    bool exception_thrown = false;
+    try
+    {
+        f.get();
+        PIKA_TEST(false);
+    }
+    catch (std::runtime_error const& e)
+    {
+        PIKA_TEST_EQ(std::string(e.what()), std::string("error"));
+        exception_thrown = true;
+    }
+    PIKA_TEST(exception_thrown);
+
+    PIKA_TEST_EQ(tt::sync_wait(async_run_guarded(g, []() { return 1; })), 1);
+}
+
+void test_queued()
+{
+    guard g;
+    std::vector<std::size_t> order;
+
+    // hold the guard while the senders are started, their functions are run
+    // in order by the task releasing the guard
+    std::vector<pika::future<void>> results;
+    pika::lcos::local::run_guarded(g, [&]() {
+        for (std::size_t i = 0; i != 10; ++i)
+        {
+            results.push_back(ex::make_future(async_run_guarded(
+                g, [&order, i]() { order.push_back(i); })));
+        }
+        PIKA_TEST(order.empty());
+    });
+
+    pika::wait_all(results);
+    PIKA_TEST_EQ(order.size(), std::size_t(10));
+    for (std::size_t i = 0; i != order.size(); ++i)
+    {
+        PIKA_TEST_EQ(order[i], i);
+    }
+}
+
+void test_guard_set()
+{
+    guard_set gs;
+    auto g1 = std::make_shared<guard>();
+    auto g2 = std::make_shared<guard>();
+    gs.add(g1);
+    gs.add(g2);
+
+    std::size_t const num_tasks = 1000;
+    std::size_t v1 = 0;
+    std::size_t v2 = 0;
+
+    std::vector<pika::future<void>> results;
+    for (std::size_t i = 0; i != num_tasks; ++i)
+    {
+        results.push_back(pika::async([&]() {
+            tt::sync_wait(async_run_guarded(gs, [&]() {
+                ++v1;
+                ++v2;
+            }));
+            tt::sync_wait(async_run_guarded(*g1, [&]() { ++v1; }));
+            pika::lcos::local::run_guarded(*g2, [&]() { ++v2; });
+        }));
+    }
+    pika::wait_all(results);
+
+    PIKA_TEST_EQ(
+        tt::sync_wait(async_run_guarded(gs, [&]() { return v1 + v2; })),
+        4 * num_tasks);
+}
+
+void test_concurrent()
+{
+    guard g;
+    std::size_t const num_tasks = 100;
+    std::size_t const num_increments = 1000;
+    std::size_t value = 0;
+    std::atomic<bool> inside{false};
+
+    std::vector<pika::future<void>> results;
+    for (std::size_t t = 0; t != num_tasks; ++t)
+    {
+        results.push_back(pika::async([&]() {
+            for (std::size_t i = 0; i != num_increments; ++i)
+            {
+                ex::start_detached(async_run_guarded(g, [&]() {
+                    PIKA_TEST(!inside.exchange(true));
+                    ++value;
+                    inside.store(false);
+                }));
+            }
+        }));
+    }
+    pika::wait_all(results);
+
+    PIKA_TEST_EQ(tt::sync_wait(async_run_guarded(g, [&]() { return value; })),
+        num_tasks * num_increments);
+}
+
+int pika_main()
+{
+    test_values();
+    test_exception();
+    test_exception_other_task();
+    test_queued();
+    test_guard_set();
+    test_concurrent();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ_MSG(pika::init(pika_main, argc, argv), 0,
+        "pika main exited with non-zero status");
+    return pika::util::report_errors();
+}
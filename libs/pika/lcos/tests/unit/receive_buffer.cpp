@@ -0,0 +1,274 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/lcos/receive_buffer.hpp>
+#include <pika/synchronization/no_mutex.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+using pika::lcos::local::receive_buffer;
+
+///////////////////////////////////////////////////////////////////////////////
+void test_store_receive(std::size_t window)
+{
+    receive_buffer<std::size_t> buffer(window);
+
+    // store before receive
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        buffer.store_received(i, std::size_t(i));
+        PIKA_TEST(buffer.try_receive(i));
+        PIKA_TEST_EQ(buffer.receive(i).get(), i);
+    }
+    PIKA_TEST(buffer.empty());
+
+    // receive before store
+    for (std::size_t i = 100; i != 200; ++i)
+    {
+        pika::future<std::size_t> f = buffer.receive(i);
+        PIKA_TEST(!f.is_ready());
+        buffer.store_received(i, std::size_t(i));
+        PIKA_TEST_EQ(f.get(), i);
+    }
+    PIKA_TEST(buffer.empty());
+
+    // generations which are far ahead of the ones in use
+    std::vector<pika::future<std::size_t>> futures;
+    for (std::size_t i = 200; i != 300; ++i)
+    {
+        futures.push_back(buffer.receive(i));
+    }
+    for (std::size_t i = 300; i != 200; --i)
+    {
+        buffer.store_received(i - 1, std::size_t(i - 1));
+    }
+    for (std::size_t i = 0; i != futures.size(); ++i)
+    {
+        PIKA_TEST_EQ(futures[i].get(), i + 200);
+    }
+    PIKA_TEST(buffer.empty());
+
+    // generations which are skipped entirely
+    buffer.store_received(1000, std::size_t(1000));
+    PIKA_TEST(!buffer.try_receive(999));
+    pika::future<std::size_t> f;
+    PIKA_TEST(buffer.try_receive(1000, &f));
+    PIKA_TEST_EQ(f.get(), std::size_t(1000));
+    PIKA_TEST(buffer.empty());
+
+    // generations too far ahead of the one using their slot to be recorded
+    // in the slot are handled by the fallback, as are all later generations
+    // of the slot
+    if (window != 0)
+    {
+        std::size_t const first = 2000 * window;
+        std::size_t const far = first + 100000 * window;
+        pika::future<std::size_t> f1 = buffer.receive(first);
+        buffer.store_received(far, std::size_t(far));
+        PIKA_TEST(buffer.try_receive(far));
+        buffer.store_received(first, std::size_t(first));
+        PIKA_TEST_EQ(f1.get(), first);
+        PIKA_TEST_EQ(buffer.receive(far).get(), far);
+
+        for (std::size_t i = first + 1; i != first + 10 * window; ++i)
+        {
+            pika::future<std::size_t> f2 = buffer.receive(i);
+            buffer.store_received(i, std::size_t(i));
+            PIKA_TEST_EQ(f2.get(), i);
+        }
+        PIKA_TEST(buffer.empty());
+    }
+}
+
+void test_store_receive_void(std::size_t window)
+{
+    receive_buffer<void> buffer(window);
+
+    std::vector<pika::future<void>> futures;
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        futures.push_back(buffer.receive(i));
+    }
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        buffer.store_received(i);
+    }
+    for (std::size_t i = 100; i != 200; ++i)
+    {
+        buffer.store_received(i);
+        futures.push_back(buffer.receive(i));
+    }
+    pika::wait_all(futures);
+    for (auto& f : futures)
+    {
+        PIKA_TEST(f.is_ready() && !f.has_exception());
+    }
+    PIKA_TEST(buffer.empty());
+}
+
+void test_concurrent(std::size_t window)
+{
+    constexpr std::size_t num_generations = 10000;
+
+    receive_buffer<std::size_t> buffer(window);
+
+    // the producer runs ahead of the consumer by a varying number of
+    // generations
+    pika::future<void> producer = pika::async([&]() {
+        for (std::size_t i = 0; i != num_generations; ++i)
+        {
+            buffer.store_received(i, std::size_t(i));
+            if (i % 7 == 0)
+            {
+                pika::this_thread::yield();
+            }
+        }
+    });
+
+    pika::future<void> consumer = pika::async([&]() {
+        for (std::size_t i = 0; i != num_generations; ++i)
+        {
+            PIKA_TEST_EQ(buffer.receive(i).get(), i);
+        }
+    });
+
+    producer.get();
+    consumer.get();
+    PIKA_TEST(buffer.empty());
+}
+
+void test_cancel(std::size_t window)
+{
+    receive_buffer<std::size_t> buffer(window);
+
+    pika::future<std::size_t> f1 = buffer.receive(0);
+    pika::future<std::size_t> f2 = buffer.receive(window + 2);
+    buffer.store_received(1, std::size_t(1));
+
+    // only entries without a value are cancelled
+    PIKA_TEST_EQ(buffer.cancel_waiting(
+                     std::make_exception_ptr(std::runtime_error("cancelled"))),
+        std::size_t(2));
+    PIKA_TEST(f1.has_exception());
+    PIKA_TEST(f2.has_exception());
+    PIKA_TEST(!buffer.empty());
+
+    PIKA_TEST_EQ(buffer.cancel_waiting(
+                     std::make_exception_ptr(std::runtime_error("cancelled")),
+                     true),
+        std::size_t(1));
+    PIKA_TEST(buffer.empty());
+}
+
+// a cancelled generation hands its slot to the following generations, they
+// don't have to be redirected to the fallback
+void test_cancel_reuses_ring(std::size_t window)
+{
+    using ring_type =
+        pika::lcos::local::detail::receive_buffer_ring<std::size_t>;
+    using lock_type = pika::lcos::local::no_mutex;
+
+    ring_type ring(window);
+
+    pika::future<std::size_t> f;
+    PIKA_TEST(ring.receive(0, f));
+    PIKA_TEST_EQ(ring.cancel_waiting(std::make_exception_ptr(
+                                         std::runtime_error("cancelled")),
+                     false),
+        std::size_t(1));
+    PIKA_TEST(f.has_exception());
+    PIKA_TEST(ring.empty());
+
+    // the other side of the cancelled generation is handled by the fallback
+    PIKA_TEST(!ring.store(0, static_cast<lock_type*>(nullptr), 0));
+
+    for (std::size_t i = 1; i != 10; ++i)
+    {
+        std::size_t const step = i * window;
+        PIKA_TEST(ring.receive(step, f));
+        PIKA_TEST(ring.store(step, static_cast<lock_type*>(nullptr), step));
+        PIKA_TEST_EQ(f.get(), step);
+    }
+    PIKA_TEST(ring.empty());
+}
+
+// The other side of a generation may be on its way into the slot while the
+// generation is cancelled, it must not end up in a later generation.
+void test_cancel_concurrent(std::size_t window)
+{
+    using ring_type =
+        pika::lcos::local::detail::receive_buffer_ring<std::size_t>;
+    using lock_type = pika::lcos::local::no_mutex;
+
+    ring_type ring(window);
+    auto const e = std::make_exception_ptr(std::runtime_error("cancelled"));
+
+    for (std::size_t i = 0; i != 1000; ++i)
+    {
+        // all generations use the same slot
+        std::size_t const step = 2 * i * window;
+
+        pika::future<std::size_t> f;
+        PIKA_TEST(ring.receive(step, f));
+
+        pika::future<bool> stored = pika::async([&]() {
+            return ring.store(step, static_cast<lock_type*>(nullptr), step);
+        });
+        std::size_t const count = ring.cancel_waiting(e, false);
+        bool const in_ring = stored.get();
+
+        if (count == 0)
+        {
+            PIKA_TEST(in_ring);
+            PIKA_TEST_EQ(f.get(), step);
+        }
+        else
+        {
+            PIKA_TEST(!in_ring);
+            PIKA_TEST(f.has_exception());
+        }
+
+        // the next generation of the slot gets its own value
+        std::size_t const next = step + window;
+        PIKA_TEST(ring.store(next, static_cast<lock_type*>(nullptr), next));
+        PIKA_TEST(ring.receive(next, f));
+        PIKA_TEST_EQ(f.get(), next);
+        PIKA_TEST(ring.empty());
+    }
+}
+
+int pika_main()
+{
+    // a window of 0 disables the ring buffer
+    for (std::size_t window : {0, 1, 4, 16})
+    {
+        test_store_receive(window);
+        test_store_receive_void(window);
+        test_concurrent(window);
+        test_cancel(window);
+    }
+
+    for (std::size_t window : {1, 4, 16})
+    {
+        test_cancel_reuses_ring(window);
+        test_cancel_concurrent(window);
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv), 0);
+    return pika::util::report_errors();
+}
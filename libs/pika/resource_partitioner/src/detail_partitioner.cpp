@@ -151,6 +151,9 @@ namespace pika { namespace resource { namespace detail {
         case resource::shared_priority:
             sched = "shared_priority";
             break;
+        case resource::local_priority_chase_lev:
+            sched = "local_priority_chase_lev";
+            break;
         }
 
         os << "\"" << sched << "\" is running on PUs : \n";
@@ -480,6 +483,12 @@ namespace pika { namespace resource { namespace detail {
         {
             default_scheduler = scheduling_policy::shared_priority;
         }
+        else if (0 ==
+            std::string("local-priority-chase-lev")
+                .find(default_scheduler_str))
+        {
+            default_scheduler = scheduling_policy::local_priority_chase_lev;
+        }
         else
         {
             throw pika::detail::command_line_error(
@@ -165,6 +165,13 @@ namespace pika { namespace util {
     defined(__FreeBSD__)
             "use_guard_pages = ${PIKA_USE_GUARD_PAGES:1}",
 #endif
+            "max_cached = "
+            "${PIKA_STACK_POOL_MAX_CACHED_STACKS:" PIKA_PP_STRINGIZE(
+                PIKA_PP_EXPAND(PIKA_STACK_POOL_MAX_CACHED_STACKS)) "}",
+            "high_water_mark = "
+            "${PIKA_STACK_POOL_HIGH_WATER_MARK:" PIKA_PP_STRINGIZE(
+                PIKA_PP_EXPAND(PIKA_STACK_POOL_HIGH_WATER_MARK)) "}",
+            "use_huge_pages = ${PIKA_USE_HUGE_PAGES_FOR_STACKS:0}",
 
             "[pika.thread_queue]",
             "max_thread_count = ${PIKA_THREAD_QUEUE_MAX_THREAD_COUNT:" PIKA_PP_STRINGIZE(
@@ -193,6 +200,17 @@ namespace pika { namespace util {
             "init_threads_count = "
             "${PIKA_THREAD_QUEUE_INIT_THREADS_COUNT:" PIKA_PP_STRINGIZE(
                 PIKA_PP_EXPAND(PIKA_THREAD_QUEUE_INIT_THREADS_COUNT)) "}",
+            "max_cached_threads = "
+            "${PIKA_THREAD_QUEUE_MAX_CACHED_THREADS:" PIKA_PP_STRINGIZE(
+                PIKA_PP_EXPAND(PIKA_THREAD_QUEUE_MAX_CACHED_THREADS)) "}",
+            "steal_policy = ${PIKA_THREAD_QUEUE_STEAL_POLICY:radial}",
+
+#if defined(PIKA_HAVE_MODULE_ASYNC_MPI)
+            "[pika.mpi]",
+            "max_requests_per_poll = "
+            "${PIKA_MPI_MAX_REQUESTS_PER_POLL:" PIKA_PP_STRINGIZE(
+                PIKA_PP_EXPAND(PIKA_MPI_MAX_REQUESTS_PER_POLL)) "}",
+#endif
 
             "[pika.commandline]",
             // enable aliasing
@@ -22,6 +22,7 @@
 #include <pika/threading_base/thread_num_tss.hpp>
 #include <pika/threading_base/thread_queue_init_parameters.hpp>
 #include <pika/topology/topology.hpp>
+#include <pika/util/get_and_reset_value.hpp>
 
 #include <atomic>
 #include <cmath>
@@ -124,6 +125,8 @@ namespace pika { namespace threads { namespace policies {
           , queues_(num_queues_)
           , high_priority_queues_(num_queues_)
           , victim_threads_(num_queues_)
+          , steal_counters_(num_queues_)
+          , victim_states_(num_queues_)
         {
             if (!deferred_initialization)
             {
@@ -504,12 +507,12 @@ namespace pika { namespace threads { namespace policies {
         }
 
         ///////////////////////////////////////////////////////////////////////
-        // create a new thread and schedule it if the initial state is equal to
-        // pending
-        void create_thread(thread_init_data& data, thread_id_ref_type* id,
-            error_code& ec) override
+        // Return the worker thread whose queues new work should be placed in
+        // according to its schedule hint, without taking into account
+        // whether the worker thread is currently active.
+        // NOTE: This scheduler ignores NUMA hints.
+        std::size_t get_requested_thread(thread_init_data const& data)
         {
-            // NOTE: This scheduler ignores NUMA hints.
             std::size_t num_thread =
                 data.schedulehint.mode == thread_schedule_hint_mode::thread ?
                 data.schedulehint.hint :
@@ -523,6 +526,33 @@ namespace pika { namespace threads { namespace policies {
             {
                 num_thread %= num_queues_;
             }
+            return num_thread;
+        }
+
+        // Return 1 for work placed in the high priority queues, -1 for work
+        // placed in the low priority queue, and 0 otherwise.
+        static int get_priority_class(thread_init_data const& data) noexcept
+        {
+            switch (data.priority)
+            {
+            case thread_priority::high_recursive:
+            case thread_priority::high:
+            case thread_priority::boost:
+                return 1;
+            case thread_priority::low:
+                return -1;
+            default:
+                return 0;
+            }
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // create a new thread and schedule it if the initial state is equal to
+        // pending
+        void create_thread(thread_init_data& data, thread_id_ref_type* id,
+            error_code& ec) override
+        {
+            std::size_t num_thread = get_requested_thread(data);
 
             std::unique_lock<pu_mutex_type> l;
             num_thread = select_active_pu(l, num_thread);
@@ -592,6 +622,196 @@ namespace pika { namespace threads { namespace policies {
                 ;
         }
 
+        // Create the threads in runs of consecutive thread descriptions which
+        // end up in the same queue. Each run is handed to its queue at once.
+        void create_threads_bulk(thread_init_data* data, std::size_t count,
+            error_code& ec) override
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            std::size_t first = 0;
+            std::size_t num_requested = get_requested_thread(data[0]);
+            while (first != count)
+            {
+                int const priority_class = get_priority_class(data[first]);
+
+                std::size_t last = first + 1;
+                std::size_t next_requested = 0;
+                for (/**/; last != count; ++last)
+                {
+                    next_requested = get_requested_thread(data[last]);
+                    if (next_requested != num_requested ||
+                        get_priority_class(data[last]) != priority_class)
+                    {
+                        break;
+                    }
+                }
+
+                std::unique_lock<pu_mutex_type> l;
+                std::size_t const num_thread =
+                    select_active_pu(l, num_requested);
+
+                for (std::size_t i = first; i != last; ++i)
+                {
+                    data[i].schedulehint.mode =
+                        thread_schedule_hint_mode::thread;
+                    data[i].schedulehint.hint =
+                        static_cast<std::int16_t>(num_thread);
+                    if (data[i].priority == thread_priority::boost)
+                    {
+                        data[i].priority = thread_priority::normal;
+                    }
+                }
+
+                thread_queue_type* queue = nullptr;
+                if (priority_class > 0)
+                {
+                    queue = high_priority_queues_[num_thread %
+                        num_high_priority_queues_]
+                                .data_;
+                }
+                else if (priority_class < 0)
+                {
+                    queue = &low_priority_queue_;
+                }
+                else
+                {
+                    PIKA_ASSERT(num_thread < num_queues_);
+                    queue = queues_[num_thread].data_;
+                }
+
+                queue->create_threads_bulk(data + first, last - first, ec);
+                if (ec)
+                {
+                    return;
+                }
+
+                LTM_(debug).format(
+                    "local_priority_queue_scheduler::create_threads_bulk: "
+                    "pool({}), scheduler({}), worker_thread({}), count({})",
+                    *this->get_parent_pool(), *this, num_thread, last - first);
+
+                first = last;
+                num_requested = next_requested;
+            }
+        }
+
+    protected:
+        struct steal_counters
+        {
+            std::atomic<std::int64_t> steal_attempts{0};
+            std::atomic<std::int64_t> successful_steals{0};
+            std::atomic<std::int64_t> stolen_threads{0};
+        };
+
+        // Try to steal pending work from the given victim queue. Either a
+        // single thread is taken from the victim, or up to half of its
+        // pending threads are moved to the local queue first.
+        bool steal_pending(thread_queue_type* victim,
+            thread_queue_type* this_queue, steal_counters& counters,
+            bool running, threads::thread_id_ref_type& thrd, bool steal_half)
+        {
+            counters.steal_attempts.fetch_add(1, std::memory_order_relaxed);
+
+            if (steal_half)
+            {
+                std::int64_t const moved =
+                    this_queue->steal_half_from(victim, running);
+                if (moved == 0)
+                {
+                    return false;
+                }
+
+                victim->increment_num_stolen_from_pending(
+                    static_cast<std::size_t>(moved));
+                this_queue->increment_num_stolen_to_pending(
+                    static_cast<std::size_t>(moved));
+                counters.stolen_threads.fetch_add(
+                    moved, std::memory_order_relaxed);
+                counters.successful_steals.fetch_add(
+                    1, std::memory_order_relaxed);
+
+                // the moved threads may have been stolen again in the meantime
+                return this_queue->get_next_thread(thrd);
+            }
+
+            if (!victim->get_next_thread(thrd, running, true))
+            {
+                return false;
+            }
+
+            victim->increment_num_stolen_from_pending();
+            this_queue->increment_num_stolen_to_pending();
+            counters.stolen_threads.fetch_add(1, std::memory_order_relaxed);
+            counters.successful_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        struct victim_state
+        {
+            detail::steal_random_generator random;
+
+            // position in the list of victims of the last successful steal
+            std::size_t last_victim = std::size_t(-1);
+        };
+
+        // Call steal for the victims of the given worker thread, in the order
+        // defined by the steal policy, until it returns true.
+        template <typename F>
+        bool steal_from_victims(std::size_t num_thread, F&& steal)
+        {
+            std::vector<std::size_t> const& victims =
+                victim_threads_[num_thread].data_;
+            std::size_t const num_victims = victims.size();
+            victim_state& state = victim_states_[num_thread].data_;
+
+            std::size_t first = 0;
+            std::size_t skip = std::size_t(-1);
+            switch (thread_queue_init_.steal_policy_)
+            {
+            case steal_policy::random:
+                if (num_victims != 0)
+                {
+                    first = state.random(num_victims);
+                }
+                break;
+
+            case steal_policy::last_victim:
+                if (state.last_victim < num_victims)
+                {
+                    if (steal(victims[state.last_victim]))
+                    {
+                        return true;
+                    }
+                    skip = state.last_victim;
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            for (std::size_t i = 0; i != num_victims; ++i)
+            {
+                std::size_t pos = first + i;
+                if (pos >= num_victims)
+                {
+                    pos -= num_victims;
+                }
+
+                if (pos != skip && steal(victims[pos]))
+                {
+                    state.last_victim = pos;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    public:
         /// Return the next thread to be executed, return false if none is
         /// available
         bool get_next_thread(std::size_t num_thread, bool running,
@@ -638,36 +858,66 @@ namespace pika { namespace threads { namespace policies {
 
             if (enable_stealing)
             {
-                for (std::size_t idx : victim_threads_[num_thread].data_)
-                {
-                    PIKA_ASSERT(idx != num_thread);
+                steal_counters& counters = steal_counters_[num_thread].data_;
+                bool const steal_half =
+                    has_scheduler_mode(policies::steal_half);
 
-                    if (idx < num_high_priority_queues_ &&
-                        num_thread < num_high_priority_queues_)
-                    {
-                        thread_queue_type* q = high_priority_queues_[idx].data_;
-                        if (q->get_next_thread(thrd, running, true))
+                bool const stolen =
+                    steal_from_victims(num_thread, [&](std::size_t idx) {
+                        PIKA_ASSERT(idx != num_thread);
+
+                        if (idx < num_high_priority_queues_ &&
+                            num_thread < num_high_priority_queues_)
                         {
-                            q->increment_num_stolen_from_pending();
-                            this_high_priority_queue
-                                ->increment_num_stolen_to_pending();
-                            return true;
+                            if (steal_pending(high_priority_queues_[idx].data_,
+                                    this_high_priority_queue, counters, running,
+                                    thrd, steal_half))
+                            {
+                                return true;
+                            }
                         }
-                    }
 
-                    if (queues_[idx].data_->get_next_thread(
-                            thrd, running, true))
-                    {
-                        queues_[idx].data_->increment_num_stolen_from_pending();
-                        this_queue->increment_num_stolen_to_pending();
-                        return true;
-                    }
+                        return steal_pending(queues_[idx].data_, this_queue,
+                            counters, running, thrd, steal_half);
+                    });
+
+                if (stolen)
+                {
+                    return true;
                 }
             }
 
             return low_priority_queue_.get_next_thread(thrd);
         }
 
+        steal_statistics get_steal_statistics(
+            std::size_t num_thread, bool reset) override
+        {
+            steal_statistics result;
+            std::size_t first = num_thread;
+            std::size_t last = num_thread + 1;
+            if (num_thread == std::size_t(-1))
+            {
+                first = 0;
+                last = num_queues_;
+            }
+
+            for (std::size_t i = first; i != last; ++i)
+            {
+                // The counters are updated in the order attempts, stolen
+                // threads, successes. Reading the successes first makes sure
+                // that they are never larger than the other two counters.
+                steal_counters& counters = steal_counters_[i].data_;
+                result.successful_steals += util::get_and_reset_value(
+                    counters.successful_steals, reset);
+                result.steal_attempts +=
+                    util::get_and_reset_value(counters.steal_attempts, reset);
+                result.stolen_threads +=
+                    util::get_and_reset_value(counters.stolen_threads, reset);
+            }
+            return result;
+        }
+
         /// Schedule the passed thread
         void schedule_thread(threads::thread_id_ref_type thrd,
             threads::thread_schedule_hint schedulehint,
@@ -1133,38 +1383,45 @@ namespace pika { namespace threads { namespace policies {
 
             if (enable_stealing)
             {
-                for (std::size_t idx : victim_threads_[num_thread].data_)
-                {
-                    PIKA_ASSERT(idx != num_thread);
+                bool const stolen =
+                    steal_from_victims(num_thread, [&](std::size_t idx) {
+                        PIKA_ASSERT(idx != num_thread);
 
-                    if (idx < num_high_priority_queues_ &&
-                        num_thread < num_high_priority_queues_)
-                    {
-                        thread_queue_type* q = high_priority_queues_[idx].data_;
-                        result = this_high_priority_queue->wait_or_add_new(
-                                     true, added, q) &&
+                        if (idx < num_high_priority_queues_ &&
+                            num_thread < num_high_priority_queues_)
+                        {
+                            thread_queue_type* q =
+                                high_priority_queues_[idx].data_;
+                            result = this_high_priority_queue->wait_or_add_new(
+                                         true, added, q) &&
+                                result;
+
+                            if (0 != added)
+                            {
+                                q->increment_num_stolen_from_staged(added);
+                                this_high_priority_queue
+                                    ->increment_num_stolen_to_staged(added);
+                                return true;
+                            }
+                        }
+
+                        thread_queue_type* q = queues_[idx].data_;
+                        result =
+                            this_queue->wait_or_add_new(true, added, q) &&
                             result;
 
                         if (0 != added)
                         {
                             q->increment_num_stolen_from_staged(added);
-                            this_high_priority_queue
-                                ->increment_num_stolen_to_staged(added);
-                            return result;
+                            this_queue->increment_num_stolen_to_staged(added);
+                            return true;
                         }
-                    }
-
-                    result = this_queue->wait_or_add_new(
-                                 true, added, queues_[idx].data_) &&
-                        result;
+                        return false;
+                    });
 
-                    if (0 != added)
-                    {
-                        queues_[idx].data_->increment_num_stolen_from_staged(
-                            added);
-                        this_queue->increment_num_stolen_to_staged(added);
-                        return result;
-                    }
+                if (stolen)
+                {
+                    return result;
                 }
             }
 
@@ -1245,19 +1502,44 @@ namespace pika { namespace threads { namespace policies {
 
             queues_[num_thread].data_->on_start_thread(num_thread);
 
+            // seed the victim selection of this worker thread differently
+            // from all others
+            victim_states_[num_thread].data_.random =
+                detail::steal_random_generator(
+                    0x9e3779b97f4a7c15ull * (num_thread + 1));
+
             std::size_t num_threads = num_queues_;
             auto const& topo = ::pika::threads::detail::create_topology();
 
+            // the hierarchical policies order the victims by the level of the
+            // topology that is shared with them
+            bool const hierarchical =
+                thread_queue_init_.steal_policy_ ==
+                    steal_policy::hierarchical ||
+                thread_queue_init_.steal_policy_ == steal_policy::last_victim;
+
             // get NUMA domain masks of all queues...
             std::vector<::pika::threads::detail::mask_type> numa_masks(
                 num_threads);
             std::vector<::pika::threads::detail::mask_type> core_masks(
                 num_threads);
+            std::vector<::pika::threads::detail::mask_type> cache_masks;
+            std::vector<::pika::threads::detail::mask_type> socket_masks;
+            if (hierarchical)
+            {
+                cache_masks.resize(num_threads);
+                socket_masks.resize(num_threads);
+            }
             for (std::size_t i = 0; i != num_threads; ++i)
             {
                 std::size_t num_pu = affinity_data_.get_pu_num(i);
                 numa_masks[i] = topo.get_numa_node_affinity_mask(num_pu);
                 core_masks[i] = topo.get_core_affinity_mask(num_pu);
+                if (hierarchical)
+                {
+                    cache_masks[i] = topo.get_cache_affinity_mask(num_pu);
+                    socket_masks[i] = topo.get_socket_affinity_mask(num_pu);
+                }
             }
 
             // iterate over the number of threads again to determine where to
@@ -1326,23 +1608,75 @@ namespace pika { namespace threads { namespace policies {
                     core_mask & core_masks[other_num_thread]);
             });
 
-            // check for threads which share the same NUMA domain...
-            iterate([&](std::size_t other_num_thread) {
-                return !::pika::threads::detail::any(
-                           core_mask & core_masks[other_num_thread]) &&
-                    ::pika::threads::detail::any(
-                        numa_mask & numa_masks[other_num_thread]);
-            });
+            if (hierarchical)
+            {
+                ::pika::threads::detail::mask_cref_type cache_mask =
+                    cache_masks[num_thread];
 
-            // check for the rest and if we are NUMA aware
-            if (has_scheduler_mode(policies::enable_stealing_numa) &&
-                ::pika::threads::detail::any(first_mask & pu_mask))
+                // check for threads which share the same last level cache...
+                iterate([&](std::size_t other_num_thread) {
+                    return !::pika::threads::detail::any(
+                               core_mask & core_masks[other_num_thread]) &&
+                        ::pika::threads::detail::any(
+                            cache_mask & cache_masks[other_num_thread]) &&
+                        ::pika::threads::detail::any(
+                            numa_mask & numa_masks[other_num_thread]);
+                });
+
+                // check for threads which share the same NUMA domain...
+                iterate([&](std::size_t other_num_thread) {
+                    return !::pika::threads::detail::any(
+                               core_mask & core_masks[other_num_thread]) &&
+                        !::pika::threads::detail::any(
+                            cache_mask & cache_masks[other_num_thread]) &&
+                        ::pika::threads::detail::any(
+                            numa_mask & numa_masks[other_num_thread]);
+                });
+            }
+            else
             {
+                // check for threads which share the same NUMA domain...
                 iterate([&](std::size_t other_num_thread) {
                     return !::pika::threads::detail::any(
-                        numa_mask & numa_masks[other_num_thread]);
+                               core_mask & core_masks[other_num_thread]) &&
+                        ::pika::threads::detail::any(
+                            numa_mask & numa_masks[other_num_thread]);
                 });
             }
+
+            // check for the rest and if we are NUMA aware
+            if (has_scheduler_mode(policies::enable_stealing_numa) &&
+                ::pika::threads::detail::any(first_mask & pu_mask))
+            {
+                if (hierarchical)
+                {
+                    ::pika::threads::detail::mask_cref_type socket_mask =
+                        socket_masks[num_thread];
+
+                    // other NUMA domains on the same socket first...
+                    iterate([&](std::size_t other_num_thread) {
+                        return !::pika::threads::detail::any(
+                                   numa_mask & numa_masks[other_num_thread]) &&
+                            ::pika::threads::detail::any(
+                                socket_mask & socket_masks[other_num_thread]);
+                    });
+
+                    // ...then the other sockets
+                    iterate([&](std::size_t other_num_thread) {
+                        return !::pika::threads::detail::any(
+                                   numa_mask & numa_masks[other_num_thread]) &&
+                            !::pika::threads::detail::any(
+                                socket_mask & socket_masks[other_num_thread]);
+                    });
+                }
+                else
+                {
+                    iterate([&](std::size_t other_num_thread) {
+                        return !::pika::threads::detail::any(
+                            numa_mask & numa_masks[other_num_thread]);
+                    });
+                }
+            }
         }
 
         void on_stop_thread(std::size_t num_thread) override
@@ -1392,6 +1726,8 @@ namespace pika { namespace threads { namespace policies {
             high_priority_queues_;
         std::vector<util::cache_line_data<std::vector<std::size_t>>>
             victim_threads_;
+        std::vector<util::cache_line_data<steal_counters>> steal_counters_;
+        std::vector<util::cache_line_data<victim_state>> victim_states_;
     };
 }}}    // namespace pika::threads::policies
 
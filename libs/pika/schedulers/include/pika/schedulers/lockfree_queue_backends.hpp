@@ -22,8 +22,12 @@
 // Does not rely on CXX11_STD_ATOMIC_128BIT
 #include <pika/concurrency/concurrentqueue.hpp>
 
+#include <pika/concurrency/detail/chase_lev_deque.hpp>
+
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <thread>
 #include <utility>
 
 namespace pika { namespace threads { namespace policies {
@@ -153,6 +157,115 @@ namespace pika { namespace threads { namespace policies {
         };
     };
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Chase-Lev work-stealing deque, LIFO for the owning worker thread and
+    // FIFO for stealing threads.
+    //
+    // The deque only allows its owner to push, the owner is the first thread
+    // popping without stealing, i.e. the worker thread the queue belongs to.
+    // Only the owner pushes and pops at the bottom of the deque without
+    // read-modify-write operations. Items pushed by other threads (or to the
+    // other end) go through a separate multi-producer queue which is polled
+    // by the owner when the deque is empty and periodically in between to
+    // not starve these items.
+    //
+    // Pushing to the other end therefore does not put the item at the end
+    // of the deque from which the owner pops last. It is only guaranteed to
+    // not be taken before the items pushed by the owner until the owner
+    // polls the multi-producer queue, i.e. after at most
+    // remote_poll_interval items taken from the deque. Threads scheduled
+    // last (e.g. with schedule_last or after yielding) may thus run before
+    // items which were pushed earlier.
+    template <typename T>
+    struct chase_lev_lifo_backend
+    {
+        using container_type = pika::concurrency::detail::chase_lev_deque<T>;
+
+        using value_type = T;
+        using reference = T&;
+        using const_reference = T const&;
+        using rvalue_reference = T&&;
+        using size_type = std::uint64_t;
+
+        // the owner takes an item from the multi-producer queue first after
+        // this many items taken from the deque
+        static constexpr std::uint64_t remote_poll_interval = 16;
+
+        chase_lev_lifo_backend(size_type initial_size = 0,
+            size_type /* num_thread */ = size_type(-1))
+          : queue_(std::size_t(initial_size))
+          , remote_queue_(std::size_t(initial_size))
+          , owner_()
+          , owner_pops_(0)
+        {
+        }
+
+        bool push(const_reference val, bool other_end = false)
+        {
+            if (!other_end && is_owner())
+            {
+                queue_.push_bottom(val);
+                return true;
+            }
+            return remote_queue_.enqueue(val);
+        }
+
+        bool push(rvalue_reference val, bool other_end = false)
+        {
+            return push(static_cast<const_reference>(val), other_end);
+        }
+
+        bool pop(reference val, bool steal = true)
+        {
+            if (steal || !(is_owner() || claim_ownership()))
+            {
+                return queue_.steal_top(val) || remote_queue_.try_dequeue(val);
+            }
+
+            if (++owner_pops_ % remote_poll_interval == 0 &&
+                remote_queue_.try_dequeue(val))
+            {
+                return true;
+            }
+            return queue_.pop_bottom(val) || remote_queue_.try_dequeue(val);
+        }
+
+        bool empty()
+        {
+            return queue_.empty() && remote_queue_.size_approx() == 0;
+        }
+
+    private:
+        bool is_owner() const noexcept
+        {
+            return owner_.load(std::memory_order_relaxed) ==
+                std::this_thread::get_id();
+        }
+
+        bool claim_ownership() noexcept
+        {
+            std::thread::id no_owner;
+            return owner_.compare_exchange_strong(no_owner,
+                std::this_thread::get_id(), std::memory_order_relaxed);
+        }
+
+        container_type queue_;
+        pika::concurrency::ConcurrentQueue<T> remote_queue_;
+        std::atomic<std::thread::id> owner_;
+
+        // only accessed by the owner
+        std::uint64_t owner_pops_;
+    };
+
+    struct chase_lev_lifo
+    {
+        template <typename T>
+        struct apply
+        {
+            using type = chase_lev_lifo_backend<T>;
+        };
+    };
+
     // LIFO
 #if defined(PIKA_HAVE_CXX11_STD_ATOMIC_128BIT)
     struct lockfree_lifo;
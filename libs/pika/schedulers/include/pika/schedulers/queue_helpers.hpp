@@ -143,6 +143,31 @@ namespace pika { namespace threads { namespace policies {
             return result;
 #endif
         }
+
+        ///////////////////////////////////////////////////////////////////////////
+        // A xorshift pseudo random number generator used to select victims for
+        // work stealing. It is cheap enough to be called on every stealing
+        // round and each worker thread owns a separate instance.
+        class steal_random_generator
+        {
+        public:
+            explicit steal_random_generator(std::uint64_t seed = 1) noexcept
+              : state_(seed != 0 ? seed : 1)
+            {
+            }
+
+            // Return a number in [0, n), n must not be zero.
+            std::size_t operator()(std::size_t n) noexcept
+            {
+                state_ ^= state_ << 13;
+                state_ ^= state_ >> 7;
+                state_ ^= state_ << 17;
+                return static_cast<std::size_t>(state_ % n);
+            }
+
+        private:
+            std::uint64_t state_;
+        };
     }    // namespace detail
 
 }}}    // namespace pika::threads::policies
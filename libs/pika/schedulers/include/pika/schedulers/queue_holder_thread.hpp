@@ -542,31 +542,43 @@ namespace pika { namespace threads { namespace policies {
             std::ptrdiff_t stacksize =
                 get_thread_id_data(tid)->get_stack_size();
 
+            thread_heap_type* heap = nullptr;
             if (stacksize == parameters_.small_stacksize_)
             {
-                thread_heap_small_.push_front(tid);
+                heap = &thread_heap_small_;
             }
             else if (stacksize == parameters_.medium_stacksize_)
             {
-                thread_heap_medium_.push_front(tid);
+                heap = &thread_heap_medium_;
             }
             else if (stacksize == parameters_.large_stacksize_)
             {
-                thread_heap_large_.push_front(tid);
+                heap = &thread_heap_large_;
             }
             else if (stacksize == parameters_.huge_stacksize_)
             {
-                thread_heap_huge_.push_front(tid);
+                heap = &thread_heap_huge_;
             }
             else if (stacksize == parameters_.nostack_stacksize_)
             {
-                thread_heap_nostack_.push_front(tid);
+                heap = &thread_heap_nostack_;
             }
             else
             {
                 PIKA_ASSERT_MSG(
                     false, util::format("Invalid stack size {1}", stacksize));
+                return;
+            }
+
+            // hand the stacks of threads beyond the limit back to the stack
+            // pool, where they can be reused by any queue
+            if (static_cast<std::int64_t>(heap->size()) >=
+                parameters_.max_cached_threads_)
+            {
+                get_thread_id_data(tid)->destroy();
+                return;
             }
+            heap->push_front(tid);
         }
 
         // ----------------------------------------------------------------
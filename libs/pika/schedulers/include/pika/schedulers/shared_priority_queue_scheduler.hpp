@@ -12,11 +12,13 @@
 
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
 #include <pika/debugging/print.hpp>
 #include <pika/execution_base/this_thread.hpp>
 #include <pika/functional/function.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/schedulers/lockfree_queue_backends.hpp>
+#include <pika/schedulers/queue_helpers.hpp>
 #include <pika/schedulers/queue_holder_numa.hpp>
 #include <pika/schedulers/queue_holder_thread.hpp>
 #include <pika/schedulers/thread_queue_mc.hpp>
@@ -172,6 +174,7 @@ namespace pika { namespace threads { namespace policies {
           , initialized_(false)
           , debug_init_(false)
           , thread_init_counter_(0)
+          , victim_states_(init.num_worker_threads_)
         {
             set_scheduler_mode(scheduler_mode::default_mode);
             PIKA_ASSERT(num_workers_ != 0);
@@ -452,10 +455,60 @@ namespace pika { namespace threads { namespace policies {
                 ->create_thread(data, thrd, local_num, ec);
         }
 
+        struct victim_state
+        {
+            detail::steal_random_generator random;
+
+            // the NUMA domain of the last successful steal
+            std::size_t last_domain = std::size_t(-1);
+        };
+
+        // The offset of the first of num_victims candidate queues or domains
+        // to steal from, relative to the first one in the default order.
+        std::size_t first_victim_offset(
+            victim_state& state, std::size_t num_victims)
+        {
+            if (queue_parameters_.steal_policy_ == steal_policy::random &&
+                num_victims > 1)
+            {
+                return state.random(num_victims);
+            }
+            return 0;
+        }
+
+        // The offset of the first other NUMA domain to steal from
+        std::size_t first_victim_domain(
+            victim_state& state, std::size_t domain)
+        {
+            if (queue_parameters_.steal_policy_ == steal_policy::last_victim &&
+                state.last_domain < num_domains_ &&
+                state.last_domain != domain)
+            {
+                return fast_mod(
+                    state.last_domain + num_domains_ - domain - 1,
+                    num_domains_);
+            }
+            return first_victim_offset(state, num_domains_ - 1);
+        }
+
+        // The d-th NUMA domain to visit when stealing, the own domain is
+        // always visited first
+        std::size_t victim_domain(
+            std::size_t domain, std::size_t first, std::size_t d) const
+        {
+            if (d == 0)
+            {
+                return domain;
+            }
+            return fast_mod(
+                domain + 1 + fast_mod(first + d - 1, num_domains_ - 1),
+                num_domains_);
+        }
+
         template <typename T>
-        bool steal_by_function(std::size_t domain, std::size_t q_index,
-            bool steal_numa, bool steal_core, thread_holder_type* origin,
-            T& var, const char* prefix,
+        bool steal_by_function(std::size_t this_thread, std::size_t domain,
+            std::size_t q_index, bool steal_numa, bool steal_core,
+            thread_holder_type* origin, T& var, const char* prefix,
             util::function<bool(
                 std::size_t, std::size_t, thread_holder_type*, T&, bool, bool)>
                 operation_HP,
@@ -464,6 +517,7 @@ namespace pika { namespace threads { namespace policies {
                 operation)
         {
             bool result;
+            victim_state& state = victim_states_[this_thread].data_;
 
             // All stealing disabled
             if (!steal_core)
@@ -484,14 +538,17 @@ namespace pika { namespace threads { namespace policies {
             // High priority tasks first
             else if (steal_hp_first_)
             {
+                std::size_t const first = first_victim_domain(state, domain);
                 for (std::size_t d = 0; d < num_domains_; ++d)
                 {
-                    std::size_t dom = fast_mod(domain + d, num_domains_);
+                    std::size_t dom = victim_domain(domain, first, d);
                     q_index = fast_mod(q_index, q_counts_[dom]);
                     result =
                         operation_HP(dom, q_index, origin, var, (d > 0), true);
                     if (result)
                     {
+                        if (d > 0)
+                            state.last_domain = dom;
                         spq_deb.debug(debug::str<>(prefix),
                             "steal_high_priority_first BP/HP",
                             (d == 0 ? "taken" : "stolen"), "D",
@@ -504,12 +561,14 @@ namespace pika { namespace threads { namespace policies {
                 }
                 for (std::size_t d = 0; d < num_domains_; ++d)
                 {
-                    std::size_t dom = fast_mod(domain + d, num_domains_);
+                    std::size_t dom = victim_domain(domain, first, d);
                     q_index = fast_mod(q_index, q_counts_[dom]);
                     result =
                         operation(dom, q_index, origin, var, (d > 0), true);
                     if (result)
                     {
+                        if (d > 0)
+                            state.last_domain = dom;
                         spq_deb.debug(debug::str<>(prefix),
                             "steal_high_priority_first NP/LP",
                             (d == 0 ? "taken" : "stolen"), "D",
@@ -542,7 +601,10 @@ namespace pika { namespace threads { namespace policies {
                     {
                         // steal from other cores on this numa domain?
                         // use q+1 to avoid testing the same local queue again
-                        q_index = fast_mod((q_index + 1), q_counts_[domain]);
+                        q_index = fast_mod(q_index + 1 +
+                                first_victim_offset(
+                                    state, q_counts_[domain] - 1),
+                            q_counts_[domain]);
                         result = operation_HP(
                             domain, q_index, origin, var, true, true);
                         result = result ||
@@ -560,15 +622,19 @@ namespace pika { namespace threads { namespace policies {
 
                 if (steal_numa)
                 {
+                    std::size_t const first =
+                        first_victim_domain(state, domain);
+
                     // try other numa domains BP/HP
                     for (std::size_t d = 1; d < num_domains_; ++d)
                     {
-                        std::size_t dom = fast_mod(domain + d, num_domains_);
+                        std::size_t dom = victim_domain(domain, first, d);
                         q_index = fast_mod(q_index, q_counts_[dom]);
                         result =
                             operation_HP(dom, q_index, origin, var, true, true);
                         if (result)
                         {
+                            state.last_domain = dom;
                             spq_deb.debug(debug::str<>(prefix),
                                 "steal_after_local other numa BP/HP",
                                 (d == 0 ? "taken" : "stolen"), "D",
@@ -580,12 +646,13 @@ namespace pika { namespace threads { namespace policies {
                     // try other numa domains NP/LP
                     for (std::size_t d = 1; d < num_domains_; ++d)
                     {
-                        std::size_t dom = fast_mod(domain + d, num_domains_);
+                        std::size_t dom = victim_domain(domain, first, d);
                         q_index = fast_mod(q_index, q_counts_[dom]);
                         result =
                             operation(dom, q_index, origin, var, true, true);
                         if (result)
                         {
+                            state.last_domain = dom;
                             spq_deb.debug(debug::str<>(prefix),
                                 "steal_after_local other numa NP/LP",
                                 (d == 0 ? "taken" : "stolen"), "D",
@@ -636,10 +703,10 @@ namespace pika { namespace threads { namespace policies {
             // first try a high priority task, allow stealing
             // if stealing of HP tasks in on, this will be fine
             // but send a null function for normal tasks
-            bool result = steal_by_function<threads::thread_id_ref_type>(domain,
-                q_index, numa_stealing_, core_stealing_, nullptr, thrd,
-                "SBF-get_next_thread", get_next_thread_function_HP,
-                get_next_thread_function);
+            bool result = steal_by_function<threads::thread_id_ref_type>(
+                this_thread, domain, q_index, numa_stealing_, core_stealing_,
+                nullptr, thrd, "SBF-get_next_thread",
+                get_next_thread_function_HP, get_next_thread_function);
 
             if (result)
                 return result;
@@ -694,9 +761,10 @@ namespace pika { namespace threads { namespace policies {
                 q_index, "numa_stealing ", numa_stealing_, "core_stealing ",
                 core_stealing_);
 
-            bool added_tasks = steal_by_function<std::size_t>(domain, q_index,
-                numa_stealing_, core_stealing_, receiver, added,
-                "wait_or_add_new", add_new_function_HP, add_new_function);
+            bool added_tasks = steal_by_function<std::size_t>(this_thread,
+                domain, q_index, numa_stealing_, core_stealing_, receiver,
+                added, "wait_or_add_new", add_new_function_HP,
+                add_new_function);
 
             if (added_tasks)
             {
@@ -1068,6 +1136,12 @@ namespace pika { namespace threads { namespace policies {
             pika::threads::detail::set_thread_pool_num_tss(
                 parent_pool_->get_pool_id().index());
 
+            // seed the victim selection of this worker thread differently
+            // from all others
+            victim_states_[local_thread].data_.random =
+                detail::steal_random_generator(
+                    0x9e3779b97f4a7c15ull * (local_thread + 1));
+
             // one thread holder per core (shared by PUs)
             thread_holder_type* thread_holder = nullptr;
 
@@ -1409,6 +1483,8 @@ namespace pika { namespace threads { namespace policies {
         std::atomic<std::size_t> thread_init_counter_;
         // used in thread pool checks
         std::size_t pool_index_;
+        // per worker thread state for selecting victims when stealing
+        std::vector<util::cache_line_data<victim_state>> victim_states_;
     };
 }}}    // namespace pika::threads::policies
 
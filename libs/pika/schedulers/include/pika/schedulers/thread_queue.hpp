@@ -328,31 +328,44 @@ namespace pika { namespace threads { namespace policies {
             std::ptrdiff_t stacksize =
                 get_thread_id_data(thrd)->get_stack_size();
 
+            thread_heap_type* heap = nullptr;
             if (stacksize == parameters_.small_stacksize_)
             {
-                thread_heap_small_.push_back(thrd);
+                heap = &thread_heap_small_;
             }
             else if (stacksize == parameters_.medium_stacksize_)
             {
-                thread_heap_medium_.push_back(thrd);
+                heap = &thread_heap_medium_;
             }
             else if (stacksize == parameters_.large_stacksize_)
             {
-                thread_heap_large_.push_back(thrd);
+                heap = &thread_heap_large_;
             }
             else if (stacksize == parameters_.huge_stacksize_)
             {
-                thread_heap_huge_.push_back(thrd);
+                heap = &thread_heap_huge_;
             }
             else if (stacksize == parameters_.nostack_stacksize_)
             {
-                thread_heap_nostack_.push_back(thrd);
+                heap = &thread_heap_nostack_;
             }
             else
             {
                 PIKA_ASSERT_MSG(
                     false, util::format("Invalid stack size {1}", stacksize));
+                return;
             }
+
+            // Keep only a limited number of threads around, the stacks of the
+            // others go back to the stack pool where they can be reused by
+            // any queue.
+            if (static_cast<std::int64_t>(heap->size()) >=
+                parameters_.max_cached_threads_)
+            {
+                deallocate(get_thread_id_data(thrd));
+                return;
+            }
+            heap->push_back(thrd);
         }
 
     public:
@@ -749,6 +762,112 @@ namespace pika { namespace threads { namespace policies {
                 ec = make_success_code();
         }
 
+        // Create new threads for all of the given thread descriptions and
+        // schedule them. This is equivalent to calling create_thread for each
+        // of them without asking for the ids of the new threads, except that
+        // the queue is locked and the counters of the queues are updated only
+        // once for the whole batch.
+        void create_threads_bulk(
+            thread_init_data* data, std::size_t count, error_code& ec)
+        {
+            std::int64_t num_run_now = 0;
+            std::int64_t num_staged = 0;
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                // the new threads would go out of scope right away if they
+                // were not scheduled
+                if (data[i].initial_state != thread_schedule_state::pending)
+                {
+                    PIKA_THROWS_IF(ec, bad_parameter,
+                        "thread_queue::create_threads_bulk",
+                        "threads created in bulk must have 'pending' as their "
+                        "initial state");
+                    return;
+                }
+
+                if (data[i].stacksize == threads::thread_stacksize::current)
+                {
+                    data[i].stacksize = get_self_stacksize_enum();
+                }
+                PIKA_ASSERT(
+                    data[i].stacksize != threads::thread_stacksize::current);
+
+                if (data[i].run_now)
+                {
+                    ++num_run_now;
+                }
+                else
+                {
+                    ++num_staged;
+                }
+            }
+
+            if (num_run_now != 0)
+            {
+                // account for all new work items at once
+                work_items_count_.data_ += num_run_now;
+
+                std::int64_t remaining = num_run_now;
+                std::unique_lock<mutex_type> lk(mtx_);
+                for (std::size_t i = 0; i != count; ++i)
+                {
+                    if (!data[i].run_now)
+                    {
+                        continue;
+                    }
+
+                    threads::thread_id_ref_type thrd;
+                    create_thread_object(thrd, data[i], lk);
+
+                    // add a new entry in the map for this thread
+                    std::pair<thread_map_type::iterator, bool> p =
+                        thread_map_.insert(thrd.noref());
+
+                    if (PIKA_UNLIKELY(!p.second))
+                    {
+                        // the remaining threads will not be scheduled
+                        work_items_count_.data_ -= remaining;
+                        lk.unlock();
+                        PIKA_THROWS_IF(ec, pika::out_of_memory,
+                            "thread_queue::create_threads_bulk",
+                            "Couldn't add new thread to the map of threads");
+                        return;
+                    }
+                    ++thread_map_count_;
+
+                    --remaining;
+                    push_work_item(PIKA_MOVE(thrd));
+                }
+            }
+
+            if (num_staged != 0)
+            {
+                // do not execute the work, but register the task descriptions
+                // for later thread creation
+                new_tasks_count_.data_ += num_staged;
+
+                for (std::size_t i = 0; i != count; ++i)
+                {
+                    if (data[i].run_now)
+                    {
+                        continue;
+                    }
+
+                    task_description* td = task_description_alloc_.allocate(1);
+#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
+                    new (td) task_description{PIKA_MOVE(data[i]),
+                        pika::chrono::high_resolution_clock::now()};
+#else
+                    new (td) task_description{PIKA_MOVE(data[i])};    //-V106
+#endif
+                    new_tasks_.push(td);
+                }
+            }
+
+            if (&ec != &throws)
+                ec = make_success_code();
+        }
+
         void move_work_items_from(thread_queue* src, std::int64_t count)
         {
             thread_description_ptr trd;
@@ -774,6 +893,50 @@ namespace pika { namespace threads { namespace policies {
             }
         }
 
+        /// Move up to half of the pending threads of the given queue to this
+        /// queue, return the number of moved threads. The threads are popped
+        /// from the given queue one at a time. As in get_next_thread the
+        /// minimum number of pending threads to steal from applies only if
+        /// \a allow_stealing is set, i.e. while the pool is running.
+        std::int64_t steal_half_from(thread_queue* src, bool allow_stealing)
+        {
+            std::int64_t const src_count =
+                src->work_items_count_.data_.load(std::memory_order_relaxed);
+            if (src_count == 0 ||
+                (allow_stealing &&
+                    parameters_.min_tasks_to_steal_pending_ > src_count))
+            {
+                return 0;
+            }
+
+            std::int64_t const count = (src_count + 1) / 2;
+            std::int64_t moved = 0;
+
+            thread_description_ptr trd;
+            while (moved != count && src->work_items_.pop(trd, true))
+            {
+#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
+                if (get_maintain_queue_wait_times_enabled())
+                {
+                    std::uint64_t now =
+                        pika::chrono::high_resolution_clock::now();
+                    src->work_items_wait_ += now - trd->waittime;
+                    ++src->work_items_wait_count_;
+                    trd->waittime = now;
+                }
+#endif
+
+                // Decrement only after the local work_items_count_ has been
+                // incremented
+                ++work_items_count_.data_;
+                --src->work_items_count_.data_;
+
+                work_items_.push(trd);
+                ++moved;
+            }
+            return moved;
+        }
+
         void move_task_items_from(thread_queue* src, std::int64_t count)
         {
             task_description* task = nullptr;
@@ -858,6 +1021,14 @@ namespace pika { namespace threads { namespace policies {
             threads::thread_id_ref_type thrd, bool other_end = false)
         {
             ++work_items_count_.data_;
+            push_work_item(PIKA_MOVE(thrd), other_end);
+        }
+
+        /// Push the passed thread to the pending queue, the caller is
+        /// responsible for accounting for it in work_items_count_
+        void push_work_item(
+            threads::thread_id_ref_type thrd, bool other_end = false)
+        {
 #ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
             work_items_.push(new thread_description{PIKA_MOVE(thrd),
                                  pika::chrono::high_resolution_clock::now()},
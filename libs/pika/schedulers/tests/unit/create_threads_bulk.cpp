@@ -0,0 +1,111 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This test checks that all threads submitted at once with register_work_bulk
+// are run, independently of their priorities and schedule hints.
+
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/threading_base.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr std::size_t num_tasks = 1000;
+
+void test_bulk(pika::threads::thread_priority priority, bool use_hints)
+{
+    pika::threads::thread_pool_base* pool =
+        pika::threads::detail::get_self_or_default_pool();
+    std::size_t const num_threads = pool->get_os_thread_count();
+
+    std::atomic<std::size_t> count(0);
+    pika::latch l(num_tasks + 1);
+
+    std::vector<pika::threads::thread_init_data> data;
+    data.reserve(num_tasks);
+    for (std::size_t i = 0; i != num_tasks; ++i)
+    {
+        // consecutive tasks are hinted to the same worker thread so that
+        // they are submitted to the queues in batches
+        pika::threads::thread_schedule_hint hint;
+        if (use_hints)
+        {
+            hint = pika::threads::thread_schedule_hint(
+                static_cast<std::int16_t>((i / 10) % num_threads));
+        }
+
+        data.emplace_back(pika::threads::make_thread_function_nullary([&]() {
+            ++count;
+            l.count_down(1);
+        }),
+            "test_bulk", priority, hint);
+    }
+
+    pika::threads::register_work_bulk(data.data(), data.size(), pool);
+    l.arrive_and_wait();
+
+    PIKA_TEST_EQ(count.load(), num_tasks);
+}
+
+void test_invalid_state()
+{
+    pika::threads::thread_init_data data(
+        pika::threads::make_thread_function_nullary([]() {}),
+        "test_invalid_state", pika::threads::thread_priority::normal,
+        pika::threads::thread_schedule_hint(),
+        pika::threads::thread_stacksize::default_,
+        pika::threads::thread_schedule_state::suspended);
+
+    bool caught_exception = false;
+    try
+    {
+        pika::threads::register_work_bulk(
+            &data, 1, pika::threads::detail::get_self_or_default_pool());
+    }
+    catch (pika::exception const& e)
+    {
+        PIKA_TEST_EQ(e.get_error(), pika::bad_parameter);
+        caught_exception = true;
+    }
+    PIKA_TEST(caught_exception);
+}
+
+int pika_main()
+{
+    for (bool use_hints : {false, true})
+    {
+        test_bulk(pika::threads::thread_priority::normal, use_hints);
+        test_bulk(pika::threads::thread_priority::high, use_hints);
+        test_bulk(pika::threads::thread_priority::high_recursive, use_hints);
+        test_bulk(pika::threads::thread_priority::boost, use_hints);
+        test_bulk(pika::threads::thread_priority::low, use_hints);
+    }
+
+    test_invalid_state();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    for (std::string const scheduler : {"local", "local-priority-fifo",
+             "local-priority-lifo", "static", "static-priority",
+             "shared-priority"})
+    {
+        pika::init_params init_args;
+        init_args.cfg = {"pika.scheduler=" + scheduler};
+
+        PIKA_TEST_EQ(pika::init(pika_main, argc, argv, init_args), 0);
+    }
+
+    return pika::util::report_errors();
+}
@@ -0,0 +1,111 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This test checks that all threads are run when the steal_half scheduler mode
+// is enabled, and that the steal statistics of the pool are consistent.
+
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/threading_base.hpp>
+#include <pika/runtime.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+constexpr std::size_t num_tasks = 1000;
+
+void test_steal(bool steal_half)
+{
+    if (steal_half)
+    {
+        pika::threads::add_scheduler_mode(
+            pika::threads::policies::steal_half);
+    }
+    else
+    {
+        pika::threads::remove_scheduler_mode(
+            pika::threads::policies::steal_half);
+    }
+
+    pika::threads::thread_pool_base* pool =
+        pika::threads::detail::get_self_or_default_pool();
+    pool->get_steal_statistics(std::size_t(-1), true);
+
+    std::atomic<std::size_t> count(0);
+    pika::latch l(num_tasks + 1);
+
+    // all threads are put on the queue of the first worker thread, the other
+    // worker threads have to steal them
+    for (std::size_t i = 0; i != num_tasks; ++i)
+    {
+        pika::threads::thread_init_data data(
+            pika::threads::make_thread_function_nullary([&]() {
+                pika::this_thread::sleep_for(std::chrono::microseconds(10));
+                ++count;
+                l.count_down(1);
+            }),
+            "test_steal", pika::threads::thread_priority::normal,
+            pika::threads::thread_schedule_hint(std::int16_t(0)));
+        pika::threads::register_work(data, pool);
+    }
+    l.arrive_and_wait();
+
+    PIKA_TEST_EQ(count.load(), num_tasks);
+
+    pika::threads::steal_statistics const stats =
+        pool->get_steal_statistics(std::size_t(-1), false);
+    PIKA_TEST_LTE(stats.successful_steals, stats.steal_attempts);
+    PIKA_TEST_LTE(stats.successful_steals, stats.stolen_threads);
+    if (!steal_half)
+    {
+        PIKA_TEST_EQ(stats.successful_steals, stats.stolen_threads);
+    }
+    if (pool->get_os_thread_count() == 1)
+    {
+        PIKA_TEST_EQ(stats.steal_attempts, std::int64_t(0));
+    }
+
+    // idle worker threads keep trying to steal, the sum of the statistics of
+    // the individual worker threads is at least the earlier total
+    pika::threads::steal_statistics sum;
+    for (std::size_t i = 0; i != pool->get_os_thread_count(); ++i)
+    {
+        pika::threads::steal_statistics const s =
+            pool->get_steal_statistics(i, true);
+        sum.steal_attempts += s.steal_attempts;
+        sum.successful_steals += s.successful_steals;
+        sum.stolen_threads += s.stolen_threads;
+    }
+    PIKA_TEST_LTE(stats.steal_attempts, sum.steal_attempts);
+    PIKA_TEST_LTE(stats.stolen_threads, sum.stolen_threads);
+}
+
+int pika_main()
+{
+    test_steal(false);
+    test_steal(true);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    for (std::string const scheduler :
+        {"local-priority-fifo", "local-priority-chase-lev"})
+    {
+        pika::init_params init_args;
+        init_args.cfg = {"pika.scheduler=" + scheduler};
+
+        PIKA_TEST_EQ(pika::init(pika_main, argc, argv, init_args), 0);
+    }
+
+    return pika::util::report_errors();
+}
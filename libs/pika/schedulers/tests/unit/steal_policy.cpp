@@ -0,0 +1,78 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This test checks that all threads are run with all victim selection policies
+// for work stealing (pika.thread_queue.steal_policy).
+
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/threading_base.hpp>
+#include <pika/runtime.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+constexpr std::size_t num_tasks = 1000;
+
+void test_steal_policy(std::int16_t hint)
+{
+    pika::threads::thread_pool_base* pool =
+        pika::threads::detail::get_self_or_default_pool();
+
+    std::atomic<std::size_t> count(0);
+    pika::latch l(num_tasks + 1);
+
+    // all threads are put on the queue of one worker thread, the other
+    // worker threads have to steal them
+    for (std::size_t i = 0; i != num_tasks; ++i)
+    {
+        pika::threads::thread_init_data data(
+            pika::threads::make_thread_function_nullary([&]() {
+                pika::this_thread::sleep_for(std::chrono::microseconds(10));
+                ++count;
+                l.count_down(1);
+            }),
+            "test_steal_policy", pika::threads::thread_priority::normal,
+            pika::threads::thread_schedule_hint(hint));
+        pika::threads::register_work(data, pool);
+    }
+    l.arrive_and_wait();
+
+    PIKA_TEST_EQ(count.load(), num_tasks);
+}
+
+int pika_main()
+{
+    std::size_t const num_threads = pika::get_num_worker_threads();
+    test_steal_policy(0);
+    test_steal_policy(static_cast<std::int16_t>(num_threads - 1));
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    for (std::string const scheduler :
+        {"local-priority-fifo", "shared-priority"})
+    {
+        for (std::string const steal_policy :
+            {"radial", "random", "hierarchical", "last-victim"})
+        {
+            pika::init_params init_args;
+            init_args.cfg = {"pika.scheduler=" + scheduler,
+                "pika.thread_queue.steal_policy=" + steal_policy};
+
+            PIKA_TEST_EQ(pika::init(pika_main, argc, argv, init_args), 0);
+        }
+    }
+
+    return pika::util::report_errors();
+}
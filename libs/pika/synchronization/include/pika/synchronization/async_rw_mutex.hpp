@@ -6,19 +6,20 @@
 
 #pragma once
 
+#include <pika/config.hpp>
 #include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/assert.hpp>
-#include <pika/datastructures/detail/small_vector.hpp>
 #include <pika/datastructures/optional.hpp>
 #include <pika/execution_base/operation_state.hpp>
 #include <pika/execution_base/receiver.hpp>
 #include <pika/execution_base/sender.hpp>
-#include <pika/functional/unique_function.hpp>
-#include <pika/synchronization/mutex.hpp>
+#include <pika/memory/intrusive_ptr.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
-#include <mutex>
 #include <type_traits>
 #include <utility>
 
@@ -30,19 +31,72 @@ namespace pika { namespace experimental {
             readwrite
         };
 
+        // An operation state waiting for access to the value. Waiting
+        // operation states are linked into a list through next_ and are
+        // completed by calling complete_ once the previous access has
+        // released the value.
+        struct async_rw_mutex_waiter
+        {
+            using complete_type = void (*)(async_rw_mutex_waiter*) noexcept;
+
+            explicit async_rw_mutex_waiter(complete_type complete) noexcept
+              : complete_(complete)
+            {
+            }
+
+            async_rw_mutex_waiter* next_ = nullptr;
+            complete_type complete_;
+        };
+
         template <typename T>
-        struct async_rw_mutex_shared_state
+        struct async_rw_mutex_value
         {
-            using shared_state_ptr_type =
-                std::shared_ptr<async_rw_mutex_shared_state>;
             pika::util::optional<T> value;
-            shared_state_ptr_type next_state;
-            pika::lcos::local::mutex mtx;
-            pika::detail::small_vector<
-                pika::util::unique_function<void(shared_state_ptr_type)>, 1>
-                continuations;
 
-            async_rw_mutex_shared_state() = default;
+            template <typename U>
+            void set_value(U&& u)
+            {
+                PIKA_ASSERT(!value);
+                value.emplace(PIKA_FORWARD(U, u));
+            }
+
+            void move_value_to(async_rw_mutex_value& next)
+            {
+                // This state must always have the value set by the time it is
+                // released.
+                PIKA_ASSERT(value);
+                next.set_value(PIKA_MOVE(value.value()));
+                value.reset();
+            }
+
+            void reset_value() noexcept
+            {
+                PIKA_ASSERT(value);
+                value.reset();
+            }
+        };
+
+        template <>
+        struct async_rw_mutex_value<void>
+        {
+            void move_value_to(async_rw_mutex_value&) noexcept {}
+            void reset_value() noexcept {}
+        };
+
+        template <typename T>
+        struct async_rw_mutex_shared_state_pool;
+
+        template <typename T>
+        struct async_rw_mutex_shared_state : async_rw_mutex_value<T>
+        {
+            using shared_state_ptr_type =
+                pika::memory::intrusive_ptr<async_rw_mutex_shared_state>;
+            using pool_type = async_rw_mutex_shared_state_pool<T>;
+
+            explicit async_rw_mutex_shared_state(pool_type* pool) noexcept
+              : pool(pool)
+            {
+            }
             async_rw_mutex_shared_state(async_rw_mutex_shared_state&&) = delete;
             async_rw_mutex_shared_state& operator=(
                 async_rw_mutex_shared_state&&) = delete;
@@ -51,101 +105,336 @@ namespace pika { namespace experimental {
             async_rw_mutex_shared_state& operator=(
                 async_rw_mutex_shared_state const&) = delete;
 
-            ~async_rw_mutex_shared_state()
+            void set_next_state(shared_state_ptr_type state)
             {
-                // The last state does not have a next state. If this state has
-                // a next state it must always have continuations.
-                PIKA_ASSERT((continuations.empty() && !next_state) ||
-                    (!continuations.empty() && next_state));
+                // The next state should only be set once
+                PIKA_ASSERT(!next_state);
+                next_state = PIKA_MOVE(state);
+            }
 
-                // This state must always have the value set by the time it is
-                // destructed. If there is no next state the value is destructed
-                // with this state.
-                PIKA_ASSERT(value);
+            // The caller must hold a reference to this state until the waiter
+            // has been added. All waiters have therefore been added by the
+            // time the last reference is released.
+            void add_waiter(async_rw_mutex_waiter* waiter) noexcept
+            {
+                async_rw_mutex_waiter* head =
+                    waiters.load(std::memory_order_relaxed);
+                do
+                {
+                    waiter->next_ = head;
+                } while (!waiters.compare_exchange_weak(head, waiter,
+                    std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            friend void intrusive_ptr_add_ref(
+                async_rw_mutex_shared_state* p) noexcept
+            {
+                p->count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            friend void intrusive_ptr_release(
+                async_rw_mutex_shared_state* p) noexcept
+            {
+                if (p->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    p->release();
+                }
+            }
 
-                if (PIKA_LIKELY(next_state))
+            // Called when the last reference has been released. The value is
+            // handed to the next state and all operations waiting for this
+            // state are completed at once. The state is returned to its pool
+            // first so that it can be reused by the accesses being completed.
+            void release() noexcept
+            {
+                async_rw_mutex_waiter* head =
+                    waiters.load(std::memory_order_relaxed);
+                waiters.store(nullptr, std::memory_order_relaxed);
+
+                // The last state does not have a next state. If this state
+                // has waiters it must always have a next state.
+                PIKA_ASSERT(head == nullptr || next_state);
+
+                shared_state_ptr_type next = PIKA_MOVE(next_state);
+                if (PIKA_LIKELY(next))
                 {
                     // The current state has now finished all accesses to the
                     // wrapped value, so we move the value to the next state.
-                    next_state->set_value(PIKA_MOVE(value.value()));
+                    this->move_value_to(*next);
+                }
+                else
+                {
+                    // If there is no next state the value is destructed with
+                    // this state.
+                    this->reset_value();
+                }
+
+                pool->release(this);
+
+                // The waiters were pushed in reverse order, they are
+                // completed in the order in which they were started.
+                async_rw_mutex_waiter* waiter = nullptr;
+                while (head != nullptr)
+                {
+                    async_rw_mutex_waiter* next_waiter = head->next_;
+                    head->next_ = waiter;
+                    waiter = head;
+                    head = next_waiter;
+                }
 
-                    for (auto& continuation : continuations)
+                while (waiter != nullptr)
+                {
+                    // The waiter may be gone once it has been completed.
+                    async_rw_mutex_waiter* next_waiter = waiter->next_;
+                    waiter->complete_(waiter);
+                    waiter = next_waiter;
+                }
+            }
+
+            pool_type* pool;
+            std::atomic<std::size_t> count{1};
+            std::atomic<async_rw_mutex_waiter*> waiters{nullptr};
+            shared_state_ptr_type next_state;
+
+            // links released states in the pool
+            async_rw_mutex_shared_state* next_free = nullptr;
+        };
+
+        // Shared states are recycled through a pool owned by the mutex.
+        // States are taken from the pool only by the mutex, but released
+        // states may be returned to it from any thread. Those are pushed onto
+        // a lock-free list which the mutex takes over as a whole once its
+        // private list of free states runs empty.
+        //
+        // The pool lives until the mutex has closed it and all states
+        // allocated from it have been deallocated. States released after the
+        // pool has been closed are deallocated immediately.
+        template <typename T>
+        struct async_rw_mutex_shared_state_pool
+        {
+            using shared_state_type = async_rw_mutex_shared_state<T>;
+
+            async_rw_mutex_shared_state_pool() = default;
+            async_rw_mutex_shared_state_pool(
+                async_rw_mutex_shared_state_pool&&) = delete;
+            async_rw_mutex_shared_state_pool& operator=(
+                async_rw_mutex_shared_state_pool&&) = delete;
+            async_rw_mutex_shared_state_pool(
+                async_rw_mutex_shared_state_pool const&) = delete;
+            async_rw_mutex_shared_state_pool& operator=(
+                async_rw_mutex_shared_state_pool const&) = delete;
+
+            // Returns a state with a reference count of one.
+            shared_state_type* acquire()
+            {
+                if (free_states == nullptr)
+                {
+                    free_states = released_states.exchange(
+                        nullptr, std::memory_order_acquire);
+                }
+
+                if (free_states != nullptr)
+                {
+                    shared_state_type* state = free_states;
+                    free_states = state->next_free;
+                    state->count.store(1, std::memory_order_relaxed);
+                    return state;
+                }
+
+                shared_state_type* state = allocate();
+                count.fetch_add(1, std::memory_order_relaxed);
+                return state;
+            }
+
+            void release(shared_state_type* state) noexcept
+            {
+                shared_state_type* head =
+                    released_states.load(std::memory_order_relaxed);
+                do
+                {
+                    if (head == closed())
                     {
-                        continuation(next_state);
+                        deallocate(state);
+                        release_states(1);
+                        return;
                     }
-                }
+                    state->next_free = head;
+                } while (!released_states.compare_exchange_weak(head, state,
+                    std::memory_order_release, std::memory_order_relaxed));
             }
 
-            template <typename U>
-            void set_value(U&& u)
+            // Called by the mutex when it is destructed.
+            void close() noexcept
             {
-                PIKA_ASSERT(!value);
-                value.emplace(PIKA_FORWARD(U, u));
+                std::size_t num_states = deallocate_list(free_states);
+                free_states = nullptr;
+                num_states += deallocate_list(released_states.exchange(
+                    closed(), std::memory_order_acquire));
+
+                // the reference of the mutex
+                release_states(num_states + 1);
             }
 
-            void set_next_state(
-                std::shared_ptr<async_rw_mutex_shared_state> state)
+        protected:
+            virtual ~async_rw_mutex_shared_state_pool() = default;
+
+        private:
+            virtual shared_state_type* allocate() = 0;
+            virtual void deallocate(shared_state_type* state) noexcept = 0;
+            virtual void destroy() noexcept = 0;
+
+            static shared_state_type* closed() noexcept
             {
-                // The next state should only be set once
-                PIKA_ASSERT(!next_state);
-                next_state = PIKA_MOVE(state);
+                return reinterpret_cast<shared_state_type*>(
+                    static_cast<std::uintptr_t>(1));
             }
 
-            template <typename F>
-            void add_continuation(F&& continuation)
+            std::size_t deallocate_list(shared_state_type* state) noexcept
             {
-                std::lock_guard<pika::lcos::local::mutex> l(mtx);
-                continuations.emplace_back(PIKA_FORWARD(F, continuation));
+                std::size_t num_states = 0;
+                while (state != nullptr)
+                {
+                    shared_state_type* next = state->next_free;
+                    deallocate(state);
+                    state = next;
+                    ++num_states;
+                }
+                return num_states;
             }
+
+            void release_states(std::size_t num_states) noexcept
+            {
+                if (count.fetch_sub(num_states, std::memory_order_acq_rel) ==
+                    num_states)
+                {
+                    destroy();
+                }
+            }
+
+            // free states, only accessed by the mutex
+            shared_state_type* free_states = nullptr;
+
+            // states released by the accesses
+            std::atomic<shared_state_type*> released_states{nullptr};
+
+            // one for the mutex and one for each allocated state
+            std::atomic<std::size_t> count{1};
         };
 
-        template <>
-        struct async_rw_mutex_shared_state<void>
+        template <typename T, typename Allocator>
+        struct async_rw_mutex_shared_state_pool_impl final
+          : async_rw_mutex_shared_state_pool<T>
         {
-            using shared_state_ptr_type =
-                std::shared_ptr<async_rw_mutex_shared_state>;
-            shared_state_ptr_type next_state;
-            pika::lcos::local::mutex mtx;
-            pika::detail::small_vector<
-                pika::util::unique_function<void(shared_state_ptr_type)>, 1>
-                continuations;
+            using shared_state_type = async_rw_mutex_shared_state<T>;
+            using state_allocator_type = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<shared_state_type>;
+            using state_traits = std::allocator_traits<state_allocator_type>;
+            using pool_allocator_type = typename std::allocator_traits<
+                Allocator>::template rebind_alloc<
+                async_rw_mutex_shared_state_pool_impl>;
+            using pool_traits = std::allocator_traits<pool_allocator_type>;
+
+            explicit async_rw_mutex_shared_state_pool_impl(
+                Allocator const& alloc)
+              : alloc(alloc)
+            {
+            }
 
-            async_rw_mutex_shared_state() = default;
-            async_rw_mutex_shared_state(async_rw_mutex_shared_state&&) = delete;
-            async_rw_mutex_shared_state& operator=(
-                async_rw_mutex_shared_state&&) = delete;
-            async_rw_mutex_shared_state(
-                async_rw_mutex_shared_state const&) = delete;
-            async_rw_mutex_shared_state& operator=(
-                async_rw_mutex_shared_state const&) = delete;
+            static async_rw_mutex_shared_state_pool<T>* create(
+                Allocator const& alloc)
+            {
+                pool_allocator_type pool_alloc(alloc);
+                auto* p = pool_traits::allocate(pool_alloc, 1);
+                try
+                {
+                    pool_traits::construct(pool_alloc, p, alloc);
+                }
+                catch (...)
+                {
+                    pool_traits::deallocate(pool_alloc, p, 1);
+                    throw;
+                }
+                return p;
+            }
+
+        private:
+            shared_state_type* allocate() override
+            {
+                auto* p = state_traits::allocate(alloc, 1);
+                state_traits::construct(alloc, p, this);
+                return p;
+            }
+
+            void deallocate(shared_state_type* state) noexcept override
+            {
+                state_traits::destroy(alloc, state);
+                state_traits::deallocate(alloc, state, 1);
+            }
 
-            ~async_rw_mutex_shared_state()
+            void destroy() noexcept override
             {
-                // The last state does not have a next state. If this state has
-                // a next state it must always have continuations.
-                PIKA_ASSERT((continuations.empty() && !next_state) ||
-                    (!continuations.empty() && next_state));
+                pool_allocator_type pool_alloc(alloc);
+                pool_traits::destroy(pool_alloc, this);
+                pool_traits::deallocate(pool_alloc, this, 1);
+            }
 
-                for (auto& continuation : continuations)
+            state_allocator_type alloc;
+        };
+
+        // Owns the pool of a mutex and closes it when the mutex is destructed.
+        // The pool is created on the first access.
+        template <typename T>
+        class async_rw_mutex_shared_state_pool_ptr
+        {
+        public:
+            async_rw_mutex_shared_state_pool_ptr() = default;
+            async_rw_mutex_shared_state_pool_ptr(
+                async_rw_mutex_shared_state_pool_ptr&& other) noexcept
+              : pool(std::exchange(other.pool, nullptr))
+            {
+            }
+            async_rw_mutex_shared_state_pool_ptr& operator=(
+                async_rw_mutex_shared_state_pool_ptr&& other) noexcept
+            {
+                if (this != &other)
                 {
-                    continuation(next_state);
+                    reset();
+                    pool = std::exchange(other.pool, nullptr);
                 }
+                return *this;
             }
+            async_rw_mutex_shared_state_pool_ptr(
+                async_rw_mutex_shared_state_pool_ptr const&) = delete;
+            async_rw_mutex_shared_state_pool_ptr& operator=(
+                async_rw_mutex_shared_state_pool_ptr const&) = delete;
 
-            void set_next_state(
-                std::shared_ptr<async_rw_mutex_shared_state> state)
+            ~async_rw_mutex_shared_state_pool_ptr()
             {
-                // The next state should only be set once
-                PIKA_ASSERT(!next_state);
-                next_state = PIKA_MOVE(state);
+                reset();
             }
 
-            template <typename F>
-            void add_continuation(F&& continuation)
+            template <typename Allocator>
+            async_rw_mutex_shared_state<T>* acquire(Allocator const& alloc)
             {
-                std::lock_guard<pika::lcos::local::mutex> l(mtx);
-                continuations.emplace_back(PIKA_FORWARD(F, continuation));
+                if (PIKA_UNLIKELY(pool == nullptr))
+                {
+                    pool = async_rw_mutex_shared_state_pool_impl<T,
+                        Allocator>::create(alloc);
+                }
+                return pool->acquire();
             }
+
+        private:
+            void reset() noexcept
+            {
+                if (pool != nullptr)
+                {
+                    pool->close();
+                    pool = nullptr;
+                }
+            }
+
+            async_rw_mutex_shared_state_pool<T>* pool = nullptr;
         };
 
         template <typename ReadWriteT, typename ReadT,
@@ -157,8 +446,8 @@ namespace pika { namespace experimental {
             async_rw_mutex_access_type::read>
         {
         private:
-            using shared_state_type =
-                std::shared_ptr<async_rw_mutex_shared_state<ReadWriteT>>;
+            using shared_state_type = pika::memory::intrusive_ptr<
+                async_rw_mutex_shared_state<ReadWriteT>>;
             shared_state_type state;
 
         public:
@@ -203,8 +492,8 @@ namespace pika { namespace experimental {
                 "async_rw_mutex_access_wrapper wrapper (ReadT is void, "
                 "ReadWriteT is non-void)");
 
-            using shared_state_type =
-                std::shared_ptr<async_rw_mutex_shared_state<ReadWriteT>>;
+            using shared_state_type = pika::memory::intrusive_ptr<
+                async_rw_mutex_shared_state<ReadWriteT>>;
             shared_state_type state;
 
         public:
@@ -243,8 +532,8 @@ namespace pika { namespace experimental {
             async_rw_mutex_access_type::read>
         {
         private:
-            using shared_state_type =
-                std::shared_ptr<async_rw_mutex_shared_state<void>>;
+            using shared_state_type = pika::memory::intrusive_ptr<
+                async_rw_mutex_shared_state<void>>;
             shared_state_type state;
 
         public:
@@ -268,8 +557,8 @@ namespace pika { namespace experimental {
             async_rw_mutex_access_type::readwrite>
         {
         private:
-            using shared_state_type =
-                std::shared_ptr<async_rw_mutex_shared_state<void>>;
+            using shared_state_type = pika::memory::intrusive_ptr<
+                async_rw_mutex_shared_state<void>>;
             shared_state_type state;
 
         public:
@@ -322,17 +611,19 @@ namespace pika { namespace experimental {
     //
     // The async_rw_mutex protects access to a given resource using two
     // reference counted shared states, the current and the previous state. Each
-    // shared state guards access to the next stage; when the shared state goes
-    // out of scope it triggers continuations for the next stage.
+    // shared state guards access to the next stage; when the last reference to
+    // a shared state is released it completes the operations waiting for the
+    // next stage.
     //
     // When read-write access is required a sender is created which holds on to
     // the newly created shared state for the read-write access and the previous
-    // state. When the sender is connected to a receiver, a callback is added to
-    // the previous shared state's destructor. The callback holds the new state,
-    // and passes a wrapper holding the shared state to set_value. Once the
-    // receiver which receives the wrapper has let the wrapper go out of scope
-    // (and all other references to the shared state are out of scope), the new
-    // shared state will again trigger its continuations.
+    // state. When the sender is connected to a receiver and started, the
+    // operation state links itself into the list of waiters of the previous
+    // state. The operation state holds the new state, and passes a wrapper
+    // holding the shared state to set_value. Once the receiver which receives
+    // the wrapper has let the wrapper go out of scope (and all other references
+    // to the shared state are out of scope), the new shared state will again
+    // complete its waiters.
     //
     // When read-only access is required and the previous access was read-only
     // the procedure is the same as for read-write access. When read-only access
@@ -340,9 +631,16 @@ namespace pika { namespace experimental {
     // all consecutive read-only accesses, such that multiple read-only accesses
     // can run concurrently, and the next access (which must be read-write) is
     // triggered once all instances of that shared state have gone out of scope.
+    // All read-only accesses waiting for the same state are released together
+    // by the access releasing that state.
+    //
+    // The shared states are reference counted intrusively and the list of
+    // waiters is lock-free. Released states are recycled through a pool owned
+    // by the mutex, such that accessing the value does not allocate memory once
+    // the pool holds enough states.
     //
     // The protected value is moved from state to state and is released when the
-    // last shared state is destroyed.
+    // last shared state is released.
 
     template <typename Allocator>
     class async_rw_mutex<void, void, Allocator>
@@ -352,7 +650,8 @@ namespace pika { namespace experimental {
         struct sender;
 
         using shared_state_type = detail::async_rw_mutex_shared_state<void>;
-        using shared_state_ptr_type = std::shared_ptr<shared_state_type>;
+        using shared_state_ptr_type =
+            pika::memory::intrusive_ptr<shared_state_type>;
 
     public:
         using read_type = void;
@@ -381,8 +680,7 @@ namespace pika { namespace experimental {
             if (prev_access == detail::async_rw_mutex_access_type::readwrite)
             {
                 prev_state = PIKA_MOVE(state);
-                state = std::allocate_shared<shared_state_type, allocator_type>(
-                    alloc);
+                state = shared_state_ptr_type(pool.acquire(alloc), false);
                 prev_access = detail::async_rw_mutex_access_type::read;
 
                 // Only the first access has no previous shared state. When
@@ -400,8 +698,7 @@ namespace pika { namespace experimental {
         sender<detail::async_rw_mutex_access_type::readwrite> readwrite()
         {
             prev_state = PIKA_MOVE(state);
-            state =
-                std::allocate_shared<shared_state_type, allocator_type>(alloc);
+            state = shared_state_ptr_type(pool.acquire(alloc), false);
             prev_access = detail::async_rw_mutex_access_type::readwrite;
 
             // Only the first access has no previous shared state. When there is
@@ -434,7 +731,7 @@ namespace pika { namespace experimental {
             static constexpr bool sends_done = false;
 
             template <typename R>
-            struct operation_state
+            struct operation_state : detail::async_rw_mutex_waiter
             {
                 std::decay_t<R> r;
                 shared_state_ptr_type prev_state;
@@ -443,7 +740,8 @@ namespace pika { namespace experimental {
                 template <typename R_>
                 operation_state(R_&& r, shared_state_ptr_type prev_state,
                     shared_state_ptr_type state)
-                  : r(PIKA_FORWARD(R_, r))
+                  : detail::async_rw_mutex_waiter(&complete)
+                  , r(PIKA_FORWARD(R_, r))
                   , prev_state(PIKA_MOVE(prev_state))
                   , state(PIKA_MOVE(state))
                 {
@@ -454,6 +752,21 @@ namespace pika { namespace experimental {
                 operation_state(operation_state const&) = delete;
                 operation_state& operator=(operation_state const&) = delete;
 
+                static void complete(detail::async_rw_mutex_waiter* w) noexcept
+                {
+                    auto& os = static_cast<operation_state&>(*w);
+                    try
+                    {
+                        pika::execution::experimental::set_value(
+                            PIKA_MOVE(os.r), access_type{PIKA_MOVE(os.state)});
+                    }
+                    catch (...)
+                    {
+                        pika::execution::experimental::set_error(
+                            PIKA_MOVE(os.r), std::current_exception());
+                    }
+                }
+
                 friend void tag_invoke(pika::execution::experimental::start_t,
                     operation_state& os) noexcept
                 {
@@ -461,37 +774,21 @@ namespace pika { namespace experimental {
                         "async_rw_lock::sender::operation_state state is "
                         "empty, was the sender already started?");
 
-                    auto continuation =
-                        [r = PIKA_MOVE(os.r)](
-                            shared_state_ptr_type state) mutable {
-                            try
-                            {
-                                pika::execution::experimental::set_value(
-                                    PIKA_MOVE(r),
-                                    access_type{PIKA_MOVE(state)});
-                            }
-                            catch (...)
-                            {
-                                pika::execution::experimental::set_error(
-                                    PIKA_MOVE(r), std::current_exception());
-                            }
-                        };
-
                     if (os.prev_state)
                     {
-                        os.prev_state->add_continuation(
-                            PIKA_MOVE(continuation));
-
-                        // We release prev_state here to allow continuations to
-                        // run. The operation state may otherwise keep it alive
-                        // longer than needed.
-                        os.prev_state.reset();
+                        // We release prev_state here to allow the waiters to
+                        // be completed. The operation state may otherwise keep
+                        // it alive longer than needed. The operation state may
+                        // be gone once the reference has been released.
+                        shared_state_ptr_type prev_state =
+                            PIKA_MOVE(os.prev_state);
+                        prev_state->add_waiter(&os);
                     }
                     else
                     {
                         // There is no previous state on the first access. We
-                        // can immediately trigger the continuation.
-                        continuation(PIKA_MOVE(os.state));
+                        // can immediately complete the operation.
+                        complete(&os);
                     }
                 }
             };
@@ -506,6 +803,7 @@ namespace pika { namespace experimental {
         };
 
         allocator_type alloc;
+        detail::async_rw_mutex_shared_state_pool_ptr<void> pool;
 
         detail::async_rw_mutex_access_type prev_access =
             detail::async_rw_mutex_access_type::readwrite;
@@ -561,8 +859,7 @@ namespace pika { namespace experimental {
             if (prev_access == detail::async_rw_mutex_access_type::readwrite)
             {
                 prev_state = PIKA_MOVE(state);
-                state = std::allocate_shared<shared_state_type, allocator_type>(
-                    alloc);
+                state = shared_state_ptr_type(pool.acquire(alloc), false);
                 prev_access = detail::async_rw_mutex_access_type::read;
 
                 // Only the first access has no previous shared state. When
@@ -585,8 +882,7 @@ namespace pika { namespace experimental {
         sender<detail::async_rw_mutex_access_type::readwrite> readwrite()
         {
             prev_state = PIKA_MOVE(state);
-            state =
-                std::allocate_shared<shared_state_type, allocator_type>(alloc);
+            state = shared_state_ptr_type(pool.acquire(alloc), false);
 
             // Only the first access has no previous shared state. When there is
             // a previous state we set the next state so that the value can be
@@ -607,7 +903,8 @@ namespace pika { namespace experimental {
     private:
         using shared_state_type =
             detail::async_rw_mutex_shared_state<value_type>;
-        using shared_state_ptr_type = std::shared_ptr<shared_state_type>;
+        using shared_state_ptr_type =
+            pika::memory::intrusive_ptr<shared_state_type>;
 
         template <detail::async_rw_mutex_access_type AccessType>
         struct sender
@@ -628,7 +925,7 @@ namespace pika { namespace experimental {
             static constexpr bool sends_done = false;
 
             template <typename R>
-            struct operation_state
+            struct operation_state : detail::async_rw_mutex_waiter
             {
                 std::decay_t<R> r;
                 shared_state_ptr_type prev_state;
@@ -637,7 +934,8 @@ namespace pika { namespace experimental {
                 template <typename R_>
                 operation_state(R_&& r, shared_state_ptr_type prev_state,
                     shared_state_ptr_type state)
-                  : r(PIKA_FORWARD(R_, r))
+                  : detail::async_rw_mutex_waiter(&complete)
+                  , r(PIKA_FORWARD(R_, r))
                   , prev_state(PIKA_MOVE(prev_state))
                   , state(PIKA_MOVE(state))
                 {
@@ -648,6 +946,21 @@ namespace pika { namespace experimental {
                 operation_state(operation_state const&) = delete;
                 operation_state& operator=(operation_state const&) = delete;
 
+                static void complete(detail::async_rw_mutex_waiter* w) noexcept
+                {
+                    auto& os = static_cast<operation_state&>(*w);
+                    try
+                    {
+                        pika::execution::experimental::set_value(
+                            PIKA_MOVE(os.r), access_type{PIKA_MOVE(os.state)});
+                    }
+                    catch (...)
+                    {
+                        pika::execution::experimental::set_error(
+                            PIKA_MOVE(os.r), std::current_exception());
+                    }
+                }
+
                 friend void tag_invoke(pika::execution::experimental::start_t,
                     operation_state& os) noexcept
                 {
@@ -655,36 +968,21 @@ namespace pika { namespace experimental {
                         "async_rw_lock::sender::operation_state state is "
                         "empty, was the sender already started?");
 
-                    auto continuation =
-                        [r = PIKA_MOVE(os.r)](
-                            shared_state_ptr_type state) mutable {
-                            try
-                            {
-                                pika::execution::experimental::set_value(
-                                    PIKA_MOVE(r),
-                                    access_type{PIKA_MOVE(state)});
-                            }
-                            catch (...)
-                            {
-                                pika::execution::experimental::set_error(
-                                    PIKA_MOVE(r), std::current_exception());
-                            }
-                        };
-
                     if (os.prev_state)
                     {
-                        os.prev_state->add_continuation(
-                            PIKA_MOVE(continuation));
-                        // We release prev_state here to allow continuations to
-                        // run. The operation state may otherwise keep it alive
-                        // longer than needed.
-                        os.prev_state.reset();
+                        // We release prev_state here to allow the waiters to
+                        // be completed. The operation state may otherwise keep
+                        // it alive longer than needed. The operation state may
+                        // be gone once the reference has been released.
+                        shared_state_ptr_type prev_state =
+                            PIKA_MOVE(os.prev_state);
+                        prev_state->add_waiter(&os);
                     }
                     else
                     {
                         // There is no previous state on the first access. We
-                        // can immediately trigger the continuation.
-                        continuation(PIKA_MOVE(os.state));
+                        // can immediately complete the operation.
+                        complete(&os);
                     }
                 }
             };
@@ -700,6 +998,7 @@ namespace pika { namespace experimental {
 
         value_type value;
         allocator_type alloc;
+        detail::async_rw_mutex_shared_state_pool_ptr<value_type> pool;
 
         detail::async_rw_mutex_access_type prev_access =
             detail::async_rw_mutex_access_type::readwrite;
@@ -1,207 +1,906 @@
 //  Copyright (c) 2019 Hartmut Kaiser
+//  Copyright (c) 2022 ETH Zurich
 //
 //  SPDX-License-Identifier: BSL-1.0
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
-//  This work is inspired by https://github.com/aprell/tasking-2.0
+//  This work is inspired by https://github.com/aprell/tasking-2.0 and by the
+//  bounded MPMC queue described by Dmitry Vyukov at
+//  https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
 
 #pragma once
 
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
+#include <pika/execution_base/agent_ref.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
+#include <pika/execution_base/this_thread.hpp>
 #include <pika/modules/concurrency.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/modules/thread_support.hpp>
 #include <pika/synchronization/spinlock.hpp>
+#include <pika/threading_base/register_thread.hpp>
+#include <pika/threading_base/thread_helpers.hpp>
 
+#include <atomic>
 #include <cstddef>
+#include <exception>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
 #include <utility>
 
 namespace pika { namespace lcos { namespace local {
 
+    namespace detail {
+        // Entry of the intrusive lists of operations waiting for an element
+        // to become available (or a slot to become free) in a bounded_channel.
+        // A waiter is notified once after it has been removed from its list.
+        // It is then expected to retry its operation.
+        struct bounded_channel_waiter
+        {
+            using notify_type = void (*)(bounded_channel_waiter*) noexcept;
+
+            explicit bounded_channel_waiter(notify_type notify) noexcept
+              : notify_(notify)
+            {
+            }
+
+            bounded_channel_waiter* next_ = nullptr;
+            notify_type notify_;
+        };
+
+        // FIFO list of waiters. The list is modified only while holding the
+        // lock of the channel, but its head can be inspected without the lock
+        // to find out whether anybody needs to be notified.
+        struct bounded_channel_waiter_list
+        {
+            bool empty() const noexcept
+            {
+                return head_.load(std::memory_order_seq_cst) == nullptr;
+            }
+
+            void push_back(bounded_channel_waiter* w) noexcept
+            {
+                w->next_ = nullptr;
+                if (tail_ == nullptr)
+                {
+                    head_.store(w, std::memory_order_relaxed);
+                }
+                else
+                {
+                    tail_->next_ = w;
+                }
+                tail_ = w;
+            }
+
+            bounded_channel_waiter* pop_front() noexcept
+            {
+                bounded_channel_waiter* w =
+                    head_.load(std::memory_order_relaxed);
+                if (w != nullptr)
+                {
+                    head_.store(w->next_, std::memory_order_relaxed);
+                    if (w->next_ == nullptr)
+                    {
+                        tail_ = nullptr;
+                    }
+                }
+                return w;
+            }
+
+            // Removes all waiters from the list and returns the first one.
+            // The remaining ones are linked through their next_ member.
+            bounded_channel_waiter* take_all() noexcept
+            {
+                tail_ = nullptr;
+                return head_.exchange(nullptr, std::memory_order_relaxed);
+            }
+
+            void erase(bounded_channel_waiter* w) noexcept
+            {
+                bounded_channel_waiter* prev = nullptr;
+                bounded_channel_waiter* curr =
+                    head_.load(std::memory_order_relaxed);
+                while (curr != w)
+                {
+                    PIKA_ASSERT(curr != nullptr);
+                    prev = curr;
+                    curr = curr->next_;
+                }
+
+                if (prev == nullptr)
+                {
+                    head_.store(w->next_, std::memory_order_relaxed);
+                }
+                else
+                {
+                    prev->next_ = w->next_;
+                }
+                if (tail_ == w)
+                {
+                    tail_ = prev;
+                }
+            }
+
+            std::atomic<bounded_channel_waiter*> head_{nullptr};
+            bounded_channel_waiter* tail_ = nullptr;
+        };
+
+        // Waiter suspending the calling thread (a pika thread or any other
+        // thread) until it is notified.
+        struct bounded_channel_sync_waiter : bounded_channel_waiter
+        {
+            bounded_channel_sync_waiter()
+              : bounded_channel_waiter(&notify)
+              , ctx_(pika::execution_base::this_thread::agent())
+            {
+            }
+
+            static void notify(bounded_channel_waiter* w) noexcept
+            {
+                // The waiter may go out of scope as soon as it is resumed.
+                auto ctx = static_cast<bounded_channel_sync_waiter*>(w)->ctx_;
+                ctx.resume();
+            }
+
+            pika::execution_base::agent_ref ctx_;
+        };
+    }    // namespace detail
+
     ////////////////////////////////////////////////////////////////////////////
     // A simple but very high performance implementation of the channel concept.
     // This channel is bounded to a size given at construction time and supports
     // multiple producers and multiple consumers. The data is stored in a
     // ring-buffer.
+    //
+    // Every slot of the ring-buffer carries a sequence number telling whether
+    // it is ready to be written or read during the current lap around the
+    // buffer. Producers and consumers claim positions with a single atomic
+    // operation on the tail or head index, so that the non-blocking operations
+    // never take a lock. The blocking operations (get, set) and the senders
+    // returned from async_get and async_set take the lock only to register
+    // themselves as waiters when the channel is empty or full, respectively.
+    // Successful operations take the lock only if there is a waiter on the
+    // other side to notify.
     template <typename T, typename Mutex = util::spinlock>
     class bounded_channel
     {
+        // An element is moved in and out of a slot after the slot has been
+        // claimed, there is no way to give the slot back if that throws.
+        static_assert(std::is_nothrow_move_constructible_v<T> &&
+                std::is_nothrow_move_assignable_v<T>,
+            "the elements of a bounded_channel must be nothrow movable");
+
     private:
         using mutex_type = Mutex;
+        using waiter_type = detail::bounded_channel_waiter;
+        using waiter_list_type = detail::bounded_channel_waiter_list;
 
-        bool is_full(std::size_t tail) const noexcept
+        struct cell
         {
-            std::size_t numitems = size_ + tail - head_.data_;
-            if (numitems < size_)
+            std::atomic<std::size_t> sequence_;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type data_;
+
+            T& data() noexcept
             {
-                return numitems == size_ - 1;
+                return *std::launder(reinterpret_cast<T*>(&data_));
             }
-            return numitems - size_ == size_ - 1;
+        };
+
+        // A position encodes the index of a slot in its lower bits and the
+        // number of laps around the buffer in the remaining ones, such that
+        // no division is needed for a buffer of arbitrary size.
+        std::size_t index(std::size_t pos) const noexcept
+        {
+            return pos & mask_;
         }
 
-        bool is_empty(std::size_t head) const noexcept
+        std::size_t next(std::size_t pos) const noexcept
         {
-            return head == tail_.data_;
+            return index(pos) + 1 == size_ ? (pos | mask_) + 1 : pos + 1;
         }
 
-    public:
-        explicit bounded_channel(std::size_t size)
-          : size_(size + 1)
-          , buffer_(new T[size + 1])
-          , closed_(false)
+        // The sequence number of a slot is 2 * lap when it is ready to be
+        // written during the given lap and 2 * lap + 1 when it is ready to be
+        // read. Counting laps instead of positions makes this work for a
+        // buffer with a single slot.
+        std::size_t write_sequence(std::size_t pos) const noexcept
         {
-            PIKA_ASSERT(size != 0);
+            return 2 * (pos >> shift_);
+        }
 
-            // invoke constructors for allocated buffer
-            for (std::size_t i = 0; i != size_; ++i)
+        std::size_t read_sequence(std::size_t pos) const noexcept
+        {
+            return 2 * (pos >> shift_) + 1;
+        }
+
+        static std::ptrdiff_t difference(
+            std::size_t lhs, std::size_t rhs) noexcept
+        {
+            return static_cast<std::ptrdiff_t>(lhs - rhs);
+        }
+
+        bool push(T&& t) noexcept
+        {
+            std::size_t pos = tail_.data_.load(std::memory_order_relaxed);
+            cell* c = nullptr;
+            for (;;)
             {
-                new (&buffer_[i]) T();
+                c = &buffer_[index(pos)];
+                std::ptrdiff_t const diff =
+                    difference(c->sequence_.load(std::memory_order_acquire),
+                        write_sequence(pos));
+                if (diff == 0)
+                {
+                    // sequentially consistent, see notify_one
+                    if (tail_.data_.compare_exchange_weak(pos, next(pos),
+                            std::memory_order_seq_cst,
+                            std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // the slot still holds the element of the previous lap
+                    return false;
+                }
+                else
+                {
+                    pos = tail_.data_.load(std::memory_order_relaxed);
+                }
             }
 
-            head_.data_ = 0;
-            tail_.data_ = 0;
+            new (&c->data_) T(PIKA_MOVE(t));
+            c->sequence_.store(read_sequence(pos), std::memory_order_release);
+            return true;
         }
 
-        bounded_channel(bounded_channel&& rhs) noexcept
-          : head_(rhs.head_)
-          , tail_(rhs.tail_)
-          , size_(rhs.size_)
-          , buffer_(PIKA_MOVE(rhs.buffer_))
-          , closed_(rhs.closed_)
+        static void move_to(T& dst, T&& src) noexcept
         {
-            rhs.size_ = 0;
-            rhs.closed_ = true;
+            dst = PIKA_MOVE(src);
         }
 
-        bounded_channel& operator=(bounded_channel&& rhs) noexcept
+        static void move_to(std::optional<T>& dst, T&& src) noexcept
         {
-            head_ = rhs.head_;
-            tail_ = rhs.tail_;
-            size_ = rhs.size_;
-            buffer_ = PIKA_MOVE(rhs.buffer_);
-            closed_ = rhs.closed_;
-            rhs.closed_ = true;
-            return *this;
+            dst.emplace(PIKA_MOVE(src));
         }
 
-        ~bounded_channel()
+        // Moves the next element to *val, which is either a T or an
+        // std::optional<T>. If val is nullptr this only checks whether there
+        // is an element.
+        template <typename U>
+        bool pop(U* val) const noexcept
+        {
+            std::size_t pos = head_.data_.load(std::memory_order_relaxed);
+            cell* c = nullptr;
+            for (;;)
+            {
+                c = &buffer_[index(pos)];
+                std::ptrdiff_t const diff =
+                    difference(c->sequence_.load(std::memory_order_acquire),
+                        read_sequence(pos));
+                if (diff == 0)
+                {
+                    if (val == nullptr)
+                    {
+                        return true;
+                    }
+                    // sequentially consistent, see notify_one
+                    if (head_.data_.compare_exchange_weak(pos, next(pos),
+                            std::memory_order_seq_cst,
+                            std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // the slot has not been written during this lap yet
+                    return false;
+                }
+                else
+                {
+                    pos = head_.data_.load(std::memory_order_relaxed);
+                }
+            }
+
+            move_to(*val, PIKA_MOVE(c->data()));
+            c->data().~T();
+            c->sequence_.store(
+                read_sequence(pos) + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Returns whether all slots have been claimed by producers and not
+        // yet claimed by consumers, i.e. the tail is exactly one lap ahead of
+        // the head. Elements (or free slots) which have been claimed may not
+        // have been published yet.
+        bool claimed_empty() const noexcept
+        {
+            return tail_.data_.load(std::memory_order_seq_cst) ==
+                head_.data_.load(std::memory_order_seq_cst);
+        }
+
+        bool claimed_full() const noexcept
+        {
+            std::size_t const head =
+                head_.data_.load(std::memory_order_seq_cst);
+            return tail_.data_.load(std::memory_order_seq_cst) ==
+                head + mask_ + 1;
+        }
+
+        // Notifies the first waiter of the given list, if any. A successful
+        // claim of a slot in push or pop is sequentially consistent and
+        // precedes this call, which pairs with the fence in wait(): either
+        // the waiter sees the claim, or this call sees the waiter.
+        void notify_one(waiter_list_type& waiters) const noexcept
         {
+            if (waiters.empty())
+            {
+                return;
+            }
+
             std::unique_lock<mutex_type> l(mtx_.data_);
+            waiter_type* w = waiters.pop_front();
+            l.unlock();
 
-            // invoke destructors for allocated buffer
-            for (std::size_t i = 0; i != size_; ++i)
+            if (w != nullptr)
+            {
+                notify(w);
+            }
+        }
+
+        // Notifying an asynchronous operation completes it on the notifying
+        // thread, which may in turn notify the next waiter of the other side.
+        // As for the continuations of futures, the notification is run on a
+        // new thread once the nesting depth exceeds
+        // PIKA_CONTINUATION_MAX_RECURSION_DEPTH.
+        void notify(waiter_type* w) const noexcept
+        {
+            std::size_t& depth =
+                pika::threads::get_continuation_recursion_count();
+            if (depth < PIKA_CONTINUATION_MAX_RECURSION_DEPTH)
             {
-                (&buffer_[i])->~T();
+                ++depth;
+                w->notify_(w);
+                --depth;
+                return;
             }
 
-            if (!closed_)
+            // the destructor waits for deferred notifications
+            pending_notifications_.fetch_add(1, std::memory_order_relaxed);
+            try
+            {
+                threads::thread_init_data data(
+                    threads::make_thread_function_nullary([this, w]() {
+                        w->notify_(w);
+                        pending_notifications_.fetch_sub(
+                            1, std::memory_order_release);
+                    }),
+                    "pika::lcos::local::bounded_channel::notify");
+                threads::register_work(data);
+            }
+            catch (...)
             {
-                close(l);
+                // no new thread could be created, notify on this thread
+                pending_notifications_.fetch_sub(
+                    1, std::memory_order_relaxed);
+                w->notify_(w);
             }
         }
 
-        bool get(T* val = nullptr) const noexcept
+        // Adds w to the given list unless the channel was closed or ready
+        // returns true in the meantime. Returns whether w was added, in which
+        // case it will be notified once it should retry its operation. If w
+        // was not added the operation should be retried right away. This
+        // amounts to spinning only while a claimed slot is being published.
+        template <typename F>
+        bool wait(waiter_list_type& waiters, waiter_type* w, F&& ready) const
         {
-            std::unique_lock<mutex_type> l(mtx_.data_);
-            if (closed_)
+            std::lock_guard<mutex_type> l(mtx_.data_);
+
+            waiters.push_back(w);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (closed_.load(std::memory_order_relaxed) || ready())
             {
+                waiters.erase(w);
                 return false;
             }
+            return true;
+        }
 
-            std::size_t head = head_.data_;
+        bool wait_get(waiter_type* w) const
+        {
+            return wait(
+                get_waiters_, w, [this]() { return !claimed_empty(); });
+        }
+
+        bool wait_set(waiter_type* w) const
+        {
+            return wait(
+                set_waiters_, w, [this]() { return !claimed_full(); });
+        }
 
-            if (is_empty(head))
+        template <typename Receiver>
+        struct get_operation_state : waiter_type
+        {
+            template <typename Receiver_>
+            get_operation_state(
+                Receiver_&& r, bounded_channel const* channel) noexcept
+              : waiter_type(&notify)
+              , r_(PIKA_FORWARD(Receiver_, r))
+              , channel_(channel)
             {
-                return false;
             }
 
-            if (val == nullptr)
+            get_operation_state(get_operation_state&&) = delete;
+            get_operation_state& operator=(get_operation_state&&) = delete;
+            get_operation_state(get_operation_state const&) = delete;
+            get_operation_state& operator=(
+                get_operation_state const&) = delete;
+
+            static void notify(waiter_type* w) noexcept
             {
-                return true;
+                static_cast<get_operation_state*>(w)->run();
             }
 
-            *val = PIKA_MOVE(buffer_[head]);
-            if (++head >= size_)
+            void run() noexcept
             {
-                head = 0;
+                try
+                {
+                    // T need not be default constructible
+                    std::optional<T> val;
+                    do
+                    {
+                        if (channel_->closed_.load(std::memory_order_acquire))
+                        {
+                            pika::execution::experimental::set_error(
+                                PIKA_MOVE(r_),
+                                PIKA_GET_EXCEPTION(pika::invalid_status,
+                                    "pika::lcos::local::bounded_channel::"
+                                    "async_get",
+                                    "the channel has been closed"));
+                            return;
+                        }
+
+                        if (channel_->try_get_impl(&val))
+                        {
+                            pika::execution::experimental::set_value(
+                                PIKA_MOVE(r_), PIKA_MOVE(*val));
+                            return;
+                        }
+                    } while (!channel_->wait_get(this));
+                }
+                catch (...)
+                {
+                    pika::execution::experimental::set_error(
+                        PIKA_MOVE(r_), std::current_exception());
+                }
             }
-            head_.data_ = head;
 
-            return true;
-        }
+            friend void tag_invoke(pika::execution::experimental::start_t,
+                get_operation_state& os) noexcept
+            {
+                os.run();
+            }
 
-        bool set(T&& t) noexcept
+            std::decay_t<Receiver> r_;
+            bounded_channel const* channel_;
+        };
+
+        template <typename Receiver>
+        struct set_operation_state : waiter_type
         {
-            std::unique_lock<mutex_type> l(mtx_.data_);
-            if (closed_)
+            template <typename Receiver_>
+            set_operation_state(
+                Receiver_&& r, bounded_channel* channel, T&& val) noexcept
+              : waiter_type(&notify)
+              , r_(PIKA_FORWARD(Receiver_, r))
+              , channel_(channel)
+              , val_(PIKA_MOVE(val))
             {
-                return false;
             }
 
-            std::size_t tail = tail_.data_;
+            set_operation_state(set_operation_state&&) = delete;
+            set_operation_state& operator=(set_operation_state&&) = delete;
+            set_operation_state(set_operation_state const&) = delete;
+            set_operation_state& operator=(
+                set_operation_state const&) = delete;
 
-            if (is_full(tail))
+            static void notify(waiter_type* w) noexcept
             {
-                return false;
+                static_cast<set_operation_state*>(w)->run();
+            }
+
+            void run() noexcept
+            {
+                try
+                {
+                    do
+                    {
+                        if (channel_->closed_.load(std::memory_order_acquire))
+                        {
+                            pika::execution::experimental::set_error(
+                                PIKA_MOVE(r_),
+                                PIKA_GET_EXCEPTION(pika::invalid_status,
+                                    "pika::lcos::local::bounded_channel::"
+                                    "async_set",
+                                    "the channel has been closed"));
+                            return;
+                        }
+
+                        if (channel_->try_set(PIKA_MOVE(val_)))
+                        {
+                            pika::execution::experimental::set_value(
+                                PIKA_MOVE(r_));
+                            return;
+                        }
+                    } while (!channel_->wait_set(this));
+                }
+                catch (...)
+                {
+                    pika::execution::experimental::set_error(
+                        PIKA_MOVE(r_), std::current_exception());
+                }
             }
 
-            buffer_[tail] = PIKA_MOVE(t);
-            if (++tail >= size_)
+            friend void tag_invoke(pika::execution::experimental::start_t,
+                set_operation_state& os) noexcept
             {
-                tail = 0;
+                os.run();
             }
-            tail_.data_ = tail;
 
+            std::decay_t<Receiver> r_;
+            bounded_channel* channel_;
+            T val_;
+        };
+
+        struct get_sender
+        {
+            bounded_channel const* channel_;
+
+            template <template <typename...> class Tuple,
+                template <typename...> class Variant>
+            using value_types = Variant<Tuple<T>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<std::exception_ptr>;
+
+            static constexpr bool sends_done = false;
+
+            template <typename Receiver>
+            friend get_operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t, get_sender s,
+                Receiver&& r)
+            {
+                return {PIKA_FORWARD(Receiver, r), s.channel_};
+            }
+        };
+
+        struct set_sender
+        {
+            bounded_channel* channel_;
+            T val_;
+
+            template <template <typename...> class Tuple,
+                template <typename...> class Variant>
+            using value_types = Variant<Tuple<>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<std::exception_ptr>;
+
+            static constexpr bool sends_done = false;
+
+            template <typename Receiver>
+            friend set_operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t, set_sender&& s,
+                Receiver&& r)
+            {
+                return {PIKA_FORWARD(Receiver, r), s.channel_,
+                    PIKA_MOVE(s.val_)};
+            }
+        };
+
+    public:
+        explicit bounded_channel(std::size_t size)
+          : size_(size)
+          , buffer_(new cell[size])
+          , closed_(false)
+        {
+            PIKA_ASSERT(size != 0);
+
+            while ((std::size_t(1) << shift_) < size_)
+            {
+                ++shift_;
+            }
+            mask_ = (std::size_t(1) << shift_) - 1;
+
+            for (std::size_t i = 0; i != size_; ++i)
+            {
+                buffer_[i].sequence_.store(
+                    write_sequence(i), std::memory_order_relaxed);
+            }
+        }
+
+        bounded_channel(bounded_channel&& rhs) noexcept
+          : size_(rhs.size_)
+          , shift_(rhs.shift_)
+          , mask_(rhs.mask_)
+          , buffer_(PIKA_MOVE(rhs.buffer_))
+        {
+            PIKA_ASSERT(rhs.get_waiters_.empty() && rhs.set_waiters_.empty());
+
+            head_.data_.store(rhs.head_.data_.load(std::memory_order_acquire),
+                std::memory_order_relaxed);
+            tail_.data_.store(rhs.tail_.data_.load(std::memory_order_acquire),
+                std::memory_order_relaxed);
+
+            closed_.store(rhs.closed_.load(std::memory_order_acquire),
+                std::memory_order_relaxed);
+            rhs.size_ = 0;
+            rhs.closed_.store(true, std::memory_order_release);
+        }
+
+        bounded_channel& operator=(bounded_channel&& rhs) noexcept
+        {
+            PIKA_ASSERT(rhs.get_waiters_.empty() && rhs.set_waiters_.empty());
+
+            clear();
+
+            head_.data_.store(rhs.head_.data_.load(std::memory_order_acquire),
+                std::memory_order_relaxed);
+            tail_.data_.store(rhs.tail_.data_.load(std::memory_order_acquire),
+                std::memory_order_relaxed);
+            size_ = rhs.size_;
+            shift_ = rhs.shift_;
+            mask_ = rhs.mask_;
+            buffer_ = PIKA_MOVE(rhs.buffer_);
+
+            closed_.store(rhs.closed_.load(std::memory_order_acquire),
+                std::memory_order_relaxed);
+            rhs.size_ = 0;
+            rhs.closed_.store(true, std::memory_order_release);
+            return *this;
+        }
+
+        // Operations started through async_get or async_set which are still
+        // waiting are failed with an error, as if the channel had been
+        // closed. No thread may be blocked in get or set anymore.
+        ~bounded_channel()
+        {
+            bool was_closed = false;
+            close_impl(was_closed);
+
+            pika::util::yield_while([this]() {
+                return pending_notifications_.load(
+                           std::memory_order_acquire) != 0;
+            });
+
+            clear();
+        }
+
+        // Moves the next element to *val without blocking. Returns false if
+        // the channel is empty or closed. If val is nullptr this only checks
+        // whether an element is available.
+        bool try_get(T* val = nullptr) const noexcept
+        {
+            return try_get_impl(val);
+        }
+
+        // Moves t into the channel without blocking. Returns false (leaving
+        // t untouched) if the channel is full or closed.
+        bool try_set(T&& t) noexcept
+        {
+            if (closed_.load(std::memory_order_acquire) || !push(PIKA_MOVE(t)))
+            {
+                return false;
+            }
+
+            notify_one(get_waiters_);
             return true;
         }
 
-        std::size_t close()
+        // Moves the next element to *val, suspending the calling thread while
+        // the channel is empty. Returns false if the channel is or gets
+        // closed. If val is nullptr this only waits for an element to become
+        // available.
+        bool get(T* val = nullptr) const
         {
-            std::unique_lock<mutex_type> l(mtx_.data_);
-            return close(l);
+            for (;;)
+            {
+                if (try_get(val))
+                {
+                    if (val == nullptr)
+                    {
+                        // the element is still there, pass the notification
+                        // on to somebody who may take it
+                        notify_one(get_waiters_);
+                    }
+                    return true;
+                }
+
+                if (closed_.load(std::memory_order_acquire))
+                {
+                    return false;
+                }
+
+                detail::bounded_channel_sync_waiter w;
+                if (wait_get(&w))
+                {
+                    w.ctx_.suspend("bounded_channel::get");
+                }
+            }
         }
 
-        std::size_t capacity() const
+        // Moves t into the channel, suspending the calling thread while the
+        // channel is full. Returns false if the channel is or gets closed.
+        bool set(T&& t)
         {
-            return size_ - 1;
+            for (;;)
+            {
+                if (try_set(PIKA_MOVE(t)))
+                {
+                    return true;
+                }
+
+                if (closed_.load(std::memory_order_acquire))
+                {
+                    return false;
+                }
+
+                detail::bounded_channel_sync_waiter w;
+                if (wait_set(&w))
+                {
+                    w.ctx_.suspend("bounded_channel::set");
+                }
+            }
         }
 
-    protected:
-        std::size_t close(std::unique_lock<mutex_type>& l)
+        // Returns a sender which sends the next element of the channel. The
+        // receiver is completed by the thread which makes an element
+        // available if the channel is empty when the operation is started. The
+        // sender sends an error if the channel is or gets closed. The channel
+        // must outlive the operation.
+        get_sender async_get() const noexcept
         {
-            PIKA_ASSERT_OWNS_LOCK(l);
+            return {this};
+        }
+
+        // Returns a sender which moves t into the channel. The receiver is
+        // completed by the thread which frees a slot if the channel is full
+        // when the operation is started. The sender sends an error if the
+        // channel is or gets closed. The channel must outlive the operation.
+        set_sender async_set(T t)
+        {
+            return {this, PIKA_MOVE(t)};
+        }
 
-            if (closed_)
+        // Closes the channel and wakes up all waiting operations. Returns the
+        // number of operations which were waiting.
+        std::size_t close()
+        {
+            bool was_closed = false;
+            std::size_t const count = close_impl(was_closed);
+            if (was_closed)
             {
-                l.unlock();
                 PIKA_THROW_EXCEPTION(pika::invalid_status,
                     "pika::lcos::local::bounded_channel::close",
                     "attempting to close an already closed channel");
             }
+            return count;
+        }
 
-            closed_ = true;
-            return 0;
+        std::size_t capacity() const
+        {
+            return size_;
         }
 
     private:
-        // keep the mutex, the head, and the tail pointer in separate cache
+        // Marks the channel as closed and notifies all waiting operations on
+        // the calling thread, one after the other. Returns the number of
+        // operations which were waiting, was_closed is set if the channel had
+        // been closed already.
+        std::size_t close_impl(bool& was_closed) noexcept
+        {
+            std::unique_lock<mutex_type> l(mtx_.data_);
+
+            if (closed_.load(std::memory_order_relaxed))
+            {
+                was_closed = true;
+                return 0;
+            }
+            closed_.store(true, std::memory_order_release);
+
+            waiter_type* waiters[] = {
+                get_waiters_.take_all(), set_waiters_.take_all()};
+            l.unlock();
+
+            std::size_t count = 0;
+            for (waiter_type* w : waiters)
+            {
+                while (w != nullptr)
+                {
+                    // the waiter may be gone once it has been notified
+                    waiter_type* next = w->next_;
+                    w->notify_(w);
+                    w = next;
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        template <typename U>
+        bool try_get_impl(U* val) const noexcept
+        {
+            if (closed_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            if (!pop(val))
+            {
+                return false;
+            }
+
+            if (val != nullptr)
+            {
+                notify_one(set_waiters_);
+            }
+            return true;
+        }
+
+        // destroys the elements left in the channel
+        void clear() noexcept
+        {
+            if (!buffer_)
+            {
+                return;
+            }
+
+            std::size_t const head =
+                head_.data_.load(std::memory_order_relaxed);
+            std::size_t const tail =
+                tail_.data_.load(std::memory_order_relaxed);
+            for (std::size_t pos = head; pos != tail; pos = next(pos))
+            {
+                buffer_[index(pos)].data().~T();
+            }
+        }
+
+        // keep the mutex, the head, and the tail index in separate cache
         // lines
         mutable pika::util::cache_aligned_data<mutex_type> mtx_;
-        mutable pika::util::cache_aligned_data<std::size_t> head_;
-        pika::util::cache_aligned_data<std::size_t> tail_;
+        mutable pika::util::cache_aligned_data<std::atomic<std::size_t>> head_;
+        pika::util::cache_aligned_data<std::atomic<std::size_t>> tail_;
+
+        // waiting operations, protected by mtx_
+        mutable waiter_list_type get_waiters_;
+        mutable waiter_list_type set_waiters_;
 
-        // a channel of size n can buffer n-1 items
         std::size_t size_;
 
+        // positions consist of a slot index in the lower shift_ bits and the
+        // lap in the remaining bits
+        std::size_t shift_ = 0;
+        std::size_t mask_ = 0;
+
         // channel buffer
-        std::unique_ptr<T[]> buffer_;
+        std::unique_ptr<cell[]> buffer_;
 
         // this channel was closed, i.e. no further operations are possible
-        bool closed_;
+        std::atomic<bool> closed_;
+
+        // number of notifications which have been deferred to a new thread
+        mutable std::atomic<std::size_t> pending_notifications_{0};
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -8,6 +8,9 @@
 #pragma once
 
 #include <pika/config.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
 #include <pika/synchronization/detail/counting_semaphore.hpp>
 #include <pika/synchronization/spinlock.hpp>
 #include <pika/timing/steady_clock.hpp>
@@ -15,6 +18,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <mutex>
+#include <type_traits>
 #include <utility>
 
 #if defined(PIKA_MSVC_WARNING_PRAGMA)
@@ -24,6 +28,76 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 namespace pika { namespace lcos { namespace local {
+    namespace detail {
+        // Sender returned by acquire_async and wait_async, sends no values once
+        // count credits have been acquired from the semaphore.
+        template <typename Mutex>
+        struct counting_semaphore_sender
+        {
+            counting_semaphore* sem;
+            Mutex* mtx;
+            std::ptrdiff_t count;
+
+            template <template <typename...> class Tuple,
+                template <typename...> class Variant>
+            using value_types = Variant<Tuple<>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<>;
+
+            static constexpr bool sends_done = false;
+
+            template <typename Receiver>
+            struct operation_state : counting_semaphore_waiter
+            {
+                counting_semaphore* sem;
+                Mutex* mtx;
+                std::decay_t<Receiver> receiver;
+
+                template <typename Receiver_>
+                operation_state(counting_semaphore* sem, Mutex* mtx,
+                    std::ptrdiff_t count, Receiver_&& receiver)
+                  : sem(sem)
+                  , mtx(mtx)
+                  , receiver(PIKA_FORWARD(Receiver_, receiver))
+                {
+                    this->count = count;
+                    this->complete = &operation_state::complete_waiter;
+                }
+
+                operation_state(operation_state&&) = delete;
+                operation_state& operator=(operation_state&&) = delete;
+                operation_state(operation_state const&) = delete;
+                operation_state& operator=(operation_state const&) = delete;
+
+                static void complete_waiter(
+                    counting_semaphore_waiter& w) noexcept
+                {
+                    pika::execution::experimental::set_value(
+                        PIKA_MOVE(static_cast<operation_state&>(w).receiver));
+                }
+
+                friend void tag_invoke(pika::execution::experimental::start_t,
+                    operation_state& os) noexcept
+                {
+                    if (os.sem->add_waiter(*os.mtx, os))
+                    {
+                        complete_waiter(os);
+                    }
+                }
+            };
+
+            template <typename Receiver>
+            friend operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t,
+                counting_semaphore_sender s, Receiver&& receiver)
+            {
+                return {
+                    s.sem, s.mtx, s.count, PIKA_FORWARD(Receiver, receiver)};
+            }
+        };
+    }    // namespace detail
+
     // A semaphore is a protected variable (an entity storing a value) or
     // abstract data type (an entity grouping several variables that may or
     // may not be numerical) which constitutes the classic method for
@@ -90,8 +164,7 @@ namespace pika { namespace lcos { namespace local {
         //                  types ([thread.mutex.requirements.mutex]).
         void release(std::ptrdiff_t update = 1)
         {
-            std::unique_lock<mutex_type> l(mtx_);
-            sem_.signal(PIKA_MOVE(l), update);
+            sem_.signal(mtx_, update);
         }
 
         // Effects:         Attempts to atomically decrement counter if it is
@@ -108,8 +181,7 @@ namespace pika { namespace lcos { namespace local {
         // Returns:         true if counter was decremented, otherwise false.
         bool try_acquire() noexcept
         {
-            std::unique_lock<mutex_type> l(mtx_);
-            return sem_.try_acquire(l);
+            return sem_.try_acquire();
         }
 
         // Effects:         Repeatedly performs the following steps, in order:
@@ -123,8 +195,18 @@ namespace pika { namespace lcos { namespace local {
         //                  types ([thread.mutex.requirements.mutex]).
         void acquire()
         {
-            std::unique_lock<mutex_type> l(mtx_);
-            sem_.wait(l, 1);
+            sem_.wait(mtx_, 1);
+        }
+
+        // Returns a sender which completes with set_value once it has
+        // decremented counter. The operation doesn't block, if counter is not
+        // positive when the sender is started, set_value is called by the
+        // thread releasing the semaphore. The semaphore has to stay alive
+        // until all started operations have completed.
+        auto acquire_async() noexcept
+        {
+            return detail::counting_semaphore_sender<mutex_type>{
+                &sem_, &mtx_, 1};
         }
 
         // Effects:         Repeatedly performs the following steps, in order:
@@ -145,8 +227,7 @@ namespace pika { namespace lcos { namespace local {
         //                  ([thread.mutex.requirements.mutex]).
         bool try_acquire_until(pika::chrono::steady_time_point const& abs_time)
         {
-            std::unique_lock<mutex_type> l(mtx_);
-            return sem_.wait_until(l, abs_time, 1);
+            return sem_.wait_until(mtx_, abs_time, 1);
         }
 
         bool try_acquire_for(pika::chrono::steady_duration const& rel_time)
@@ -212,8 +293,18 @@ namespace pika { namespace lcos { namespace local {
         //                 yielded.
         void wait(std::ptrdiff_t count = 1)
         {
-            std::unique_lock<mutex_type> l(this->mtx_);
-            this->sem_.wait(l, count);
+            this->sem_.wait(this->mtx_, count);
+        }
+
+        // \brief Returns a sender which completes once the given number of
+        //        credits has been acquired from the semaphore
+        //
+        // \param count    [in] The value by which the internal lock count will
+        //                 be decremented.
+        auto wait_async(std::ptrdiff_t count = 1) noexcept
+        {
+            return detail::counting_semaphore_sender<mutex_type>{
+                &this->sem_, &this->mtx_, count};
         }
 
         // \brief Try to wait for the semaphore to be signaled
@@ -229,21 +320,18 @@ namespace pika { namespace lcos { namespace local {
         //                 are available at this point in time.
         bool try_wait(std::ptrdiff_t count = 1)
         {
-            std::unique_lock<mutex_type> l(this->mtx_);
-            return this->sem_.try_wait(l, count);
+            return this->sem_.try_acquire(count);
         }
 
         /// \brief Signal the semaphore
         void signal(std::ptrdiff_t count = 1)
         {
-            std::unique_lock<mutex_type> l(this->mtx_);
-            this->sem_.signal(PIKA_MOVE(l), count);
+            this->sem_.signal(this->mtx_, count);
         }
 
         std::ptrdiff_t signal_all()
         {
-            std::unique_lock<mutex_type> l(this->mtx_);
-            return this->sem_.signal_all(PIKA_MOVE(l));
+            return this->sem_.signal_all(this->mtx_);
         }
     };
 
@@ -11,6 +11,7 @@
 #include <pika/synchronization/detail/condition_variable.hpp>
 #include <pika/synchronization/spinlock.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <mutex>
@@ -23,6 +24,19 @@
 ////////////////////////////////////////////////////////////////////////////////
 namespace pika { namespace lcos { namespace local { namespace detail {
 
+    // An asynchronous waiter, queued on the semaphore until it can acquire
+    // count credits. The waiter is completed by the thread which releases the
+    // credits, after the semaphore has been unlocked.
+    struct counting_semaphore_waiter
+    {
+        counting_semaphore_waiter* next = nullptr;
+        std::ptrdiff_t count = 1;
+        void (*complete)(counting_semaphore_waiter&) noexcept = nullptr;
+    };
+
+    // The credits are kept in an atomic word. Acquiring available credits and
+    // releasing credits while no thread waits don't lock the mutex passed to
+    // the functions, it is used only to protect the queues of waiters.
     class counting_semaphore
     {
     private:
@@ -32,26 +46,56 @@ namespace pika { namespace lcos { namespace local { namespace detail {
         PIKA_EXPORT counting_semaphore(std::ptrdiff_t value = 0);
         PIKA_EXPORT ~counting_semaphore();
 
-        PIKA_EXPORT void wait(
-            std::unique_lock<mutex_type>& l, std::ptrdiff_t count);
+        bool try_acquire(std::ptrdiff_t count = 1) noexcept
+        {
+            std::ptrdiff_t value = value_.load();
+            while (value >= count)
+            {
+                if (value_.compare_exchange_weak(value, value - count,
+                        std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        PIKA_EXPORT void wait(mutex_type& mtx, std::ptrdiff_t count);
 
-        PIKA_EXPORT bool wait_until(std::unique_lock<mutex_type>& l,
+        PIKA_EXPORT bool wait_until(mutex_type& mtx,
             pika::chrono::steady_time_point const& abs_time,
             std::ptrdiff_t count);
 
-        PIKA_EXPORT bool try_wait(
-            std::unique_lock<mutex_type>& l, std::ptrdiff_t count = 1);
+        // Returns true if the credits have been acquired right away, in which
+        // case the waiter is not queued.
+        PIKA_EXPORT bool add_waiter(
+            mutex_type& mtx, counting_semaphore_waiter& w) noexcept;
 
-        PIKA_EXPORT bool try_acquire(std::unique_lock<mutex_type>& l);
+        void signal(mutex_type& mtx, std::ptrdiff_t count)
+        {
+            value_.fetch_add(count);
+            if (waiters_.load() != 0)
+            {
+                signal_waiters(std::unique_lock<mutex_type>(mtx), count);
+            }
+        }
 
-        PIKA_EXPORT void signal(
+        PIKA_EXPORT std::ptrdiff_t signal_all(mutex_type& mtx);
+
+    private:
+        PIKA_EXPORT void signal_waiters(
             std::unique_lock<mutex_type> l, std::ptrdiff_t count);
 
-        PIKA_EXPORT std::ptrdiff_t signal_all(std::unique_lock<mutex_type> l);
+        // The number of waiters is updated while holding the mutex. A waiter
+        // increments it before checking the credits for the last time, which
+        // guarantees that a concurrent signal either finds the waiter or
+        // the waiter finds the released credits.
+        std::atomic<std::ptrdiff_t> value_;
+        std::atomic<std::size_t> waiters_;
 
-    private:
-        std::ptrdiff_t value_;
         local::detail::condition_variable cond_;
+        counting_semaphore_waiter* head_;
+        counting_semaphore_waiter* tail_;
     };
 }}}}    // namespace pika::lcos::local::detail
 
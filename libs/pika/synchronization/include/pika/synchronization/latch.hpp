@@ -10,6 +10,9 @@
 
 #include <pika/assert.hpp>
 #include <pika/concurrency/cache_line_data.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
 #include <pika/synchronization/detail/condition_variable.hpp>
 #include <pika/synchronization/spinlock.hpp>
 #include <pika/type_support/unused.hpp>
@@ -19,10 +22,47 @@
 #include <cstdint>
 #include <limits>
 #include <mutex>
+#include <type_traits>
 #include <utility>
 
 ///////////////////////////////////////////////////////////////////////////////
 namespace pika { namespace lcos { namespace local {
+    class cpp20_latch;
+
+    namespace detail {
+        // An asynchronous waiter, queued on the latch until its counter
+        // reaches zero.
+        struct latch_waiter
+        {
+            latch_waiter* next = nullptr;
+            void (*complete)(latch_waiter&) noexcept = nullptr;
+        };
+
+        template <typename Receiver>
+        struct latch_operation_state;
+
+        // Sender returned by cpp20_latch::wait_async, sends no values once
+        // the counter of the latch has reached zero.
+        struct latch_sender
+        {
+            cpp20_latch const* latch;
+
+            template <template <typename...> class Tuple,
+                template <typename...> class Variant>
+            using value_types = Variant<Tuple<>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<>;
+
+            static constexpr bool sends_done = false;
+
+            template <typename Receiver>
+            friend latch_operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t, latch_sender s,
+                Receiver&& receiver);
+        };
+    }    // namespace detail
+
     /// Latches are a thread coordination mechanism that allow one or more
     /// threads to block until an operation is completed. An individual latch
     /// is a singleuse object; once the operation has been completed, the latch
@@ -46,7 +86,9 @@ namespace pika { namespace lcos { namespace local {
           : mtx_()
           , cond_()
           , counter_(count)
+          , waiters_(0)
           , notified_(count == 0)
+          , head_(nullptr)
         {
         }
 
@@ -89,24 +131,27 @@ namespace pika { namespace lcos { namespace local {
         {
             PIKA_ASSERT(update >= 0);
 
+            // Decrements which leave counter_ above 0 don't need the lock.
+            // counter_ only reaches 0 while holding the lock, which keeps it
+            // consistent with notified_ for reset_if_needed_and_count_up.
+            std::ptrdiff_t old_count = counter_.load(std::memory_order_relaxed);
+            while (old_count > update)
+            {
+                if (counter_.compare_exchange_weak(old_count,
+                        old_count - update, std::memory_order_acq_rel))
+                {
+                    return;
+                }
+            }
+
+            std::unique_lock l(mtx_.data_);
+
             std::ptrdiff_t new_count = (counter_ -= update);
             PIKA_ASSERT(new_count >= 0);
 
             if (new_count == 0)
             {
-                std::unique_lock l(mtx_.data_);
-                notified_ = true;
-
-                // Note: we use notify_one repeatedly instead of notify_all as we
-                // know that our implementation of condition_variable::notify_one
-                // relinquishes the lock before resuming the waiting thread
-                // which avoids suspension of this thread when it tries to
-                // re-lock the mutex while exiting from condition_variable::wait
-                while (cond_.data_.notify_one(
-                    PIKA_MOVE(l), threads::thread_priority::boost))
-                {
-                    l = std::unique_lock(mtx_.data_);
-                }
+                notify_waiters(PIKA_MOVE(l));
             }
         }
 
@@ -125,14 +170,23 @@ namespace pika { namespace lcos { namespace local {
         ///
         void wait() const
         {
-            std::unique_lock l(mtx_.data_);
-            if (counter_.load(std::memory_order_relaxed) > 0 || !notified_)
+            if (counter_.load(std::memory_order_acquire) == 0)
             {
-                cond_.data_.wait(l, "pika::cpp20_latch::wait");
-
-                PIKA_ASSERT(counter_.load(std::memory_order_relaxed) == 0);
-                PIKA_ASSERT(notified_);
+                return;
             }
+
+            std::unique_lock l(mtx_.data_);
+            wait_locked(l, "pika::cpp20_latch::wait");
+        }
+
+        /// Returns a sender which completes with set_value once counter_ has
+        /// reached 0. The operation doesn't block, if counter_ is not 0 when
+        /// the sender is started, set_value is called by the thread which
+        /// decrements counter_ to 0. The latch has to stay alive until all
+        /// started operations have completed.
+        detail::latch_sender wait_async() const noexcept
+        {
+            return detail::latch_sender{this};
         }
 
         /// Effects: Equivalent to:
@@ -144,41 +198,163 @@ namespace pika { namespace lcos { namespace local {
 
             std::unique_lock l(mtx_.data_);
 
-            std::ptrdiff_t old_count =
-                counter_.fetch_sub(update, std::memory_order_relaxed);
+            std::ptrdiff_t old_count = counter_.fetch_sub(update);
             PIKA_ASSERT(old_count >= update);
 
             if (old_count > update)
             {
-                cond_.data_.wait(l, "pika::cpp20_latch::arrive_and_wait");
-
-                PIKA_ASSERT(counter_.load(std::memory_order_relaxed) == 0);
-                PIKA_ASSERT(notified_);
+                wait_locked(l, "pika::cpp20_latch::arrive_and_wait");
             }
             else
             {
-                notified_ = true;
-
-                // Note: we use notify_one repeatedly instead of notify_all as we
-                // know that our implementation of condition_variable::notify_one
-                // relinquishes the lock before resuming the waiting thread
-                // which avoids suspension of this thread when it tries to
-                // re-lock the mutex while exiting from condition_variable::wait
-                while (cond_.data_.notify_one(
-                    PIKA_MOVE(l), threads::thread_priority::boost))
-                {
-                    l = std::unique_lock(mtx_.data_);
-                }
+                notify_waiters(PIKA_MOVE(l));
             }
         }
 
     protected:
+        template <typename Receiver>
+        friend struct detail::latch_operation_state;
+
+        // The waiters are registered while holding the lock and counter_
+        // reaches 0 only while holding the lock, a waiter either finds
+        // counter_ at 0 or is notified. waiters_ allows skipping the
+        // notification if there are no waiters.
+        void wait_locked(
+            std::unique_lock<mutex_type>& l, char const* desc) const
+        {
+            waiters_.fetch_add(1);
+            if (counter_.load() > 0)
+            {
+                cond_.data_.wait(l, desc);
+                PIKA_ASSERT(notified_.load(std::memory_order_relaxed));
+            }
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Returns true if counter_ has reached 0 already, in which case the
+        // waiter is not queued.
+        bool add_waiter(detail::latch_waiter& w) const noexcept
+        {
+            if (counter_.load(std::memory_order_acquire) == 0)
+            {
+                return true;
+            }
+
+            std::unique_lock l(mtx_.data_);
+            waiters_.fetch_add(1);
+            if (counter_.load() == 0)
+            {
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            w.next = head_;
+            head_ = &w;
+            return false;
+        }
+
+        void notify_waiters(std::unique_lock<mutex_type> l)
+        {
+            if (waiters_.load(std::memory_order_relaxed) == 0)
+            {
+                notified_.store(true, std::memory_order_release);
+                return;
+            }
+            notify_waiters_locked(PIKA_MOVE(l));
+        }
+
+        void notify_waiters_locked(std::unique_lock<mutex_type> l)
+        {
+            notified_.store(true, std::memory_order_release);
+
+            // the asynchronous waiters are completed once the lock has been
+            // released
+            detail::latch_waiter* waiters = head_;
+            head_ = nullptr;
+            for (detail::latch_waiter* w = waiters; w != nullptr; w = w->next)
+            {
+                waiters_.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            // Note: we use notify_one repeatedly instead of notify_all as we
+            // know that our implementation of condition_variable::notify_one
+            // relinquishes the lock before resuming the waiting thread
+            // which avoids suspension of this thread when it tries to
+            // re-lock the mutex while exiting from condition_variable::wait
+            while (cond_.data_.notify_one(
+                PIKA_MOVE(l), threads::thread_priority::boost))
+            {
+                l = std::unique_lock(mtx_.data_);
+            }
+
+            while (waiters != nullptr)
+            {
+                detail::latch_waiter* next = waiters->next;
+                waiters->complete(*waiters);
+                waiters = next;
+            }
+        }
+
         mutable util::cache_line_data<mutex_type> mtx_;
         mutable util::cache_line_data<local::detail::condition_variable> cond_;
         std::atomic<std::ptrdiff_t> counter_;
-        bool notified_;
+        mutable std::atomic<std::size_t> waiters_;
+        std::atomic<bool> notified_;
+        mutable detail::latch_waiter* head_;
     };
 
+    namespace detail {
+        template <typename Receiver>
+        struct latch_operation_state : latch_waiter
+        {
+            cpp20_latch const* latch;
+            std::decay_t<Receiver> receiver;
+
+            template <typename Receiver_>
+            latch_operation_state(
+                cpp20_latch const* latch, Receiver_&& receiver)
+              : latch(latch)
+              , receiver(PIKA_FORWARD(Receiver_, receiver))
+            {
+                this->complete = &latch_operation_state::complete_waiter;
+            }
+
+            latch_operation_state(latch_operation_state&&) = delete;
+            latch_operation_state& operator=(latch_operation_state&&) = delete;
+            latch_operation_state(latch_operation_state const&) = delete;
+            latch_operation_state& operator=(
+                latch_operation_state const&) = delete;
+
+            static void complete_waiter(latch_waiter& w) noexcept
+            {
+                pika::execution::experimental::set_value(PIKA_MOVE(
+                    static_cast<latch_operation_state&>(w).receiver));
+            }
+
+            void start() noexcept
+            {
+                if (latch->add_waiter(*this))
+                {
+                    complete_waiter(*this);
+                }
+            }
+
+            friend void tag_invoke(pika::execution::experimental::start_t,
+                latch_operation_state& os) noexcept
+            {
+                os.start();
+            }
+        };
+
+        template <typename Receiver>
+        latch_operation_state<Receiver> tag_invoke(
+            pika::execution::experimental::connect_t, latch_sender s,
+            Receiver&& receiver)
+        {
+            return {s.latch, PIKA_FORWARD(Receiver, receiver)};
+        }
+    }    // namespace detail
+
     ///////////////////////////////////////////////////////////////////////////
     /// A latch maintains an internal counter_ that is initialized when the
     /// latch is created. Threads may block at a synchronization point waiting
@@ -285,7 +461,7 @@ namespace pika { namespace lcos { namespace local {
             PIKA_UNUSED(old_count);
 
             std::scoped_lock l(mtx_.data_);
-            notified_ = false;
+            notified_.store(false, std::memory_order_relaxed);
         }
 
         /// Effects: Equivalent to:
@@ -301,9 +477,9 @@ namespace pika { namespace lcos { namespace local {
 
             std::unique_lock l(mtx_.data_);
 
-            if (notified_)
+            if (notified_.load(std::memory_order_relaxed))
             {
-                notified_ = false;
+                notified_.store(false, std::memory_order_relaxed);
 
                 std::ptrdiff_t old_count =
                     counter_.fetch_add(n + count, std::memory_order_relaxed);
@@ -16,6 +16,10 @@
 #include <pika/synchronization/spinlock.hpp>
 #include <pika/timing/steady_clock.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
 namespace pika { namespace threads {
 
     using thread_id_ref_type = thread_id_ref;
@@ -33,6 +37,11 @@ namespace pika { namespace threads {
 
 namespace pika { namespace lcos { namespace local {
     ///////////////////////////////////////////////////////////////////////////
+    // The state of the mutex is kept in a single atomic word. Uncontended
+    // locking and unlocking take a single atomic operation. Contended lockers
+    // spin for a while (adapted to how long the mutex was held in the past)
+    // before suspending. Suspended lockers are queued and the mutex is handed
+    // directly to the first of them when it is unlocked.
     class mutex
     {
     public:
@@ -64,8 +73,31 @@ namespace pika { namespace lcos { namespace local {
         PIKA_EXPORT void unlock(error_code& ec = throws);
 
     protected:
+        enum state : std::uint8_t
+        {
+            unlocked = 0,
+            locked = 1,
+            locked_with_waiters = 2
+        };
+
+        bool try_lock_fast() noexcept
+        {
+            std::uint8_t expected = unlocked;
+            return state_.compare_exchange_strong(expected, locked,
+                std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        bool try_lock_spin() noexcept;
+        bool lock_slow(pika::chrono::steady_time_point const* abs_time,
+            error_code& ec);
+
+        std::atomic<std::uint8_t> state_;
+        std::atomic<std::uint16_t> spin_count_;
+        // thread_id::get() of the owning thread
+        std::atomic<void*> owner_id_;
+
+        // protects the queue of suspended lockers
         mutable mutex_type mtx_;
-        threads::thread_id_type owner_id_;
         lcos::local::detail::condition_variable cond_;
     };
 
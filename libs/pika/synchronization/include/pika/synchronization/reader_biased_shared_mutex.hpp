@@ -0,0 +1,116 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
+#include <pika/synchronization/detail/condition_variable.hpp>
+#include <pika/synchronization/mutex.hpp>
+#include <pika/synchronization/spinlock.hpp>
+#include <pika/threading_base/thread_num_tss.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace pika { namespace lcos { namespace local {
+    ///////////////////////////////////////////////////////////////////////////
+    // A reader-writer lock optimized for read-mostly workloads. Readers
+    // announce themselves in a counter which belongs to the worker thread
+    // they run on, taking a shared lock does not write to any cache line
+    // shared with readers on other worker threads. Writers are serialized by a
+    // mutex, block new readers and suspend until the readers which are already
+    // inside have left. Blocked readers are suspended until the writer unlocks
+    // the mutex. Taking an exclusive lock is expensive, this should be used
+    // only when writes are rare compared to reads.
+    class reader_biased_shared_mutex
+    {
+    public:
+        PIKA_NON_COPYABLE(reader_biased_shared_mutex);
+
+    private:
+        using mutex_type = lcos::local::spinlock;
+
+    public:
+        PIKA_EXPORT reader_biased_shared_mutex();
+        PIKA_EXPORT ~reader_biased_shared_mutex();
+
+        void lock_shared()
+        {
+            if (!try_lock_shared())
+            {
+                lock_shared_slow();
+            }
+        }
+
+        bool try_lock_shared()
+        {
+            // The increment has to be visible before the check of the writer
+            // flag. This pairs with the writer setting the flag before it
+            // looks at the reader counts.
+            std::atomic<std::int64_t>& readers = reader_count();
+            readers.fetch_add(1, std::memory_order_seq_cst);
+            if (PIKA_LIKELY(!writer_.load(std::memory_order_seq_cst)))
+            {
+                return true;
+            }
+
+            leave(readers);
+            return false;
+        }
+
+        void unlock_shared()
+        {
+            // The reader may have been moved to a different worker thread
+            // since it took the lock. Only the sum of all counters is
+            // meaningful, the individual counters may become negative.
+            leave(reader_count());
+        }
+
+        PIKA_EXPORT void lock();
+        PIKA_EXPORT bool try_lock();
+        PIKA_EXPORT void unlock();
+
+    private:
+        std::atomic<std::int64_t>& reader_count()
+        {
+            return reader_counts_[pika::get_worker_thread_num() %
+                num_reader_counts_]
+                .data_;
+        }
+
+        void leave(std::atomic<std::int64_t>& readers)
+        {
+            // A writer waiting for the readers to leave has to be woken up.
+            readers.fetch_sub(1, std::memory_order_seq_cst);
+            if (PIKA_UNLIKELY(writer_.load(std::memory_order_seq_cst)))
+            {
+                notify_writer();
+            }
+        }
+
+        PIKA_EXPORT void lock_shared_slow();
+        PIKA_EXPORT void notify_writer();
+        bool has_readers() const noexcept;
+        void release_readers();
+
+        std::size_t num_reader_counts_;
+        std::unique_ptr<util::cache_aligned_data<std::atomic<std::int64_t>>[]>
+            reader_counts_;
+        std::atomic<bool> writer_;
+
+        // serializes writers
+        lcos::local::mutex writer_mtx_;
+
+        // protects the queues of the readers waiting for a writer to finish
+        // and of the writer waiting for the readers to leave
+        mutable mutex_type mtx_;
+        lcos::local::detail::condition_variable reader_cond_;
+        lcos::local::detail::condition_variable writer_cond_;
+    };
+}}}    // namespace pika::lcos::local
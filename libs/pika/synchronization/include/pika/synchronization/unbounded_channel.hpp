@@ -0,0 +1,369 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
+#include <pika/modules/errors.hpp>
+#include <pika/synchronization/spinlock.hpp>
+#include <pika/threading_base/register_thread.hpp>
+#include <pika/threading_base/thread_helpers.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace pika { namespace lcos { namespace local {
+
+    namespace detail {
+        // A receive operation waiting for a value. The operation is removed
+        // from the list of waiting operations before it is completed.
+        template <typename T>
+        struct unbounded_channel_waiter
+        {
+            using set_value_type = void (*)(
+                unbounded_channel_waiter*, T&&) noexcept;
+            using set_error_type = void (*)(
+                unbounded_channel_waiter*, std::exception_ptr) noexcept;
+
+            unbounded_channel_waiter(
+                set_value_type set_value, set_error_type set_error) noexcept
+              : set_value_(set_value)
+              , set_error_(set_error)
+            {
+            }
+
+            unbounded_channel_waiter* next_ = nullptr;
+            set_value_type set_value_;
+            set_error_type set_error_;
+        };
+    }    // namespace detail
+
+    ////////////////////////////////////////////////////////////////////////////
+    // A channel with an unlimited buffer which is accessed through senders.
+    //
+    // send(v) hands the value to the oldest waiting receive operation or
+    // appends it to the buffer if nobody is waiting. receive() returns a
+    // sender which sends the oldest buffered value, or which waits for the
+    // next value sent if the buffer is empty. Waiting receive operations are
+    // linked into a list through their operation states, such that neither
+    // sending nor receiving a value allocates memory apart from growing the
+    // buffer (which allocates in chunks).
+    //
+    // Receive operations are completed on the thread which makes them
+    // possible. Their continuations may send or receive again, to bound the
+    // nesting the operation is completed on a new thread instead once the
+    // nesting depth exceeds PIKA_CONTINUATION_MAX_RECURSION_DEPTH, as for
+    // the continuations of futures.
+    //
+    // Closing the channel prevents further values from being sent. Values
+    // sent before the channel was closed can still be received. Receive
+    // operations which are waiting when the channel is closed, or which are
+    // started once the channel is closed and empty, send an error.
+    //
+    // The channel must outlive all operations started on it. It is neither
+    // copyable nor movable.
+    template <typename T, typename Mutex = pika::lcos::local::spinlock>
+    class unbounded_channel
+    {
+    private:
+        using mutex_type = Mutex;
+        using waiter_type = detail::unbounded_channel_waiter<T>;
+
+        template <typename Receiver>
+        struct receive_operation_state : waiter_type
+        {
+            template <typename Receiver_>
+            receive_operation_state(
+                Receiver_&& r, unbounded_channel* channel) noexcept
+              : waiter_type(&set_value, &set_error)
+              , r_(PIKA_FORWARD(Receiver_, r))
+              , channel_(channel)
+            {
+            }
+
+            receive_operation_state(receive_operation_state&&) = delete;
+            receive_operation_state& operator=(
+                receive_operation_state&&) = delete;
+            receive_operation_state(receive_operation_state const&) = delete;
+            receive_operation_state& operator=(
+                receive_operation_state const&) = delete;
+
+            static void set_value(waiter_type* w, T&& val) noexcept
+            {
+                auto* os = static_cast<receive_operation_state*>(w);
+                pika::execution::experimental::set_value(
+                    PIKA_MOVE(os->r_), PIKA_MOVE(val));
+            }
+
+            static void set_error(
+                waiter_type* w, std::exception_ptr e) noexcept
+            {
+                auto* os = static_cast<receive_operation_state*>(w);
+                pika::execution::experimental::set_error(
+                    PIKA_MOVE(os->r_), PIKA_MOVE(e));
+            }
+
+            void start() noexcept
+            {
+                channel_->start_receive(this);
+            }
+
+            friend void tag_invoke(pika::execution::experimental::start_t,
+                receive_operation_state& os) noexcept
+            {
+                os.start();
+            }
+
+            std::decay_t<Receiver> r_;
+            unbounded_channel* channel_;
+        };
+
+        struct receive_sender
+        {
+            unbounded_channel* channel_;
+
+            template <template <typename...> class Tuple,
+                template <typename...> class Variant>
+            using value_types = Variant<Tuple<T>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<std::exception_ptr>;
+
+            static constexpr bool sends_done = false;
+
+            template <typename Receiver>
+            friend receive_operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t, receive_sender s,
+                Receiver&& r)
+            {
+                return {PIKA_FORWARD(Receiver, r), s.channel_};
+            }
+        };
+
+    public:
+        unbounded_channel() = default;
+
+        unbounded_channel(unbounded_channel&&) = delete;
+        unbounded_channel& operator=(unbounded_channel&&) = delete;
+        unbounded_channel(unbounded_channel const&) = delete;
+        unbounded_channel& operator=(unbounded_channel const&) = delete;
+
+        ~unbounded_channel()
+        {
+            PIKA_ASSERT(head_ == nullptr);
+        }
+
+        // Sends val to the oldest waiting receive operation (completing it
+        // on the calling thread, see above) or buffers it if no operation is
+        // waiting. Throws if the channel has been closed.
+        void send(T val)
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+            if (closed_)
+            {
+                l.unlock();
+                PIKA_THROW_EXCEPTION(pika::invalid_status,
+                    "pika::lcos::local::unbounded_channel::send",
+                    "attempting to send to a closed channel");
+            }
+
+            if (head_ == nullptr)
+            {
+                buffer_.push_back(PIKA_MOVE(val));
+                return;
+            }
+
+            waiter_type* w = head_;
+            head_ = w->next_;
+            if (head_ == nullptr)
+            {
+                tail_ = nullptr;
+            }
+            l.unlock();
+
+            complete_value(w, PIKA_MOVE(val));
+        }
+
+        // Returns a sender which sends the next value of the channel. The
+        // sender completes on the thread calling send if it has to wait for
+        // the value.
+        receive_sender receive() noexcept
+        {
+            return {this};
+        }
+
+        // Closes the channel. Receive operations which are waiting for a
+        // value receive an error. Returns the number of these operations.
+        std::size_t close()
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+            if (closed_)
+            {
+                l.unlock();
+                PIKA_THROW_EXCEPTION(pika::invalid_status,
+                    "pika::lcos::local::unbounded_channel::close",
+                    "attempting to close an already closed channel");
+            }
+
+            closed_ = true;
+
+            waiter_type* w = head_;
+            head_ = nullptr;
+            tail_ = nullptr;
+            l.unlock();
+
+            if (w == nullptr)
+            {
+                return 0;
+            }
+
+            std::exception_ptr e =
+                PIKA_GET_EXCEPTION(pika::future_cancelled, pika::lightweight,
+                    "pika::lcos::local::unbounded_channel::close",
+                    "canceled waiting on this entry");
+
+            std::size_t count = 0;
+            while (w != nullptr)
+            {
+                // the operation may be gone once it has been completed
+                waiter_type* next = w->next_;
+                complete_error(w, e);
+                w = next;
+                ++count;
+            }
+            return count;
+        }
+
+        // Returns the number of buffered values.
+        std::size_t size() const
+        {
+            std::lock_guard<mutex_type> l(mtx_);
+            return buffer_.size();
+        }
+
+    private:
+        void start_receive(waiter_type* w) noexcept
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+            if (!buffer_.empty())
+            {
+                try
+                {
+                    T val = PIKA_MOVE(buffer_.front());
+                    buffer_.pop_front();
+                    l.unlock();
+
+                    complete_value(w, PIKA_MOVE(val));
+                }
+                catch (...)
+                {
+                    if (l.owns_lock())
+                    {
+                        l.unlock();
+                    }
+                    complete_error(w, std::current_exception());
+                }
+                return;
+            }
+
+            if (closed_)
+            {
+                l.unlock();
+                complete_error(w,
+                    PIKA_GET_EXCEPTION(pika::invalid_status,
+                        "pika::lcos::local::unbounded_channel::receive",
+                        "this channel is empty and was closed"));
+                return;
+            }
+
+            w->next_ = nullptr;
+            if (tail_ == nullptr)
+            {
+                head_ = w;
+            }
+            else
+            {
+                tail_->next_ = w;
+            }
+            tail_ = w;
+        }
+
+        static void complete_value(waiter_type* w, T&& val) noexcept
+        {
+            std::size_t& depth =
+                pika::threads::get_continuation_recursion_count();
+            if (depth < PIKA_CONTINUATION_MAX_RECURSION_DEPTH)
+            {
+                ++depth;
+                w->set_value_(w, PIKA_MOVE(val));
+                --depth;
+                return;
+            }
+
+            try
+            {
+                threads::thread_init_data data(
+                    threads::make_thread_function_nullary(
+                        [w, val = PIKA_MOVE(val)]() mutable {
+                            w->set_value_(w, PIKA_MOVE(val));
+                        }),
+                    "pika::lcos::local::unbounded_channel::complete_value");
+                threads::register_work(data);
+            }
+            catch (...)
+            {
+                // no new thread could be created, the value may be gone
+                w->set_error_(w, std::current_exception());
+            }
+        }
+
+        static void complete_error(
+            waiter_type* w, std::exception_ptr e) noexcept
+        {
+            std::size_t& depth =
+                pika::threads::get_continuation_recursion_count();
+            if (depth < PIKA_CONTINUATION_MAX_RECURSION_DEPTH)
+            {
+                ++depth;
+                w->set_error_(w, PIKA_MOVE(e));
+                --depth;
+                return;
+            }
+
+            try
+            {
+                threads::thread_init_data data(
+                    threads::make_thread_function_nullary([w, e]() {
+                        w->set_error_(w, e);
+                    }),
+                    "pika::lcos::local::unbounded_channel::complete_error");
+                threads::register_work(data);
+            }
+            catch (...)
+            {
+                // no new thread could be created, complete on this thread
+                w->set_error_(w, PIKA_MOVE(e));
+            }
+        }
+
+        mutable mutex_type mtx_;
+        std::deque<T> buffer_;
+
+        // waiting receive operations, oldest first
+        waiter_type* head_ = nullptr;
+        waiter_type* tail_ = nullptr;
+
+        bool closed_ = false;
+    };
+}}}    // namespace pika::lcos::local
@@ -12,6 +12,7 @@
 #include <pika/synchronization/spinlock.hpp>
 #include <pika/thread_support/assert_owns_lock.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <mutex>
@@ -22,79 +23,129 @@ namespace pika { namespace lcos { namespace local { namespace detail {
 
     counting_semaphore::counting_semaphore(std::ptrdiff_t value)
       : value_(value)
+      , waiters_(0)
+      , head_(nullptr)
+      , tail_(nullptr)
     {
     }
 
-    counting_semaphore::~counting_semaphore() = default;
+    counting_semaphore::~counting_semaphore()
+    {
+        PIKA_ASSERT(head_ == nullptr);
+    }
 
-    void counting_semaphore::wait(
-        std::unique_lock<mutex_type>& l, std::ptrdiff_t count)
+    void counting_semaphore::wait(mutex_type& mtx, std::ptrdiff_t count)
     {
-        PIKA_ASSERT_OWNS_LOCK(l);
+        if (try_acquire(count))
+        {
+            return;
+        }
+
+        std::unique_lock<mutex_type> l(mtx);
+        waiters_.fetch_add(1);
 
-        while (value_ < count)
+        while (!try_acquire(count))
         {
             cond_.wait(l, "counting_semaphore::wait");
         }
-        value_ -= count;
+
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
     }
 
-    bool counting_semaphore::wait_until(std::unique_lock<mutex_type>& l,
+    bool counting_semaphore::wait_until(mutex_type& mtx,
         pika::chrono::steady_time_point const& abs_time, std::ptrdiff_t count)
     {
-        PIKA_ASSERT_OWNS_LOCK(l);
+        if (try_acquire(count))
+        {
+            return true;
+        }
 
-        while (value_ < count)
+        std::unique_lock<mutex_type> l(mtx);
+        waiters_.fetch_add(1);
+
+        bool acquired = true;
+        while (!try_acquire(count))
         {
             // return false if unblocked by timeout expiring
             if (cond_.wait_until(
                     l, abs_time, "counting_semaphore::wait_until") !=
                 threads::thread_restart_state::unknown)
             {
-                return false;
+                acquired = false;
+                break;
             }
         }
-        value_ -= count;
-        return true;
+
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return acquired;
     }
 
-    bool counting_semaphore::try_wait(
-        std::unique_lock<mutex_type>& l, std::ptrdiff_t count)
+    bool counting_semaphore::add_waiter(
+        mutex_type& mtx, counting_semaphore_waiter& w) noexcept
     {
-        PIKA_ASSERT_OWNS_LOCK(l);
-
-        if (!(value_ < count))
+        if (try_acquire(w.count))
         {
-            // enter wait_locked only if there are sufficient credits
-            // available
-            wait(l, count);
             return true;
         }
-        return false;
-    }
 
-    bool counting_semaphore::try_acquire(std::unique_lock<mutex_type>& l)
-    {
-        PIKA_ASSERT_OWNS_LOCK(l);
+        std::unique_lock<mutex_type> l(mtx);
+        waiters_.fetch_add(1);
 
-        if (value_ >= 1)
+        if (try_acquire(w.count))
         {
-            --value_;
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
             return true;
         }
+
+        w.next = nullptr;
+        if (tail_ == nullptr)
+        {
+            head_ = &w;
+        }
+        else
+        {
+            tail_->next = &w;
+        }
+        tail_ = &w;
         return false;
     }
 
-    void counting_semaphore::signal(
+    void counting_semaphore::signal_waiters(
         std::unique_lock<mutex_type> l, std::ptrdiff_t count)
     {
         PIKA_ASSERT_OWNS_LOCK(l);
 
         mutex_type* mtx = l.mutex();
 
+        // hand the credits to the asynchronous waiters in the order they
+        // have been queued, they are completed once the lock is released
+        counting_semaphore_waiter* ready = nullptr;
+        counting_semaphore_waiter* ready_tail = nullptr;
+        while (head_ != nullptr && try_acquire(head_->count))
+        {
+            counting_semaphore_waiter* w = head_;
+            head_ = w->next;
+            if (head_ == nullptr)
+            {
+                tail_ = nullptr;
+            }
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+
+            w->next = nullptr;
+            if (ready_tail == nullptr)
+            {
+                ready = w;
+            }
+            else
+            {
+                ready_tail->next = w;
+            }
+            ready_tail = w;
+        }
+
         // release no more threads than we get resources
-        value_ += count;
-        for (std::int64_t i = 0; value_ >= 0 && i < count; ++i)
+        for (std::int64_t i = 0;
+             value_.load(std::memory_order_relaxed) > 0 && i < count; ++i)
         {
             // notify_one() returns false if no more threads are
             // waiting
@@ -103,15 +154,29 @@ namespace pika { namespace lcos { namespace local { namespace detail {
 
             l = std::unique_lock<mutex_type>(*mtx);
         }
+
+        if (l.owns_lock())
+        {
+            l.unlock();
+        }
+
+        while (ready != nullptr)
+        {
+            counting_semaphore_waiter* next = ready->next;
+            ready->complete(*ready);
+            ready = next;
+        }
     }
 
-    std::ptrdiff_t counting_semaphore::signal_all(
-        std::unique_lock<mutex_type> l)
+    std::ptrdiff_t counting_semaphore::signal_all(mutex_type& mtx)
     {
-        PIKA_ASSERT_OWNS_LOCK(l);
+        std::unique_lock<mutex_type> l(mtx);
 
-        std::ptrdiff_t count = static_cast<std::ptrdiff_t>(cond_.size(l));
-        signal(PIKA_MOVE(l), count);
+        // all waiters are registered while holding the lock
+        std::ptrdiff_t count = static_cast<std::ptrdiff_t>(
+            waiters_.load(std::memory_order_relaxed));
+        value_.fetch_add(count);
+        signal_waiters(PIKA_MOVE(l), count);
         return count;
     }
 }}}}    // namespace pika::lcos::local::detail
@@ -18,13 +18,18 @@
 #include <pika/timing/steady_clock.hpp>
 #include <pika/type_support/unused.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <utility>
 
 namespace pika { namespace lcos { namespace local {
     ///////////////////////////////////////////////////////////////////////////
     mutex::mutex(char const* const description)
-      : owner_id_(threads::invalid_thread_id)
+      : state_(unlocked)
+      , spin_count_(0)
+      , owner_id_(nullptr)
     {
         PIKA_ITT_SYNC_CREATE(this, "lcos::local::mutex", description);
         PIKA_ITT_SYNC_RENAME(this, "lcos::local::mutex");
@@ -35,27 +40,99 @@ namespace pika { namespace lcos { namespace local {
         PIKA_ITT_SYNC_DESTROY(this);
     }
 
-    void mutex::lock(char const* description, error_code& ec)
+    // Spin while the mutex is held by a thread and nobody is suspended on it.
+    // The number of iterations is bounded by twice the (moving) average of the
+    // iterations needed to acquire the mutex in the past.
+    bool mutex::try_lock_spin() noexcept
     {
-        PIKA_ASSERT(threads::get_self_ptr() != nullptr);
+        std::int32_t const spin_count =
+            spin_count_.load(std::memory_order_relaxed);
+        std::int32_t const max_spins = (std::min)(
+            std::int32_t(PIKA_MUTEX_MAX_SPIN_COUNT), 2 * spin_count + 10);
+
+        std::int32_t k = 0;
+        bool acquired = false;
+        for (/**/; k < max_spins; ++k)
+        {
+            std::uint8_t s = state_.load(std::memory_order_relaxed);
+            if (s == unlocked)
+            {
+                if (state_.compare_exchange_weak(s, locked,
+                        std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    acquired = true;
+                    break;
+                }
+            }
+            else if (s == locked_with_waiters)
+            {
+                // the mutex will be handed to one of the suspended threads
+                return false;
+            }
+            PIKA_SMT_PAUSE;
+        }
 
-        PIKA_ITT_SYNC_PREPARE(this);
+        if (max_spins > 0)
+        {
+            spin_count_.store(
+                std::uint16_t(spin_count + (k - spin_count) / 8),
+                std::memory_order_relaxed);
+        }
+        return acquired;
+    }
+
+    // Suspend until the mutex is handed over to this thread. Returns false if
+    // the mutex could not be acquired before abs_time (if given).
+    bool mutex::lock_slow(
+        pika::chrono::steady_time_point const* abs_time, error_code& ec)
+    {
         std::unique_lock<mutex_type> l(mtx_);
 
-        threads::thread_id_type self_id = threads::get_self_id();
-        if (owner_id_ == self_id)
+        // Announce the waiter before suspending, the thread unlocking the
+        // mutex will then hand it over instead of releasing it.
+        while (state_.exchange(locked_with_waiters,
+                   std::memory_order_acquire) != unlocked)
         {
-            PIKA_ITT_SYNC_CANCEL(this);
-            l.unlock();
-            PIKA_THROWS_IF(ec, deadlock, description,
-                "The calling thread already owns the mutex");
-            return;
+            if (abs_time != nullptr &&
+                abs_time->value() <= pika::chrono::steady_clock::now())
+            {
+                return false;
+            }
+
+            threads::thread_restart_state const reason =
+                abs_time != nullptr ? cond_.wait_until(l, *abs_time, ec) :
+                                      cond_.wait(l, ec);
+            if (ec)
+            {
+                return false;
+            }
+
+            // the unlocking thread has passed the ownership to this thread
+            if (reason == threads::thread_restart_state::signaled)
+            {
+                break;
+            }
         }
+        return true;
+    }
 
-        while (owner_id_ != threads::invalid_thread_id)
+    void mutex::lock(char const* description, error_code& ec)
+    {
+        PIKA_ASSERT(threads::get_self_ptr() != nullptr);
+
+        PIKA_ITT_SYNC_PREPARE(this);
+        threads::thread_id_type self_id = threads::get_self_id();
+        if (!try_lock_fast())
         {
-            cond_.wait(l, ec);
-            if (ec)
+            if (owner_id_.load(std::memory_order_relaxed) == self_id.get())
+            {
+                PIKA_ITT_SYNC_CANCEL(this);
+                PIKA_THROWS_IF(ec, deadlock, description,
+                    "The calling thread already owns the mutex");
+                return;
+            }
+
+            if (!try_lock_spin() && !lock_slow(nullptr, ec))
             {
                 PIKA_ITT_SYNC_CANCEL(this);
                 return;
@@ -64,7 +141,7 @@ namespace pika { namespace lcos { namespace local {
 
         util::register_lock(this);
         PIKA_ITT_SYNC_ACQUIRED(this);
-        owner_id_ = self_id;
+        owner_id_.store(self_id.get(), std::memory_order_relaxed);
     }
 
     bool mutex::try_lock(char const* /* description */, error_code& /* ec */)
@@ -72,18 +149,16 @@ namespace pika { namespace lcos { namespace local {
         PIKA_ASSERT(threads::get_self_ptr() != nullptr);
 
         PIKA_ITT_SYNC_PREPARE(this);
-        std::unique_lock<mutex_type> l(mtx_);
-
-        if (owner_id_ != threads::invalid_thread_id)
+        if (!try_lock_fast())
         {
             PIKA_ITT_SYNC_CANCEL(this);
             return false;
         }
 
-        threads::thread_id_type self_id = threads::get_self_id();
         util::register_lock(this);
         PIKA_ITT_SYNC_ACQUIRED(this);
-        owner_id_ = self_id;
+        owner_id_.store(
+            threads::get_self_id().get(), std::memory_order_relaxed);
         return true;
     }
 
@@ -92,21 +167,34 @@ namespace pika { namespace lcos { namespace local {
         PIKA_ASSERT(threads::get_self_ptr() != nullptr);
 
         PIKA_ITT_SYNC_RELEASING(this);
-        // Unregister lock early as the lock guard below may suspend.
-        util::unregister_lock(this);
-        std::unique_lock<mutex_type> l(mtx_);
-
-        threads::thread_id_type self_id = threads::get_self_id();
-        if (PIKA_UNLIKELY(owner_id_ != self_id))
+        if (PIKA_UNLIKELY(owner_id_.load(std::memory_order_relaxed) !=
+                threads::get_self_id().get()))
         {
-            l.unlock();
             PIKA_THROWS_IF(ec, lock_error, "mutex::unlock",
                 "The calling thread does not own the mutex");
             return;
         }
 
+        // Unregister lock early as the lock guard below may suspend.
+        util::unregister_lock(this);
+        owner_id_.store(nullptr, std::memory_order_relaxed);
         PIKA_ITT_SYNC_RELEASED(this);
-        owner_id_ = threads::invalid_thread_id;
+
+        std::uint8_t expected = locked;
+        if (state_.compare_exchange_strong(expected, unlocked,
+                std::memory_order_release, std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        // There may be suspended threads, hand the mutex over to the first of
+        // them without releasing it.
+        std::unique_lock<mutex_type> l(mtx_);
+        if (cond_.empty(l))
+        {
+            state_.store(unlocked, std::memory_order_release);
+            return;
+        }
 
         {
             util::ignore_while_checking il(&l);
@@ -131,35 +219,16 @@ namespace pika { namespace lcos { namespace local {
         PIKA_ASSERT(threads::get_self_ptr() != nullptr);
 
         PIKA_ITT_SYNC_PREPARE(this);
-        std::unique_lock<mutex_type> l(mtx_);
-
         threads::thread_id_type self_id = threads::get_self_id();
-        if (owner_id_ != threads::invalid_thread_id)
+        if (!try_lock_fast() && !try_lock_spin() && !lock_slow(&abs_time, ec))
         {
-            threads::thread_restart_state const reason =
-                cond_.wait_until(l, abs_time, ec);
-            if (ec)
-            {
-                PIKA_ITT_SYNC_CANCEL(this);
-                return false;
-            }
-
-            if (reason == threads::thread_restart_state::timeout)    //-V110
-            {
-                PIKA_ITT_SYNC_CANCEL(this);
-                return false;
-            }
-
-            if (owner_id_ != threads::invalid_thread_id)    //-V110
-            {
-                PIKA_ITT_SYNC_CANCEL(this);
-                return false;
-            }
+            PIKA_ITT_SYNC_CANCEL(this);
+            return false;
         }
 
         util::register_lock(this);
         PIKA_ITT_SYNC_ACQUIRED(this);
-        owner_id_ = self_id;
+        owner_id_.store(self_id.get(), std::memory_order_relaxed);
         return true;
     }
 }}}    // namespace pika::lcos::local
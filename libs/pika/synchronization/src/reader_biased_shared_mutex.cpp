@@ -0,0 +1,119 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
+#include <pika/lock_registration/detail/register_locks.hpp>
+#include <pika/synchronization/mutex.hpp>
+#include <pika/synchronization/reader_biased_shared_mutex.hpp>
+#include <pika/topology/topology.hpp>
+#include <pika/type_support/unused.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace pika { namespace lcos { namespace local {
+    ///////////////////////////////////////////////////////////////////////////
+    reader_biased_shared_mutex::reader_biased_shared_mutex()
+      : num_reader_counts_(
+            (std::max)(threads::detail::hardware_concurrency(), 1u))
+      , reader_counts_(new util::cache_aligned_data<
+            std::atomic<std::int64_t>>[num_reader_counts_])
+      , writer_(false)
+    {
+        for (std::size_t i = 0; i != num_reader_counts_; ++i)
+        {
+            reader_counts_[i].data_.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    reader_biased_shared_mutex::~reader_biased_shared_mutex() = default;
+
+    bool reader_biased_shared_mutex::has_readers() const noexcept
+    {
+        std::int64_t readers = 0;
+        for (std::size_t i = 0; i != num_reader_counts_; ++i)
+        {
+            readers += reader_counts_[i].data_.load(std::memory_order_seq_cst);
+        }
+        return readers != 0;
+    }
+
+    void reader_biased_shared_mutex::lock_shared_slow()
+    {
+        do
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+            while (writer_.load(std::memory_order_acquire))
+            {
+                reader_cond_.wait(l);
+            }
+        } while (!try_lock_shared());
+    }
+
+    void reader_biased_shared_mutex::notify_writer()
+    {
+        std::unique_lock<mutex_type> l(mtx_);
+        writer_cond_.notify_one(PIKA_MOVE(l));
+    }
+
+    void reader_biased_shared_mutex::lock()
+    {
+        std::unique_lock<lcos::local::mutex> wl(writer_mtx_);
+        {
+            std::unique_lock<mutex_type> l(mtx_);
+
+            // New readers see the flag and wait, readers leaving see the flag
+            // and wake this thread up.
+            writer_.store(true, std::memory_order_seq_cst);
+
+            util::ignore_while_checking il(&wl);
+            PIKA_UNUSED(il);
+
+            while (has_readers())
+            {
+                writer_cond_.wait(l);
+            }
+        }
+        wl.release();
+    }
+
+    bool reader_biased_shared_mutex::try_lock()
+    {
+        std::unique_lock<lcos::local::mutex> wl(writer_mtx_, std::try_to_lock);
+        if (!wl.owns_lock())
+        {
+            return false;
+        }
+
+        writer_.store(true, std::memory_order_seq_cst);
+        if (has_readers())
+        {
+            release_readers();
+            return false;
+        }
+
+        wl.release();
+        return true;
+    }
+
+    void reader_biased_shared_mutex::unlock()
+    {
+        release_readers();
+        writer_mtx_.unlock();
+    }
+
+    void reader_biased_shared_mutex::release_readers()
+    {
+        std::unique_lock<mutex_type> l(mtx_);
+        writer_.store(false, std::memory_order_seq_cst);
+        reader_cond_.notify_all(PIKA_MOVE(l));
+    }
+}}}    // namespace pika::lcos::local
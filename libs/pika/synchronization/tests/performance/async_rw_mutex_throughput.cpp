@@ -0,0 +1,141 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the overhead of accessing a value through an
+// async_rw_mutex. All accesses complete inline, i.e. the numbers contain only
+// the cost of retrieving the senders from the mutex and of handing the value
+// from one access to the next.
+//
+// - readwrite: a sequence of read-write accesses, each one is started once
+//   the previous one has released the value.
+// - generations: read-write accesses each followed by a number of read-only
+//   accesses. All accesses of a batch of generations are started while the
+//   value is held, such that they are queued on the mutex, and are released
+//   by the access which holds the value.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/synchronization/async_rw_mutex.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::experimental::async_rw_mutex;
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+void report(char const* name, std::size_t accesses, std::uint64_t start)
+{
+    double const elapsed = static_cast<double>(
+                               pika::chrono::high_resolution_clock::now() -
+                               start) /
+        1e9;
+
+    std::cout << name << ": " << (accesses / elapsed) << " [op/s] ("
+              << (elapsed / accesses) << " [s/op])\n";
+}
+
+void test_readwrite(std::size_t num_accesses)
+{
+    async_rw_mutex<std::size_t> rwm{0};
+
+    std::uint64_t start = pika::chrono::high_resolution_clock::now();
+
+    for (std::size_t i = 0; i != num_accesses; ++i)
+    {
+        ex::start_detached(rwm.readwrite() | ex::then([](auto&& access) {
+            ++static_cast<std::size_t&>(access);
+        }));
+    }
+
+    report("readwrite", num_accesses, start);
+
+    if (tt::sync_wait(rwm.readwrite()).get() != num_accesses)
+    {
+        std::cout << "Error!\n";
+    }
+}
+
+void test_generations(std::size_t num_accesses, std::size_t num_readers,
+    std::size_t batch_size)
+{
+    async_rw_mutex<std::size_t> rwm{0};
+
+    std::size_t const num_batches =
+        num_accesses / ((num_readers + 1) * batch_size);
+    std::size_t sum = 0;
+
+    std::uint64_t start = pika::chrono::high_resolution_clock::now();
+
+    for (std::size_t i = 0; i != num_batches; ++i)
+    {
+        // hold the value until all accesses of this batch have been started,
+        // they are released when the gate goes out of scope
+        auto gate = tt::sync_wait(rwm.readwrite());
+
+        for (std::size_t b = 0; b != batch_size; ++b)
+        {
+            ex::start_detached(rwm.readwrite() | ex::then([](auto&& access) {
+                ++static_cast<std::size_t&>(access);
+            }));
+            for (std::size_t r = 0; r != num_readers; ++r)
+            {
+                ex::start_detached(
+                    rwm.read() | ex::then([&sum](auto&& access) {
+                        sum += static_cast<std::size_t const&>(access);
+                    }));
+            }
+        }
+    }
+
+    report("generations", num_batches * batch_size * (num_readers + 1), start);
+
+    if (tt::sync_wait(rwm.readwrite()).get() != num_batches * batch_size ||
+        sum == 0)
+    {
+        std::cout << "Error!\n";
+    }
+}
+
+int pika_main(variables_map& vm)
+{
+    std::size_t const num_accesses = vm["accesses"].as<std::size_t>();
+    std::size_t const num_readers = vm["readers"].as<std::size_t>();
+    std::size_t const batch_size = vm["batch-size"].as<std::size_t>();
+
+    test_readwrite(num_accesses);
+    test_generations(num_accesses, num_readers, batch_size);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("accesses", value<std::size_t>()->default_value(1000000),
+         "number of accesses to the mutex")
+        ("readers", value<std::size_t>()->default_value(4),
+         "number of read-only accesses following each read-write access")
+        ("batch-size", value<std::size_t>()->default_value(8),
+         "number of generations queued on the mutex at a time");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
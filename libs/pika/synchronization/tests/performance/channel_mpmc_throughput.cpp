@@ -6,6 +6,7 @@
 
 //  This work is inspired by https://github.com/aprell/tasking-2.0
 
+#include <pika/execution.hpp>
 #include <pika/future.hpp>
 #include <pika/init.hpp>
 #include <pika/modules/timing.hpp>
@@ -16,6 +17,7 @@
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <utility>
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -38,33 +40,72 @@ constexpr int NUM_TESTS = 100000000;
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
-inline data channel_get(pika::lcos::local::channel_mpmc<data> const& c)
+// The channel is accessed either through the non-blocking operations (yielding
+// while the channel is empty or full), through the blocking operations, or
+// through the senders.
+enum class access_mode
+{
+    try_get_set,
+    get_set,
+    async_get_set,
+};
+
+inline data channel_get(
+    pika::lcos::local::channel_mpmc<data> const& c, access_mode mode)
 {
     data result;
-    while (!c.get(&result))
+    switch (mode)
     {
-        pika::this_thread::yield();
+    case access_mode::try_get_set:
+        while (!c.try_get(&result))
+        {
+            pika::this_thread::yield();
+        }
+        break;
+
+    case access_mode::get_set:
+        c.get(&result);
+        break;
+
+    case access_mode::async_get_set:
+        result = pika::this_thread::experimental::sync_wait(c.async_get());
+        break;
     }
     return result;
 }
 
-inline void channel_set(pika::lcos::local::channel_mpmc<data>& c, data&& val)
+inline void channel_set(
+    pika::lcos::local::channel_mpmc<data>& c, data&& val, access_mode mode)
 {
-    while (!c.set(std::move(val)))    // NOLINT
+    switch (mode)
     {
-        pika::this_thread::yield();
+    case access_mode::try_get_set:
+        while (!c.try_set(std::move(val)))    // NOLINT
+        {
+            pika::this_thread::yield();
+        }
+        break;
+
+    case access_mode::get_set:
+        c.set(std::move(val));
+        break;
+
+    case access_mode::async_get_set:
+        pika::this_thread::experimental::sync_wait(
+            c.async_set(std::move(val)));
+        break;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // Produce
-double thread_func_0(pika::lcos::local::channel_mpmc<data>& c)
+double thread_func_0(pika::lcos::local::channel_mpmc<data>& c, access_mode mode)
 {
     std::uint64_t start = pika::chrono::high_resolution_clock::now();
 
     for (int i = 0; i != NUM_TESTS; ++i)
     {
-        channel_set(c, data{i});
+        channel_set(c, data{i}, mode);
     }
 
     std::uint64_t end = pika::chrono::high_resolution_clock::now();
@@ -73,13 +114,13 @@ double thread_func_0(pika::lcos::local::channel_mpmc<data>& c)
 }
 
 // Consume
-double thread_func_1(pika::lcos::local::channel_mpmc<data>& c)
+double thread_func_1(pika::lcos::local::channel_mpmc<data>& c, access_mode mode)
 {
     std::uint64_t start = pika::chrono::high_resolution_clock::now();
 
     for (int i = 0; i != NUM_TESTS; ++i)
     {
-        data d = channel_get(c);
+        data d = channel_get(c, mode);
         if (d.data_[0] != i)
         {
             std::cout << "Error!\n";
@@ -93,18 +134,32 @@ double thread_func_1(pika::lcos::local::channel_mpmc<data>& c)
 
 int pika_main()
 {
-    pika::lcos::local::channel_mpmc<data> c(10000);
+    char const* const names[] = {"try_get/try_set", "get/set",
+        "async_get/async_set"};
+    access_mode const modes[] = {access_mode::try_get_set,
+        access_mode::get_set, access_mode::async_get_set};
 
-    pika::future<double> producer = pika::async(thread_func_0, std::ref(c));
-    pika::future<double> consumer = pika::async(thread_func_1, std::ref(c));
+    for (std::size_t m = 0; m != std::size(modes); ++m)
+    {
+        pika::lcos::local::channel_mpmc<data> c(10000);
 
-    auto producer_time = producer.get();
-    std::cout << "Producer throughput: " << (NUM_TESTS / producer_time)
-              << " [op/s] (" << (producer_time / NUM_TESTS) << " [s/op])\n";
+        pika::future<double> producer =
+            pika::async(thread_func_0, std::ref(c), modes[m]);
+        pika::future<double> consumer =
+            pika::async(thread_func_1, std::ref(c), modes[m]);
 
-    auto consumer_time = consumer.get();
-    std::cout << "Consumer throughput: " << (NUM_TESTS / consumer_time)
-              << " [op/s] (" << (consumer_time / NUM_TESTS) << " [s/op])\n";
+        std::cout << names[m] << ":\n";
+
+        auto producer_time = producer.get();
+        std::cout << "Producer throughput: " << (NUM_TESTS / producer_time)
+                  << " [op/s] (" << (producer_time / NUM_TESTS)
+                  << " [s/op])\n";
+
+        auto consumer_time = consumer.get();
+        std::cout << "Consumer throughput: " << (NUM_TESTS / consumer_time)
+                  << " [op/s] (" << (consumer_time / NUM_TESTS)
+                  << " [s/op])\n";
+    }
 
     return pika::finalize();
 }
@@ -19,6 +19,7 @@
 #include <vector>
 
 using pika::execution::experimental::execute;
+using pika::execution::experimental::start_detached;
 using pika::execution::experimental::then;
 using pika::execution::experimental::thread_pool_scheduler;
 using pika::execution::experimental::transfer;
@@ -253,6 +254,40 @@ void test_multiple_accesses(
     rwm.readwrite() | sync_wait();
 }
 
+// The shared states of the mutex may outlive the mutex. Accesses which are
+// still waiting when the mutex is destructed are completed once the access
+// holding the value releases it.
+void test_destructed_mutex(std::size_t iterations)
+{
+    using readwrite_access_type =
+        async_rw_mutex<std::size_t>::readwrite_access_type;
+
+    std::atomic<std::size_t> count{0};
+    std::vector<readwrite_access_type> held;
+    {
+        async_rw_mutex<std::size_t> rwm{0};
+        held.push_back(sync_wait(rwm.readwrite()));
+
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            start_detached(rwm.read() | then([&, i](std::size_t const& x) {
+                PIKA_TEST_EQ(x, i);
+                ++count;
+            }));
+            start_detached(rwm.readwrite() | then([&, i](std::size_t& x) {
+                PIKA_TEST_EQ(x, i);
+                ++x;
+                ++count;
+            }));
+        }
+    }
+    PIKA_TEST_EQ(count, std::size_t(0));
+
+    // Releasing the value completes all accesses
+    held.clear();
+    PIKA_TEST_EQ(count, 2 * iterations);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 int pika_main(pika::program_options::variables_map& vm)
 {
@@ -279,6 +314,8 @@ int pika_main(pika::program_options::variables_map& vm)
     test_multiple_accesses(
         async_rw_mutex<mytype, mytype_base>{mytype{}}, iterations);
 
+    test_destructed_mutex(iterations);
+
     return pika::finalize();
 }
 
@@ -0,0 +1,325 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/execution.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/synchronization/channel_mpmc.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::lcos::local::bounded_channel;
+using pika::lcos::local::channel_mpmc;
+
+///////////////////////////////////////////////////////////////////////////////
+void test_try_get_set(std::size_t size)
+{
+    channel_mpmc<std::size_t> c(size);
+    PIKA_TEST_EQ(c.capacity(), size);
+
+    // several laps around the buffer
+    for (std::size_t lap = 0; lap != 3; ++lap)
+    {
+        PIKA_TEST(!c.try_get());
+        for (std::size_t i = 0; i != size; ++i)
+        {
+            PIKA_TEST(c.try_set(std::size_t(i)));
+        }
+        PIKA_TEST(!c.try_set(std::size_t(size)));
+        PIKA_TEST(c.try_get());
+
+        for (std::size_t i = 0; i != size; ++i)
+        {
+            std::size_t val = 0;
+            PIKA_TEST(c.try_get(&val));
+            PIKA_TEST_EQ(val, i);
+        }
+        PIKA_TEST(!c.try_get());
+    }
+}
+
+void test_move_only()
+{
+    channel_mpmc<std::unique_ptr<int>> c(2);
+
+    auto p = std::make_unique<int>(42);
+    PIKA_TEST(c.try_set(PIKA_MOVE(p)));
+    PIKA_TEST(!p);
+
+    p = std::make_unique<int>(43);
+    PIKA_TEST(c.set(PIKA_MOVE(p)));
+
+    // a failed try_set leaves the value alone
+    p = std::make_unique<int>(44);
+    PIKA_TEST(!c.try_set(PIKA_MOVE(p)));
+    PIKA_TEST(p);
+
+    std::unique_ptr<int> result;
+    PIKA_TEST(c.get(&result));
+    PIKA_TEST_EQ(*result, 42);
+
+    // the channel destroys the remaining element
+}
+
+struct no_default
+{
+    explicit no_default(int v) noexcept
+      : value(v)
+    {
+    }
+
+    int value;
+};
+
+void test_no_default_constructor()
+{
+    channel_mpmc<no_default> c(1);
+
+    // async_get does not need an element to move the result into
+    PIKA_TEST(c.try_set(no_default(42)));
+    PIKA_TEST_EQ(tt::sync_wait(c.async_get()).value, 42);
+
+    auto f = ex::make_future(c.async_get());
+    PIKA_TEST(c.set(no_default(43)));
+    PIKA_TEST_EQ(f.get().value, 43);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename Channel, typename Spawn>
+void test_blocking_impl(std::size_t size, Spawn&& spawn)
+{
+    constexpr std::size_t num_producers = 4;
+    constexpr std::size_t num_consumers = 4;
+    constexpr std::size_t num_values = 2000;
+
+    Channel c(size);
+    std::atomic<std::size_t> sum(0);
+
+    auto noop = []() {};
+    std::vector<decltype(spawn(noop))> tasks;
+    for (std::size_t p = 0; p != num_producers; ++p)
+    {
+        tasks.push_back(spawn([&c]() {
+            for (std::size_t i = 0; i != num_values; ++i)
+            {
+                PIKA_TEST(c.set(std::size_t(i)));
+            }
+        }));
+    }
+    for (std::size_t p = 0; p != num_consumers; ++p)
+    {
+        tasks.push_back(spawn([&c, &sum]() {
+            std::size_t local_sum = 0;
+            for (std::size_t i = 0; i != num_values; ++i)
+            {
+                std::size_t val = 0;
+                PIKA_TEST(c.get(&val));
+                local_sum += val;
+            }
+            sum += local_sum;
+        }));
+    }
+
+    for (auto& t : tasks)
+    {
+        t.get();
+    }
+
+    PIKA_TEST_EQ(sum.load(), num_producers * num_values * (num_values - 1) / 2);
+    PIKA_TEST(!c.try_get());
+}
+
+void test_blocking(std::size_t size)
+{
+    test_blocking_impl<channel_mpmc<std::size_t>>(size,
+        [](auto&& f) { return pika::async(PIKA_FORWARD(decltype(f), f)); });
+
+    // the default mutex allows using the channel from other threads
+    test_blocking_impl<bounded_channel<std::size_t>>(size, [](auto&& f) {
+        return std::async(std::launch::async, PIKA_FORWARD(decltype(f), f));
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void test_senders(std::size_t size)
+{
+    constexpr std::size_t num_values = 1000;
+
+    channel_mpmc<std::size_t> c(size);
+
+    // the operations complete immediately if possible
+    tt::sync_wait(c.async_set(42));
+    PIKA_TEST_EQ(tt::sync_wait(c.async_get()), std::size_t(42));
+
+    // the operations are completed by the thread which makes them possible
+    std::atomic<std::size_t> sum(0);
+    std::atomic<std::size_t> num_received(0);
+    for (std::size_t i = 0; i != num_values; ++i)
+    {
+        ex::start_detached(c.async_get() | ex::then([&](std::size_t val) {
+            sum += val;
+            ++num_received;
+        }));
+    }
+
+    std::atomic<std::size_t> num_sent(0);
+    for (std::size_t i = 0; i != num_values; ++i)
+    {
+        ex::start_detached(
+            c.async_set(std::size_t(i)) | ex::then([&]() { ++num_sent; }));
+    }
+
+    pika::util::yield_while(
+        [&]() { return num_received != num_values || num_sent != num_values; });
+    PIKA_TEST_EQ(sum.load(), num_values * (num_values - 1) / 2);
+
+    // senders and blocking operations can be mixed
+    auto producer = pika::async([&]() {
+        for (std::size_t i = 0; i != num_values; ++i)
+        {
+            tt::sync_wait(c.async_set(std::size_t(i)));
+        }
+    });
+    for (std::size_t i = 0; i != num_values; ++i)
+    {
+        std::size_t val = 0;
+        PIKA_TEST(c.get(&val));
+        PIKA_TEST_EQ(val, i);
+    }
+    producer.get();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void test_close()
+{
+    channel_mpmc<int> c(1);
+
+    // waiting operations are woken up when the channel is closed
+    auto blocked_get = pika::async([&]() {
+        int val = 0;
+        return c.get(&val);
+    });
+
+    std::atomic<bool> sender_failed(false);
+    ex::start_detached(c.async_get() | ex::then([](int) { PIKA_TEST(false); }) |
+        ex::let_error([&](std::exception_ptr) {
+            sender_failed = true;
+            return ex::just();
+        }));
+
+    // give the blocking operation a chance to be registered, the sender
+    // has been registered already
+    pika::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    PIKA_TEST_LTE(std::size_t(1), c.close());
+    PIKA_TEST(!blocked_get.get());
+    PIKA_TEST(sender_failed);
+
+    // all operations fail on a closed channel
+    PIKA_TEST(!c.try_set(1));
+    PIKA_TEST(!c.set(1));
+    PIKA_TEST(!c.get());
+    bool caught = false;
+    try
+    {
+        tt::sync_wait(c.async_set(1));
+    }
+    catch (pika::exception const& e)
+    {
+        PIKA_TEST_EQ(e.get_error(), pika::invalid_status);
+        caught = true;
+    }
+    PIKA_TEST(caught);
+
+    caught = false;
+    try
+    {
+        c.close();
+    }
+    catch (pika::exception const&)
+    {
+        caught = true;
+    }
+    PIKA_TEST(caught);
+}
+
+// waiting operations are failed when the channel is destroyed
+void test_destroy_with_waiters()
+{
+    std::atomic<bool> sender_failed(false);
+    {
+        channel_mpmc<int> c(1);
+        ex::start_detached(c.async_get() |
+            ex::then([](int) { PIKA_TEST(false); }) |
+            ex::let_error([&](std::exception_ptr) {
+                sender_failed = true;
+                return ex::just();
+            }));
+        PIKA_TEST(!sender_failed);
+    }
+    PIKA_TEST(sender_failed);
+}
+
+// completing a waiting operation may make the next one possible, a long chain
+// of such operations must not exhaust the stack of the notifying thread
+void test_notification_chain()
+{
+    constexpr std::size_t num_values = 10000;
+
+    channel_mpmc<std::size_t> c(1);
+    PIKA_TEST(c.try_set(0));
+
+    // every completed async_set frees the slot for the next one
+    std::atomic<std::size_t> num_sent(0);
+    for (std::size_t i = 0; i != num_values; ++i)
+    {
+        ex::start_detached(c.async_set(std::size_t(i)) | ex::then([&]() {
+            std::size_t val = 0;
+            PIKA_TEST(c.try_get(&val));
+            ++num_sent;
+        }));
+    }
+    PIKA_TEST_EQ(num_sent.load(), std::size_t(0));
+
+    std::size_t val = 0;
+    PIKA_TEST(c.try_get(&val));
+    pika::util::yield_while([&]() { return num_sent != num_values; });
+}
+
+int pika_main()
+{
+    for (std::size_t size : {1, 2, 7, 64})
+    {
+        test_try_get_set(size);
+        test_blocking(size);
+        test_senders(size);
+    }
+    test_move_only();
+    test_no_default_constructor();
+    test_close();
+    test_destroy_with_waiters();
+    test_notification_chain();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv), 0);
+    return pika::util::report_errors();
+}
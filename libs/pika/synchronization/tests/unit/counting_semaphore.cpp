@@ -40,6 +40,65 @@ int pika_main()
 
     PIKA_TEST_EQ(count, 10);
 
+    // wait_async completes once the credits have been signaled
+    {
+        namespace ex = pika::execution::experimental;
+        namespace tt = pika::this_thread::experimental;
+
+        count = 0;
+
+        pika::lcos::local::counting_semaphore sem;
+
+        std::atomic<int> num_completed(0);
+        std::vector<pika::future<void>> waits;
+        for (std::size_t i = 0; i != 10; ++i)
+        {
+            waits.push_back(ex::make_future(
+                sem.wait_async(2) | ex::then([&]() { ++num_completed; })));
+        }
+        PIKA_TEST_EQ(num_completed, 0);
+
+        for (std::size_t i = 0; i != 20; ++i)
+            pika::apply(&worker, std::ref(sem));
+
+        pika::wait_all(waits);
+        PIKA_TEST_EQ(count, 20);
+        PIKA_TEST_EQ(num_completed, 10);
+        PIKA_TEST(!sem.try_wait());
+
+        // credits which are available are acquired inline
+        sem.signal(3);
+        tt::sync_wait(sem.wait_async(3));
+        PIKA_TEST(!sem.try_wait());
+    }
+
+    // mixed blocking and asynchronous waiters
+    {
+        namespace ex = pika::execution::experimental;
+
+        pika::lcos::local::counting_semaphore sem;
+
+        std::size_t const num_waiters = 100;
+        std::vector<pika::future<void>> waits;
+        for (std::size_t i = 0; i != num_waiters; ++i)
+        {
+            if (i % 2 == 0)
+            {
+                waits.push_back(ex::make_future(sem.wait_async()));
+            }
+            else
+            {
+                waits.push_back(pika::async([&sem]() { sem.wait(); }));
+            }
+        }
+
+        for (std::size_t i = 0; i != num_waiters; ++i)
+            pika::apply(&worker, std::ref(sem));
+
+        pika::wait_all(waits);
+        PIKA_TEST(!sem.try_wait());
+    }
+
     return pika::finalize();
 }
 
@@ -5,6 +5,7 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include <pika/execution.hpp>
 #include <pika/init.hpp>
 #include <pika/semaphore.hpp>
 #include <pika/testing.hpp>
@@ -190,6 +191,37 @@ void test_semaphore_try_acquire_for_until()
     }
 }
 
+void test_semaphore_acquire_async()
+{
+    namespace ex = pika::execution::experimental;
+    namespace tt = pika::this_thread::experimental;
+
+    pika::counting_semaphore<> sem(1);
+
+    // available credits are acquired inline
+    bool acquired = false;
+    ex::start_detached(
+        sem.acquire_async() | ex::then([&]() { acquired = true; }));
+    PIKA_TEST(acquired);
+    PIKA_TEST(!sem.try_acquire());
+
+    // the sender is completed by release
+    acquired = false;
+    ex::start_detached(
+        sem.acquire_async() | ex::then([&]() { acquired = true; }));
+    PIKA_TEST(!acquired);
+    sem.release();
+    PIKA_TEST(acquired);
+    PIKA_TEST(!sem.try_acquire());
+
+    pika::thread release_thread([&sem]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        sem.release();
+    });
+    tt::sync_wait(sem.acquire_async());
+    release_thread.join();
+}
+
 int pika_main()
 {
     test_semaphore_release_acquire();
@@ -199,6 +231,7 @@ int pika_main()
     test_semaphore_try_acquire_for();
     test_semaphore_try_acquire_until();
     test_semaphore_try_acquire_for_until();
+    test_semaphore_acquire_async();
 
     pika::finalize();
     return pika::util::report_errors();
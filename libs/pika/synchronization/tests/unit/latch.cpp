@@ -151,6 +151,79 @@ int pika_main()
         PIKA_TEST_EQ(num_threads.load(), NUM_THREADS);
     }
 
+    // wait_async
+    {
+        namespace ex = pika::execution::experimental;
+        namespace tt = pika::this_thread::experimental;
+
+        num_threads.store(0);
+
+        pika::lcos::local::latch l(NUM_THREADS);
+
+        // senders started before the latch is ready are completed by the
+        // last call to count_down
+        std::atomic<std::size_t> num_completed(0);
+        std::vector<pika::future<void>> waits;
+        for (std::size_t i = 0; i != 10; ++i)
+        {
+            waits.push_back(ex::make_future(
+                l.wait_async() | ex::then([&]() { ++num_completed; })));
+        }
+        PIKA_TEST_EQ(num_completed.load(), std::size_t(0));
+
+        std::vector<pika::future<void>> results;
+        for (std::ptrdiff_t i = 0; i != NUM_THREADS; ++i)
+        {
+            results.push_back(pika::async([&]() {
+                ++num_threads;
+                l.count_down(1);
+            }));
+        }
+
+        tt::sync_wait(l.wait_async());
+        pika::wait_all(waits);
+        pika::wait_all(results);
+
+        PIKA_TEST(l.is_ready());
+        PIKA_TEST_EQ(num_threads.load(), NUM_THREADS);
+        PIKA_TEST_EQ(num_completed.load(), std::size_t(10));
+
+        // senders started after the latch is ready complete inline
+        bool completed = false;
+        ex::start_detached(
+            l.wait_async() | ex::then([&]() { completed = true; }));
+        PIKA_TEST(completed);
+    }
+
+    // reset_if_needed_and_count_up racing with the count_down which takes
+    // the counter to 0, as in task_group
+    {
+        pika::lcos::local::latch l(1);
+        l.count_down(1);
+
+        for (std::size_t round = 0; round != 100; ++round)
+        {
+            std::atomic<std::size_t> num_done(0);
+            std::vector<pika::future<void>> results;
+            for (std::size_t i = 0; i != 10; ++i)
+            {
+                l.reset_if_needed_and_count_up(1, 1);
+                results.push_back(pika::async([&]() {
+                    ++num_done;
+                    l.count_down(1);
+                }));
+            }
+
+            l.arrive_and_wait();
+            PIKA_TEST_EQ(num_done.load(), std::size_t(10));
+
+            l.wait();
+            PIKA_TEST(l.is_ready());
+
+            pika::wait_all(results);
+        }
+    }
+
     PIKA_TEST_EQ(pika::finalize(), 0);
     return 0;
 }
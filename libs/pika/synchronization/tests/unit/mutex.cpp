@@ -16,6 +16,7 @@
 #include <pika/testing.hpp>
 
 #include <chrono>
+#include <cstddef>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -275,10 +276,98 @@ struct test_recursive_lock
     }
 };
 
+template <typename M>
+struct test_contention
+{
+    using mutex_type = M;
+
+    static constexpr std::size_t num_threads = 16;
+    static constexpr std::size_t num_iterations = 1000;
+
+    mutex_type mutex;
+    std::size_t counter = 0;
+
+    void locking_thread()
+    {
+        for (std::size_t i = 0; i != num_iterations; ++i)
+        {
+            std::lock_guard<mutex_type> lock(mutex);
+            std::size_t const c = counter;
+            if (i % 100 == 0)
+            {
+                // suspend while holding the lock to force other threads to
+                // wait for it
+                pika::this_thread::yield();
+            }
+            counter = c + 1;
+        }
+    }
+
+    void operator()()
+    {
+        std::vector<pika::thread> threads;
+        for (std::size_t i = 0; i != num_threads; ++i)
+        {
+            threads.emplace_back(&test_contention::locking_thread, this);
+        }
+        for (pika::thread& t : threads)
+        {
+            t.join();
+        }
+
+        PIKA_TEST_EQ(counter, num_threads * num_iterations);
+    }
+};
+
+template <typename M>
+struct test_timedlock_contention
+{
+    using mutex_type = M;
+
+    static constexpr std::size_t num_threads = 16;
+    static constexpr std::size_t num_iterations = 100;
+
+    mutex_type mutex;
+    std::size_t counter = 0;
+
+    void locking_thread()
+    {
+        for (std::size_t i = 0; i != num_iterations; ++i)
+        {
+            if (!mutex.try_lock_for(std::chrono::microseconds(10)))
+            {
+                mutex.lock();
+            }
+            ++counter;
+            pika::this_thread::yield();
+            mutex.unlock();
+        }
+    }
+
+    void operator()()
+    {
+        std::vector<pika::thread> threads;
+        for (std::size_t i = 0; i != num_threads; ++i)
+        {
+            threads.emplace_back(
+                &test_timedlock_contention::locking_thread, this);
+        }
+        for (pika::thread& t : threads)
+        {
+            t.join();
+        }
+
+        PIKA_TEST_EQ(counter, num_threads * num_iterations);
+        PIKA_TEST(mutex.try_lock());
+        mutex.unlock();
+    }
+};
+
 void test_mutex()
 {
     test_lock<pika::lcos::local::mutex>()();
     test_trylock<pika::lcos::local::mutex>()();
+    test_contention<pika::lcos::local::mutex>()();
 }
 
 void test_timed_mutex()
@@ -286,6 +375,8 @@ void test_timed_mutex()
     test_lock<pika::lcos::local::timed_mutex>()();
     test_trylock<pika::lcos::local::timed_mutex>()();
     test_timedlock<pika::lcos::local::timed_mutex>()();
+    test_contention<pika::lcos::local::timed_mutex>()();
+    test_timedlock_contention<pika::lcos::local::timed_mutex>()();
 }
 
 //void test_recursive_mutex()
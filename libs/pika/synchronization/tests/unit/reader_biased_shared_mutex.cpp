@@ -0,0 +1,169 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/shared_mutex.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+using mutex_type = pika::reader_biased_shared_mutex;
+
+void test_try_lock()
+{
+    mutex_type mtx;
+
+    // multiple shared locks can be held at the same time
+    PIKA_TEST(mtx.try_lock_shared());
+    PIKA_TEST(mtx.try_lock_shared());
+    PIKA_TEST(!mtx.try_lock());
+    mtx.unlock_shared();
+    PIKA_TEST(!mtx.try_lock());
+    mtx.unlock_shared();
+
+    // an exclusive lock excludes all other locks
+    PIKA_TEST(mtx.try_lock());
+    PIKA_TEST(!mtx.try_lock());
+    PIKA_TEST(!mtx.try_lock_shared());
+    mtx.unlock();
+
+    PIKA_TEST(mtx.try_lock_shared());
+    mtx.unlock_shared();
+
+    {
+        std::shared_lock<mutex_type> l(mtx);
+        PIKA_TEST(l.owns_lock());
+    }
+    {
+        std::unique_lock<mutex_type> l(mtx);
+        PIKA_TEST(l.owns_lock());
+    }
+}
+
+void test_writer_waits_for_readers()
+{
+    mutex_type mtx;
+    std::atomic<bool> reader_done(false);
+
+    mtx.lock_shared();
+    pika::future<void> f = pika::async([&]() {
+        std::lock_guard<mutex_type> l(mtx);
+        PIKA_TEST(reader_done.load());
+    });
+
+    // the writer must not get the lock before the reader has left
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        pika::this_thread::yield();
+    }
+    reader_done = true;
+    mtx.unlock_shared();
+
+    f.get();
+}
+
+void test_reader_waits_for_writer()
+{
+    mutex_type mtx;
+    std::atomic<bool> writer_done(false);
+
+    mtx.lock();
+    pika::future<void> f = pika::async([&]() {
+        std::shared_lock<mutex_type> l(mtx);
+        PIKA_TEST(writer_done.load());
+    });
+
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        pika::this_thread::yield();
+    }
+    writer_done = true;
+    mtx.unlock();
+
+    f.get();
+}
+
+void test_readers_and_writers()
+{
+    constexpr std::size_t num_readers = 32;
+    constexpr std::size_t num_writers = 4;
+    constexpr std::size_t num_iterations = 1000;
+
+    mutex_type mtx;
+    std::size_t x = 0;
+    std::size_t y = 0;
+    std::atomic<std::size_t> readers_inside(0);
+    std::atomic<bool> writer_inside(false);
+
+    std::vector<pika::future<void>> futures;
+    for (std::size_t i = 0; i != num_readers; ++i)
+    {
+        futures.push_back(pika::async([&]() {
+            for (std::size_t j = 0; j != num_iterations; ++j)
+            {
+                std::shared_lock<mutex_type> l(mtx);
+                ++readers_inside;
+                PIKA_TEST(!writer_inside.load());
+                PIKA_TEST_EQ(x, y);
+
+                // readers may move to a different worker thread while
+                // holding the lock
+                if (j % 10 == 0)
+                {
+                    pika::this_thread::yield();
+                }
+                PIKA_TEST_EQ(x, y);
+                --readers_inside;
+            }
+        }));
+    }
+
+    for (std::size_t i = 0; i != num_writers; ++i)
+    {
+        futures.push_back(pika::async([&]() {
+            for (std::size_t j = 0; j != num_iterations / 10; ++j)
+            {
+                std::lock_guard<mutex_type> l(mtx);
+                PIKA_TEST(!writer_inside.exchange(true));
+                PIKA_TEST_EQ(readers_inside.load(), std::size_t(0));
+                ++x;
+                pika::this_thread::yield();
+                ++y;
+                writer_inside = false;
+            }
+        }));
+    }
+
+    pika::wait_all(futures);
+
+    PIKA_TEST_EQ(x, num_writers * (num_iterations / 10));
+    PIKA_TEST_EQ(y, num_writers * (num_iterations / 10));
+    PIKA_TEST(mtx.try_lock());
+    mtx.unlock();
+}
+
+int pika_main()
+{
+    test_try_lock();
+    test_writer_waits_for_readers();
+    test_reader_waits_for_writer();
+    test_readers_and_writers();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv), 0);
+    return pika::util::report_errors();
+}
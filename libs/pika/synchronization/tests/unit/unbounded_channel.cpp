@@ -0,0 +1,268 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/execution.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/synchronization/unbounded_channel.hpp>
+#include <pika/testing.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::lcos::local::unbounded_channel;
+
+///////////////////////////////////////////////////////////////////////////////
+void test_send_receive()
+{
+    unbounded_channel<std::size_t> c;
+
+    // buffered values are received in order
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        c.send(i);
+    }
+    PIKA_TEST_EQ(c.size(), std::size_t(100));
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        PIKA_TEST_EQ(tt::sync_wait(c.receive()), i);
+    }
+    PIKA_TEST_EQ(c.size(), std::size_t(0));
+
+    // waiting receive operations are completed in order by send
+    std::vector<std::size_t> received;
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        ex::start_detached(c.receive() |
+            ex::then([&](std::size_t val) { received.push_back(val); }));
+    }
+    PIKA_TEST(received.empty());
+    for (std::size_t i = 0; i != 100; ++i)
+    {
+        c.send(i);
+        PIKA_TEST_EQ(received.size(), i + 1);
+        PIKA_TEST_EQ(received.back(), i);
+    }
+    PIKA_TEST_EQ(c.size(), std::size_t(0));
+}
+
+void test_move_only()
+{
+    unbounded_channel<std::unique_ptr<int>> c;
+
+    c.send(std::make_unique<int>(42));
+    PIKA_TEST_EQ(*tt::sync_wait(c.receive()), 42);
+
+    auto f = ex::make_future(c.receive());
+    c.send(std::make_unique<int>(43));
+    PIKA_TEST_EQ(*f.get(), 43);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void test_composition()
+{
+    unbounded_channel<int> c1;
+    unbounded_channel<int> c2;
+
+    // when_all waits for several values
+    auto both = ex::when_all(c1.receive(), c1.receive()) |
+        ex::then([](int a, int b) { return a + b; });
+    c1.send(1);
+    c1.send(2);
+    PIKA_TEST_EQ(tt::sync_wait(std::move(both)), 3);
+
+    // let_value forwards a value from one channel to another one and waits
+    // for the reply
+    auto f = ex::make_future(c1.receive() | ex::let_value([&](int val) {
+        c2.send(val + 1);
+        return c2.receive();
+    }));
+    c1.send(41);
+    PIKA_TEST_EQ(f.get(), 42);
+}
+
+// Two actors pass a counter back and forth, each one increments it and sends
+// it back until it reaches the given limit.
+void test_ping_pong()
+{
+    constexpr int limit = 10000;
+
+    unbounded_channel<int> ping;
+    unbounded_channel<int> pong;
+
+    auto actor = [](unbounded_channel<int>& in, unbounded_channel<int>& out) {
+        for (;;)
+        {
+            int val = tt::sync_wait(in.receive());
+            if (val >= limit)
+            {
+                out.send(val);
+                return;
+            }
+            out.send(val + 1);
+        }
+    };
+
+    auto a = pika::async(actor, std::ref(ping), std::ref(pong));
+    auto b = pika::async(actor, std::ref(pong), std::ref(ping));
+    ping.send(0);
+
+    a.get();
+    b.get();
+    PIKA_TEST_EQ(ping.size() + pong.size(), std::size_t(1));
+}
+
+// Every receive operation sends the next value and starts the next receive
+// operation, which completes right away on the same thread. A long chain of
+// such operations must not exhaust the stack.
+void receive_next(
+    unbounded_channel<int>& c, std::atomic<int>& received, int limit)
+{
+    ex::start_detached(c.receive() | ex::then([&c, &received, limit](int val) {
+        if (val == limit)
+        {
+            received = val;
+            return;
+        }
+        c.send(val + 1);
+        receive_next(c, received, limit);
+    }));
+}
+
+void test_receive_chain()
+{
+    constexpr int limit = 100000;
+
+    unbounded_channel<int> c;
+    std::atomic<int> received(-1);
+
+    receive_next(c, received, limit);
+    c.send(0);
+
+    pika::util::yield_while([&]() { return received != limit; });
+    PIKA_TEST_EQ(c.size(), std::size_t(0));
+}
+
+void test_concurrent()
+{
+    constexpr std::size_t num_producers = 4;
+    constexpr std::size_t num_values = 10000;
+
+    unbounded_channel<std::size_t> c;
+    std::atomic<std::size_t> sum(0);
+    std::atomic<std::size_t> num_received(0);
+
+    // a mix of waiting and immediately completed receive operations
+    std::vector<pika::future<void>> tasks;
+    tasks.push_back(pika::async([&]() {
+        for (std::size_t i = 0; i != num_producers * num_values; ++i)
+        {
+            ex::start_detached(
+                c.receive() | ex::then([&](std::size_t val) {
+                    sum += val;
+                    ++num_received;
+                }));
+        }
+    }));
+    for (std::size_t p = 0; p != num_producers; ++p)
+    {
+        tasks.push_back(pika::async([&]() {
+            for (std::size_t i = 0; i != num_values; ++i)
+            {
+                c.send(i);
+            }
+        }));
+    }
+    pika::wait_all(tasks);
+
+    PIKA_TEST_EQ(num_received.load(), num_producers * num_values);
+    PIKA_TEST_EQ(sum.load(), num_producers * num_values * (num_values - 1) / 2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename Sender>
+void check_error(Sender&& s, pika::error expected)
+{
+    bool caught = false;
+    try
+    {
+        tt::sync_wait(PIKA_FORWARD(Sender, s));
+    }
+    catch (pika::exception const& e)
+    {
+        PIKA_TEST_EQ(e.get_error(), expected);
+        caught = true;
+    }
+    PIKA_TEST(caught);
+}
+
+void test_close()
+{
+    unbounded_channel<int> c;
+
+    // waiting receive operations are cancelled
+    std::atomic<std::size_t> num_errors(0);
+    for (int i = 0; i != 3; ++i)
+    {
+        ex::start_detached(c.receive() |
+            ex::then([](int) { PIKA_TEST(false); }) |
+            ex::let_error([&](std::exception_ptr) {
+                ++num_errors;
+                return ex::just();
+            }));
+    }
+    PIKA_TEST_EQ(c.close(), std::size_t(3));
+    PIKA_TEST_EQ(num_errors.load(), std::size_t(3));
+
+    // values can neither be sent nor received once the channel is closed
+    bool caught = false;
+    try
+    {
+        c.send(1);
+    }
+    catch (pika::exception const& e)
+    {
+        PIKA_TEST_EQ(e.get_error(), pika::invalid_status);
+        caught = true;
+    }
+    PIKA_TEST(caught);
+    check_error(c.receive(), pika::invalid_status);
+
+    // values sent before the channel was closed are still received
+    unbounded_channel<int> c2;
+    c2.send(1);
+    c2.send(2);
+    PIKA_TEST_EQ(c2.close(), std::size_t(0));
+    PIKA_TEST_EQ(tt::sync_wait(c2.receive()), 1);
+    PIKA_TEST_EQ(tt::sync_wait(c2.receive()), 2);
+    check_error(c2.receive(), pika::invalid_status);
+}
+
+int pika_main()
+{
+    test_send_receive();
+    test_move_only();
+    test_composition();
+    test_ping_pong();
+    test_receive_chain();
+    test_concurrent();
+    test_close();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv), 0);
+    return pika::util::report_errors();
+}
@@ -77,6 +77,9 @@ namespace pika { namespace threads { namespace detail {
         thread_id_ref_type create_work(
             thread_init_data& data, error_code& ec) override;
 
+        void create_work_bulk(thread_init_data* data, std::size_t count,
+            error_code& ec) override;
+
         thread_state set_state(thread_id_type const& id,
             thread_schedule_state new_state, thread_restart_state new_state_ex,
             thread_priority priority, error_code& ec) override;
@@ -219,6 +222,12 @@ namespace pika { namespace threads { namespace detail {
             return sched_->Scheduler::get_queue_length(num_thread);
         }
 
+        steal_statistics get_steal_statistics(
+            std::size_t num_thread, bool reset) override
+        {
+            return sched_->Scheduler::get_steal_statistics(num_thread, reset);
+        }
+
 #ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
         std::int64_t get_average_thread_wait_time(
             std::size_t num_thread, bool /* reset */) override
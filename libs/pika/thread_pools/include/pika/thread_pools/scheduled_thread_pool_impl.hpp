@@ -10,6 +10,7 @@
 #include <pika/affinity/affinity_data.hpp>
 #include <pika/assert.hpp>
 #include <pika/concurrency/barrier.hpp>
+#include <pika/coroutines/detail/stack_pool.hpp>
 #include <pika/execution_base/this_thread.hpp>
 #include <pika/functional/deferred_call.hpp>
 #include <pika/functional/detail/invoke.hpp>
@@ -232,7 +233,7 @@ namespace pika { namespace threads { namespace detail {
             sched_->Scheduler::set_all_states_at_least(state_stopping);
 
             // make sure we're not waiting
-            sched_->Scheduler::do_some_work(std::size_t(-1));
+            sched_->Scheduler::unpark_all();
 
             if (blocking)
             {
@@ -243,9 +244,9 @@ namespace pika { namespace threads { namespace detail {
                         continue;
 
                     // make sure no OS thread is waiting
-                    LTM_(info).format("stop: {} notify_all", id_.name());
+                    LTM_(info).format("stop: {} unpark_all", id_.name());
 
-                    sched_->Scheduler::do_some_work(std::size_t(-1));
+                    sched_->Scheduler::unpark_all();
 
                     LTM_(info).format("stop: {} join:{}", id_.name(), i);
 
@@ -468,6 +469,14 @@ namespace pika { namespace threads { namespace detail {
             }
         }
 
+        // idle threads are woken up preferably from within their NUMA domain,
+        // stacks are preferably reused within the same NUMA domain
+        std::size_t const numa_domain = topo.get_numa_node_number(
+            affinity_data_.get_pu_num(global_thread_num));
+        sched_->Scheduler::set_numa_domain(thread_num, numa_domain);
+        threads::coroutines::detail::stack_pool::register_thread(
+            id_.index(), numa_domain);
+
         // manage the number of this thread in its TSS
         init_tss_helper<Scheduler> tss_helper(
             *this, thread_num, global_thread_num);
@@ -638,6 +647,26 @@ namespace pika { namespace threads { namespace detail {
         return id;
     }
 
+    template <typename Scheduler>
+    void scheduled_thread_pool<Scheduler>::create_work_bulk(
+        thread_init_data* data, std::size_t count, error_code& ec)
+    {
+        // verify state
+        if (thread_count_ == 0 && !sched_->Scheduler::is_state(state_running))
+        {
+            // thread-manager is not currently running
+            PIKA_THROWS_IF(ec, invalid_status,
+                "thread_pool<Scheduler>::create_work_bulk",
+                "invalid state: thread pool is not running");
+            return;
+        }
+
+        detail::create_work_bulk(sched_.get(), data, count, ec);    //-V601
+
+        // update statistics
+        tasks_scheduled_ += static_cast<std::int64_t>(count);
+    }
+
     ///////////////////////////////////////////////////////////////////////////
     template <typename Scheduler>
     thread_state scheduled_thread_pool<Scheduler>::set_state(
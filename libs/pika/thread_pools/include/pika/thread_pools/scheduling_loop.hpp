@@ -998,6 +998,15 @@ namespace pika { namespace threads { namespace detail {
                 }
             }
 
+            // expire due timers of this worker, idle workers additionally
+            // take care of the timers of busy workers
+            if (scheduler.SchedulingPolicy::poll_timers(
+                    num_thread, idle_loop_count != 0) ==
+                policies::detail::polling_status::busy)
+            {
+                idle_loop_count = 0;
+            }
+
             if (scheduler.custom_polling_function() ==
                 policies::detail::polling_status::busy)
             {
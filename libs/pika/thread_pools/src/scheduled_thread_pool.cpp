@@ -28,6 +28,12 @@ template class PIKA_EXPORT
 template class PIKA_EXPORT pika::threads::detail::scheduled_thread_pool<
     pika::threads::policies::local_priority_queue_scheduler<std::mutex,
         pika::threads::policies::lockfree_fifo>>;
+template class PIKA_EXPORT
+    pika::threads::policies::local_priority_queue_scheduler<std::mutex,
+        pika::threads::policies::chase_lev_lifo>;
+template class PIKA_EXPORT pika::threads::detail::scheduled_thread_pool<
+    pika::threads::policies::local_priority_queue_scheduler<std::mutex,
+        pika::threads::policies::chase_lev_lifo>>;
 
 template class PIKA_EXPORT
     pika::threads::policies::static_priority_queue_scheduler<>;
@@ -426,8 +426,7 @@ int pika_main()
     test_callback_executed_if_stop_requested_before_destruction();
     test_callback_executed_immediately_if_stop_already_requested();
     test_register_multiple_callbacks();
-    // Disabled due to unavailable timed suspension
-    // test_concurrent_callback_registration();
+    test_concurrent_callback_registration();
     test_callback_deregistered_from_within_callback_does_not_deadlock();
     test_callback_deregistration_doesnt_wait_for_others_to_finish_executing();
     test_callback_deregistration_blocks_until_callback_finishes();
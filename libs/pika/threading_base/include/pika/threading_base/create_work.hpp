@@ -11,9 +11,17 @@
 #include <pika/threading_base/thread_init_data.hpp>
 #include <pika/threading_base/threading_base_fwd.hpp>
 
+#include <cstddef>
+
 namespace pika { namespace threads { namespace detail {
 
     PIKA_EXPORT thread_id_ref_type create_work(
         policies::scheduler_base* scheduler, threads::thread_init_data& data,
         error_code& ec = throws);
+
+    // Create and schedule new threads for all of the given \a count thread
+    // descriptions. All of them have to be in the pending state.
+    PIKA_EXPORT void create_work_bulk(policies::scheduler_base* scheduler,
+        threads::thread_init_data* data, std::size_t count,
+        error_code& ec = throws);
 }}}    // namespace pika::threads::detail
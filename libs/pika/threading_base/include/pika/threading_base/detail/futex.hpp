@@ -0,0 +1,39 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace pika { namespace threads { namespace detail {
+
+    /// Blocks the calling (OS) thread as long as \a word holds \a expected.
+    /// On Linux this is a futex wait on the word itself, other platforms
+    /// sleep on a mutex and a condition variable taken from a small global
+    /// table indexed by the address of the word.
+    ///
+    /// The function may return spuriously, the caller has to re-check the
+    /// word. A wake issued after the word has been changed can't get lost.
+    PIKA_EXPORT void futex_wait(
+        std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept;
+
+    /// Same as \a futex_wait, but returns at the latest after \a timeout.
+    PIKA_EXPORT void futex_wait_for(std::atomic<std::uint32_t>& word,
+        std::uint32_t expected,
+        std::chrono::steady_clock::duration timeout) noexcept;
+
+    /// Wakes up at least one thread blocked in \a futex_wait on \a word.
+    /// The word has to be changed before calling this function. The word is
+    /// only used as an address, it may already have been destroyed.
+    PIKA_EXPORT void futex_wake_one(std::atomic<std::uint32_t>& word) noexcept;
+
+    /// Wakes up all threads blocked in \a futex_wait on \a word.
+    PIKA_EXPORT void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept;
+}}}    // namespace pika::threads::detail
@@ -0,0 +1,61 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace pika { namespace threads { namespace detail {
+
+    /// A park slot lets exactly one (OS) thread sleep until it is woken up
+    /// explicitly or a deadline has passed. On Linux the slot is a single
+    /// futex word, waking up a parked thread is one compare-and-swap plus a
+    /// futex wake system call and never touches other sleeping threads.
+    /// Other platforms fall back to the mutex and condition variable based
+    /// emulation of \a futex_wait.
+    ///
+    /// Wakeups are not remembered: calling \a unpark on a slot no thread is
+    /// parked on has no effect.
+    class PIKA_EXPORT park_slot
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        park_slot() noexcept
+          : state_(empty)
+        {
+        }
+
+        park_slot(park_slot const&) = delete;
+        park_slot& operator=(park_slot const&) = delete;
+
+        /// Blocks the calling thread until \a unpark is called or
+        /// \a abs_time has been reached. Only one thread may park on a slot
+        /// at any time. Returns true if the thread was woken up by
+        /// \a unpark.
+        bool park(clock_type::time_point abs_time);
+
+        /// Wakes up the thread parked on this slot. Returns false if no
+        /// thread was parked.
+        bool unpark();
+
+        bool is_parked() const noexcept
+        {
+            return state_.load(std::memory_order_relaxed) == parked;
+        }
+
+    private:
+        static constexpr std::uint32_t empty = 0;
+        static constexpr std::uint32_t parked = 1;
+        static constexpr std::uint32_t notified = 2;
+
+        std::atomic<std::uint32_t> state_;
+    };
+}}}    // namespace pika::threads::detail
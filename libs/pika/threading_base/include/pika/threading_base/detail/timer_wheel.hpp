@@ -0,0 +1,144 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/concurrency/spinlock.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace pika { namespace threads { namespace detail {
+
+    class timer_wheel;
+
+    /// A single timer registered with a \a timer_wheel. Entries are
+    /// intrusive: the wheel never allocates, the owner of an entry has to
+    /// keep it alive until it has either been cancelled successfully or its
+    /// callback has finished running (see \a has_expired).
+    struct timer_wheel_entry
+    {
+        using callback_type = void (*)(timer_wheel_entry&);
+
+        explicit timer_wheel_entry(callback_type on_expired) noexcept
+          : on_expired_(on_expired)
+        {
+        }
+
+        timer_wheel_entry(timer_wheel_entry const&) = delete;
+        timer_wheel_entry& operator=(timer_wheel_entry const&) = delete;
+
+        /// Returns true once the callback of this entry has returned
+        bool has_expired() const noexcept
+        {
+            return state_.load(std::memory_order_acquire) == state::expired;
+        }
+
+    private:
+        friend class timer_wheel;
+
+        enum class state : std::uint8_t
+        {
+            idle,
+            armed,
+            expiring,
+            expired
+        };
+
+        timer_wheel_entry* prev_ = nullptr;
+        timer_wheel_entry* next_ = nullptr;
+        std::uint64_t expiry_ = 0;
+        std::uint32_t level_ = 0;
+        std::uint32_t slot_ = 0;
+        callback_type on_expired_;
+        std::atomic<state> state_{state::idle};
+    };
+
+    /// A hierarchical timer wheel (Varghese & Lauck) with num_levels levels
+    /// of num_slots slots each. Insertion and cancellation are O(1), expiring
+    /// timers costs O(1) per timer plus O(num_levels) per cascade. Empty
+    /// stretches of time are skipped using per-level occupancy bitmaps, so
+    /// polling an idle wheel only costs a couple of atomic loads.
+    ///
+    /// The wheel does not own a thread, it has to be driven by calling
+    /// \a poll (the scheduling loop does this for the per-worker wheels of a
+    /// scheduler).
+    class PIKA_EXPORT timer_wheel
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        static constexpr std::size_t slot_bits = 6;
+        static constexpr std::size_t num_slots = std::size_t(1) << slot_bits;
+        static constexpr std::size_t num_levels = 6;
+
+        // The resolution of the wheel is 2^tick_shift nanoseconds (~1us).
+        static constexpr std::size_t tick_shift = 10;
+
+        timer_wheel();
+
+        timer_wheel(timer_wheel const&) = delete;
+        timer_wheel& operator=(timer_wheel const&) = delete;
+
+        /// Arm the given entry to expire at (or shortly after) \a expiry.
+        /// Returns false without arming the entry if \a expiry has already
+        /// passed, in which case the callback will not be called.
+        bool insert(timer_wheel_entry& e, clock_type::time_point expiry);
+
+        /// Disarm the given entry. Returns true if the entry was removed
+        /// before expiring. If false is returned the callback of the entry
+        /// either has run or is running concurrently, \a has_expired can be
+        /// used to wait for it to finish.
+        bool cancel(timer_wheel_entry& e);
+
+        /// Run the callbacks of all entries which have expired at time
+        /// \a now. Returns the number of expired entries. If \a try_lock is
+        /// true the function returns immediately if the wheel is currently
+        /// being accessed by another thread.
+        std::size_t poll(clock_type::time_point now, bool try_lock = false);
+
+        std::size_t poll(bool try_lock = false)
+        {
+            if (size() == 0)
+            {
+                return 0;
+            }
+            return poll(clock_type::now(), try_lock);
+        }
+
+        /// The number of currently armed entries
+        std::size_t size() const noexcept
+        {
+            return count_.load(std::memory_order_relaxed);
+        }
+
+        /// Returns a time point at or before the earliest expiry of all
+        /// armed entries, or clock_type::time_point::max() if there are none.
+        clock_type::time_point next_expiry() const noexcept;
+
+    private:
+        static std::uint64_t to_tick(clock_type::time_point t) noexcept;
+        static std::uint64_t to_tick_ceil(clock_type::time_point t) noexcept;
+
+        void link(timer_wheel_entry& e) noexcept;
+        void unlink(timer_wheel_entry& e) noexcept;
+        void cascade(std::size_t level, std::size_t slot) noexcept;
+        std::uint64_t compute_next_tick() const noexcept;
+
+        util::spinlock mtx_;
+        std::atomic<std::size_t> count_;
+        std::atomic<std::uint64_t> next_tick_;
+
+        // the last tick that has been processed
+        std::uint64_t now_;
+
+        std::uint64_t occupied_[num_levels];
+        timer_wheel_entry* slots_[num_levels][num_slots];
+    };
+}}}    // namespace pika::threads::detail
@@ -209,6 +209,40 @@ namespace pika { namespace threads {
     {
         return register_work(data, detail::get_self_or_default_pool(), ec);
     }
+
+    /// \brief Create new work items using the given data. All work items are
+    ///        submitted to the scheduler of the thread pool at once, which is
+    ///        cheaper than calling \a register_work for each of them.
+    ///
+    /// As for \a register_work, the threads of work items with a high (or
+    /// high recursive) or boost priority are created immediately, the other
+    /// work items are staged and their threads are created once a worker
+    /// thread runs out of work. The \a run_now member of \a data is
+    /// ignored.
+    ///
+    /// \param data       [in] The data to use for creating the threads. All
+    ///                   of the thread descriptions must have \a pending as
+    ///                   their initial state.
+    /// \param count      [in] The number of elements in \a data.
+    /// \param pool       [in] The thread pool to use for launching the work.
+    /// \param ec         [in,out] This represents the error status on exit,
+    ///                   if this is pre-initialized to \a pika#throws
+    ///                   the function will throw on error instead.
+    ///
+    /// \throws invalid_status if the runtime system has not been started yet.
+    ///
+    /// \note             As long as \a ec is not pre-initialized to
+    ///                   \a pika#throws this function doesn't
+    ///                   throw but returns the result code using the
+    ///                   parameter \a ec. Otherwise it throws an instance
+    ///                   of pika#exception.
+    inline void register_work_bulk(threads::thread_init_data* data,
+        std::size_t count, threads::thread_pool_base* pool,
+        error_code& ec = throws)
+    {
+        PIKA_ASSERT(pool);
+        pool->create_work_bulk(data, count, ec);
+    }
 }}    // namespace pika::threads
 
 /// \endcond
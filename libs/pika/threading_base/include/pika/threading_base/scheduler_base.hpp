@@ -12,6 +12,8 @@
 #include <pika/functional/function.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/modules/format.hpp>
+#include <pika/threading_base/detail/park_slot.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/scheduler_mode.hpp>
 #include <pika/threading_base/scheduler_state.hpp>
 #include <pika/threading_base/thread_data.hpp>
@@ -96,13 +98,49 @@ namespace pika { namespace threads { namespace policies {
         void idle_callback(std::size_t num_thread);
 
         /// This function gets called by the thread-manager whenever new work
-        /// has been added, allowing the scheduler to reactivate one or more of
-        /// possibly idling OS threads
-        void do_some_work(std::size_t);
+        /// has been added, allowing the scheduler to reactivate one of the
+        /// possibly idling OS threads. Idle threads in the same NUMA domain
+        /// as the given worker thread are preferred.
+        void do_some_work(std::size_t num_thread);
+
+        /// Same as do_some_work(num_thread), but reactivates up to \a count
+        /// idling OS threads at once, used when a batch of work has been
+        /// added.
+        void do_some_work(std::size_t num_thread, std::size_t count);
+
+        /// Wake up all OS threads sleeping in \a idle_callback
+        void unpark_all();
+
+        /// Tells the scheduler which NUMA domain the given worker thread is
+        /// running on, this is used to select idle threads to wake up
+        void set_numa_domain(std::size_t num_thread, std::size_t domain);
+
+        /// Returns how often the given worker thread (or all worker threads
+        /// if num_thread is std::size_t(-1)) went to sleep in
+        /// \a idle_callback
+        std::int64_t get_park_count(std::size_t num_thread, bool reset);
+
+        /// Returns how often the given worker thread (or all worker threads
+        /// if num_thread is std::size_t(-1)) was woken up early by new work
+        std::int64_t get_unpark_count(std::size_t num_thread, bool reset);
 
         virtual void suspend(std::size_t num_thread);
         virtual void resume(std::size_t num_thread);
 
+        /// Returns the timer wheel used for timed suspension of threads
+        /// running on the given worker thread
+        threads::detail::timer_wheel& get_timer_wheel(std::size_t num_thread)
+        {
+            PIKA_ASSERT(num_thread < timers_.size());
+            return timers_[num_thread].data_;
+        }
+
+        /// Expire the timers of the given worker thread which are due. If
+        /// \a steal is true, the timers of other worker threads are expired
+        /// as well, unless they are currently being accessed.
+        detail::polling_status poll_timers(
+            std::size_t num_thread, bool steal = false);
+
         std::size_t select_active_pu(std::unique_lock<pu_mutex_type>& l,
             std::size_t num_thread, bool allow_fallback = false);
 
@@ -190,6 +228,15 @@ namespace pika { namespace threads { namespace policies {
             std::size_t num_thread, bool reset) = 0;
 #endif
 
+        // Returns the work stealing counters of the given worker thread, or
+        // their sum if num_thread is -1. Schedulers which do not steal work
+        // report no steal attempts.
+        virtual steal_statistics get_steal_statistics(
+            std::size_t /* num_thread */, bool /* reset */)
+        {
+            return steal_statistics();
+        }
+
         virtual std::int64_t get_queue_length(
             std::size_t num_thread = std::size_t(-1)) const = 0;
 
@@ -222,6 +269,13 @@ namespace pika { namespace threads { namespace policies {
         virtual void create_thread(
             thread_init_data& data, thread_id_ref_type* id, error_code& ec) = 0;
 
+        // Create and schedule new threads for all of the given \a count
+        // thread descriptions. Schedulers may override this to submit the
+        // threads to their queues in batches, by default create_thread is
+        // called for each of the thread descriptions.
+        virtual void create_threads_bulk(
+            thread_init_data* data, std::size_t count, error_code& ec);
+
         virtual bool get_next_thread(std::size_t num_thread, bool running,
             threads::thread_id_ref_type& thrd, bool enable_stealing) = 0;
 
@@ -374,17 +428,28 @@ namespace pika { namespace threads { namespace policies {
         util::cache_line_data<std::atomic<scheduler_mode>> mode_;
 
 #if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
-        // support for suspension on idle queues
-        pu_mutex_type mtx_;
-        std::condition_variable cond_;
+        // support for suspension on idle queues, every worker thread sleeps
+        // on its own park slot
         struct idle_backoff_data
         {
-            std::uint32_t wait_count_;
-            double max_idle_backoff_time_;
+            std::uint32_t wait_count_ = 0;
+            double max_idle_backoff_time_ = 0.0;
+            std::atomic<std::size_t> numa_domain_{0};
+            threads::detail::park_slot park_slot_;
+            std::atomic<std::int64_t> park_count_{0};
+            std::atomic<std::int64_t> unpark_count_{0};
         };
         std::vector<util::cache_line_data<idle_backoff_data>> wait_counts_;
+
+        // the number of worker threads currently parked, allows skipping the
+        // search for an idle thread if all threads are busy
+        util::cache_line_data<std::atomic<std::size_t>> num_parked_;
 #endif
 
+        // timers for timed suspension, one wheel per worker thread
+        std::vector<util::cache_line_data<threads::detail::timer_wheel>>
+            timers_;
+
         // support for suspension of pus
         std::vector<pu_mutex_type> suspend_mtxs_;
         std::vector<std::condition_variable> suspend_conds_;
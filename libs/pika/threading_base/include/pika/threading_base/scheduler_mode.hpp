@@ -58,6 +58,10 @@ namespace pika { namespace threads { namespace policies {
         /// This option allows for certain schedulers to explicitly disable
         /// exponential idle-back off
         enable_idle_backoff = 0x0800,
+        /// This option tells schedulers that support it to move up to half of
+        /// the pending threads of a victim queue to the local queue at once
+        /// when stealing, instead of stealing one thread at a time
+        steal_half = 0x1000,
 
         // clang-format off
         /// This option represents the default mode.
@@ -83,7 +87,8 @@ namespace pika { namespace threads { namespace policies {
             assign_work_thread_parent |
             steal_high_priority_first |
             steal_after_local |
-            enable_idle_backoff
+            enable_idle_backoff |
+            steal_half
         // clang-format on
     };
 }}}    // namespace pika::threads::policies
@@ -10,6 +10,7 @@
 #include <pika/coroutines/coroutine.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/modules/timing.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/set_thread_state.hpp>
 #include <pika/threading_base/threading_base_fwd.hpp>
@@ -18,6 +19,33 @@
 
 namespace pika { namespace threads { namespace detail {
 
+    /// A timer wheel entry which sets the state of the given thread to
+    /// pending (with thread_restart_state::timeout) when it expires. The
+    /// thread has to stay alive until the entry has been cancelled or has
+    /// expired.
+    struct PIKA_EXPORT timeout_entry : timer_wheel_entry
+    {
+        explicit timeout_entry(thread_id_type const& id) noexcept
+          : timer_wheel_entry(&timeout_entry::on_expired)
+          , id_(id)
+        {
+        }
+
+        static void on_expired(timer_wheel_entry& e);
+
+        thread_id_type id_;
+    };
+
+    /// Returns the timer wheel of the worker thread of the given scheduler
+    /// the calling thread is running on
+    PIKA_EXPORT timer_wheel& get_timer_wheel(
+        policies::scheduler_base* scheduler);
+
+    /// Disarm the given entry, waiting for its callback to finish if it is
+    /// expiring concurrently. This has to be called by the thread the entry
+    /// refers to before the entry goes out of scope.
+    PIKA_EXPORT void cancel_timeout(timer_wheel& timers, timeout_entry& entry);
+
     /// Set a timer to set the state of the given \a thread to the given
     /// new value after it expired (at the given time)
     PIKA_EXPORT thread_id_ref_type set_thread_state_timed(
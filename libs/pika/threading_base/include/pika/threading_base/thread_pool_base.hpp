@@ -10,6 +10,7 @@
 #include <pika/config.hpp>
 #include <pika/affinity/affinity_data.hpp>
 #include <pika/concurrency/barrier.hpp>
+#include <pika/coroutines/detail/stack_pool.hpp>
 #include <pika/functional/function.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/threading_base/callback_notifier.hpp>
@@ -51,6 +52,22 @@ namespace pika { namespace threads {
         std::uint64_t queue_length_;
     };
 
+    /// \brief Counters of the work stealing done by the worker threads of a
+    ///        thread pool.
+    struct steal_statistics
+    {
+        /// Number of times a queue of another worker thread was looked at for
+        /// work.
+        std::int64_t steal_attempts = 0;
+
+        /// Number of steal attempts which found work.
+        std::int64_t successful_steals = 0;
+
+        /// Number of threads which have been moved from the queues of other
+        /// worker threads.
+        std::int64_t stolen_threads = 0;
+    };
+
     namespace detail {
         ///////////////////////////////////////////////////////////////////////
         enum executor_parameter
@@ -240,6 +257,8 @@ namespace pika { namespace threads {
             thread_init_data& data, thread_id_ref_type& id, error_code& ec) = 0;
         virtual thread_id_ref_type create_work(
             thread_init_data& data, error_code& ec) = 0;
+        virtual void create_work_bulk(
+            thread_init_data* data, std::size_t count, error_code& ec) = 0;
 
         virtual thread_state set_state(thread_id_type const& id,
             thread_schedule_state new_state, thread_restart_state new_state_ex,
@@ -430,6 +449,15 @@ namespace pika { namespace threads {
         }
 #endif
 
+        /// Returns the work stealing counters of the given worker thread, or
+        /// their sum over all worker threads of the pool if \a num_thread is
+        /// -1.
+        virtual steal_statistics get_steal_statistics(
+            std::size_t /*num_thread*/, bool /*reset*/)
+        {
+            return steal_statistics();
+        }
+
         virtual std::int64_t get_thread_count(thread_schedule_state /*state*/,
             thread_priority /*priority*/, std::size_t /*num_thread*/,
             bool /*reset*/)
@@ -484,6 +512,15 @@ namespace pika { namespace threads {
                 thread_priority::default_, num_thread, reset);
         }
 
+        /// Returns the counters of the coroutine stack pool for the stacks
+        /// allocated and released by the worker threads of this pool.
+        coroutines::detail::stack_pool_statistics get_stack_pool_statistics(
+            bool reset)
+        {
+            return coroutines::detail::stack_pool::get().get_statistics(
+                id_.index(), reset);
+        }
+
         virtual std::int64_t get_scheduler_utilization() const = 0;
 
         virtual std::int64_t get_idle_loop_count(
@@ -14,6 +14,27 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 namespace pika { namespace threads { namespace policies {
+    /// The order in which an idle worker thread visits the queues of the other
+    /// worker threads when trying to steal work.
+    enum class steal_policy : std::uint8_t
+    {
+        /// Visit the worker threads on the same core first, then the ones in
+        /// the same NUMA domain, each in order of increasing distance of the
+        /// worker thread numbers.
+        radial = 0,
+        /// Like radial, but every stealing round starts at a victim chosen by
+        /// a per-worker pseudo random number generator. This avoids that many
+        /// idle worker threads contend on the same victims.
+        random = 1,
+        /// Visit the worker threads ordered by topological distance: the same
+        /// core, the same last level cache, the same NUMA domain, the same
+        /// socket, and finally all others.
+        hierarchical = 2,
+        /// Like hierarchical, but the victim of the last successful steal is
+        /// tried first.
+        last_victim = 3
+    };
+
     struct thread_queue_init_parameters
     {
         thread_queue_init_parameters(
@@ -39,7 +60,10 @@ namespace pika { namespace threads { namespace policies {
             std::ptrdiff_t small_stacksize = PIKA_SMALL_STACK_SIZE,
             std::ptrdiff_t medium_stacksize = PIKA_MEDIUM_STACK_SIZE,
             std::ptrdiff_t large_stacksize = PIKA_LARGE_STACK_SIZE,
-            std::ptrdiff_t huge_stacksize = PIKA_HUGE_STACK_SIZE)
+            std::ptrdiff_t huge_stacksize = PIKA_HUGE_STACK_SIZE,
+            std::int64_t max_cached_threads = std::int64_t(
+                PIKA_THREAD_QUEUE_MAX_CACHED_THREADS),
+            policies::steal_policy steal = steal_policy::radial)
           : max_thread_count_(max_thread_count)
           , min_tasks_to_steal_pending_(min_tasks_to_steal_pending)
           , min_tasks_to_steal_staged_(min_tasks_to_steal_staged)
@@ -55,6 +79,8 @@ namespace pika { namespace threads { namespace policies {
           , large_stacksize_(large_stacksize)
           , huge_stacksize_(huge_stacksize)
           , nostack_stacksize_((std::numeric_limits<std::ptrdiff_t>::max)())
+          , max_cached_threads_(max_cached_threads)
+          , steal_policy_(steal)
         {
         }
 
@@ -73,5 +99,7 @@ namespace pika { namespace threads { namespace policies {
         std::ptrdiff_t const large_stacksize_;
         std::ptrdiff_t const huge_stacksize_;
         std::ptrdiff_t const nostack_stacksize_;
+        std::int64_t max_cached_threads_;
+        policies::steal_policy steal_policy_;
     };
 }}}    // namespace pika::threads::policies
@@ -12,85 +12,105 @@
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/thread_data.hpp>
 #include <pika/threading_base/thread_init_data.hpp>
+#include <pika/threading_base/thread_pool_base.hpp>
+
+#include <algorithm>
+#include <cstddef>
 
 namespace pika { namespace threads { namespace detail {
 
-    thread_id_ref_type create_work(policies::scheduler_base* scheduler,
-        threads::thread_init_data& data, error_code& ec)
-    {
-        // verify parameters
-        switch (data.initial_state)
+    namespace {
+        // Verify the thread description and fill in the defaults, returns
+        // false if the description is not valid.
+        bool prepare_work(policies::scheduler_base* scheduler,
+            threads::thread_init_data& data, thread_self* self,
+            char const* function_name, error_code& ec)
         {
-        case thread_schedule_state::pending:
-        case thread_schedule_state::pending_do_not_schedule:
-        case thread_schedule_state::pending_boost:
-        case thread_schedule_state::suspended:
-            break;
+            // verify parameters
+            switch (data.initial_state)
+            {
+            case thread_schedule_state::pending:
+            case thread_schedule_state::pending_do_not_schedule:
+            case thread_schedule_state::pending_boost:
+            case thread_schedule_state::suspended:
+                break;
 
-        default:
-        {
-            PIKA_THROWS_IF(ec, bad_parameter, "thread::detail::create_work",
-                "invalid initial state: {}", data.initial_state);
-            return invalid_thread_id;
-        }
-        }
+            default:
+            {
+                PIKA_THROWS_IF(ec, bad_parameter, function_name,
+                    "invalid initial state: {}", data.initial_state);
+                return false;
+            }
+            }
 
 #ifdef PIKA_HAVE_THREAD_DESCRIPTION
-        if (!data.description)
-        {
-            PIKA_THROWS_IF(ec, bad_parameter, "thread::detail::create_work",
-                "description is nullptr");
-            return invalid_thread_id;
-        }
+            if (!data.description)
+            {
+                PIKA_THROWS_IF(ec, bad_parameter, function_name,
+                    "description is nullptr");
+                return false;
+            }
 #endif
 
-        LTM_(info)
-            .format("create_work: pool({}), scheduler({}), initial_state({}), "
-                    "thread_priority({})",
-                *scheduler->get_parent_pool(), *scheduler,
-                get_thread_state_name(data.initial_state),
-                get_thread_priority_name(data.priority))
+            LTM_(info)
+                .format("{}: pool({}), scheduler({}), initial_state({}), "
+                        "thread_priority({})",
+                    function_name, *scheduler->get_parent_pool(), *scheduler,
+                    get_thread_state_name(data.initial_state),
+                    get_thread_priority_name(data.priority))
 #ifdef PIKA_HAVE_THREAD_DESCRIPTION
-            .format(", description({})", data.description)
+                .format(", description({})", data.description)
 #endif
-            ;
-
-        thread_self* self = get_self_ptr();
+                ;
 
 #ifdef PIKA_HAVE_THREAD_PARENT_REFERENCE
-        if (nullptr == data.parent_id)
-        {
-            if (self)
+            if (nullptr == data.parent_id)
             {
-                data.parent_id = get_thread_id_data(self->get_thread_id());
-                data.parent_phase = self->get_thread_phase();
+                if (self)
+                {
+                    data.parent_id = get_thread_id_data(self->get_thread_id());
+                    data.parent_phase = self->get_thread_phase();
+                }
             }
-        }
-        if (0 == data.parent_locality_id)
-            data.parent_locality_id = detail::get_locality_id(pika::throws);
+            if (0 == data.parent_locality_id)
+                data.parent_locality_id = detail::get_locality_id(pika::throws);
 #endif
 
-        if (nullptr == data.scheduler_base)
-            data.scheduler_base = scheduler;
+            if (nullptr == data.scheduler_base)
+                data.scheduler_base = scheduler;
 
-        // Pass critical priority from parent to child.
-        if (self)
-        {
-            if (data.priority == thread_priority::default_ &&
-                thread_priority::high_recursive ==
-                    get_thread_id_data(self->get_thread_id())->get_priority())
+            // Pass critical priority from parent to child.
+            if (self)
             {
-                data.priority = thread_priority::high_recursive;
+                if (data.priority == thread_priority::default_ &&
+                    thread_priority::high_recursive ==
+                        get_thread_id_data(self->get_thread_id())
+                            ->get_priority())
+                {
+                    data.priority = thread_priority::high_recursive;
+                }
             }
-        }
 
-        // create the new thread
-        if (data.priority == thread_priority::default_)
-            data.priority = thread_priority::normal;
+            // create the new thread
+            if (data.priority == thread_priority::default_)
+                data.priority = thread_priority::normal;
 
-        data.run_now = (thread_priority::high == data.priority ||
-            thread_priority::high_recursive == data.priority ||
-            thread_priority::boost == data.priority);
+            data.run_now = (thread_priority::high == data.priority ||
+                thread_priority::high_recursive == data.priority ||
+                thread_priority::boost == data.priority);
+
+            return true;
+        }
+    }    // namespace
+
+    thread_id_ref_type create_work(policies::scheduler_base* scheduler,
+        threads::thread_init_data& data, error_code& ec)
+    {
+        if (!prepare_work(scheduler, data, get_self_ptr(),
+                "thread::detail::create_work", ec))
+        {
+            return invalid_thread_id;
+        }
 
         thread_id_ref_type id = invalid_thread_id;
         scheduler->create_thread(data, data.run_now ? &id : nullptr, ec);
@@ -101,4 +121,46 @@ namespace pika { namespace threads { namespace detail {
 
         return id;
     }
+
+    void create_work_bulk(policies::scheduler_base* scheduler,
+        threads::thread_init_data* data, std::size_t count, error_code& ec)
+    {
+        thread_self* self = get_self_ptr();
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            // the ids of the new threads are not returned, they have to be
+            // scheduled right away
+            if (data[i].initial_state != thread_schedule_state::pending)
+            {
+                PIKA_THROWS_IF(ec, bad_parameter,
+                    "thread::detail::create_work_bulk",
+                    "invalid initial state: {}", data[i].initial_state);
+                return;
+            }
+
+            if (!prepare_work(scheduler, data[i], self,
+                    "thread::detail::create_work_bulk", ec))
+            {
+                return;
+            }
+        }
+
+        scheduler->create_threads_bulk(data, count, ec);
+        if (ec)
+        {
+            return;
+        }
+
+        // Wake up as many threads as there is new work, but no more than
+        // there are worker threads, in a single pass over the parked threads.
+        // The schedule hint has been set by the scheduler to the worker
+        // thread owning the queue the first new thread ended up in, the
+        // threads close to it are woken up first.
+        if (count != 0)
+        {
+            scheduler->do_some_work(data[0].schedulehint.hint,
+                (std::min)(count,
+                    scheduler->get_parent_pool()->get_os_thread_count()));
+        }
+    }
 }}}    // namespace pika::threads::detail
@@ -18,6 +18,7 @@
 #include <pika/threading_base/execution_agent.hpp>
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/set_thread_state.hpp>
+#include <pika/threading_base/set_thread_state_timed.hpp>
 #include <pika/threading_base/thread_description.hpp>
 
 #ifdef PIKA_HAVE_THREAD_BACKTRACE_ON_SUSPENSION
@@ -101,27 +102,40 @@ namespace pika { namespace threads {
     void execution_agent::sleep_until(
         pika::chrono::steady_time_point const& sleep_time, const char* desc)
     {
-        // Just yield until time has passed by...
-        auto now = std::chrono::steady_clock::now();
-
-        // Note: we yield at least once to allow for other threads to
-        // make progress in any case. We also use yield instead of yield_k
-        // for the same reason.
-        std::size_t k = 0;
-        do
+        thread_id_type id = self_.get_thread_id();
+        if (PIKA_UNLIKELY(!id))
+        {
+            PIKA_THROW_EXCEPTION(null_thread_id, "execution_agent::sleep_until",
+                "null thread id encountered (is this executed on a "
+                "pika-thread?)");
+        }
+
+        // Suspend until the timer fires or until the thread is resumed
+        // explicitly. The timer entry lives on our stack and has to be
+        // disarmed before leaving this function.
+        detail::timer_wheel& timers = detail::get_timer_wheel(
+            get_thread_id_data(id)->get_scheduler_base());
+        detail::timeout_entry timer(id);
+
+        if (!timers.insert(timer, sleep_time.value()))
         {
-            if (k < 32 || k & 1)
-            {
-                do_yield(
-                    desc, pika::threads::thread_schedule_state::pending_boost);
-            }
-            else
-            {
-                do_yield(desc, pika::threads::thread_schedule_state::pending);
-            }
-            ++k;
-            now = std::chrono::steady_clock::now();
-        } while (now < sleep_time.value());
+            // Note: we yield at least once to allow for other threads to
+            // make progress in any case.
+            do_yield(desc, pika::threads::thread_schedule_state::pending);
+            return;
+        }
+
+        try
+        {
+            do_yield(desc, pika::threads::thread_schedule_state::suspended);
+        }
+        catch (...)
+        {
+            detail::cancel_timeout(timers, timer);
+            throw;
+        }
+
+        detail::cancel_timeout(timers, timer);
     }
 
 #if defined(PIKA_HAVE_VERIFY_LOCKS)
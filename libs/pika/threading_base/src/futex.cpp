@@ -0,0 +1,142 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/threading_base/detail/futex.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace pika { namespace threads { namespace detail {
+
+#if defined(__linux__)
+    namespace {
+        static_assert(sizeof(std::atomic<std::uint32_t>) ==
+                sizeof(std::uint32_t),
+            "the futex word has to be a plain 32 bit integer");
+
+        std::uint32_t* futex_address(std::atomic<std::uint32_t>& word) noexcept
+        {
+            return reinterpret_cast<std::uint32_t*>(&word);
+        }
+
+        void futex_wake(std::atomic<std::uint32_t>& word, int count) noexcept
+        {
+            syscall(SYS_futex, futex_address(word), FUTEX_WAKE_PRIVATE, count,
+                nullptr, nullptr, 0);
+        }
+    }    // namespace
+
+    // Spurious wakeups and interruptions are handled by the caller
+    // re-checking the futex word.
+    void futex_wait(
+        std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept
+    {
+        syscall(SYS_futex, futex_address(word), FUTEX_WAIT_PRIVATE, expected,
+            nullptr, nullptr, 0);
+    }
+
+    void futex_wait_for(std::atomic<std::uint32_t>& word,
+        std::uint32_t expected,
+        std::chrono::steady_clock::duration timeout) noexcept
+    {
+        auto const secs =
+            std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        auto const nsecs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                timeout - secs);
+
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(secs.count());
+        ts.tv_nsec = static_cast<long>(nsecs.count());
+
+        syscall(SYS_futex, futex_address(word), FUTEX_WAIT_PRIVATE, expected,
+            &ts, nullptr, 0);
+    }
+
+    void futex_wake_one(std::atomic<std::uint32_t>& word) noexcept
+    {
+        futex_wake(word, 1);
+    }
+
+    void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept
+    {
+        futex_wake(word, INT_MAX);
+    }
+#else
+    namespace {
+        // Words which hash to the same bucket share its condition variable,
+        // wakeups therefore always notify all threads of a bucket.
+        struct futex_bucket
+        {
+            std::mutex mtx;
+            std::condition_variable cond;
+        };
+
+        constexpr std::size_t num_futex_buckets = 64;
+
+        futex_bucket& get_futex_bucket(
+            std::atomic<std::uint32_t> const& word) noexcept
+        {
+            static futex_bucket buckets[num_futex_buckets];
+            auto const addr = reinterpret_cast<std::uintptr_t>(&word);
+            return buckets[(addr >> 4) % num_futex_buckets];
+        }
+    }    // namespace
+
+    void futex_wait(
+        std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept
+    {
+        futex_bucket& b = get_futex_bucket(word);
+        std::unique_lock<std::mutex> l(b.mtx);
+        if (word.load(std::memory_order_acquire) == expected)
+        {
+            b.cond.wait(l);
+        }
+    }
+
+    void futex_wait_for(std::atomic<std::uint32_t>& word,
+        std::uint32_t expected,
+        std::chrono::steady_clock::duration timeout) noexcept
+    {
+        futex_bucket& b = get_futex_bucket(word);
+        std::unique_lock<std::mutex> l(b.mtx);
+        if (word.load(std::memory_order_acquire) == expected)
+        {
+            b.cond.wait_for(l, timeout);
+        }
+    }
+
+    void futex_wake_one(std::atomic<std::uint32_t>& word) noexcept
+    {
+        futex_wake_all(word);
+    }
+
+    void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept
+    {
+        futex_bucket& b = get_futex_bucket(word);
+        {
+            // the lock makes sure that a waiting thread is either not yet
+            // waiting on the condition variable or has released the mutex
+            std::lock_guard<std::mutex> l(b.mtx);
+        }
+        b.cond.notify_all();
+    }
+#endif
+}}}    // namespace pika::threads::detail
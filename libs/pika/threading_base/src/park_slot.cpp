@@ -0,0 +1,58 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/threading_base/detail/futex.hpp>
+#include <pika/threading_base/detail/park_slot.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace pika { namespace threads { namespace detail {
+
+    bool park_slot::park(clock_type::time_point abs_time)
+    {
+        state_.store(parked, std::memory_order_seq_cst);
+
+        while (state_.load(std::memory_order_acquire) == parked)
+        {
+            auto const now = clock_type::now();
+            if (now >= abs_time)
+            {
+                break;
+            }
+            futex_wait_for(state_, parked, abs_time - now);
+        }
+
+        // If the slot is still marked as parked nobody has woken us up,
+        // otherwise unpark has switched it to notified.
+        std::uint32_t expected = parked;
+        if (state_.compare_exchange_strong(
+                expected, empty, std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        state_.store(empty, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool park_slot::unpark()
+    {
+        // avoid the read-modify-write for slots nobody is parked on
+        std::uint32_t expected = parked;
+        if (state_.load(std::memory_order_relaxed) != parked ||
+            !state_.compare_exchange_strong(
+                expected, notified, std::memory_order_acq_rel))
+        {
+            return false;
+        }
+
+        futex_wake_one(state_);
+        return true;
+    }
+}}}    // namespace pika::threads::detail
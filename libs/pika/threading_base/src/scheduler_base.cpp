@@ -7,10 +7,13 @@
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
 #include <pika/execution_base/this_thread.hpp>
+#include <pika/threading_base/detail/park_slot.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/scheduler_mode.hpp>
 #include <pika/threading_base/scheduler_state.hpp>
 #include <pika/threading_base/thread_init_data.hpp>
+#include <pika/threading_base/thread_num_tss.hpp>
 #include <pika/threading_base/thread_pool_base.hpp>
 #if defined(PIKA_HAVE_SCHEDULER_LOCAL_STORAGE)
 #include <pika/coroutines/detail/tss.hpp>
@@ -38,7 +41,8 @@ namespace pika { namespace threads { namespace policies {
     scheduler_base::scheduler_base(std::size_t num_threads,
         char const* description, thread_queue_init_parameters thread_queue_init,
         scheduler_mode mode)
-      : suspend_mtxs_(num_threads)
+      : timers_(num_threads)
+      , suspend_mtxs_(num_threads)
       , suspend_conds_(num_threads)
       , pu_mtxs_(num_threads)
       , states_(num_threads)
@@ -56,12 +60,14 @@ namespace pika { namespace threads { namespace policies {
 #if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
         double max_time = thread_queue_init.max_idle_backoff_time_;
 
-        wait_counts_.resize(num_threads);
+        wait_counts_ =
+            std::vector<util::cache_line_data<idle_backoff_data>>(num_threads);
         for (auto&& data : wait_counts_)
         {
             data.data_.wait_count_ = 0;
             data.data_.max_idle_backoff_time_ = max_time;
         }
+        num_parked_.data_.store(0, std::memory_order_relaxed);
 #endif
 
         for (std::size_t i = 0; i != num_threads; ++i)
@@ -88,8 +94,18 @@ namespace pika { namespace threads { namespace policies {
 
             ++data.wait_count_;
 
-            std::unique_lock<pu_mutex_type> l(mtx_);
-            if (cond_.wait_for(l, period) == std::cv_status::no_timeout)
+            // don't sleep past the next timer expiring on this worker
+            auto const wakeup = (std::min)(
+                std::chrono::steady_clock::now() + period,
+                timers_[num_thread].data_.next_expiry());
+
+            data.park_count_.fetch_add(1, std::memory_order_relaxed);
+            num_parked_.data_.fetch_add(1, std::memory_order_seq_cst);
+
+            bool const woken = data.park_slot_.park(wakeup);
+
+            num_parked_.data_.fetch_sub(1, std::memory_order_relaxed);
+            if (woken)
             {
                 // reset counter if thread was woken up
                 data.wait_count_ = 0;
@@ -100,20 +116,188 @@ namespace pika { namespace threads { namespace policies {
 #endif
     }
 
+    void scheduler_base::create_threads_bulk(
+        thread_init_data* data, std::size_t count, error_code& ec)
+    {
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            create_thread(data[i], nullptr, ec);
+            if (ec)
+            {
+                return;
+            }
+        }
+    }
+
     /// This function gets called by the thread-manager whenever new work
-    /// has been added, allowing the scheduler to reactivate one or more of
+    /// has been added, allowing the scheduler to reactivate one of the
     /// possibly idling OS threads
-    void scheduler_base::do_some_work(std::size_t)
+    void scheduler_base::do_some_work(std::size_t num_thread)
+    {
+        do_some_work(num_thread, 1);
+    }
+
+    void scheduler_base::do_some_work(std::size_t num_thread, std::size_t count)
     {
 #if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
-        if (mode_.data_.load(std::memory_order_relaxed) &
-            policies::enable_idle_backoff)
+        if (count == 0 ||
+            !(mode_.data_.load(std::memory_order_relaxed) &
+                policies::enable_idle_backoff) ||
+            num_parked_.data_.load(std::memory_order_seq_cst) == 0)
+        {
+            return;
+        }
+
+        std::size_t const num_threads = wait_counts_.size();
+        if (num_thread >= num_threads)
         {
-            cond_.notify_all();
+            // no (valid) target queue, prefer waking up a thread close to
+            // the one creating the work
+            num_thread = pika::get_local_worker_thread_num();
+            if (num_thread >= num_threads)
+            {
+                num_thread = 0;
+            }
         }
+
+        // Wake up count parked threads, if there are as many. The thread
+        // owning the target queue is tried first, followed by the other
+        // threads in its NUMA domain and finally all remaining threads.
+        std::size_t const domain =
+            wait_counts_[num_thread].data_.numa_domain_.load(
+                std::memory_order_relaxed);
+        for (int same_domain = 1; same_domain >= 0; --same_domain)
+        {
+            for (std::size_t i = 0; i != num_threads; ++i)
+            {
+                idle_backoff_data& data =
+                    wait_counts_[(num_thread + i) % num_threads].data_;
+                if ((data.numa_domain_.load(std::memory_order_relaxed) ==
+                        domain) != bool(same_domain))
+                {
+                    continue;
+                }
+
+                if (data.park_slot_.unpark())
+                {
+                    data.unpark_count_.fetch_add(1, std::memory_order_relaxed);
+                    if (--count == 0)
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+#else
+        (void) num_thread;
+        (void) count;
 #endif
     }
 
+    void scheduler_base::unpark_all()
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        for (auto&& data : wait_counts_)
+        {
+            if (data.data_.park_slot_.unpark())
+            {
+                data.data_.unpark_count_.fetch_add(
+                    1, std::memory_order_relaxed);
+            }
+        }
+#endif
+    }
+
+    void scheduler_base::set_numa_domain(
+        std::size_t num_thread, std::size_t domain)
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        PIKA_ASSERT(num_thread < wait_counts_.size());
+        wait_counts_[num_thread].data_.numa_domain_.store(
+            domain, std::memory_order_relaxed);
+#else
+        (void) num_thread;
+        (void) domain;
+#endif
+    }
+
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+    namespace {
+        std::int64_t get_count(std::atomic<std::int64_t>& count, bool reset)
+        {
+            return reset ? count.exchange(0, std::memory_order_relaxed) :
+                           count.load(std::memory_order_relaxed);
+        }
+    }    // namespace
+#endif
+
+    std::int64_t scheduler_base::get_park_count(
+        std::size_t num_thread, bool reset)
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        if (num_thread != std::size_t(-1))
+        {
+            PIKA_ASSERT(num_thread < wait_counts_.size());
+            return get_count(wait_counts_[num_thread].data_.park_count_, reset);
+        }
+
+        std::int64_t result = 0;
+        for (auto&& data : wait_counts_)
+        {
+            result += get_count(data.data_.park_count_, reset);
+        }
+        return result;
+#else
+        (void) num_thread;
+        (void) reset;
+        return 0;
+#endif
+    }
+
+    std::int64_t scheduler_base::get_unpark_count(
+        std::size_t num_thread, bool reset)
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        if (num_thread != std::size_t(-1))
+        {
+            PIKA_ASSERT(num_thread < wait_counts_.size());
+            return get_count(
+                wait_counts_[num_thread].data_.unpark_count_, reset);
+        }
+
+        std::int64_t result = 0;
+        for (auto&& data : wait_counts_)
+        {
+            result += get_count(data.data_.unpark_count_, reset);
+        }
+        return result;
+#else
+        (void) num_thread;
+        (void) reset;
+        return 0;
+#endif
+    }
+
+    detail::polling_status scheduler_base::poll_timers(
+        std::size_t num_thread, bool steal)
+    {
+        PIKA_ASSERT(num_thread < timers_.size());
+
+        std::size_t expired = timers_[num_thread].data_.poll();
+        if (steal)
+        {
+            std::size_t const num_timers = timers_.size();
+            for (std::size_t i = 1; i != num_timers; ++i)
+            {
+                expired += timers_[(num_thread + i) % num_timers].data_.poll(
+                    true);
+            }
+        }
+
+        return expired != 0 ? detail::polling_status::busy :
+                              detail::polling_status::idle;
+    }
+
     void scheduler_base::suspend(std::size_t num_thread)
     {
         PIKA_ASSERT(num_thread < suspend_conds_.size());
@@ -318,7 +502,7 @@ namespace pika { namespace threads { namespace policies {
     {
         // distribute the same value across all cores
         mode_.data_.store(mode, std::memory_order_release);
-        do_some_work(std::size_t(-1));
+        unpark_all();
     }
 
     void scheduler_base::add_scheduler_mode(scheduler_mode mode)
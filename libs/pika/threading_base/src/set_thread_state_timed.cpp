@@ -7,72 +7,64 @@
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
 #include <pika/coroutines/coroutine.hpp>
+#include <pika/execution_base/this_thread.hpp>
 #include <pika/functional/bind.hpp>
-#include <pika/functional/bind_front.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/threading_base/create_thread.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/set_thread_state_timed.hpp>
+#include <pika/threading_base/thread_num_tss.hpp>
 #include <pika/threading_base/threading_base_fwd.hpp>
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <functional>
-#include <memory>
-#include <system_error>
-#include <utility>
 
 namespace pika { namespace threads { namespace detail {
 
-    ///////////////////////////////////////////////////////////////////////////
-    /// This thread function is used by the at_timer thread below to trigger
-    /// the required action.
-    thread_result_type wake_timer_thread(thread_id_ref_type const& thrd,
-        thread_schedule_state /*newstate*/,
-        thread_restart_state /*newstate_ex*/, thread_priority /*priority*/,
-        thread_id_type timer_id,
-        std::shared_ptr<std::atomic<bool>> const& triggered,
-        bool retry_on_active, thread_restart_state my_statex)
+    void timeout_entry::on_expired(timer_wheel_entry& e)
     {
-        if (PIKA_UNLIKELY(!thrd))
-        {
-            PIKA_THROW_EXCEPTION(null_thread_id,
-                "threads::detail::wake_timer_thread",
-                "null thread id encountered (id)");
-            return thread_result_type(
-                thread_schedule_state::terminated, invalid_thread_id);
-        }
+        // If the thread has already been woken up by other means this is a
+        // no-op.
+        error_code ec(lightweight);    // do not throw
+        set_thread_state(static_cast<timeout_entry&>(e).id_,
+            thread_schedule_state::pending, thread_restart_state::timeout,
+            thread_priority::boost, thread_schedule_hint(), false, ec);
+    }
 
-        if (PIKA_UNLIKELY(!timer_id))
+    timer_wheel& get_timer_wheel(policies::scheduler_base* scheduler)
+    {
+        // fall back to the first worker if the calling thread does not run
+        // on this scheduler
+        std::size_t num_thread = 0;
+        thread_data* self = get_self_id_data();
+        if (self != nullptr && self->get_scheduler_base() == scheduler)
         {
-            PIKA_THROW_EXCEPTION(null_thread_id,
-                "threads::detail::wake_timer_thread",
-                "null thread id encountered (timer_id)");
-            return thread_result_type(
-                thread_schedule_state::terminated, invalid_thread_id);
+            num_thread = get_local_worker_thread_num();
         }
+        return scheduler->get_timer_wheel(num_thread);
+    }
 
-        PIKA_ASSERT(my_statex == thread_restart_state::abort ||
-            my_statex == thread_restart_state::timeout);
-
-        if (!triggered->load())
+    void cancel_timeout(timer_wheel& timers, timeout_entry& entry)
+    {
+        if (!timers.cancel(entry))
         {
-            error_code ec(lightweight);    // do not throw
-            set_thread_state(timer_id, thread_schedule_state::pending,
-                my_statex, thread_priority::boost, thread_schedule_hint(),
-                retry_on_active, ec);
+            // the callback may still be running even if it has already
+            // woken us up
+            pika::util::yield_while(
+                [&entry]() { return !entry.has_expired(); }, "cancel_timeout");
         }
-
-        return thread_result_type(
-            thread_schedule_state::terminated, invalid_thread_id);
     }
 
+    ///////////////////////////////////////////////////////////////////////////
     /// This thread function initiates the required set_state action (on
     /// behalf of one of the threads#detail#set_thread_state functions).
     thread_result_type at_timer(policies::scheduler_base* scheduler,
-        std::chrono::steady_clock::time_point& /*abs_time*/,
+        std::chrono::steady_clock::time_point& abs_time,
         thread_id_ref_type const& thrd, thread_schedule_state newstate,
         thread_restart_state newstate_ex, thread_priority priority,
-        std::atomic<bool>* /*started*/, bool retry_on_active)
+        std::atomic<bool>* started, bool /*retry_on_active*/)
     {
         if (PIKA_UNLIKELY(!thrd))
         {
@@ -82,77 +74,49 @@ namespace pika { namespace threads { namespace detail {
                 thread_schedule_state::terminated, invalid_thread_id);
         }
 
-        // create a new thread in suspended state, which will execute the
-        // requested set_state when timer fires and will re-awaken this thread,
-        // allowing the deadline_timer to go out of scope gracefully
+        // register the timer with the wheel of the worker thread we're
+        // running on, the timer will re-awaken this thread when it fires
+        timer_wheel& timers = get_timer_wheel(scheduler);
+
         thread_id_ref_type self_id = get_self_id();    // keep alive
+        timeout_entry entry(self_id.noref());
+
+        if (!timers.insert(entry, abs_time))
+        {
+            // the timer has expired already
+            if (started != nullptr)
+            {
+                started->store(true);
+            }
 
-        std::shared_ptr<std::atomic<bool>> triggered(
-            std::make_shared<std::atomic<bool>>(false));
+            detail::set_thread_state(
+                thrd.noref(), newstate, newstate_ex, priority);
 
-        thread_init_data data(
-            util::bind_front(&wake_timer_thread, thrd, newstate, newstate_ex,
-                priority, self_id.noref(), triggered, retry_on_active),
-            "wake_timer", priority, thread_schedule_hint(),
-            thread_stacksize::small_, thread_schedule_state::suspended, true);
-
-        thread_id_ref_type wake_id = invalid_thread_id;
-        create_thread(scheduler, data, wake_id);
-
-        PIKA_THROW_EXCEPTION(invalid_status, "at_timer",
-            "Timed suspension is currently not supported");
-        // // create timer firing in correspondence with given time
-        // using deadline_timer =
-        //     asio::basic_waitable_timer<std::chrono::steady_clock>;
-
-        // asio::io_context* s = get_default_timer_service();
-        // PIKA_ASSERT(s);
-        // deadline_timer t(*s, abs_time);
-
-        // // let the timer invoke the set_state on the new (suspended) thread
-        // t.async_wait([wake_id = PIKA_MOVE(wake_id), priority, retry_on_active](
-        //                  std::error_code const& ec) {
-        //     if (ec == std::make_error_code(std::errc::operation_canceled))
-        //     {
-        //         set_thread_state(wake_id.noref(),
-        //             thread_schedule_state::pending, thread_restart_state::abort,
-        //             priority, thread_schedule_hint(), retry_on_active, throws);
-        //     }
-        //     else
-        //     {
-        //         set_thread_state(wake_id.noref(),
-        //             thread_schedule_state::pending,
-        //             thread_restart_state::timeout, priority,
-        //             thread_schedule_hint(), retry_on_active, throws);
-        //     }
-        // });
-
-        // if (started != nullptr)
-        // {
-        //     started->store(true);
-        // }
-
-        // // this waits for the thread to be reactivated when the timer fired
-        // // if it returns signaled the timer has been canceled, otherwise
-        // // the timer fired and the wake_timer_thread above has been executed
-        // thread_restart_state statex = get_self().yield(thread_result_type(
-        //     thread_schedule_state::suspended, invalid_thread_id));
-
-        // PIKA_ASSERT(statex == thread_restart_state::abort ||
-        //     statex == thread_restart_state::timeout);
-
-        // // NOLINTNEXTLINE(bugprone-branch-clone)
-        // if (thread_restart_state::timeout != statex)    //-V601
-        // {
-        //     triggered->store(true);
-        //     // wake_timer_thread has not been executed yet, cancel timer
-        //     t.cancel();
-        // }
-        // else
-        // {
-        //     detail::set_thread_state(
-        //         thrd.noref(), newstate, newstate_ex, priority);
-        // }
+            return thread_result_type(
+                thread_schedule_state::terminated, invalid_thread_id);
+        }
+
+        if (started != nullptr)
+        {
+            started->store(true);
+        }
+
+        // this waits for the thread to be reactivated when the timer fired
+        // if it returns abort the timer has been canceled, otherwise
+        // the timer fired and the requested state change has to be applied
+        thread_restart_state statex = get_self().yield(thread_result_type(
+            thread_schedule_state::suspended, invalid_thread_id));
+
+        PIKA_ASSERT(statex == thread_restart_state::abort ||
+            statex == thread_restart_state::timeout);
+
+        cancel_timeout(timers, entry);
+
+        if (thread_restart_state::timeout == statex)    //-V601
+        {
+            detail::set_thread_state(
+                thrd.noref(), newstate, newstate_ex, priority);
+        }
 
         return thread_result_type(
             thread_schedule_state::terminated, invalid_thread_id);
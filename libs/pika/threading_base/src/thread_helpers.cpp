@@ -537,48 +537,48 @@ namespace pika { namespace this_thread {
 #ifdef PIKA_HAVE_THREAD_BACKTRACE_ON_SUSPENSION
             threads::detail::reset_backtrace bt(id, ec);
 #endif
-            std::atomic<bool> timer_started(false);
-            threads::thread_id_ref_type timer_id =
-                threads::set_thread_state(id.noref(), abs_time, &timer_started,
-                    threads::thread_schedule_state::pending,
-                    threads::thread_restart_state::timeout,
-                    threads::thread_priority::boost, true, ec);
-            if (ec)
-                return threads::thread_restart_state::unknown;
+            // register a timer waking us up at abs_time directly with the
+            // timer wheel of the current worker thread, the entry lives on
+            // our stack
+            auto* scheduler = get_thread_id_data(id)->get_scheduler_base();
+            threads::detail::timer_wheel& timers =
+                threads::detail::get_timer_wheel(scheduler);
+            threads::detail::timeout_entry timer(id.noref());
 
             // We might need to dispatch 'nextid' to it's correct scheduler
             // only if our current scheduler is the same, we should yield the id
             if (nextid &&
-                get_thread_id_data(nextid)->get_scheduler_base() !=
-                    get_thread_id_data(id)->get_scheduler_base())
+                get_thread_id_data(nextid)->get_scheduler_base() != scheduler)
             {
-                auto* scheduler =
+                auto* nextid_scheduler =
                     get_thread_id_data(nextid)->get_scheduler_base();
-                scheduler->schedule_thread(
+                nextid_scheduler->schedule_thread(
                     PIKA_MOVE(nextid), threads::thread_schedule_hint());
-                statex = self.yield(threads::thread_result_type(
-                    threads::thread_schedule_state::suspended,
-                    threads::invalid_thread_id));
+                nextid = threads::invalid_thread_id;
+            }
+
+            if (!timers.insert(timer, abs_time.value()))
+            {
+                // the deadline has passed already, there is no need to
+                // suspend
+                if (nextid)
+                {
+                    scheduler->schedule_thread(
+                        PIKA_MOVE(nextid), threads::thread_schedule_hint());
+                }
+                statex = threads::thread_restart_state::timeout;
             }
             else
             {
                 statex = self.yield(threads::thread_result_type(
                     threads::thread_schedule_state::suspended,
                     PIKA_MOVE(nextid)));
-            }
 
-            if (statex != threads::thread_restart_state::timeout)
-            {
-                PIKA_ASSERT(statex == threads::thread_restart_state::abort ||
+                PIKA_ASSERT(statex == threads::thread_restart_state::timeout ||
+                    statex == threads::thread_restart_state::abort ||
                     statex == threads::thread_restart_state::signaled);
-                error_code ec1(lightweight);    // do not throw
-                pika::util::yield_while(
-                    [&timer_started]() { return !timer_started.load(); },
-                    "set_thread_state_timed");
-                threads::set_thread_state(timer_id.noref(),
-                    threads::thread_schedule_state::pending,
-                    threads::thread_restart_state::abort,
-                    threads::thread_priority::boost, true, ec1);
+
+                threads::detail::cancel_timeout(timers, timer);
             }
         }
 
@@ -0,0 +1,361 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#if defined(PIKA_MSVC)
+#include <intrin.h>
+#endif
+
+namespace pika { namespace threads { namespace detail {
+
+    namespace {
+        constexpr std::uint64_t no_tick =
+            (std::numeric_limits<std::uint64_t>::max)();
+
+        constexpr std::uint64_t slot_mask = timer_wheel::num_slots - 1;
+
+        // the largest distance (in ticks) representable by the wheel
+        constexpr std::uint64_t max_delta =
+            (std::uint64_t(1)
+                << (timer_wheel::num_levels * timer_wheel::slot_bits)) -
+            1;
+
+        // x must not be zero
+        inline std::size_t count_trailing_zeros(std::uint64_t x) noexcept
+        {
+            PIKA_ASSERT(x != 0);
+#if defined(PIKA_MSVC)
+            unsigned long index = 0;
+            _BitScanForward64(&index, x);
+            return static_cast<std::size_t>(index);
+#else
+            return static_cast<std::size_t>(__builtin_ctzll(x));
+#endif
+        }
+
+        inline std::uint64_t rotate_right(
+            std::uint64_t x, std::size_t r) noexcept
+        {
+            return r == 0 ? x : (x >> r) | (x << (64 - r));
+        }
+    }    // namespace
+
+    timer_wheel::timer_wheel()
+      : count_(0)
+      , next_tick_(no_tick)
+      , now_(to_tick(clock_type::now()))
+      , occupied_{}
+      , slots_{}
+    {
+    }
+
+    std::uint64_t timer_wheel::to_tick(clock_type::time_point t) noexcept
+    {
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t.time_since_epoch())
+                            .count();
+        return ns <= 0 ? 0 : std::uint64_t(ns) >> tick_shift;
+    }
+
+    // Expiry times are rounded up to the next tick so that no entry expires
+    // before its requested time.
+    std::uint64_t timer_wheel::to_tick_ceil(clock_type::time_point t) noexcept
+    {
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t.time_since_epoch())
+                            .count();
+        return ns <= 0 ?
+            0 :
+            (std::uint64_t(ns) + (std::uint64_t(1) << tick_shift) - 1) >>
+                tick_shift;
+    }
+
+    // Entries are stored on the lowest level whose range covers their
+    // distance from now_. An entry on level L ends up in the slot which is
+    // reached (and cascaded to a lower level) at the first tick which is a
+    // multiple of num_slots^L and not after its expiry.
+    void timer_wheel::link(timer_wheel_entry& e) noexcept
+    {
+        PIKA_ASSERT(e.expiry_ >= now_);
+
+        std::uint64_t const delta = e.expiry_ - now_;
+        std::size_t level = 0;
+        while (level + 1 < num_levels &&
+            delta >= (std::uint64_t(1) << ((level + 1) * slot_bits)))
+        {
+            ++level;
+        }
+
+        // entries too far in the future are parked in the last slot of the
+        // top level and are re-inserted once they get cascaded
+        std::uint64_t const placed =
+            delta > max_delta ? now_ + max_delta : e.expiry_;
+        std::size_t const slot =
+            std::size_t((placed >> (level * slot_bits)) & slot_mask);
+
+        timer_wheel_entry*& head = slots_[level][slot];
+        e.level_ = static_cast<std::uint32_t>(level);
+        e.slot_ = static_cast<std::uint32_t>(slot);
+        e.prev_ = nullptr;
+        e.next_ = head;
+        if (head != nullptr)
+        {
+            head->prev_ = &e;
+        }
+        head = &e;
+        occupied_[level] |= std::uint64_t(1) << slot;
+    }
+
+    void timer_wheel::unlink(timer_wheel_entry& e) noexcept
+    {
+        timer_wheel_entry*& head = slots_[e.level_][e.slot_];
+        if (e.prev_ != nullptr)
+        {
+            e.prev_->next_ = e.next_;
+        }
+        else
+        {
+            PIKA_ASSERT(head == &e);
+            head = e.next_;
+        }
+
+        if (e.next_ != nullptr)
+        {
+            e.next_->prev_ = e.prev_;
+        }
+
+        if (head == nullptr)
+        {
+            occupied_[e.level_] &= ~(std::uint64_t(1) << e.slot_);
+        }
+
+        e.prev_ = nullptr;
+        e.next_ = nullptr;
+    }
+
+    void timer_wheel::cascade(std::size_t level, std::size_t slot) noexcept
+    {
+        timer_wheel_entry* e = slots_[level][slot];
+        slots_[level][slot] = nullptr;
+        occupied_[level] &= ~(std::uint64_t(1) << slot);
+
+        while (e != nullptr)
+        {
+            timer_wheel_entry* next = e->next_;
+            link(*e);
+            e = next;
+        }
+    }
+
+    // Returns the next tick after now_ at which a slot on any level has to
+    // be processed.
+    std::uint64_t timer_wheel::compute_next_tick() const
+        noexcept
+    {
+        std::uint64_t next = no_tick;
+        for (std::size_t level = 0; level != num_levels; ++level)
+        {
+            std::uint64_t const occupied = occupied_[level];
+            if (occupied == 0)
+            {
+                continue;
+            }
+
+            std::size_t const shift = level * slot_bits;
+            std::uint64_t const base = now_ >> shift;
+            std::size_t const first = std::size_t((base + 1) & slot_mask);
+            std::uint64_t const distance =
+                count_trailing_zeros(rotate_right(occupied, first)) + 1;
+            std::uint64_t const tick = (base + distance) << shift;
+
+            if (tick < next)
+            {
+                next = tick;
+            }
+        }
+        return next;
+    }
+
+    bool timer_wheel::insert(timer_wheel_entry& e, clock_type::time_point expiry)
+    {
+        if (expiry <= clock_type::now())
+        {
+            return false;
+        }
+
+        std::uint64_t const expiry_tick = to_tick_ceil(expiry);
+
+        std::lock_guard<util::spinlock> l(mtx_);
+        PIKA_ASSERT(e.state_.load(std::memory_order_relaxed) !=
+            timer_wheel_entry::state::armed);
+
+        if (expiry_tick <= now_)
+        {
+            return false;
+        }
+
+        e.expiry_ = expiry_tick;
+        e.state_.store(
+            timer_wheel_entry::state::armed, std::memory_order_relaxed);
+        link(e);
+
+        count_.fetch_add(1, std::memory_order_relaxed);
+        next_tick_.store(compute_next_tick(), std::memory_order_release);
+        return true;
+    }
+
+    bool timer_wheel::cancel(timer_wheel_entry& e)
+    {
+        std::lock_guard<util::spinlock> l(mtx_);
+        if (e.state_.load(std::memory_order_relaxed) !=
+            timer_wheel_entry::state::armed)
+        {
+            return false;
+        }
+
+        unlink(e);
+        e.state_.store(
+            timer_wheel_entry::state::idle, std::memory_order_relaxed);
+
+        count_.fetch_sub(1, std::memory_order_relaxed);
+        next_tick_.store(compute_next_tick(), std::memory_order_release);
+        return true;
+    }
+
+    std::size_t timer_wheel::poll(clock_type::time_point now, bool try_lock)
+    {
+        if (count_.load(std::memory_order_relaxed) == 0)
+        {
+            return 0;
+        }
+
+        std::uint64_t const target = to_tick(now);
+        if (target < next_tick_.load(std::memory_order_acquire))
+        {
+            return 0;
+        }
+
+        std::unique_lock<util::spinlock> l(mtx_, std::defer_lock);
+        if (try_lock)
+        {
+            if (!l.try_lock())
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            l.lock();
+        }
+
+        // Collect all expired entries while holding the lock, the callbacks
+        // are run after releasing it.
+        timer_wheel_entry* expired = nullptr;
+        std::size_t num_expired = 0;
+
+        std::uint64_t tick = compute_next_tick();
+        while (tick <= target)
+        {
+            now_ = tick;
+
+            // move entries from higher levels closer to their expiry,
+            // starting from the top-most level that has reached a slot
+            // boundary
+            for (std::size_t level = num_levels - 1; level != 0; --level)
+            {
+                std::size_t const shift = level * slot_bits;
+                if ((tick & ((std::uint64_t(1) << shift) - 1)) != 0)
+                {
+                    continue;
+                }
+
+                std::size_t const slot =
+                    std::size_t((tick >> shift) & slot_mask);
+                if (occupied_[level] & (std::uint64_t(1) << slot))
+                {
+                    cascade(level, slot);
+                }
+            }
+
+            std::size_t const slot = std::size_t(tick & slot_mask);
+            timer_wheel_entry* e = slots_[0][slot];
+            slots_[0][slot] = nullptr;
+            occupied_[0] &= ~(std::uint64_t(1) << slot);
+
+            while (e != nullptr)
+            {
+                timer_wheel_entry* next = e->next_;
+                PIKA_ASSERT(e->expiry_ == tick);
+
+                e->state_.store(timer_wheel_entry::state::expiring,
+                    std::memory_order_relaxed);
+                e->prev_ = nullptr;
+                e->next_ = expired;
+                expired = e;
+                ++num_expired;
+
+                e = next;
+            }
+
+            tick = compute_next_tick();
+        }
+
+        if (target > now_)
+        {
+            now_ = target;
+        }
+
+        count_.fetch_sub(num_expired, std::memory_order_relaxed);
+        next_tick_.store(compute_next_tick(), std::memory_order_release);
+
+        l.unlock();
+
+        while (expired != nullptr)
+        {
+            timer_wheel_entry* next = expired->next_;
+            expired->next_ = nullptr;
+
+            expired->on_expired_(*expired);
+
+            // the entry must not be touched after this store, its owner may
+            // release it as soon as it observes the new state
+            expired->state_.store(timer_wheel_entry::state::expired,
+                std::memory_order_release);
+
+            expired = next;
+        }
+
+        return num_expired;
+    }
+
+    timer_wheel::clock_type::time_point timer_wheel::next_expiry()
+        const noexcept
+    {
+        std::uint64_t const tick = next_tick_.load(std::memory_order_acquire);
+        if (count_.load(std::memory_order_relaxed) == 0 || tick == no_tick ||
+            tick > (std::uint64_t(
+                        (std::numeric_limits<std::int64_t>::max)()) >>
+                       tick_shift))
+        {
+            return clock_type::time_point::max();
+        }
+
+        return clock_type::time_point(
+            std::chrono::duration_cast<clock_type::duration>(
+                std::chrono::nanoseconds(
+                    std::int64_t(tick << tick_shift))));
+    }
+}}}    // namespace pika::threads::detail
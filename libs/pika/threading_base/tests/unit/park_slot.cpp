@@ -0,0 +1,94 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/testing.hpp>
+#include <pika/threading_base/detail/park_slot.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+using pika::threads::detail::park_slot;
+using clock_type = park_slot::clock_type;
+
+void test_timeout()
+{
+    park_slot s;
+    PIKA_TEST(!s.is_parked());
+
+    // nobody is parked, unparking has no effect
+    PIKA_TEST(!s.unpark());
+
+    auto const deadline = clock_type::now() + std::chrono::milliseconds(10);
+    PIKA_TEST(!s.park(deadline));
+    PIKA_TEST(clock_type::now() >= deadline);
+    PIKA_TEST(!s.is_parked());
+
+    // a deadline in the past returns immediately
+    PIKA_TEST(!s.park(clock_type::now() - std::chrono::seconds(1)));
+}
+
+void test_unpark()
+{
+    park_slot s;
+    std::atomic<bool> woken(false);
+
+    std::thread t([&] {
+        // the deadline is far enough in the future to only be reached if
+        // the wakeup is lost
+        woken = s.park(clock_type::now() + std::chrono::seconds(30));
+    });
+
+    while (!s.is_parked())
+    {
+        std::this_thread::yield();
+    }
+
+    PIKA_TEST(s.unpark());
+    t.join();
+
+    PIKA_TEST(woken);
+    PIKA_TEST(!s.is_parked());
+    PIKA_TEST(!s.unpark());
+}
+
+void test_unpark_repeated()
+{
+    park_slot s;
+    std::size_t const iterations = 1000;
+    std::atomic<std::size_t> num_woken(0);
+
+    std::thread t([&] {
+        for (std::size_t i = 0; i != iterations; ++i)
+        {
+            if (s.park(clock_type::now() + std::chrono::seconds(30)))
+            {
+                ++num_woken;
+            }
+        }
+    });
+
+    for (std::size_t i = 0; i != iterations; ++i)
+    {
+        while (!s.unpark())
+        {
+            std::this_thread::yield();
+        }
+    }
+    t.join();
+
+    PIKA_TEST_EQ(num_woken.load(), iterations);
+}
+
+int main()
+{
+    test_timeout();
+    test_unpark();
+    test_unpark_repeated();
+
+    return pika::util::report_errors();
+}
@@ -0,0 +1,159 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/testing.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+using pika::threads::detail::timer_wheel;
+using pika::threads::detail::timer_wheel_entry;
+using clock_type = timer_wheel::clock_type;
+
+unsigned int seed = std::random_device{}();
+
+struct test_entry : timer_wheel_entry
+{
+    test_entry()
+      : timer_wheel_entry(&test_entry::on_expired)
+    {
+    }
+
+    static void on_expired(timer_wheel_entry& e)
+    {
+        auto& self = static_cast<test_entry&>(e);
+        ++self.count;
+    }
+
+    std::size_t count = 0;
+    clock_type::time_point expiry;
+};
+
+void test_basic()
+{
+    timer_wheel w;
+    PIKA_TEST_EQ(w.size(), std::size_t(0));
+    PIKA_TEST(w.next_expiry() == clock_type::time_point::max());
+
+    // deadlines in the past are rejected
+    test_entry past;
+    PIKA_TEST(!w.insert(past, clock_type::now() - std::chrono::seconds(1)));
+    PIKA_TEST_EQ(w.size(), std::size_t(0));
+
+    test_entry e;
+    auto const start = clock_type::now();
+    e.expiry = start + std::chrono::milliseconds(10);
+    PIKA_TEST(w.insert(e, e.expiry));
+    PIKA_TEST_EQ(w.size(), std::size_t(1));
+    PIKA_TEST(w.next_expiry() <= e.expiry);
+
+    // nothing expires before the deadline
+    PIKA_TEST_EQ(w.poll(start), std::size_t(0));
+    PIKA_TEST_EQ(e.count, std::size_t(0));
+
+    PIKA_TEST_EQ(w.poll(e.expiry + std::chrono::microseconds(2)),
+        std::size_t(1));
+    PIKA_TEST_EQ(e.count, std::size_t(1));
+    PIKA_TEST(e.has_expired());
+    PIKA_TEST_EQ(w.size(), std::size_t(0));
+
+    // expired entries can't be cancelled, but they can be reused
+    PIKA_TEST(!w.cancel(e));
+    PIKA_TEST(w.insert(e, clock_type::now() + std::chrono::hours(1)));
+    PIKA_TEST(w.cancel(e));
+    PIKA_TEST(!w.cancel(e));
+    PIKA_TEST_EQ(w.size(), std::size_t(0));
+    PIKA_TEST_EQ(e.count, std::size_t(1));
+}
+
+void test_random()
+{
+    std::mt19937 gen(seed);
+
+    // spread deadlines over all levels of the wheel, including deadlines
+    // beyond its range
+    std::uniform_int_distribution<std::int64_t> dist_exp(0, 42);
+    std::uniform_int_distribution<int> dist_cancel(0, 3);
+
+    std::size_t const num_entries = 1000;
+    std::vector<std::unique_ptr<test_entry>> entries;
+    entries.reserve(num_entries);
+
+    // leave enough time for all insertions to happen before the first
+    // deadline
+    timer_wheel w;
+    auto const start = clock_type::now() + std::chrono::seconds(10);
+    std::size_t armed = 0;
+    for (std::size_t i = 0; i != num_entries; ++i)
+    {
+        entries.push_back(std::make_unique<test_entry>());
+        test_entry& e = *entries.back();
+        std::uniform_int_distribution<std::int64_t> dist(
+            0, std::int64_t(1) << dist_exp(gen));
+        e.expiry = start + std::chrono::nanoseconds(1000 + dist(gen));
+        PIKA_TEST(w.insert(e, e.expiry));
+        ++armed;
+    }
+
+    for (auto& e : entries)
+    {
+        if (dist_cancel(gen) == 0)
+        {
+            PIKA_TEST(w.cancel(*e));
+            e->count = std::size_t(-1);
+            --armed;
+        }
+    }
+    PIKA_TEST_EQ(w.size(), armed);
+
+    // advance simulated time in irregular steps until the wheel is empty
+    std::uniform_int_distribution<std::int64_t> dist_step(0, 34);
+    auto now = start;
+    while (w.size() != 0)
+    {
+        now += std::chrono::nanoseconds(std::int64_t(1) << dist_step(gen));
+        w.poll(now);
+
+        for (auto& e : entries)
+        {
+            if (e->count == std::size_t(-1))
+            {
+                continue;
+            }
+
+            // no entry may expire early, and every entry has to expire
+            // exactly once within the resolution of the wheel
+            if (e->expiry > now)
+            {
+                PIKA_TEST_EQ(e->count, std::size_t(0));
+            }
+            else if (now - e->expiry >=
+                std::chrono::nanoseconds(std::int64_t(1)
+                    << timer_wheel::tick_shift))
+            {
+                PIKA_TEST_EQ(e->count, std::size_t(1));
+            }
+        }
+    }
+
+    for (auto& e : entries)
+    {
+        PIKA_TEST(e->count == 1 || e->count == std::size_t(-1));
+    }
+}
+
+int main()
+{
+    test_basic();
+    test_random();
+
+    return pika::util::report_errors();
+}
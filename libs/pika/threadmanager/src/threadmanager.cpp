@@ -56,6 +56,32 @@ namespace pika { namespace threads {
                     "than number of threads (--pika:threads)");
             }
         }
+
+        policies::steal_policy parse_steal_policy(std::string const& policy)
+        {
+            if (policy == "radial")
+            {
+                return policies::steal_policy::radial;
+            }
+            else if (policy == "random")
+            {
+                return policies::steal_policy::random;
+            }
+            else if (policy == "hierarchical")
+            {
+                return policies::steal_policy::hierarchical;
+            }
+            else if (policy == "last-victim")
+            {
+                return policies::steal_policy::last_victim;
+            }
+
+            throw pika::detail::command_line_error(
+                "Invalid value for pika.thread_queue.steal_policy: \"" +
+                policy +
+                "\", should be one of radial, random, hierarchical, or "
+                "last-victim");
+        }
     }    // namespace detail
 
     ///////////////////////////////////////////////////////////////////////////
@@ -135,8 +161,14 @@ namespace pika { namespace threads {
             pika::util::get_entry_as<std::int64_t>(rtcfg_,
                 "pika.thread_queue.init_threads_count",
                 PIKA_THREAD_QUEUE_INIT_THREADS_COUNT);
+        std::int64_t const max_cached_threads =
+            pika::util::get_entry_as<std::int64_t>(rtcfg_,
+                "pika.thread_queue.max_cached_threads",
+                PIKA_THREAD_QUEUE_MAX_CACHED_THREADS);
         double const max_idle_backoff_time = pika::util::get_entry_as<double>(
             rtcfg_, "pika.max_idle_backoff_time", PIKA_IDLE_BACKOFF_TIME_MAX);
+        policies::steal_policy const steal_policy = detail::parse_steal_policy(
+            rtcfg_.get_entry("pika.thread_queue.steal_policy", "radial"));
 
         std::ptrdiff_t small_stacksize =
             rtcfg_.get_stack_size(thread_stacksize::small_);
@@ -152,7 +184,8 @@ namespace pika { namespace threads {
             min_tasks_to_steal_staged, min_add_new_count, max_add_new_count,
             min_delete_count, max_delete_count, max_terminated_threads,
             init_threads_count, max_idle_backoff_time, small_stacksize,
-            medium_stacksize, large_stacksize, huge_stacksize);
+            medium_stacksize, large_stacksize, huge_stacksize,
+            max_cached_threads, steal_policy);
 
         // instantiate the pools
         for (size_t i = 0; i != num_pools; i++)
@@ -496,6 +529,45 @@ namespace pika { namespace threads {
                 pools_.push_back(PIKA_MOVE(pool));
                 break;
             }
+
+            case resource::local_priority_chase_lev:
+            {
+                // set parameters for scheduler and pool instantiation and
+                // perform compatibility checks
+                std::size_t num_high_priority_queues =
+                    pika::util::get_entry_as<std::size_t>(rtcfg_,
+                        "pika.thread_queue.high_priority_queues",
+                        thread_pool_init.num_threads_);
+                detail::check_num_high_priority_queues(
+                    thread_pool_init.num_threads_, num_high_priority_queues);
+
+                // instantiate the scheduler
+                using local_sched_type =
+                    pika::threads::policies::local_priority_queue_scheduler<
+                        std::mutex, pika::threads::policies::chase_lev_lifo>;
+
+                local_sched_type::init_parameter_type init(
+                    thread_pool_init.num_threads_,
+                    thread_pool_init.affinity_data_, num_high_priority_queues,
+                    thread_queue_init,
+                    "core-local_priority_chase_lev_queue_scheduler");
+
+                std::unique_ptr<local_sched_type> sched(
+                    new local_sched_type(init));
+
+                // set the default scheduler flags
+                sched->set_scheduler_mode(thread_pool_init.mode_);
+                // conditionally set/unset this flag
+                sched->update_scheduler_mode(
+                    policies::enable_stealing_numa, !numa_sensitive);
+
+                // instantiate the pool
+                std::unique_ptr<thread_pool_base> pool(
+                    new pika::threads::detail::scheduled_thread_pool<
+                        local_sched_type>(PIKA_MOVE(sched), thread_pool_init));
+                pools_.push_back(PIKA_MOVE(pool));
+                break;
+            }
             }
 
             // update the thread_offset for the next pool
@@ -168,6 +168,17 @@ namespace pika::threads::detail {
         mask_cref_type get_numa_node_affinity_mask(
             std::size_t num_thread, error_code& ec = throws) const;
 
+        /// \brief Return a bit mask where each set bit corresponds to a
+        ///        processing unit available to the given thread which shares
+        ///        the last level (L3) cache with it. If the topology has no
+        ///        L3 cache information this is the NUMA domain mask.
+        ///
+        /// \param ec         [in,out] this represents the error status on exit,
+        ///                   if this is pre-initialized to \a pika#throws
+        ///                   the function will throw on error instead.
+        mask_cref_type get_cache_affinity_mask(
+            std::size_t num_thread, error_code& ec = throws) const;
+
         /// \brief Return a bit mask where each set bit corresponds to a
         ///        processing unit associated with the given NUMA node.
         ///
@@ -355,6 +366,8 @@ namespace pika::threads::detail {
                 get_numa_node_number(num_thread));
         }
 
+        mask_type init_cache_affinity_mask(std::size_t num_thread) const;
+
         mask_type init_core_affinity_mask(std::size_t num_thread) const
         {
             mask_type default_mask = numa_node_affinity_masks_[num_thread];
@@ -403,6 +416,7 @@ namespace pika::threads::detail {
         mask_type machine_affinity_mask_;
         std::vector<mask_type> socket_affinity_masks_;
         std::vector<mask_type> numa_node_affinity_masks_;
+        std::vector<mask_type> cache_affinity_masks_;
         std::vector<mask_type> core_affinity_masks_;
         std::vector<mask_type> thread_affinity_masks_;
     };
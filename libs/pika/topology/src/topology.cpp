@@ -278,6 +278,7 @@ namespace pika::threads::detail {
         machine_affinity_mask_ = init_machine_affinity_mask();
         socket_affinity_masks_.reserve(num_of_pus_);
         numa_node_affinity_masks_.reserve(num_of_pus_);
+        cache_affinity_masks_.reserve(num_of_pus_);
         core_affinity_masks_.reserve(num_of_pus_);
         thread_affinity_masks_.reserve(num_of_pus_);
 
@@ -292,6 +293,11 @@ namespace pika::threads::detail {
                 init_numa_node_affinity_mask(i));
         }
 
+        for (std::size_t i = 0; i < num_of_pus_; ++i)
+        {
+            cache_affinity_masks_.push_back(init_cache_affinity_mask(i));
+        }
+
         for (std::size_t i = 0; i < num_of_pus_; ++i)
         {
             core_affinity_masks_.push_back(init_core_affinity_mask(i));
@@ -333,6 +339,8 @@ namespace pika::threads::detail {
             "socket_affinity_mask", socket_affinity_masks_);
         detail::write_to_log_mask(
             "numa_node_affinity_mask", numa_node_affinity_masks_);
+        detail::write_to_log_mask(
+            "cache_affinity_mask", cache_affinity_masks_);
         detail::write_to_log_mask("core_affinity_mask", core_affinity_masks_);
         detail::write_to_log_mask(
             "thread_affinity_mask", thread_affinity_masks_);
@@ -434,6 +442,25 @@ namespace pika::threads::detail {
         return empty_mask;
     }    // }}}
 
+    mask_cref_type topology::get_cache_affinity_mask(
+        std::size_t num_thread, error_code& ec) const
+    {
+        std::size_t num_pu = num_thread % num_of_pus_;
+
+        if (num_pu < cache_affinity_masks_.size())
+        {
+            if (&ec != &throws)
+                ec = make_success_code();
+
+            return cache_affinity_masks_[num_pu];
+        }
+
+        PIKA_THROWS_IF(ec, bad_parameter,
+            "pika::threads::detail::topology::get_cache_affinity_mask",
+            "thread number {1} is out of range", num_thread);
+        return empty_mask;
+    }
+
     mask_cref_type topology::get_core_affinity_mask(
         std::size_t num_thread, error_code& ec) const
     {
@@ -1084,6 +1111,43 @@ namespace pika::threads::detail {
         return machine_affinity_mask_;
     }    // }}}
 
+    mask_type topology::init_cache_affinity_mask(std::size_t num_thread) const
+    {    // {{{
+        std::size_t num_pu = (num_thread + pu_offset) % num_of_pus_;
+
+        hwloc_obj_t obj = nullptr;
+        {
+            std::unique_lock<mutex_type> lk(topo_mtx);
+            obj = hwloc_get_obj_by_type(
+                topo, HWLOC_OBJ_PU, static_cast<unsigned>(num_pu));
+
+            // find the L3 cache object containing this processing unit
+            while (obj != nullptr)
+            {
+#if HWLOC_API_VERSION >= 0x00020000
+                if (obj->type == HWLOC_OBJ_L3CACHE)
+#else
+                if (obj->type == HWLOC_OBJ_CACHE && obj->attr->cache.depth == 3)
+#endif
+                {
+                    break;
+                }
+                obj = obj->parent;
+            }
+        }
+
+        if (obj)
+        {
+            mask_type cache_affinity_mask = mask_type();
+            resize(cache_affinity_mask, get_number_of_pus());
+
+            extract_node_mask(obj, cache_affinity_mask);
+            return cache_affinity_mask;
+        }
+
+        return numa_node_affinity_masks_[num_thread];
+    }    // }}}
+
     mask_type topology::init_core_affinity_mask_from_core(
         std::size_t core, mask_cref_type default_mask) const
     {    // {{{
@@ -1558,6 +1622,8 @@ namespace pika::threads::detail {
         print_mask_vector(os, socket_affinity_masks_);
         os << "numa node             : \n";
         print_mask_vector(os, numa_node_affinity_masks_);
+        os << "cache                 : \n";
+        print_mask_vector(os, cache_affinity_masks_);
         os << "core                  : \n";
         print_mask_vector(os, core_affinity_masks_);
         os << "PUs (/threads)        : \n";
@@ -0,0 +1,115 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark compares the loop schedules of the fork_join_executor for
+// workloads where every element has the same cost, where the cost grows
+// linearly with the index (as in loops over triangular matrices), and where
+// the cost of each element is random. openmp_loop_schedules runs the same
+// workloads with the corresponding OpenMP schedules.
+
+#include <pika/execution.hpp>
+#include <pika/executors/fork_join_executor.hpp>
+#include <pika/init.hpp>
+#include <pika/iterator_support/counting_shape.hpp>
+#include <pika/testing/performance.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+
+// Spins for the given number of units of work.
+void do_work(std::uint64_t cost)
+{
+    double volatile x = 0.0;
+    for (std::uint64_t i = 0; i != cost; ++i)
+    {
+        x = x + 1.0;
+    }
+}
+
+void run_bulk(
+    ex::fork_join_executor& exec, std::vector<std::uint64_t> const& costs)
+{
+    exec.bulk_sync_execute([&](std::size_t i) { do_work(costs[i]); },
+        pika::util::detail::make_counting_shape(costs.size()));
+}
+
+int pika_main(pika::program_options::variables_map& vm)
+{
+    std::size_t const size = vm["size"].as<std::size_t>();
+    std::uint64_t const cost = vm["cost"].as<std::uint64_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+
+    // All workloads have the same total cost.
+    std::vector<std::uint64_t> uniform(size, cost);
+
+    std::vector<std::uint64_t> triangular(size);
+    for (std::size_t i = 0; i != size; ++i)
+    {
+        triangular[i] = 2 * cost * i / size;
+    }
+
+    std::vector<std::uint64_t> random(size);
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::uint64_t> dist(0, 2 * cost);
+    for (auto& c : random)
+    {
+        c = dist(gen);
+    }
+
+    for (auto const schedule : {
+             ex::fork_join_executor::loop_schedule::static_,
+             ex::fork_join_executor::loop_schedule::dynamic,
+             ex::fork_join_executor::loop_schedule::guided,
+             ex::fork_join_executor::loop_schedule::adaptive,
+         })
+    {
+        ex::fork_join_executor exec{pika::threads::thread_priority::high,
+            pika::threads::thread_stacksize::small_, schedule};
+
+        std::ostringstream executor;
+        executor << "fork_join_executor, " << schedule;
+
+        pika::util::perftests_report("bulk, uniform cost", executor.str(),
+            repetitions, [&]() { run_bulk(exec, uniform); });
+        pika::util::perftests_report("bulk, triangular cost", executor.str(),
+            repetitions, [&]() { run_bulk(exec, triangular); });
+        pika::util::perftests_report("bulk, random cost", executor.str(),
+            repetitions, [&]() { run_bulk(exec, random); });
+    }
+
+    pika::util::perftests_print_times();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    using pika::program_options::options_description;
+    using pika::program_options::value;
+
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("size", value<std::size_t>()->default_value(100000),
+         "number of elements in the bulk operations")
+        ("cost", value<std::uint64_t>()->default_value(100),
+         "average units of work per element")
+        ("repetitions", value<std::size_t>()->default_value(10),
+         "number of repetitions of each measurement");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -7,29 +7,64 @@
 
 // make inspect happy: pikainspect:nodeprecatedinclude pikainspect:nodeprecatedname
 
+// This benchmark measures the overhead of calling function objects through
+// the various function wrappers, and the number of memory allocations caused
+// by storing closures of different sizes in them. The latter is also measured
+// for spawning tasks, where the closure is stored in the thread function.
+
 #include <pika/functional/function.hpp>
+#include <pika/functional/unique_function.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
 #include <pika/modules/timing.hpp>
-#include <pika/pika.hpp>
+#include <pika/thread.hpp>
 
 #include <pika/modules/program_options.hpp>
 #include <boost/function.hpp>
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <new>
 
 #include "worker_timed.hpp"
 
-using pika::program_options::command_line_parser;
-using pika::program_options::notify;
 using pika::program_options::options_description;
-using pika::program_options::store;
 using pika::program_options::value;
 using pika::program_options::variables_map;
 
 std::uint64_t iterations = 500000;
 std::uint64_t delay = 5;
 
+///////////////////////////////////////////////////////////////////////////////
+// count all allocations done through the global operator new
+std::atomic<std::uint64_t> allocations(0);
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+///////////////////////////////////////////////////////////////////////////////
 struct foo
 {
     void operator()() const
@@ -51,21 +86,97 @@ void run(F const& f, std::uint64_t local_iterations)
     std::cout << " walltime/iteration: " << ((elapsed / i) * 1e9) << " ns\n";
 }
 
-int app_main(variables_map& vm)
+///////////////////////////////////////////////////////////////////////////////
+// a callable of (at least) N bytes
+template <std::size_t N>
+struct closure
 {
+    unsigned char data[N] = {};
+
+    void operator()() const {}
+};
+
+template <typename Function, std::size_t N>
+void construct(char const* name, std::uint64_t local_iterations)
+{
+    std::uint64_t const allocations_before = allocations;
+    pika::chrono::high_resolution_timer t;
+
+    std::uint64_t i = 0;
+    for (; i < local_iterations; ++i)
+    {
+        Function f = closure<N>();
+        f();
+    }
+
+    double elapsed = t.elapsed();
+    std::cout << name << " (" << sizeof(closure<N>) << " byte closure)"
+              << " walltime/iteration: " << ((elapsed / i) * 1e9) << " ns"
+              << ", allocations/iteration: "
+              << double(allocations - allocations_before) / double(i) << "\n";
+}
+
+template <std::size_t N>
+void construct_all(std::uint64_t local_iterations)
+{
+    construct<pika::util::unique_function<void()>, N>(
+        "pika::util::unique_function", local_iterations);
+    construct<pika::util::unique_function<void(), 128>, N>(
+        "pika::util::unique_function<void(), 128>", local_iterations);
+    // the inline buffer of the function wrapper used for task functions
+    construct<pika::util::unique_function<void(),
+                  PIKA_THREAD_FUNCTION_STORAGE_SIZE>,
+        N>("pika::util::unique_function (task sized)", local_iterations);
+    construct<std::function<void()>, N>("std::function", local_iterations);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <std::size_t N>
+void spawn(std::uint64_t num_tasks)
+{
+    pika::latch l(num_tasks + 1);
+    closure<N> c;
+
+    std::uint64_t const allocations_before = allocations;
+    pika::chrono::high_resolution_timer t;
+
+    for (std::uint64_t i = 0; i != num_tasks; ++i)
+    {
+        pika::apply([&l, c]() {
+            c();
+            worker_timed(delay * 1000);
+            l.count_down(1);
+        });
+    }
+    l.arrive_and_wait();
+
+    double elapsed = t.elapsed();
+    std::cout << "spawn (" << sizeof(closure<N>) + sizeof(void*)
+              << " byte closure) walltime/task: "
+              << ((elapsed / num_tasks) * 1e9) << " ns"
+              << ", allocations/task: "
+              << double(allocations - allocations_before) / double(num_tasks)
+              << "\n";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::uint64_t const tasks = vm["tasks"].as<std::uint64_t>();
+
     {
         foo f;
         std::cout << "baseline";
         run(f, iterations);
     }
     {
-        pika::util::function<void(), false> f = foo();
-        std::cout << "pika::util::function (non-serializable)";
+        pika::util::unique_function<void()> f = foo();
+        std::cout << "pika::util::unique_function";
         run(f, iterations);
     }
     {
         pika::util::function<void()> f = foo();
-        std::cout << "pika::util::function (serializable)";
+        std::cout << "pika::util::function";
         run(f, iterations);
     }
     {
@@ -79,36 +190,37 @@ int app_main(variables_map& vm)
         run(f, iterations);
     }
 
-    return 0;
+    construct_all<8>(iterations);
+    construct_all<32>(iterations);
+    construct_all<48>(iterations);
+    construct_all<112>(iterations);
+
+    // the task closures additionally capture a reference to the latch
+    spawn<8>(tasks);
+    spawn<32>(tasks);
+    spawn<48>(tasks);
+    spawn<112>(tasks);
+
+    return pika::finalize();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 int main(int argc, char* argv[])
 {
-    ///////////////////////////////////////////////////////////////////////////
-    // Parse command line.
-    variables_map vm;
-
     options_description cmdline("Usage: " PIKA_APPLICATION_STRING " [options]");
 
-    cmdline.add_options()("help,h", "print out program usage (this message)")
-
+    // clang-format off
+    cmdline.add_options()
         ("iterations", value<std::uint64_t>(&iterations)->default_value(500000),
-            "number of iterations to invoke for each test")
-
-            ("delay", value<std::uint64_t>(&delay)->default_value(5),
-                "duration of delay in microseconds");
-
-    store(command_line_parser(argc, argv).options(cmdline).run(), vm);
+         "number of iterations to invoke for each test")
+        ("delay", value<std::uint64_t>(&delay)->default_value(5),
+         "duration of delay in microseconds")
+        ("tasks", value<std::uint64_t>()->default_value(100000),
+         "number of tasks to spawn for each closure size");
+    // clang-format on
 
-    notify(vm);
-
-    // Print help screen.
-    if (vm.count("help"))
-    {
-        std::cout << cmdline;
-        return 0;
-    }
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
 
-    return app_main(vm);
+    return pika::init(pika_main, argc, argv, init_args);
 }
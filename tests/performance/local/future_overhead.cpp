@@ -158,6 +158,58 @@ void measure_function_futures_wait_all(
     print_stats("async", "WaitAll", exec_name(exec), count, duration, csv);
 }
 
+// Time attaching a continuation to a future which is made ready afterwards
+void measure_function_futures_then(std::uint64_t count, bool csv)
+{
+    std::vector<future<double>> futures;
+    futures.reserve(count);
+
+    // start the clock
+    high_resolution_timer walltime;
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        pika::lcos::local::promise<void> p;
+        futures.push_back(p.get_future().then(pika::launch::sync,
+            [](future<void>&&) { return null_function(); }));
+        p.set_value();
+    }
+    pika::wait_all(futures);
+
+    const double duration = walltime.elapsed();
+    print_stats("then", "WaitAll", "launch::sync", count, duration, csv);
+}
+
+// Time attaching several continuations to a shared future which is made ready
+// afterwards
+void measure_function_futures_shared_then(std::uint64_t count, bool csv)
+{
+    constexpr std::uint64_t num_continuations = 8;
+
+    std::vector<future<double>> futures;
+    futures.reserve(count);
+
+    // start the clock
+    high_resolution_timer walltime;
+    for (std::uint64_t i = 0; i < count; i += num_continuations)
+    {
+        pika::lcos::local::promise<void> p;
+        pika::shared_future<void> f = p.get_future().share();
+        for (std::uint64_t j = 0; j < num_continuations && i + j < count; ++j)
+        {
+            futures.push_back(f.then(pika::launch::sync,
+                [](pika::shared_future<void> const&) {
+                    return null_function();
+                }));
+        }
+        p.set_value();
+    }
+    pika::wait_all(futures);
+
+    const double duration = walltime.elapsed();
+    print_stats(
+        "shared_future::then", "WaitAll", "launch::sync", count, duration, csv);
+}
+
 template <typename Executor>
 void measure_function_futures_limiting_executor(
     std::uint64_t count, bool csv, Executor exec)
@@ -450,6 +502,7 @@ int pika_main(variables_map& vm)
             numa_sensitive = 0;
 
         bool test_all = (vm.count("test-all") > 0);
+        bool test_limiting = (vm.count("limiting-executor") > 0);
         const int repetitions = vm["repetitions"].as<int>();
 
         if (vm.count("info"))
@@ -475,6 +528,14 @@ int pika_main(variables_map& vm)
 
         for (int i = 0; i < repetitions; i++)
         {
+            if (test_limiting)
+            {
+                // only the throughput of the executor interface of
+                // limiting_executor, without throttle and rate limit
+                measure_function_futures_limiting_executor(count, csv, par);
+                continue;
+            }
+
             measure_function_futures_create_thread_hierarchical_placement(
                 count, csv);
             if (test_all)
@@ -482,6 +543,8 @@ int pika_main(variables_map& vm)
                 measure_function_futures_limiting_executor(count, csv, par);
                 measure_function_futures_wait_each(count, csv, par);
                 measure_function_futures_wait_all(count, csv, par);
+                measure_function_futures_then(count, csv);
+                measure_function_futures_shared_then(count, csv);
                 measure_function_futures_sliding_semaphore(count, csv, par);
                 measure_function_futures_for_loop(count, csv, par);
                 measure_function_futures_for_loop(count, csv, par_agg);
@@ -515,6 +578,7 @@ int main(int argc, char* argv[])
 
         ("csv", "output results as csv (format: count,duration)")
         ("test-all", "run all benchmarks")
+        ("limiting-executor", "run only the limiting_executor benchmark")
         ("repetitions", value<int>()->default_value(1),
          "number of repetitions of the full benchmark")
 
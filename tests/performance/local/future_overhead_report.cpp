@@ -9,6 +9,7 @@
 #include <pika/config.hpp>
 #include <pika/chrono.hpp>
 #include <pika/future.hpp>
+#include <pika/futures/detail/future_data_pool.hpp>
 #include <pika/init.hpp>
 #include <pika/testing.hpp>
 #include <pika/thread.hpp>
@@ -16,8 +17,10 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <iostream>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 using pika::program_options::options_description;
 using pika::program_options::value;
@@ -67,6 +70,68 @@ struct scratcher
     }
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// Prints the allocations of future shared states done since the statistics in
+// before were collected
+void print_future_data_pool_statistics(std::string const& name,
+    pika::lcos::detail::future_data_pool_statistics const& before)
+{
+#if defined(PIKA_HAVE_FUTURE_DATA_POOL)
+    auto const after = pika::lcos::detail::get_future_data_pool_statistics();
+    std::cout << "future data pool (" << name << "): "
+              << "allocations " << after.allocations - before.allocations
+              << ", reused " << after.reused_blocks - before.reused_blocks
+              << ", allocated "
+              << after.allocated_blocks - before.allocated_blocks
+              << ", large "
+              << after.large_allocations - before.large_allocations
+              << ", remote deallocations "
+              << after.remote_deallocations - before.remote_deallocations
+              << std::endl;
+#else
+    PIKA_UNUSED(name);
+    PIKA_UNUSED(before);
+#endif
+}
+
+void measure_function_futures_wait_all(
+    std::uint64_t count, int const repetitions)
+{
+    std::string const name = "future overhead - async - wait_all";
+    auto const before = pika::lcos::detail::get_future_data_pool_statistics();
+
+    pika::util::perftests_report(name, "no-executor", repetitions, [&]() {
+        std::vector<future<double>> futures;
+        futures.reserve(count);
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            futures.push_back(async(&null_function));
+        }
+        pika::wait_all(futures);
+    });
+
+    print_future_data_pool_statistics(name, before);
+}
+
+void measure_function_futures_then(std::uint64_t count, int const repetitions)
+{
+    std::string const name = "future overhead - then - wait_all";
+    auto const before = pika::lcos::detail::get_future_data_pool_statistics();
+
+    pika::util::perftests_report(name, "no-executor", repetitions, [&]() {
+        std::vector<future<double>> futures;
+        futures.reserve(count);
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            futures.push_back(pika::make_ready_future().then(
+                [](future<void>&&) { return null_function(); }));
+        }
+        pika::wait_all(futures);
+    });
+
+    print_future_data_pool_statistics(name, before);
+}
+
 void measure_function_futures_create_thread_hierarchical_placement(
     std::uint64_t count, const int repetitions)
 {
@@ -136,7 +201,6 @@ void measure_function_futures_create_thread_hierarchical_placement(
             }
             l.wait();
         });
-    pika::util::perftests_print_times();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -169,6 +233,9 @@ int pika_main(variables_map& vm)
         {
             measure_function_futures_create_thread_hierarchical_placement(
                 count, repetitions);
+            measure_function_futures_wait_all(count, repetitions);
+            measure_function_futures_then(count, repetitions);
+            pika::util::perftests_print_times();
         }
     }
 
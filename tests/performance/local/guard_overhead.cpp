@@ -0,0 +1,123 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the overhead of running tasks through composable
+// guards (pika::lcos::local::run_guarded), once on a single guard, once on a
+// set of two guards and once with several tasks updating the same guarded
+// object concurrently.
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/lcos/composable_guard.hpp>
+#include <pika/testing/performance.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using pika::lcos::local::guard;
+using pika::lcos::local::guard_set;
+
+///////////////////////////////////////////////////////////////////////////////
+void check(std::size_t value, std::size_t expected)
+{
+    if (value != expected)
+    {
+        throw std::logic_error("guard_overhead: wrong value");
+    }
+}
+
+void single_guard(std::size_t count)
+{
+    guard g;
+    std::size_t value = 0;
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        pika::lcos::local::run_guarded(g, [&value]() { ++value; });
+    }
+    check(value, count);
+}
+
+void two_guards(std::size_t count)
+{
+    guard_set gs;
+    gs.add(std::make_shared<guard>());
+    gs.add(std::make_shared<guard>());
+
+    std::size_t value = 0;
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        pika::lcos::local::run_guarded(gs, [&value]() { ++value; });
+    }
+    check(value, count);
+}
+
+void concurrent(std::size_t count, std::size_t num_tasks)
+{
+    guard g;
+    std::size_t value = 0;
+
+    std::vector<pika::future<void>> tasks;
+    tasks.reserve(num_tasks);
+    for (std::size_t t = 0; t != num_tasks; ++t)
+    {
+        tasks.push_back(pika::async([&]() {
+            for (std::size_t i = 0; i != count / num_tasks; ++i)
+            {
+                pika::lcos::local::run_guarded(g, [&value]() { ++value; });
+            }
+        }));
+    }
+
+    // a queued task is run by the caller which runs the task in front of it,
+    // so all tasks have been run once all callers have returned
+    pika::wait_all(tasks);
+    check(value, count / num_tasks * num_tasks);
+}
+
+int pika_main(variables_map& vm)
+{
+    std::size_t const count = vm["count"].as<std::size_t>();
+    std::size_t const num_tasks = vm["tasks"].as<std::size_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+
+    pika::util::perftests_report("run_guarded", "single guard", repetitions,
+        [&]() { single_guard(count); });
+    pika::util::perftests_report("run_guarded", "two guards", repetitions,
+        [&]() { two_guards(count); });
+    pika::util::perftests_report("run_guarded", "concurrent", repetitions,
+        [&]() { concurrent(count, num_tasks); });
+
+    pika::util::perftests_print_times();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("count", value<std::size_t>()->default_value(1000000),
+         "number of tasks run through the guards")
+        ("tasks", value<std::size_t>()->default_value(4),
+         "number of tasks running guarded updates concurrently")
+        ("repetitions", value<std::size_t>()->default_value(10),
+         "number of repetitions of each measurement");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -0,0 +1,124 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the throughput of lock/unlock pairs of
+// pika::lcos::local::mutex (and of pika::lcos::local::spinlock for comparison)
+// with an increasing number of pika threads contending for the same lock.
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/mutex.hpp>
+#include <pika/runtime.hpp>
+#include <pika/synchronization/spinlock.hpp>
+#include <pika/testing/performance.hpp>
+
+#include <pika/modules/program_options.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename Mutex>
+void contend(Mutex& mtx, std::uint64_t& counter, std::size_t num_contenders,
+    std::size_t iterations, std::size_t work)
+{
+    std::vector<pika::future<void>> futures;
+    futures.reserve(num_contenders);
+    for (std::size_t i = 0; i != num_contenders; ++i)
+    {
+        futures.push_back(pika::async([&]() {
+            for (std::size_t j = 0; j != iterations; ++j)
+            {
+                std::lock_guard<Mutex> l(mtx);
+
+                // simulate a short critical section
+                for (std::size_t k = 0; k != work; ++k)
+                {
+                    ++counter;
+                }
+                ++counter;
+            }
+        }));
+    }
+    pika::wait_all(futures);
+}
+
+template <typename Mutex>
+void run_benchmark(std::string const& exec, std::size_t max_contenders,
+    std::size_t iterations, std::size_t work, std::size_t repetitions)
+{
+    for (std::size_t num_contenders = 1; num_contenders <= max_contenders;
+         num_contenders *= 2)
+    {
+        pika::util::perftests_report(
+            "mutex lock/unlock, " + std::to_string(num_contenders) +
+                " contenders",
+            exec, repetitions, [&]() {
+                Mutex mtx;
+                std::uint64_t counter = 0;
+                contend(mtx, counter, num_contenders, iterations, work);
+
+                if (counter != num_contenders * iterations * (work + 1))
+                {
+                    throw std::logic_error(
+                        "mutex_throughput: wrong counter value");
+                }
+            });
+    }
+}
+
+int pika_main(variables_map& vm)
+{
+    std::size_t max_contenders = vm["max-contenders"].as<std::size_t>();
+    if (max_contenders == 0)
+    {
+        max_contenders = 2 * pika::get_num_worker_threads();
+    }
+    std::size_t const iterations = vm["iterations"].as<std::size_t>();
+    std::size_t const work = vm["work"].as<std::size_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+
+    run_benchmark<pika::lcos::local::mutex>(
+        "lcos::local::mutex", max_contenders, iterations, work, repetitions);
+    run_benchmark<pika::lcos::local::spinlock>("lcos::local::spinlock",
+        max_contenders, iterations, work, repetitions);
+
+    pika::util::perftests_print_times();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("max-contenders", value<std::size_t>()->default_value(0),
+         "maximum number of pika threads contending for the lock, runs are "
+         "done with all powers of two up to this number (default: twice the "
+         "number of worker threads)")
+        ("iterations", value<std::size_t>()->default_value(10000),
+         "number of lock/unlock pairs per contending thread")
+        ("work", value<std::size_t>()->default_value(10),
+         "number of increments done while holding the lock")
+        ("repetitions", value<std::size_t>()->default_value(10),
+         "number of repetitions for each number of contenders");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
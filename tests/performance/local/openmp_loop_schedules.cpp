@@ -0,0 +1,134 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This example benchmarks OpenMP loop schedules for workloads where every
+// element has the same cost, where the cost grows linearly with the index,
+// and where the cost of each element is random. This is meant to be compared
+// to fork_join_loop_schedules.
+
+#include <pika/modules/program_options.hpp>
+#include <pika/modules/timing.hpp>
+
+#include <omp.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Spins for the given number of units of work.
+void do_work(std::uint64_t cost)
+{
+    double volatile x = 0.0;
+    for (std::uint64_t i = 0; i != cost; ++i)
+    {
+        x = x + 1.0;
+    }
+}
+
+void run_loop(std::vector<std::uint64_t> const& costs)
+{
+    std::int64_t const size = static_cast<std::int64_t>(costs.size());
+
+#pragma omp parallel for schedule(runtime)
+    for (std::int64_t i = 0; i < size; ++i)
+    {
+        do_work(costs[i]);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    pika::program_options::options_description desc_commandline;
+    // clang-format off
+    desc_commandline.add_options()
+        ("size",
+         pika::program_options::value<std::size_t>()->default_value(100000),
+         "number of elements in the loops")
+        ("cost",
+         pika::program_options::value<std::uint64_t>()->default_value(100),
+         "average units of work per element")
+        ("repetitions",
+         pika::program_options::value<std::uint64_t>()->default_value(10),
+         "number of repetitions of each measurement");
+    // clang-format on
+
+    pika::program_options::variables_map vm;
+    pika::program_options::store(
+        pika::program_options::command_line_parser(argc, argv)
+            .allow_unregistered()
+            .options(desc_commandline)
+            .run(),
+        vm);
+
+    std::size_t const size = vm["size"].as<std::size_t>();
+    std::uint64_t const cost = vm["cost"].as<std::uint64_t>();
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+
+    // All workloads have the same total cost.
+    std::vector<std::uint64_t> uniform(size, cost);
+
+    std::vector<std::uint64_t> triangular(size);
+    for (std::size_t i = 0; i != size; ++i)
+    {
+        triangular[i] = 2 * cost * i / size;
+    }
+
+    std::vector<std::uint64_t> random(size);
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::uint64_t> dist(0, 2 * cost);
+    for (auto& c : random)
+    {
+        c = dist(gen);
+    }
+
+    std::pair<std::string, std::vector<std::uint64_t> const&> const
+        workloads[] = {
+            {"uniform", uniform},
+            {"triangular", triangular},
+            {"random", random},
+        };
+
+    std::pair<std::string, omp_sched_t> const schedules[] = {
+        {"static", omp_sched_static},
+        {"dynamic", omp_sched_dynamic},
+        {"guided", omp_sched_guided},
+        {"auto", omp_sched_auto},
+    };
+
+    std::size_t threads = omp_get_max_threads();
+
+    std::cout << "threads, schedule, workload, loop [s]" << std::endl;
+
+    pika::chrono::high_resolution_timer timer;
+
+    for (auto const& schedule : schedules)
+    {
+        // A chunk size of zero selects the default of each schedule
+        omp_set_schedule(schedule.second, 0);
+
+        for (auto const& workload : workloads)
+        {
+            // Do one warmup iteration
+            run_loop(workload.second);
+
+            for (std::uint64_t i = 0; i < repetitions; ++i)
+            {
+                timer.restart();
+
+                run_loop(workload.second);
+
+                auto t_loop = timer.elapsed();
+
+                std::cout << threads << ", " << schedule.first << ", "
+                          << workload.first << ", " << t_loop << std::endl;
+            }
+        }
+    }
+}
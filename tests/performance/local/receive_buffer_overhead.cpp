@@ -0,0 +1,127 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the overhead of storing and receiving values through
+// a pika::lcos::local::receive_buffer, once with all generations kept in the
+// map and once with the generations in use kept in a ring buffer. The values
+// are exchanged like in a halo exchange: a producer runs ahead of the consumer
+// by at most a given number of generations.
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/lcos/receive_buffer.hpp>
+#include <pika/testing/performance.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using buffer_type = pika::lcos::local::receive_buffer<std::size_t>;
+
+///////////////////////////////////////////////////////////////////////////////
+// Stores and receives the generations one after the other on one thread.
+void store_receive(buffer_type& buffer, std::size_t generations)
+{
+    for (std::size_t i = 0; i != generations; ++i)
+    {
+        buffer.store_received(i, std::size_t(i));
+        if (buffer.receive(i).get() != i)
+        {
+            throw std::logic_error("receive_buffer_overhead: wrong value");
+        }
+    }
+}
+
+// The producer stores a generation only once the consumer has received the
+// generation which lies lag generations behind it. Both directions use a
+// receive buffer with the given window.
+void exchange(std::size_t window, std::size_t generations, std::size_t lag)
+{
+    buffer_type buffer(window);
+    buffer_type acks(window);
+
+    pika::future<void> producer = pika::async([&]() {
+        for (std::size_t i = 0; i != generations; ++i)
+        {
+            if (i >= lag)
+            {
+                acks.receive(i - lag).get();
+            }
+            buffer.store_received(i, std::size_t(i));
+        }
+    });
+
+    for (std::size_t i = 0; i != generations; ++i)
+    {
+        if (buffer.receive(i).get() != i)
+        {
+            throw std::logic_error("receive_buffer_overhead: wrong value");
+        }
+        if (i + lag < generations)
+        {
+            acks.store_received(i, std::size_t(i));
+        }
+    }
+
+    producer.get();
+}
+
+int pika_main(variables_map& vm)
+{
+    std::size_t const generations = vm["generations"].as<std::size_t>();
+    std::size_t const window = vm["window"].as<std::size_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+
+    for (std::size_t w : {std::size_t(0), window})
+    {
+        std::string const exec =
+            w == 0 ? "map" : "ring buffer (" + std::to_string(w) + ")";
+
+        pika::util::perftests_report("receive_buffer, store/receive", exec,
+            repetitions, [&]() {
+                buffer_type buffer(w);
+                store_receive(buffer, generations);
+            });
+
+        for (std::size_t lag = 1; lag <= window; lag *= 2)
+        {
+            pika::util::perftests_report(
+                "receive_buffer, exchange, lag " + std::to_string(lag), exec,
+                repetitions, [&]() { exchange(w, generations, lag); });
+        }
+    }
+
+    pika::util::perftests_print_times();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("generations", value<std::size_t>()->default_value(100000),
+         "number of generations exchanged through the receive buffer")
+        ("window", value<std::size_t>()->default_value(8),
+         "number of slots of the ring buffer, the exchange is done with all "
+         "powers of two up to this number of generations between producer "
+         "and consumer")
+        ("repetitions", value<std::size_t>()->default_value(10),
+         "number of repetitions of each measurement");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
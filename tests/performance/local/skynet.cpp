@@ -16,10 +16,14 @@
 
 // This code implements two versions of the skynet micro benchmark: a 'normal'
 // and a futurized one.
+//
+// The number of actors on the final level and the number of actors spawned by
+// each actor can be changed with --size and --div.
 
 #include <pika/chrono.hpp>
 #include <pika/future.hpp>
 #include <pika/init.hpp>
+#include <pika/modules/program_options.hpp>
 
 #include <cstdint>
 #include <iostream>
@@ -81,12 +85,16 @@ pika::future<std::int64_t> skynet_f(
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-int pika_main()
+std::int64_t skynet_size = 1000000;
+std::int64_t skynet_div = 10;
+
+int pika_main(pika::program_options::variables_map&)
 {
     {
         std::uint64_t t = pika::chrono::high_resolution_clock::now();
 
-        pika::future<std::int64_t> result = pika::async(skynet, 0, 1000000, 10);
+        pika::future<std::int64_t> result =
+            pika::async(skynet, 0, skynet_size, skynet_div);
         result.wait();
 
         t = pika::chrono::high_resolution_clock::now() - t;
@@ -99,7 +107,7 @@ int pika_main()
         std::uint64_t t = pika::chrono::high_resolution_clock::now();
 
         pika::future<std::int64_t> result =
-            pika::async(skynet_f, 0, 1000000, 10);
+            pika::async(skynet_f, 0, skynet_size, skynet_div);
         result.wait();
 
         t = pika::chrono::high_resolution_clock::now() - t;
@@ -107,10 +115,28 @@ int pika_main()
         std::cout << "Result 2: " << result.get() << " in " << (t / 1e6)
                   << " ms.\n";
     }
-    return 0;
+    return pika::finalize();
 }
 
 int main(int argc, char* argv[])
 {
-    return pika::init(pika_main, argc, argv);
+    namespace po = pika::program_options;
+    po::options_description cmdline(
+        "usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("size",
+            po::value<std::int64_t>(&skynet_size)->default_value(1000000),
+            "number of actors on the final level (default: 1000000)")
+        ("div",
+            po::value<std::int64_t>(&skynet_div)->default_value(10),
+            "number of actors spawned by each actor (default: 10)")
+        ;
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
 }
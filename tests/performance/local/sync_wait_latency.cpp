@@ -0,0 +1,113 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the latency of sync_wait, once called from a pika
+// thread and once called from an OS thread which is not managed by the
+// runtime. The awaited senders are either ready immediately, scheduled on a
+// thread_pool_scheduler, or scheduled and then busy for a given number of
+// microseconds before they complete.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/testing/performance.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+void busy_wait(std::chrono::microseconds delay)
+{
+    auto const start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < delay)
+    {
+    }
+}
+
+void run_benchmarks(std::string const& caller, std::size_t count,
+    std::size_t repetitions, std::chrono::microseconds delay)
+{
+    ex::thread_pool_scheduler sched{};
+
+    pika::util::perftests_report("sync_wait, ready", caller, repetitions,
+        [&]() {
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                tt::sync_wait(ex::just());
+            }
+        });
+
+    pika::util::perftests_report("sync_wait, scheduled", caller, repetitions,
+        [&]() {
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                tt::sync_wait(ex::schedule(sched));
+            }
+        });
+
+    pika::util::perftests_report(
+        "sync_wait, scheduled and busy for " + std::to_string(delay.count()) +
+            "us",
+        caller, repetitions, [&]() {
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                tt::sync_wait(ex::schedule(sched) |
+                    ex::then([delay]() { busy_wait(delay); }));
+            }
+        });
+}
+
+int pika_main(pika::program_options::variables_map& vm)
+{
+    std::size_t const count = vm["count"].as<std::size_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+    std::chrono::microseconds const delay(vm["delay"].as<std::uint64_t>());
+
+    run_benchmarks("pika thread", count, repetitions, delay);
+
+    // Suspend on a latch instead of blocking in join, the worker thread is
+    // needed to run the scheduled senders.
+    pika::lcos::local::latch os_thread_done(1);
+    std::thread os_thread([&]() {
+        run_benchmarks("OS thread", count, repetitions, delay);
+        os_thread_done.count_down(1);
+    });
+    os_thread_done.wait();
+    os_thread.join();
+
+    pika::util::perftests_print_times();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    using pika::program_options::options_description;
+    using pika::program_options::value;
+
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("count", value<std::size_t>()->default_value(10000),
+         "number of calls to sync_wait per measurement")
+        ("repetitions", value<std::size_t>()->default_value(10),
+         "number of repetitions of each measurement")
+        ("delay", value<std::uint64_t>()->default_value(5),
+         "time in microseconds the delayed senders are busy before they "
+         "complete");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -0,0 +1,85 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the time to run chains of continuations which are
+// each transferred to a thread_pool_scheduler, with and without inline
+// execution of the continuations enabled on the scheduler.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/testing/performance.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+void run_chain(ex::thread_pool_scheduler const& sched, std::size_t length)
+{
+    ex::unique_any_sender<std::size_t> s = ex::just(std::size_t(0));
+    for (std::size_t i = 0; i != length; ++i)
+    {
+        s = ex::transfer(std::move(s), sched) |
+            ex::then([](std::size_t x) { return x + 1; });
+    }
+
+    if (tt::sync_wait(std::move(s)) != length)
+    {
+        throw std::logic_error("then_chain: wrong result of chain");
+    }
+}
+
+int pika_main(pika::program_options::variables_map& vm)
+{
+    std::size_t const max_length = vm["max-chain-length"].as<std::size_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+
+    ex::thread_pool_scheduler sched{};
+    for (bool inline_execution : {false, true})
+    {
+        auto const chain_sched =
+            ex::with_inline_execution(sched, inline_execution);
+        std::string const exec = inline_execution ?
+            "thread_pool_scheduler (inline execution)" :
+            "thread_pool_scheduler";
+
+        for (std::size_t length = 1; length <= max_length; length *= 10)
+        {
+            pika::util::perftests_report(
+                "then chain, length " + std::to_string(length), exec,
+                repetitions, [&]() { run_chain(chain_sched, length); });
+        }
+    }
+
+    pika::util::perftests_print_times();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    using pika::program_options::options_description;
+    using pika::program_options::value;
+
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("max-chain-length", value<std::size_t>()->default_value(1000),
+         "maximum number of continuations in a chain, chains with lengths of "
+         "all powers of ten up to this length are run")
+        ("repetitions", value<std::size_t>()->default_value(10),
+         "number of repetitions for each chain length");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
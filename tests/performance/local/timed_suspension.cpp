@@ -0,0 +1,120 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the wakeup jitter and the throughput of timed
+// suspension of pika threads. Each task suspends itself with sleep_for for a
+// (randomized) duration and records how late it was woken up.
+
+#include <pika/chrono.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <pika/modules/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const num_tasks = vm["tasks"].as<std::size_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+    std::uint64_t const delay = vm["delay"].as<std::uint64_t>();
+    std::uint64_t const spread = vm["spread"].as<std::uint64_t>();
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<std::uint64_t> dist(0, spread);
+
+    std::cout << "tasks, delay [us], spread [us], elapsed [s], "
+                 "timers/s, mean late [us], median late [us], "
+                 "p99 late [us], max late [us]"
+              << std::endl;
+
+    double total_elapsed = 0;
+    for (std::size_t r = 0; r != repetitions; ++r)
+    {
+        std::vector<std::chrono::nanoseconds> durations(num_tasks);
+        for (auto& d : durations)
+        {
+            d = std::chrono::microseconds(delay + dist(gen));
+        }
+
+        std::vector<double> late(num_tasks, 0.0);
+        std::vector<pika::future<void>> futures;
+        futures.reserve(num_tasks);
+
+        pika::chrono::high_resolution_timer timer;
+        for (std::size_t i = 0; i != num_tasks; ++i)
+        {
+            futures.push_back(pika::async([&durations, &late, i]() {
+                auto const start = std::chrono::steady_clock::now();
+                pika::this_thread::sleep_for(durations[i]);
+                auto const woken = std::chrono::steady_clock::now();
+
+                late[i] = std::chrono::duration<double, std::micro>(
+                    (woken - start) - durations[i])
+                              .count();
+            }));
+        }
+        pika::wait_all(futures);
+        double const elapsed = timer.elapsed();
+        total_elapsed += elapsed;
+
+        std::sort(late.begin(), late.end());
+        double mean = 0;
+        for (double l : late)
+        {
+            mean += l;
+        }
+        mean /= double(num_tasks);
+
+        std::cout << num_tasks << ", " << delay << ", " << spread << ", "
+                  << elapsed << ", " << double(num_tasks) / elapsed << ", "
+                  << mean << ", " << late[num_tasks / 2] << ", "
+                  << late[std::min(num_tasks - 1, (num_tasks * 99) / 100)]
+                  << ", " << late.back() << std::endl;
+
+        // no thread may ever be woken up before its deadline
+        PIKA_TEST_LTE(0.0, late.front());
+    }
+
+    pika::util::print_cdash_timing("TimedSuspension", total_elapsed);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description desc_commandline;
+    // clang-format off
+    desc_commandline.add_options()
+        ("tasks", value<std::size_t>()->default_value(100000),
+         "number of tasks suspending themselves")
+        ("repetitions", value<std::size_t>()->default_value(5),
+         "number of repetitions")
+        ("delay", value<std::uint64_t>()->default_value(1000),
+         "minimum suspension time of each task [us]")
+        ("spread", value<std::uint64_t>()->default_value(10000),
+         "maximum additional random suspension time of each task [us]");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = desc_commandline;
+
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv, init_args), 0);
+    return pika::util::report_errors();
+}
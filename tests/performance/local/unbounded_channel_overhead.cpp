@@ -0,0 +1,143 @@
+//  Copyright (c) 2022 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the overhead of passing values through a channel
+// with an unlimited buffer, once with the future based
+// pika::lcos::local::channel and once with the sender based
+// pika::lcos::local::unbounded_channel. The values are either buffered and
+// received later on the same thread, or passed back and forth between two
+// tasks such that every receive has to wait for the value.
+
+#include <pika/execution.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/lcos/channel.hpp>
+#include <pika/synchronization/unbounded_channel.hpp>
+#include <pika/testing/performance.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+namespace tt = pika::this_thread::experimental;
+
+///////////////////////////////////////////////////////////////////////////////
+struct future_channel
+{
+    pika::lcos::local::channel<std::size_t> c;
+
+    void send(std::size_t val)
+    {
+        c.set(val);
+    }
+
+    std::size_t receive()
+    {
+        return c.get().get();
+    }
+};
+
+struct sender_channel
+{
+    pika::lcos::local::unbounded_channel<std::size_t> c;
+
+    void send(std::size_t val)
+    {
+        c.send(val);
+    }
+
+    std::size_t receive()
+    {
+        return tt::sync_wait(c.receive());
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Sends all values before receiving them on the same thread.
+template <typename Channel>
+void buffered(std::size_t count)
+{
+    Channel c;
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        c.send(i);
+    }
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        if (c.receive() != i)
+        {
+            throw std::logic_error("unbounded_channel_overhead: wrong value");
+        }
+    }
+}
+
+// Two tasks pass a counter back and forth until it reaches count.
+template <typename Channel>
+void ping_pong(std::size_t count)
+{
+    Channel ping;
+    Channel pong;
+
+    auto actor = [count](Channel& in, Channel& out) {
+        for (;;)
+        {
+            std::size_t val = in.receive();
+            out.send(val + 1);
+            if (val + 1 >= count)
+            {
+                return;
+            }
+        }
+    };
+
+    pika::future<void> f = pika::async(actor, std::ref(pong), std::ref(ping));
+    ping.send(0);
+    actor(ping, pong);
+    f.get();
+}
+
+int pika_main(variables_map& vm)
+{
+    std::size_t const count = vm["count"].as<std::size_t>();
+    std::size_t const repetitions = vm["repetitions"].as<std::size_t>();
+
+    pika::util::perftests_report("channel, buffered", "future", repetitions,
+        [&]() { buffered<future_channel>(count); });
+    pika::util::perftests_report("channel, buffered", "sender", repetitions,
+        [&]() { buffered<sender_channel>(count); });
+
+    pika::util::perftests_report("channel, ping-pong", "future", repetitions,
+        [&]() { ping_pong<future_channel>(count); });
+    pika::util::perftests_report("channel, ping-pong", "sender", repetitions,
+        [&]() { ping_pong<sender_channel>(count); });
+
+    pika::util::perftests_print_times();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("count", value<std::size_t>()->default_value(100000),
+         "number of values passed through the channel")
+        ("repetitions", value<std::size_t>()->default_value(10),
+         "number of repetitions of each measurement");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}